@@ -0,0 +1 @@
+CONFDEFS?=-DHAVE_MKSTEMP -DHAVE_HYPOT
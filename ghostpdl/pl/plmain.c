@@ -13,6 +13,7 @@
 
 /* plmain.c */
 /* Main program command-line interpreter for PCL interpreters */
+#include <stdlib.h>		/* for strtol */
 #include "string_.h"
 #include "gdebug.h"
 #include "gscdefs.h"
@@ -82,6 +83,10 @@ static const char *pl_usage = "\
 Usage: %s [option* file]+...\n\
 Options: -dNOPAUSE -E[#] -h -L<PCL|PCLXL> -K<maxK> -l<PCL5C|PCL5E|RTL> -Z...\n\
          -sDEVICE=<dev> -g<W>x<H> -r<X>[x<Y>] -d{First|Last}Page=<#>\n\
+         -sPageList=<#>[-[<#>]][,...] -dNumWorkers=<#>\n\
+         -dXPSStreamSize=<bytes> -dXPSImageCacheSize=<bytes>\n\
+         -dXPSResourceCacheSize=<bytes> -dSVGStreaming -dSVGBatch\n\
+         -dSVGTransparency=<true|false> -sSVGFontPath=<directories>\n\
          -sOutputFile=<file> (-s<option>=<string> | -d<option>[=<value>])*\n\
          -J<PJL commands>\n";
 
@@ -212,6 +217,537 @@ close_job(pl_main_universe_t *universe, pl_main_instance_t *pti)
     return pl_dnit_job(universe->curr_instance);
 }
 
+/* Run one input file through PJL and the PDLs it selects.
+ * Returns -1 on errors that should end the run, else 0.
+ */
+static int
+pl_main_run_file(gs_memory_t *mem, pl_main_universe_t *universe,
+                 pl_main_instance_t *inst, pl_interp_instance_t *pjl_instance,
+                 gs_c_param_list *params, pl_interp_instance_t **pcurr_instance,
+                 char *filename)
+{
+    /* for debugging we test the parser with a small 256 byte
+       buffer - for production systems use 8192 bytes */
+#ifdef DEBUG
+    byte                buf[1<<9];
+#else
+    byte                buf[1<<13];
+#endif
+    char                err_buf[256];
+    pl_top_cursor_t     r;
+    int                 code = 0;
+    bool                in_pjl = true;
+    bool                new_job = false;
+    pl_interp_instance_t *curr_instance = *pcurr_instance;
+
+    /* open file for reading - NB we should respect the minimum
+       requirements specified by each implementation in the
+       characteristics structure */
+    if (pl_main_cursor_open(mem, &r, filename, buf, sizeof(buf)) < 0) {
+        errprintf(mem, "Unable to open %s for reading.\n", filename);
+        return -1;
+    }
+#if defined(DEBUG) && defined(ALLOW_VD_TRACE)
+    vd_trace0 = visual_tracer_init();
+#endif
+
+#ifdef DEBUG
+    if (gs_debug_c(':'))
+        dprintf1("%% Reading %s:\n", filename);
+#endif
+    /* pump data thru PJL/PDL until EOD or error */
+    new_job = false;
+    in_pjl = true;
+    for (;;) {
+        if_debug1('i', "[i][file pos=%ld]\n", pl_main_cursor_position(&r));
+        /* end of data - if we are not back in pjl the job has
+           ended in the middle of the data stream. */
+        if (pl_main_cursor_next(&r) <= 0) {
+            if_debug0('|', "End of of data\n");
+            if ( !in_pjl ) {
+                if_debug0('|', "end of data stream found in middle of job\n");
+                pl_process_eof(curr_instance);
+                if ( close_job(universe, inst) < 0 ) {
+                    dprintf("Unable to deinit PDL job.\n");
+                    return -1;
+                }
+            }
+            break;
+        }
+        if ( in_pjl ) {
+            if_debug0('|', "Processing pjl\n");
+            code = pl_process(pjl_instance, &r.cursor);
+            if (code == e_ExitLanguage) {
+                if_debug0('|', "Exiting pjl\n" );
+                in_pjl = false;
+                new_job = true;
+            }
+        }
+        if ( new_job ) {
+            if (mem->gs_lib_ctx->gs_next_id > 0xFF000000) {
+                dprintf("Once a year reset the gs_next_id.\n");
+                return -1;
+            }
+
+            if_debug0('|', "Selecting PDL\n" );
+            curr_instance = pl_main_universe_select(universe, err_buf,
+                                                    pjl_instance,
+                                                    pl_select_implementation(pjl_instance, inst, r),
+                                                    inst, (gs_param_list *)params);
+            if ( curr_instance == NULL ) {
+                dprintf(err_buf);
+                return -1;
+            }
+
+            if ( pl_init_job(curr_instance) < 0 ) {
+                dprintf("Unable to init PDL job.\n");
+                return -1;
+            }
+            if_debug1('|', "selected and initializing (%s)\n",
+                      pl_characteristics(curr_instance->interp->implementation)->language);
+            new_job = false;
+        }
+        if ( curr_instance ) {
+
+            /* Special case when the job resides in a seekable file and
+               the implementation has a function to process a file at a
+               time. */
+            if (curr_instance->interp->implementation->proc_process_file &&
+                r.strm != mem->gs_lib_ctx->fstdin) {
+                if_debug1('|', "processing job from file (%s)\n", filename);
+                code = pl_process_file(curr_instance, filename);
+                if (code < 0) {
+                    dprintf1("Warning interpreter exited with error code %d\n", code);
+                }
+                if (close_job(universe, inst) < 0) {
+                    dprintf("Unable to deinit PJL.\n");
+                    return -1;
+                }
+                if_debug0('|', "exiting job and proceeding to next file\n");
+                break; /* break out of the loop to process the next file */
+            }
+
+            code = pl_process(curr_instance, &r.cursor);
+            if_debug1('|', "processing (%s) job\n",
+                      pl_characteristics(curr_instance->interp->implementation)->language);
+            if (code == e_ExitLanguage) {
+                in_pjl = true;
+                if_debug1('|', "exiting (%s) job back to pjl\n",
+                          pl_characteristics(curr_instance->interp->implementation)->language);
+                if ( close_job(universe, inst) < 0 ) {
+                    dprintf( "Unable to deinit PDL job.\n");
+                    return -1;
+                }
+                if ( pl_init_job(pjl_instance) < 0 ) {
+                    dprintf("Unable to init PJL job.\n");
+                    return -1;
+                }
+                pl_renew_cursor_status(&r);
+            } else if ( code < 0 ) { /* error and not exit language */
+                dprintf1("Warning interpreter exited with error code %d\n", code );
+                dprintf("Flushing to end of job\n" );
+                /* flush eoj may require more data */
+                while ((pl_flush_to_eoj(curr_instance, &r.cursor)) == 0) {
+                    if_debug1('|', "flushing to eoj for (%s) job\n",
+                              pl_characteristics(curr_instance->interp->implementation)->language);
+                    if (pl_main_cursor_next(&r) <= 0) {
+                        if_debug0('|', "end of data found while flushing\n");
+                        break;
+                    }
+                }
+                pl_report_errors(curr_instance, code,
+                                 pl_main_cursor_position(&r),
+                                 inst->error_report > 0);
+                if ( close_job(universe, inst) < 0 ) {
+                    dprintf("Unable to deinit PJL.\n");
+                    return -1;
+                }
+                /* Print PDL status if applicable, then dnit PDL job */
+                code = 0;
+                new_job = true;
+                /* go back to pjl */
+                in_pjl = true;
+            }
+        }
+    }
+    pl_main_cursor_close(&r);
+    *pcurr_instance = curr_instance;
+    return 0;
+}
+
+/* ----------- Worker pool ------ */
+
+/*
+ * With -dNumWorkers=N the input files are shared out among N worker
+ * processes. Each worker is forked before any device is opened, so it
+ * gets its own copy of the allocators, the interpreter instances and
+ * the device, and then works through the files it is given exactly as
+ * the serial loop would. The parent acts as the work queue: it sends
+ * the next file index to whichever worker reports back first.
+ *
+ * Workers write their pages under private names next to the output;
+ * as soon as every earlier file is finished the parent renames them to
+ * the page numbers a serial run would have produced. This needs an
+ * OutputFile with a %d in it. Each worker reports its own errors on the
+ * shared stderr, and an error that stops a serial run stops handing out
+ * files and publishing pages at the same point.
+ *
+ * Options must all come before the first file, and page ranges are
+ * not supported, since both depend on state carried from one file to
+ * the next.
+ *
+ * A single file is run in the main process instead. The worker count
+ * is passed on to the interpreter, which may share out the pages of
+ * the file among workers of its own (see xpsworker.c).
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/wait.h>
+#include "errno_.h"
+#include "unistd_.h"
+#include "gxiodev.h"
+
+#define PL_MAX_WORKERS 256
+
+typedef struct pl_worker_result_s {
+    int worker;
+    int job;
+    int code;           /* 0, or -1 if the run should end */
+    long first_page;    /* PageCount of the worker's device before the job */
+    long last_page;     /* and after */
+} pl_worker_result_t;
+
+typedef struct pl_worker_job_s {
+    int done;
+    pl_worker_result_t result;
+} pl_worker_job_t;
+
+/* Format a page file name the way gx_device_open_output_file does. */
+static void
+pl_worker_page_name(char *buf, const char *fname, const char *fmt, long page)
+{
+    while (*fmt != 'l' && *fmt != '%')
+        --fmt;
+    if (*fmt == 'l')
+        sprintf(buf, fname, page);
+    else
+        sprintf(buf, fname, (int)page);
+}
+
+static int
+pl_worker_read(int fd, void *buf, int len)
+{
+    int n = 0, k;
+
+    while (n < len) {
+        k = read(fd, (char *)buf + n, len - n);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return -1;
+        n += k;
+    }
+    return 0;
+}
+
+static int
+pl_worker_write(int fd, const void *buf, int len)
+{
+    int n = 0, k;
+
+    while (n < len) {
+        k = write(fd, (const char *)buf + n, len - n);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return -1;
+        n += k;
+    }
+    return 0;
+}
+
+/* The worker side: run the files the parent sends until told to stop. */
+static int
+pl_worker_main(gs_memory_t *mem, pl_main_universe_t *universe,
+               pl_main_instance_t *inst, pl_interp_instance_t *pjl_instance,
+               gs_c_param_list *params, char **files, const char *page_template,
+               int worker, int job_fd, int result_fd)
+{
+    pl_interp_instance_t *curr_instance = 0;
+    pl_worker_result_t result;
+    gs_param_string str;
+    int job, first = 1;
+
+    /* the files are shared out here, so each one renders its pages itself */
+    inst->workers = 1;
+
+    /* redirect the pages; the newest value of a parameter wins */
+    gs_c_param_list_write_more(params);
+    param_string_from_transient_string(str, page_template);
+    if (param_write_string((gs_param_list *)params, "OutputFile", &str) < 0)
+        return -1;
+    gs_c_param_list_read(params);
+
+    while (pl_worker_read(job_fd, &job, sizeof(job)) == 0 && job >= 0) {
+        if (!first && pl_init_job(pjl_instance) < 0) {
+            errprintf(mem, "Unable to init PJL job.\n");
+            return -1;
+        }
+        first = 0;
+        result.worker = worker;
+        result.job = job;
+        result.first_page = inst->device->PageCount;
+        result.code = pl_main_run_file(mem, universe, inst, pjl_instance,
+                                       params, &curr_instance, files[job]);
+        result.last_page = inst->device->PageCount;
+        if (pl_worker_write(result_fd, &result, sizeof(result)) < 0 ||
+            result.code < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Rename the pages of a finished file to their serial page numbers. */
+static void
+pl_worker_publish(const pl_worker_result_t *result, char templates[][gp_file_name_sizeof],
+                  const char *fname, const char *fmt, long *page_count)
+{
+    char from[gp_file_name_sizeof];
+    char to[gp_file_name_sizeof];
+    long page;
+
+    for (page = result->first_page + 1; page <= result->last_page; page++) {
+        sprintf(from, templates[result->worker], page);
+        pl_worker_page_name(to, fname, fmt, ++*page_count);
+        if (rename(from, to) != 0)
+            errprintf_nomem("Unable to rename %s to %s.\n", from, to);
+    }
+}
+
+static void
+pl_worker_discard(const pl_worker_result_t *result, char templates[][gp_file_name_sizeof])
+{
+    char from[gp_file_name_sizeof];
+    long page;
+
+    for (page = result->first_page + 1; page <= result->last_page; page++) {
+        sprintf(from, templates[result->worker], page);
+        unlink(from);
+    }
+}
+
+static void
+pl_worker_free_files(gs_memory_t *mem, char **files, int nfiles, pl_worker_job_t *jobs)
+{
+    int i;
+
+    for (i = 0; i < nfiles; i++)
+        gs_free_object(mem, files[i], "pl_main_run_workers");
+    gs_free_object(mem, files, "pl_main_run_workers");
+    gs_free_object(mem, jobs, "pl_main_run_workers");
+}
+
+static int
+pl_main_run_workers(gs_memory_t *mem, pl_main_universe_t *universe,
+                    pl_main_instance_t *inst, pl_interp_instance_t *pjl_instance,
+                    gs_c_param_list *params, arg_list *pal, char *filename)
+{
+    char templates[PL_MAX_WORKERS][gp_file_name_sizeof];
+    char output_name[gp_file_name_sizeof];
+    int job_fds[PL_MAX_WORKERS];
+    pid_t pids[PL_MAX_WORKERS];
+    int result_fds[2];
+    gs_param_string output;
+    gs_parsed_file_name_t parsed;
+    const char *fmt = NULL;
+    const char *arg;
+    const char *slash;
+    char **files = NULL;
+    pl_worker_job_t *jobs = NULL;
+    pl_worker_result_t result;
+    pl_interp_instance_t *curr_instance = 0;
+    int nfiles = 0, maxfiles = 0;
+    int nworkers, started = 0;
+    int next = 0, published = 0, running = 0;
+    bool failed = false;
+    bool stop = false;  /* a published file failed: discard the rest */
+    long page_count = 0;
+    int code = 0, i, k;
+
+    /* collect the files; from here on there are no options */
+    for (arg = filename; arg != 0; arg = arg_next(pal, &code)) {
+        if (code < 0)
+            return -1;
+        if (arg[0] == '-') {
+            errprintf(mem, "With -dNumWorkers all options must precede the files, and stdin cannot be read.\n");
+            return -1;
+        }
+        if (nfiles == maxfiles) {
+            char **p = (char **)gs_alloc_byte_array(mem, maxfiles * 2 + 64, sizeof(char *),
+                                                    "pl_main_run_workers");
+            if (p == 0)
+                goto fail;
+            if (files) {
+                memcpy(p, files, nfiles * sizeof(char *));
+                gs_free_object(mem, files, "pl_main_run_workers");
+            }
+            files = p;
+            maxfiles = maxfiles * 2 + 64;
+        }
+        if ((files[nfiles++] = arg_copy(arg, mem)) == 0)
+            goto fail;
+    }
+
+    /* one file: run it here, and let the interpreter share out its pages */
+    if (nfiles == 1) {
+        code = pl_main_run_file(mem, universe, inst, pjl_instance, params,
+                                &curr_instance, files[0]);
+        pl_worker_free_files(mem, files, nfiles, jobs);
+        return code;
+    }
+
+    if (inst->first_page != 1 || inst->last_page != max_int || inst->page_list) {
+        errprintf(mem, "-dFirstPage, -dLastPage and -sPageList cannot be used with -dNumWorkers.\n");
+        pl_worker_free_files(mem, files, nfiles, jobs);
+        return -1;
+    }
+
+    /* the output must be a page numbered file name */
+    if (param_read_string((gs_param_list *)params, "OutputFile", &output) != 0 ||
+        output.size >= gp_file_name_sizeof) {
+        errprintf(mem, "-dNumWorkers needs an OutputFile with a %%d page number.\n");
+        pl_worker_free_files(mem, files, nfiles, jobs);
+        return -1;
+    }
+    memcpy(output_name, output.data, output.size);
+    output_name[output.size] = 0;
+    if (gx_parse_output_file_name(&parsed, &fmt, output_name, output.size, mem) < 0 ||
+        fmt == NULL || parsed.iodev != iodev_default(mem)) {
+        errprintf(mem, "-dNumWorkers needs an OutputFile with a %%d page number.\n");
+        pl_worker_free_files(mem, files, nfiles, jobs);
+        return -1;
+    }
+
+    jobs = (pl_worker_job_t *)gs_alloc_byte_array(mem, nfiles, sizeof(pl_worker_job_t),
+                                                  "pl_main_run_workers");
+    if (jobs == 0 || pipe(result_fds) < 0)
+        goto fail;
+    memset(jobs, 0, nfiles * sizeof(pl_worker_job_t));
+
+    /* private page names live next to the real ones, so rename is cheap */
+    slash = strrchr(parsed.fname, '/');
+    nworkers = min(min(inst->workers, nfiles), PL_MAX_WORKERS);
+    for (i = 0; i < nworkers; i++) {
+        int fds[2];
+
+        sprintf(templates[i], "%.*s.plwork%ld-%d-%%ld",
+                slash ? (int)(slash - parsed.fname + 1) : 0, parsed.fname,
+                (long)getpid(), i);
+        if (pipe(fds) < 0)
+            break;
+        errflush(mem);
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            break;
+        }
+        if (pids[i] == 0) {
+            /* the worker keeps only its own ends of the pipes */
+            for (k = 0; k < i; k++)
+                close(job_fds[k]);
+            close(fds[1]);
+            close(result_fds[0]);
+            code = pl_worker_main(mem, universe, inst, pjl_instance, params,
+                                  files, templates[i], i, fds[0], result_fds[1]);
+            close(fds[0]);
+            close(result_fds[1]);
+            return code < 0 ? -1 : 0;
+        }
+        close(fds[0]);
+        job_fds[i] = fds[1];
+        started++;
+    }
+    close(result_fds[1]);
+    if (started == 0)
+        goto fail;
+
+    /* hand out the first files, then one more per reply */
+    for (i = 0; i < started && next < nfiles; i++, running++)
+        pl_worker_write(job_fds[i], &next, sizeof(next)), next++;
+
+    while (running > 0 && pl_worker_read(result_fds[0], &result, sizeof(result)) == 0) {
+        running--;
+        jobs[result.job].done = 1;
+        jobs[result.job].result = result;
+        if (result.code < 0)
+            failed = true;
+        else if (!failed && next < nfiles) {
+            pl_worker_write(job_fds[result.worker], &next, sizeof(next));
+            next++;
+            running++;
+        }
+
+        /* publish in input order, stopping where a serial run would */
+        while (published < nfiles && jobs[published].done) {
+            if (stop)
+                pl_worker_discard(&jobs[published].result, templates);
+            else {
+                pl_worker_publish(&jobs[published].result, templates,
+                                  parsed.fname, fmt, &page_count);
+                stop = jobs[published].result.code < 0;
+            }
+            published++;
+        }
+    }
+
+    /* a worker died before it answered */
+    if (running > 0)
+        failed = true;
+    for (; published < next; published++)
+        if (jobs[published].done)
+            pl_worker_discard(&jobs[published].result, templates);
+
+    for (i = 0; i < started; i++)
+        close(job_fds[i]);
+    close(result_fds[0]);
+    for (i = 0; i < started; i++) {
+        int status = 0;
+        pid_t pid;
+
+        while ((pid = waitpid(pids[i], &status, 0)) < 0 && errno == EINTR)
+            ;
+        if (pid < 0)
+            continue;   /* already reaped; there is no status to check */
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0 && !failed)) {
+            errprintf(mem, "Worker %d exited abnormally.\n", i);
+            failed = true;
+        }
+    }
+
+    pl_worker_free_files(mem, files, nfiles, jobs);
+    return failed ? -1 : 0;
+
+ fail:
+    errprintf(mem, "Unable to start the worker processes.\n");
+    pl_worker_free_files(mem, files, nfiles, jobs);
+    return -1;
+}
+
+#else
+
+static int
+pl_main_run_workers(gs_memory_t *mem, pl_main_universe_t *universe,
+                    pl_main_instance_t *inst, pl_interp_instance_t *pjl_instance,
+                    gs_c_param_list *params, arg_list *pal, char *filename)
+{
+    errprintf(mem, "-dNumWorkers is not supported on this platform.\n");
+    return -1;
+}
+
+#endif
+
 /* ----------- Command-line driver for pl_interp's  ------ */
 /*
  * Here is the real main program.
@@ -286,19 +822,6 @@ pl_main_aux(
     /* ------ Begin Main LOOP ------- */
     for (;;) {
         /* Process one input file. */
-        /* for debugging we test the parser with a small 256 byte
-           buffer - for production systems use 8192 bytes */
-#ifdef DEBUG
-        byte                buf[1<<9];
-#else
-        byte                buf[1<<13];
-#endif
-        pl_top_cursor_t     r;
-        int                 code = 0;
-        bool                in_pjl = true;
-        bool                new_job = false;
-
-
         if ( pl_init_job(pjl_instance) < 0 ) {
             errprintf(mem, "Unable to init PJL job.\n");
             return -1;
@@ -348,137 +871,17 @@ pl_main_aux(
 	    ddev->callback = (display_callback *)disp;
 	}
 
-	/* open file for reading - NB we should respect the minimum
-           requirements specified by each implementation in the
-           characteristics structure */
-        if (pl_main_cursor_open(mem, &r, filename, buf, sizeof(buf)) < 0) {
-            errprintf(mem, "Unable to open %s for reading.\n", filename);
-            return -1;
+        /* Hand this and the remaining files to a pool of workers */
+        if (inst.workers > 1) {
+            if (pl_main_run_workers(mem, &universe, &inst, pjl_instance,
+                                    &params, &args, filename) < 0)
+                return -1;
+            break;
         }
-#if defined(DEBUG) && defined(ALLOW_VD_TRACE)
-        vd_trace0 = visual_tracer_init();
-#endif
 
-#ifdef DEBUG
-        if (gs_debug_c(':'))
-            dprintf1("%% Reading %s:\n", filename);
-#endif
-        /* pump data thru PJL/PDL until EOD or error */
-        new_job = false;
-        in_pjl = true;
-        for (;;) {
-            if_debug1('i', "[i][file pos=%ld]\n", pl_main_cursor_position(&r));
-            /* end of data - if we are not back in pjl the job has
-               ended in the middle of the data stream. */
-            if (pl_main_cursor_next(&r) <= 0) {
-                if_debug0('|', "End of of data\n");
-                if ( !in_pjl ) {
-                    if_debug0('|', "end of data stream found in middle of job\n");
-                    pl_process_eof(curr_instance);
-                    if ( close_job(&universe, &inst) < 0 ) {
-                        dprintf("Unable to deinit PDL job.\n");
-                        return -1;
-                    }
-                }
-                break;
-            }
-            if ( in_pjl ) {
-                if_debug0('|', "Processing pjl\n");
-                code = pl_process(pjl_instance, &r.cursor);
-                if (code == e_ExitLanguage) {
-                    if_debug0('|', "Exiting pjl\n" );
-                    in_pjl = false;
-                    new_job = true;
-                }
-            }
-            if ( new_job ) {
-                if (mem->gs_lib_ctx->gs_next_id > 0xFF000000) {
-                    dprintf("Once a year reset the gs_next_id.\n");
-                    return -1;
-                }
-
-                if_debug0('|', "Selecting PDL\n" );
-                curr_instance = pl_main_universe_select(&universe, err_buf,
-                                                        pjl_instance,
-                                                        pl_select_implementation(pjl_instance, &inst, r),
-                                                        &inst, (gs_param_list *)&params);
-                if ( curr_instance == NULL ) {
-                    dprintf(err_buf);
-                    return -1;
-                }
-
-                if ( pl_init_job(curr_instance) < 0 ) {
-                    dprintf("Unable to init PDL job.\n");
-                    return -1;
-                }
-                if_debug1('|', "selected and initializing (%s)\n",
-                          pl_characteristics(curr_instance->interp->implementation)->language);
-                new_job = false;
-            }
-            if ( curr_instance ) {
-
-                /* Special case when the job resides in a seekable file and
-                   the implementation has a function to process a file at a
-                   time. */
-                if (curr_instance->interp->implementation->proc_process_file &&
-                    r.strm != mem->gs_lib_ctx->fstdin) {
-                    if_debug1('|', "processing job from file (%s)\n", filename);
-                    code = pl_process_file(curr_instance, filename);
-                    if (code < 0) {
-                        dprintf1("Warning interpreter exited with error code %d\n", code);
-                    }
-                    if (close_job(&universe, &inst) < 0) {
-                        dprintf("Unable to deinit PJL.\n");
-                        return -1;
-                    }
-                    if_debug0('|', "exiting job and proceeding to next file\n");
-                    break; /* break out of the loop to process the next file */
-                }
-
-                code = pl_process(curr_instance, &r.cursor);
-                if_debug1('|', "processing (%s) job\n",
-                          pl_characteristics(curr_instance->interp->implementation)->language);
-                if (code == e_ExitLanguage) {
-                    in_pjl = true;
-                    if_debug1('|', "exiting (%s) job back to pjl\n",
-                              pl_characteristics(curr_instance->interp->implementation)->language);
-                    if ( close_job(&universe, &inst) < 0 ) {
-                        dprintf( "Unable to deinit PDL job.\n");
-                        return -1;
-                    }
-                    if ( pl_init_job(pjl_instance) < 0 ) {
-                        dprintf("Unable to init PJL job.\n");
-                        return -1;
-                    }
-                    pl_renew_cursor_status(&r);
-                } else if ( code < 0 ) { /* error and not exit language */
-                    dprintf1("Warning interpreter exited with error code %d\n", code );
-                    dprintf("Flushing to end of job\n" );
-                    /* flush eoj may require more data */
-                    while ((pl_flush_to_eoj(curr_instance, &r.cursor)) == 0) {
-                        if_debug1('|', "flushing to eoj for (%s) job\n",
-                                  pl_characteristics(curr_instance->interp->implementation)->language);
-                        if (pl_main_cursor_next(&r) <= 0) {
-                            if_debug0('|', "end of data found while flushing\n");
-                            break;
-                        }
-                    }
-                    pl_report_errors(curr_instance, code,
-                                     pl_main_cursor_position(&r),
-                                     inst.error_report > 0);
-                    if ( close_job(&universe, &inst) < 0 ) {
-                        dprintf("Unable to deinit PJL.\n");
-                        return -1;
-                    }
-                    /* Print PDL status if applicable, then dnit PDL job */
-                    code = 0;
-                    new_job = true;
-                    /* go back to pjl */
-                    in_pjl = true;
-                }
-            }
-        }
-        pl_main_cursor_close(&r);
+        if (pl_main_run_file(mem, &universe, &inst, pjl_instance, &params,
+                             &curr_instance, filename) < 0)
+            return -1;
     }
 
     /* ----- End Main loop ----- */
@@ -631,6 +1034,15 @@ pl_main_universe_dnit(
 
     /* dealloc device if sel'd */
     if (universe->curr_device) {
+        /* Close it explicitly: a printer with pages still printing in the */
+        /* background (MaxPagesInFlight) only finishes them when closed, */
+        /* and other references, e.g. from a transparency compositor, */
+        /* can keep the device from being freed below. */
+        if (gs_closedevice(universe->curr_device) < 0) {
+            if (err_str)
+                strcpy(err_str, "Unable to close device.\n");
+            return -1;
+        }
         gs_unregister_root(universe->curr_device->memory, &device_root, "pl_main_universe_select");
         /* ps allocator retain's the device, pl_alloc doesn't */
         gx_device_retain(universe->curr_device, false);
@@ -731,6 +1143,17 @@ pl_main_universe_select(
         /* NB fix me, these parameters should not be passed this way */
         universe->curr_instance->pcl_personality = pti->pcl_personality;
         universe->curr_instance->interpolate = pti->interpolate;
+        universe->curr_instance->first_page = pti->first_page;
+        universe->curr_instance->last_page = pti->last_page;
+        universe->curr_instance->page_list = pti->page_list;
+        universe->curr_instance->workers = pti->workers;
+        universe->curr_instance->xps_stream_size = pti->xps_stream_size;
+        universe->curr_instance->xps_image_cache_size = pti->xps_image_cache_size;
+        universe->curr_instance->xps_resource_cache_size = pti->xps_resource_cache_size;
+        universe->curr_instance->svg_streaming = pti->svg_streaming;
+        universe->curr_instance->svg_batch = pti->svg_batch;
+        universe->curr_instance->svg_transparency = pti->svg_transparency;
+        universe->curr_instance->svg_font_path = pti->svg_font_path;
 
         /* Select curr/new device into PDL instance */
         if ( pl_set_device(universe->curr_instance, universe->curr_device) < 0 ) {
@@ -739,7 +1162,8 @@ pl_main_universe_select(
             return 0;
         }
         /* potentially downgrade the resolution */
-        if ( ( pti->page_count + 1 ) < pti->first_page ) {
+        if ( ( pti->page_count + 1 ) < pti->first_page &&
+             !pl_characteristics(desired_implementation)->selects_pages ) {
             if ( !pti->saved_hwres ) {
                 gx_device *pdev = universe->curr_device;
                 pti->saved_hwres = true;
@@ -795,6 +1219,15 @@ pl_main_init_instance(pl_main_instance_t *pti, gs_memory_t *mem)
     gp_get_usertime(pti->base_time);
     pti->first_page = 1;
     pti->last_page = max_int;
+    pti->page_list = NULL;
+    pti->workers = 1;
+    pti->xps_stream_size = -1;
+    pti->xps_image_cache_size = -1;
+    pti->xps_resource_cache_size = -1;
+    pti->svg_streaming = false;
+    pti->svg_batch = false;
+    pti->svg_transparency = -1;
+    pti->svg_font_path = NULL;
     pti->page_count = 0;
     pti->saved_hwres = false;
     pti->interpolate = false;
@@ -849,6 +1282,53 @@ set_debug_flags(const char *arg, char *flags)
         flags[*arg++ & 127] = value;
 }
 
+/*
+ * Read an interpreter option -d<name>=<value>, whose value must be an
+ * integer of at least min_value. Returns 1 if arg is the option, 0 if
+ * it is some other option, and -1 if the value is not valid.
+ */
+static int
+pl_main_int_option(const char *arg, const char *name, int min_value, int *pvalue)
+{
+    int len = strlen(name);
+    const char *value = arg + len + 1;
+    char *end;
+    long v;
+
+    if ( strncmp(arg, name, len) || arg[len] != '=' )
+        return 0;
+    v = strtol(value, &end, 10);
+    if ( end == value || *end != '\0' || v < min_value || v > max_int ) {
+        dprintf3("Usage for -d%s is -d%s=<integer>, at least %d\n",
+                 name, name, min_value);
+        return -1;
+    }
+    *pvalue = (int)v;
+    return 1;
+}
+
+/*
+ * Read an interpreter option -d<name>, -d<name>=true or -d<name>=false.
+ * Returns as pl_main_int_option does.
+ */
+static int
+pl_main_bool_option(const char *arg, const char *name, bool *pvalue)
+{
+    int len = strlen(name);
+
+    if ( strncmp(arg, name, len) || (arg[len] != '\0' && arg[len] != '=') )
+        return 0;
+    if ( arg[len] == '\0' || !strcmp(arg + len + 1, "true") )
+        *pvalue = true;
+    else if ( !strcmp(arg + len + 1, "false") )
+        *pvalue = false;
+    else {
+        dprintf2("Usage for -d%s is -d%s[=true|false]\n", name, name);
+        return -1;
+    }
+    return 1;
+}
+
 #define arg_heap_copy(str) arg_copy(str, pmi->memory)
 int
 pl_main_process_options(pl_main_instance_t *pmi, arg_list *pal,
@@ -887,6 +1367,27 @@ pl_main_process_options(pl_main_instance_t *pmi, arg_list *pal,
                 pmi->interpolate = true;
                 continue;
             }
+            /* interpreter options, passed on with the interpreter instance */
+            code = pl_main_int_option(arg, "XPSStreamSize", 1, &pmi->xps_stream_size);
+            if ( code == 0 )
+                code = pl_main_int_option(arg, "XPSImageCacheSize", 0, &pmi->xps_image_cache_size);
+            if ( code == 0 )
+                code = pl_main_int_option(arg, "XPSResourceCacheSize", 0, &pmi->xps_resource_cache_size);
+            if ( code == 0 )
+                code = pl_main_bool_option(arg, "SVGStreaming", &pmi->svg_streaming);
+            if ( code == 0 )
+                code = pl_main_bool_option(arg, "SVGBatch", &pmi->svg_batch);
+            if ( code == 0 ) {
+                bool transparency;
+
+                code = pl_main_bool_option(arg, "SVGTransparency", &transparency);
+                if ( code > 0 )
+                    pmi->svg_transparency = transparency;
+            }
+            if ( code < 0 )
+                return -1;
+            if ( code > 0 )
+                continue;
 
             {
                 /* We're setting a device parameter to a non-string value. */
@@ -942,6 +1443,8 @@ pl_main_process_options(pl_main_instance_t *pmi, arg_list *pal,
                         pmi->first_page = max(vi, 1);
                     else if ( !strncmp(arg, "LastPage", 8) )
                         pmi->last_page = vi;
+                    else if ( !strncmp(arg, "NumWorkers", 10) )
+                        pmi->workers = max(vi, 1);
                     else {
                         /* create a null terminated string */
                         strncpy(buffer, arg, eqp - arg);
@@ -1122,6 +1625,20 @@ pl_main_process_options(pl_main_instance_t *pmi, arg_list *pal,
                                              false);
                     if ( code < 0 ) return code;
                 }
+                else if ( !strncmp(arg, "PageList", 8) ) {
+                    if ( pl_check_page_list(value) < 0 ) {
+                        dprintf("Usage for -sPageList is -sPageList=<#>[-[<#>]][,...]\n");
+                        return -1;
+                    }
+                    pmi->page_list = arg_heap_copy(value);
+                }
+                else if ( !strncmp(arg, "SVGFontPath", 11) ) {
+                    if ( *value == '\0' ) {
+                        dprintf("Usage for -sSVGFontPath is -sSVGFontPath=<directory list>\n");
+                        return -1;
+                    }
+                    pmi->svg_font_path = arg_heap_copy(value);
+                }
                 else {
                     char buffer[128];
                     strncpy(buffer, arg, eqp - arg);
@@ -1242,6 +1759,26 @@ pl_pre_finish_page(pl_interp_instance_t *interp, void *closure)
     /* up the page count */
     ++(pti->page_count);
 
+    /* the interpreter only outputs the pages that are wanted */
+    if ( pl_characteristics(interp->interp->implementation)->selects_pages ) {
+        if ( pti->saved_hwres ) {
+            pti->saved_hwres = false;
+            gx_device_set_resolution(pti->device,
+                                     pti->hwres[0], pti->hwres[1]);
+        }
+        return 0;
+    }
+
+    /* pages outside the page list are rendered but not printed */
+    if ( pti->page_list ) {
+        int selected = pl_page_selected(pti->first_page, pti->last_page,
+                                        pti->page_list, pti->page_count);
+        if ( selected < 0 )
+            return e_ExitLanguage;
+        if ( selected == 0 )
+            return 1;
+    }
+
     /* if the next page is in range we want to restore the resolution */
     if ( (pti->page_count + 1) >= pti->first_page &&
          (pti->page_count + 1) <= pti->last_page ) {
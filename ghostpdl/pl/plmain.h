@@ -39,6 +39,15 @@ typedef struct pl_main_instance_s {
     bool pause;		        /* -dNOPAUSE => false */
     int first_page;		/* -dFirstPage= */
     int last_page;		/* -dLastPage= */
+    const char *page_list;	/* -sPageList=, or NULL */
+    int workers;		/* -dNumWorkers= */
+    int xps_stream_size;	/* -dXPSStreamSize=, or -1 */
+    int xps_image_cache_size;	/* -dXPSImageCacheSize=, or -1 */
+    int xps_resource_cache_size;	/* -dXPSResourceCacheSize=, or -1 */
+    bool svg_streaming;		/* -dSVGStreaming */
+    bool svg_batch;		/* -dSVGBatch */
+    int svg_transparency;	/* -dSVGTransparency=, or -1 */
+    const char *svg_font_path;	/* -sSVGFontPath=, or NULL */
     gx_device *device;
     vm_spaces spaces;           /* spaces for "ersatz" garbage collector */
 
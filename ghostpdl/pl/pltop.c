@@ -14,6 +14,7 @@
 /* pltop.c */
 /* Top-level API for interpreters */
 
+#include <stdlib.h>		/* for strtol */
 #include "string_.h"
 #include "gdebug.h"
 #include "gsnogc.h"
@@ -237,3 +238,78 @@ pl_deallocate_interp(
 	return code;
 }
 
+
+/* Read the next entry of a page list, "3" or "5-7" or "10-".
+ * Returns 1 with the range, 0 at the end of the list, or -1 if the
+ * list is malformed.
+ */
+static int
+pl_next_page_range(const char **plist, int *lo, int *hi)
+{
+    const char *p = *plist;
+    char *end;
+    long v;
+
+    if (*p == 0)
+        return 0;
+    v = strtol(p, &end, 10);
+    if (end == p || v < 1)
+        return -1;
+    *lo = *hi = (int)min(v, max_int);
+    p = end;
+    if (*p == '-') {
+        p++;
+        if (*p == 0 || *p == ',')
+            *hi = max_int;
+        else {
+            v = strtol(p, &end, 10);
+            if (end == p || v < *lo)
+                return -1;
+            *hi = (int)min(v, max_int);
+            p = end;
+        }
+    }
+    if (*p == ',')
+        p++;
+    else if (*p != 0)
+        return -1;
+    *plist = p;
+    return 1;
+}
+
+/* Check the syntax of a comma separated list of pages and ranges. */
+int   /* ret 0 ok, else -ve error code */
+pl_check_page_list(const char *page_list)
+{
+    int lo, hi, code;
+
+    while ((code = pl_next_page_range(&page_list, &lo, &hi)) > 0)
+        ;
+    return code;
+}
+
+/* Pages are counted from 1. The page list, if any, selects a set of
+ * pages within FirstPage..LastPage; pages are always produced in
+ * document order.
+ */
+int   /* ret 1 if the page is selected, 0 if not, -1 if no later page is */
+pl_page_selected(int first_page, int last_page, const char *page_list, int page)
+{
+    int lo, hi;
+    bool later = false;
+
+    if (page > last_page)
+        return -1;
+    if (page < first_page)
+        return 0;
+    if (!page_list)
+        return 1;
+
+    while (pl_next_page_range(&page_list, &lo, &hi) > 0) {
+        if (page >= lo && page <= hi)
+            return 1;
+        if (hi > page)
+            later = true;
+    }
+    return later ? 0 : -1;
+}
@@ -41,6 +41,17 @@ typedef struct pl_interp_instance_s {
     vm_spaces       spaces;             /* spaces for GC */
     char *          pcl_personality;
     bool            interpolate;
+    int             first_page;         /* -dFirstPage=, 1 if not given */
+    int             last_page;          /* -dLastPage=, max_int if not given */
+    const char *    page_list;          /* -sPageList=, or NULL */
+    int             workers;            /* -dNumWorkers=, 1 if not given */
+    int             xps_stream_size;    /* -dXPSStreamSize=, -1 if not given */
+    int             xps_image_cache_size; /* -dXPSImageCacheSize=, -1 if not given */
+    int             xps_resource_cache_size; /* -dXPSResourceCacheSize=, -1 if not given */
+    bool            svg_streaming;      /* -dSVGStreaming */
+    bool            svg_batch;          /* -dSVGBatch */
+    int             svg_transparency;   /* -dSVGTransparency=, -1 if not given */
+    const char *    svg_font_path;      /* -sSVGFontPath=, or NULL */
 } pl_interp_instance_t;
 
 /* Param data types */
@@ -57,6 +68,8 @@ typedef struct pl_interp_characteristics_s {
   const char*                 version;           /* version str */
   const char*                 build_date;        /* build date str */
   int                         min_input_size;    /* min sizeof input buffer */
+  bool                        selects_pages;     /* skips unselected pages itself, counting
+						    pages from the start of each job */
 } pl_interp_characteristics_t;
 
 /*
@@ -167,6 +180,10 @@ int pl_deallocate_interp(pl_interp_t *);
 typedef int (*pl_interp_proc_deallocate_interp_t)(pl_interp_t *);
 
 int pl_get_device_memory(pl_interp_instance_t *, gs_memory_t **);
+
+/* Page selection by -dFirstPage, -dLastPage and -sPageList */
+int pl_check_page_list(const char *page_list);
+int pl_page_selected(int first_page, int last_page, const char *page_list, int page);
 typedef int (*pl_interp_proc_get_device_memory_t)(pl_interp_instance_t *, gs_memory_t **);
 
 pl_interp_instance_t *get_interpreter_from_memory( const gs_memory_t *mem );
@@ -25,6 +25,7 @@
 #include "gsmatrix.h"
 #include "gscoord.h"
 #include "gsmemory.h"
+#include "gdebug.h"
 #include "gsparam.h"
 #include "gsdevice.h"
 #include "scommon.h"
@@ -86,17 +87,22 @@
 
 typedef struct svg_context_s svg_context_t;
 typedef struct svg_item_s svg_item_t;
+typedef struct svg_arena_block_s svg_arena_block_t;
+typedef struct svg_display_list_s svg_display_list_t;
+typedef struct svg_gradient_s svg_gradient_t;
 
 /*
  * Context and memory.
  */
 
+void * svg_realloc_imp(svg_context_t *ctx, void *ptr, int size, const char *func);
+
 #define svg_alloc(ctx, size) \
     ((void*)gs_alloc_bytes(ctx->memory, size, __func__));
 #define svg_realloc(ctx, ptr, size) \
-    gs_resize_object(ctx->memory, ptr, size, __func__);
+    svg_realloc_imp(ctx, ptr, size, __func__)
 #define svg_strdup(ctx, str) \
-    svg_strdup_imp(ctx, str, __func__);
+    svg_strdup_imp(ctx, str, __func__)
 #define svg_free(ctx, ptr) \
     gs_free_object(ctx->memory, ptr, __func__);
 
@@ -107,6 +113,19 @@ char *svg_strdup_imp(svg_context_t *ctx, const char *str, const char *function);
 char *svg_clean_path(char *name);
 void svg_absolute_path(char *output, char *pwd, char *path);
 
+/*
+ * Generic hashtable.
+ */
+
+typedef struct svg_hash_table_s svg_hash_table_t;
+
+svg_hash_table_t *svg_hash_new(svg_context_t *ctx);
+void *svg_hash_lookup(svg_hash_table_t *table, const char *key);
+int svg_hash_insert(svg_context_t *ctx, svg_hash_table_t *table, char *key, void *value);
+void svg_hash_free(svg_context_t *ctx, svg_hash_table_t *table,
+    void (*free_key)(svg_context_t *ctx, void *),
+    void (*free_value)(svg_context_t *ctx, void *));
+
 /* end of page device callback foo */
 int svg_show_page(svg_context_t *ctx, int num_copies, int flush);
 
@@ -121,6 +140,8 @@ float svg_parse_angle(char *str);
 
 int svg_parse_color(char *str, float *rgb);
 
+int svg_lex_number(const char **sp, float *val);
+
 int svg_is_whitespace_or_comma(int c);
 int svg_is_whitespace(int c);
 int svg_is_alpha(int c);
@@ -132,14 +153,153 @@ int svg_is_digit(int c);
 
 int svg_parse_common(svg_context_t *ctx, svg_item_t *node);
 
+typedef struct svg_paint_state_s svg_paint_state_t;
+
+struct svg_paint_state_s
+{
+    int fill_rule;
+    int fill_is_set;
+    float fill_color[3];
+    svg_gradient_t *fill_gradient;
+    float fill_opacity;
+    int stroke_is_set;
+    float stroke_color[3];
+    svg_gradient_t *stroke_gradient;
+    float stroke_opacity;
+    float opacity;
+};
+
+void svg_save_paint(svg_context_t *ctx, svg_paint_state_t *ps);
+void svg_restore_paint(svg_context_t *ctx, const svg_paint_state_t *ps);
+
 int svg_parse_transform(svg_context_t *ctx, char *str);
 
 void svg_set_color(svg_context_t *ctx, float *rgb);
+void svg_set_alpha(svg_context_t *ctx, float alpha);
 void svg_set_fill_color(svg_context_t *ctx);
 void svg_set_stroke_color(svg_context_t *ctx);
 
 int svg_parse_image(svg_context_t *ctx, svg_item_t *node);
 
+/*
+ * Gradients, compiled to shadings and kept by id for the document.
+ */
+
+int svg_parse_gradient(svg_context_t *ctx, svg_item_t *node);
+int svg_lookup_gradient(svg_context_t *ctx, const char *str, svg_gradient_t **gradp);
+int svg_paint_gradient(svg_context_t *ctx, svg_gradient_t *grad, int stroke);
+void svg_free_gradients(svg_context_t *ctx);
+
+/*
+ * Opacity. The pdf14 compositor is only pushed for documents
+ * that need it.
+ */
+
+int svg_needs_transparency(svg_item_t *root);
+float svg_element_opacity(svg_context_t *ctx, svg_item_t *node);
+int svg_parse_translucent_element(svg_context_t *ctx, svg_item_t *node, float opacity);
+int svg_begin_opacity(svg_context_t *ctx, float opacity, const gs_rect *bbox);
+void svg_end_opacity(svg_context_t *ctx);
+int svg_bounds_in_user_space(svg_context_t *ctx, gs_rect *ubox);
+
+/*
+ * Path construction. Segments are transformed by the CTM that was
+ * current at svg_begin_path and appended straight to the gx_path
+ * in fixed point, bypassing the gs_moveto family of calls.
+ */
+
+typedef struct svg_path_builder_s svg_path_builder_t;
+
+struct svg_path_builder_s
+{
+    svg_context_t *ctx;
+    gs_state *pgs;
+    gx_path *ppath;
+    svg_display_list_t *rec; /* record segments here instead */
+    gs_matrix ctm;
+    float cx, cy; /* current point in user space */
+    float sx, sy; /* start of current subpath */
+    int started;
+};
+
+void svg_begin_path(svg_context_t *ctx, svg_path_builder_t *pb);
+int svg_end_path(svg_path_builder_t *pb);
+int svg_path_moveto(svg_path_builder_t *pb, float x, float y);
+int svg_path_lineto(svg_path_builder_t *pb, float x, float y);
+int svg_path_curveto(svg_path_builder_t *pb, float x1, float y1, float x2, float y2, float x3, float y3);
+int svg_path_closepath(svg_path_builder_t *pb);
+
+int svg_paint_path(svg_context_t *ctx, int fill, int stroke);
+
+/*
+ * Compiled display lists for referenced content (<defs>, <symbol>, <use>).
+ *
+ * While a definition is compiled, the path builder and painting
+ * functions append to ctx->record instead of drawing. Each painted
+ * path is stored in user space with its CTM relative to the referencing
+ * <use> element, so that instances can be replayed under any CTM
+ * without touching the attributes or path strings again.
+ */
+
+#define SVG_INHERIT (-1) /* fill/stroke not set in the definition */
+
+#define SVG_PAINT_FILL 1
+#define SVG_PAINT_STROKE 2
+
+typedef struct svg_display_op_s svg_display_op_t;
+
+struct svg_display_op_s
+{
+    gs_matrix ctm;
+    int paint;
+    int cmd_first, cmd_count; /* segments, as path commands */
+    int coord_first; /* and their coordinates */
+
+    int fill_rule;
+    int fill_is_set;
+    float fill_color[3];
+    svg_gradient_t *fill_gradient;
+    int stroke_is_set;
+    float stroke_color[3];
+    svg_gradient_t *stroke_gradient;
+    float fill_opacity;
+    float stroke_opacity;
+    float opacity;
+
+    float line_width;
+    gs_line_cap line_cap;
+    gs_line_join line_join;
+    float miter_limit;
+};
+
+struct svg_display_list_s
+{
+    int op_count, op_cap;
+    svg_display_op_t *ops;
+    int cmd_count, cmd_cap;
+    byte *cmds;
+    int coord_count, coord_cap;
+    float *coords;
+
+    /* state for the path being recorded */
+    gs_matrix path_ctm;
+    int path_cmd_first;
+    int path_coord_first;
+};
+
+int svg_record_segment(svg_context_t *ctx, svg_display_list_t *list, int cmd, const float *coords, int n);
+int svg_record_paint(svg_context_t *ctx, int paint);
+int svg_record_element(svg_context_t *ctx, svg_item_t *node, svg_display_list_t *list,
+	int is_symbol, float opacity);
+int svg_replay_list(svg_context_t *ctx, svg_display_list_t *list);
+int svg_display_list_bbox(svg_display_list_t *list, gs_rect *box);
+void svg_free_display_list(svg_context_t *ctx, svg_display_list_t *list);
+
+int svg_parse_defs(svg_context_t *ctx, svg_item_t *node);
+int svg_parse_symbol(svg_context_t *ctx, svg_item_t *node);
+int svg_parse_use(svg_context_t *ctx, svg_item_t *node);
+void svg_free_defs(svg_context_t *ctx);
+
 int svg_parse_path(svg_context_t *ctx, svg_item_t *node);
 
 int svg_parse_rect(svg_context_t *ctx, svg_item_t *node);
@@ -149,32 +309,98 @@ int svg_parse_line(svg_context_t *ctx, svg_item_t *node);
 int svg_parse_polyline(svg_context_t *ctx, svg_item_t *node);
 int svg_parse_polygon(svg_context_t *ctx, svg_item_t *node);
 
+/*
+ * Fonts and text.
+ */
+
+int svg_init_font_cache(svg_context_t *ctx);
+void svg_free_font_cache(svg_context_t *ctx);
+gs_font *svg_select_font(svg_context_t *ctx, const char *family, int bold, int italic);
+
 int svg_parse_text(svg_context_t *ctx, svg_item_t *node);
+void svg_debug_text(svg_context_t *ctx);
 
 /*
  * Global context and XML parsing.
  */
 
 int svg_parse_element(svg_context_t *ctx, svg_item_t *root);
+int svg_draw_element(svg_context_t *ctx, svg_item_t *root);
 
 int svg_open_xml_parser(svg_context_t *ctx);
 int svg_feed_xml_parser(svg_context_t *ctx, const char *buf, int len);
 svg_item_t * svg_close_xml_parser(svg_context_t *ctx);
+int svg_close_xml_stream(svg_context_t *ctx);
+int svg_close_xml_batch(svg_context_t *ctx);
+void svg_free_xml_parser(svg_context_t *ctx);
 int svg_parse_document(svg_context_t *ctx, svg_item_t *root);
 
+/* Split up document and group parsing, for the streaming renderer */
+int svg_begin_document(svg_context_t *ctx, svg_item_t *root);
+int svg_end_document(svg_context_t *ctx);
+void svg_abort_document(svg_context_t *ctx);
+int svg_begin_group(svg_context_t *ctx, svg_item_t *node);
+int svg_end_group(svg_context_t *ctx, svg_item_t *node);
+
+/* Batch mode timing */
+void svg_start_batch_timer(svg_context_t *ctx);
+void svg_end_batch_document(svg_context_t *ctx, int code);
+void svg_report_batch(svg_context_t *ctx);
+
+/*
+ * Element and attribute names are interned as small integers when
+ * the document is parsed. Unknown names get the NONE atom.
+ */
+
+enum
+{
+    SVG_TAG_NONE,
+#define SVG_TAG(id, name) SVG_TAG_##id,
+#define SVG_ATT(id, name)
+#include "svgatomlist.h"
+#undef SVG_TAG
+#undef SVG_ATT
+    SVG_TAG_COUNT
+};
+
+enum
+{
+    SVG_ATT_NONE,
+#define SVG_TAG(id, name)
+#define SVG_ATT(id, name) SVG_ATT_##id,
+#include "svgatomlist.h"
+#undef SVG_TAG
+#undef SVG_ATT
+    SVG_ATT_COUNT
+};
+
 svg_item_t * svg_next(svg_item_t *item);
 svg_item_t * svg_down(svg_item_t *item);
 void svg_free_item(svg_context_t *ctx, svg_item_t *item);
+void svg_free_xml_memory(svg_context_t *ctx);
 char * svg_tag(svg_item_t *item);
 char * svg_att(svg_item_t *item, const char *att);
+int svg_tag_atom(svg_item_t *item);
+char * svg_att_atom(svg_item_t *item, int att);
 void svg_debug_item(svg_item_t *item, int level);
 
+/* a known attribute of an item and the index of its value in atts */
+typedef struct svg_att_slot_s
+{
+    unsigned short att;
+    unsigned short value;
+} svg_att_slot_t;
+
 struct svg_item_s
 {
     char *name;
     char **atts;
+    int tag; /* interned name */
+    int nslots;
+    svg_att_slot_t *slots; /* the known attributes, in document order */
     svg_item_t *up;
     svg_item_t *down;
+    svg_item_t *tail; /* last child, for appending */
     svg_item_t *next;
 };
 
@@ -190,17 +416,79 @@ struct svg_context_s
 
     int fill_is_set;
     float fill_color[3];
+    svg_gradient_t *fill_gradient; /* or NULL for a solid color */
 
     int stroke_is_set;
     float stroke_color[3];
+    svg_gradient_t *stroke_gradient;
+
+    float fill_opacity;
+    float stroke_opacity;
+    float opacity; /* of the element, when it is folded into the paint */
 
     float viewbox_width;
     float viewbox_height;
     float viewbox_size;
 
+    int transparency; /* -dSVGTransparency: 1, 0, or -1 to decide per document */
+    int use_transparency;
+    int opacity_groups;
+
+    /* Compiled definitions, by id */
+    svg_hash_table_t *defs;
+    svg_display_list_t *record;
+    int def_count;
+    int use_count;
+    int use_misses;
+
+    /* Compiled gradients, by id */
+    svg_hash_table_t *gradients;
+    int gradient_fills;
+    int gradient_shadings;
+
+    /* Font faces by file name, and resolved font-family lists */
+    const char *font_path; /* -sSVGFontPath=, or NULL */
+    svg_hash_table_t *font_faces;
+    svg_hash_table_t *font_table;
+    long glyph_count;
+    long glyph_runs;
+    long glyph_renders; /* glyphs that had to be added to the cache */
+
     svg_item_t *root;
     svg_item_t *head;
     const char *error;
     void *parser; /* Expat XML_Parser */
+
+    /* The items and their strings are carved out of large blocks,
+     * which are released in bulk when the items are freed.
+     */
+    svg_arena_block_t *arena;
+    svg_arena_block_t *arena_spare;
+    long arena_items;
+    long arena_blocks;
+
+    /* Streaming mode: render elements from the expat callbacks as soon
+     * as they are closed, instead of waiting for the whole tree.
+     * The stream_head is the innermost open element (<svg> or <g>)
+     * whose children are drawn and freed as they complete.
+     */
+    int streaming;
+    svg_item_t *stream_head;
+    int stream_code;
+
+    /* Batch mode: a job may hold several documents back to back, and
+     * the latency of every document is kept for the final report.
+     * The offsets count bytes fed since the parser was last reset.
+     */
+    int batch;
+    int batch_pending; /* part of a document has been fed */
+    long batch_offset;
+    long batch_end; /* end of the root element, or -1 */
+    int batch_code; /* first error in the job */
+    int batch_errors;
+    long batch_start[2];
+    float *latency; /* milliseconds */
+    int latency_count;
+    int latency_cap;
 };
 
@@ -34,9 +34,9 @@ svg.config-clean: clean_gs
 	$(RM_) $(SVGOBJ)devs.tr5
 
 
-ghostsvg_h=$(SVGSRC)ghostsvg.h $(memory__h) $(math__h) \
+ghostsvg_h=$(SVGSRC)ghostsvg.h $(SVGSRC)svgatomlist.h $(memory__h) $(math__h) \
 	$(gsgc_h) $(gstypes_h) $(gsstate_h) $(gsmatrix_h) $(gscoord_h) \
-	$(gsmemory_h) $(gsparam_h) $(gsdevice_h) $(scommon_h) \
+	$(gsmemory_h) $(gdebug_h) $(gsparam_h) $(gsdevice_h) $(scommon_h) \
 	$(gserror_h) $(gserrors_h) $(gspaint_h) $(gspath_h) $(gsimage_h) \
 	$(gscspace_h) $(gsptype1_h) $(gscolor2_h) $(gscolor3_h) \
 	$(gsutil_h) $(gsicc_h) $(gstrans_h) $(gxpath_h) $(gxfixed_h) \
@@ -46,6 +46,15 @@ ghostsvg_h=$(SVGSRC)ghostsvg.h $(memory__h) $(math__h) \
 
 SVGINCLUDES=$(ghostsvg_h)
 
+$(SVGOBJ)svgmem.$(OBJ): $(SVGSRC)svgmem.c $(SVGINCLUDES)
+	$(SVGCCC) $(SVGSRC)svgmem.c $(SVGO_)svgmem.$(OBJ)
+
+$(SVGOBJ)svghash.$(OBJ): $(SVGSRC)svghash.c $(SVGINCLUDES)
+	$(SVGCCC) $(SVGSRC)svghash.c $(SVGO_)svghash.$(OBJ)
+
+$(SVGOBJ)svgutf.$(OBJ): $(SVGSRC)svgutf.c $(SVGINCLUDES)
+	$(SVGCCC) $(SVGSRC)svgutf.c $(SVGO_)svgutf.$(OBJ)
+
 $(SVGOBJ)svgtypes.$(OBJ): $(SVGSRC)svgtypes.c $(SVGINCLUDES)
 	$(SVGCCC) $(SVGSRC)svgtypes.c $(SVGO_)svgtypes.$(OBJ)
 
@@ -58,24 +67,51 @@ $(SVGOBJ)svgtransform.$(OBJ): $(SVGSRC)svgtransform.c $(SVGINCLUDES)
 $(SVGOBJ)svgshapes.$(OBJ): $(SVGSRC)svgshapes.c $(SVGINCLUDES)
 	$(SVGCCC) $(SVGSRC)svgshapes.c $(SVGO_)svgshapes.$(OBJ)
 
+$(SVGOBJ)svgdefs.$(OBJ): $(SVGSRC)svgdefs.c $(SVGINCLUDES)
+	$(SVGCCC) $(SVGSRC)svgdefs.c $(SVGO_)svgdefs.$(OBJ)
+
+$(SVGOBJ)svggradient.$(OBJ): $(SVGSRC)svggradient.c $(SVGINCLUDES)
+	$(SVGCCC) $(SVGSRC)svggradient.c $(SVGO_)svggradient.$(OBJ)
+
+$(SVGOBJ)svgopacity.$(OBJ): $(SVGSRC)svgopacity.c $(SVGINCLUDES) $(gzcpath_h)
+	$(SVGCCC) $(SVGSRC)svgopacity.c $(SVGO_)svgopacity.$(OBJ)
+
+$(SVGOBJ)svgfont.$(OBJ): $(SVGSRC)svgfont.c $(SVGINCLUDES) $(gscdefs_h) $(plfont_h)
+	$(SVGCCC) $(SVGSRC)svgfont.c $(SVGO_)svgfont.$(OBJ)
+
+$(SVGOBJ)svgtext.$(OBJ): $(SVGSRC)svgtext.c $(SVGINCLUDES)
+	$(SVGCCC) $(SVGSRC)svgtext.c $(SVGO_)svgtext.$(OBJ)
+
 $(SVGOBJ)svgdoc.$(OBJ): $(SVGSRC)svgdoc.c $(SVGINCLUDES)
 	$(SVGCCC) $(SVGSRC)svgdoc.c $(SVGO_)svgdoc.$(OBJ)
 
 $(SVGOBJ)svgxml.$(OBJ): $(SVGSRC)svgxml.c $(SVGINCLUDES)
 	$(SVGCCC) $(SVGSRC)svgxml.c $(SVGO_)svgxml.$(OBJ)
 
+$(SVGOBJ)svgbatch.$(OBJ): $(SVGSRC)svgbatch.c $(SVGINCLUDES) $(gp_h)
+	$(SVGCCC) $(SVGSRC)svgbatch.c $(SVGO_)svgbatch.$(OBJ)
+
 
 $(SVG_TOP_OBJ): $(SVGSRC)svgtop.c $(pltop_h) $(SVGGEN)pconf.h $(SVGINCLUDES)
 	$(CP_) $(SVGGEN)pconf.h $(SVGGEN)pconfig.h
 	$(SVGCCC) $(SVGSRC)svgtop.c $(SVGO_)svgtop.$(OBJ)
 
 SVG_OBJS=\
+    $(SVGOBJ)svgmem.$(OBJ) \
+    $(SVGOBJ)svghash.$(OBJ) \
+    $(SVGOBJ)svgutf.$(OBJ) \
     $(SVGOBJ)svgtypes.$(OBJ) \
     $(SVGOBJ)svgcolor.$(OBJ) \
     $(SVGOBJ)svgtransform.$(OBJ) \
     $(SVGOBJ)svgshapes.$(OBJ) \
+    $(SVGOBJ)svgdefs.$(OBJ) \
+    $(SVGOBJ)svggradient.$(OBJ) \
+    $(SVGOBJ)svgopacity.$(OBJ) \
+    $(SVGOBJ)svgfont.$(OBJ) \
+    $(SVGOBJ)svgtext.$(OBJ) \
     $(SVGOBJ)svgdoc.$(OBJ) \
     $(SVGOBJ)svgxml.$(OBJ) \
+    $(SVGOBJ)svgbatch.$(OBJ) \
 
 # NB - note this is a bit squirrely.  Right now the pjl interpreter is
 # required and shouldn't be and PLOBJ==SVGGEN is required.
@@ -0,0 +1,83 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - element and attribute names we know about */
+
+/* Both lists must be kept sorted (by strcmp) for the binary search. */
+
+SVG_TAG(CIRCLE, "circle")
+SVG_TAG(DEFS, "defs")
+SVG_TAG(DESC, "desc")
+SVG_TAG(ELLIPSE, "ellipse")
+SVG_TAG(G, "g")
+SVG_TAG(LINE, "line")
+SVG_TAG(LINEAR_GRADIENT, "linearGradient")
+SVG_TAG(PATH, "path")
+SVG_TAG(POLYGON, "polygon")
+SVG_TAG(POLYLINE, "polyline")
+SVG_TAG(RADIAL_GRADIENT, "radialGradient")
+SVG_TAG(RECT, "rect")
+SVG_TAG(STOP, "stop")
+SVG_TAG(SVG, "svg")
+SVG_TAG(SYMBOL, "symbol")
+SVG_TAG(TEXT, "text")
+SVG_TAG(TITLE, "title")
+SVG_TAG(TSPAN, "tspan")
+SVG_TAG(USE, "use")
+
+SVG_ATT(CX, "cx")
+SVG_ATT(CY, "cy")
+SVG_ATT(D, "d")
+SVG_ATT(DX, "dx")
+SVG_ATT(DY, "dy")
+SVG_ATT(FILL, "fill")
+SVG_ATT(FILL_OPACITY, "fill-opacity")
+SVG_ATT(FILL_RULE, "fill-rule")
+SVG_ATT(FONT_FAMILY, "font-family")
+SVG_ATT(FONT_SIZE, "font-size")
+SVG_ATT(FONT_STYLE, "font-style")
+SVG_ATT(FONT_WEIGHT, "font-weight")
+SVG_ATT(FX, "fx")
+SVG_ATT(FY, "fy")
+SVG_ATT(GRADIENT_TRANSFORM, "gradientTransform")
+SVG_ATT(GRADIENT_UNITS, "gradientUnits")
+SVG_ATT(HEIGHT, "height")
+SVG_ATT(HREF, "href")
+SVG_ATT(ID, "id")
+SVG_ATT(OFFSET, "offset")
+SVG_ATT(OPACITY, "opacity")
+SVG_ATT(PATH_LENGTH, "pathLength")
+SVG_ATT(POINTS, "points")
+SVG_ATT(R, "r")
+SVG_ATT(RX, "rx")
+SVG_ATT(RY, "ry")
+SVG_ATT(SPREAD_METHOD, "spreadMethod")
+SVG_ATT(STOP_COLOR, "stop-color")
+SVG_ATT(STROKE, "stroke")
+SVG_ATT(STROKE_LINECAP, "stroke-linecap")
+SVG_ATT(STROKE_LINEJOIN, "stroke-linejoin")
+SVG_ATT(STROKE_MITERLIMIT, "stroke-miterlimit")
+SVG_ATT(STROKE_OPACITY, "stroke-opacity")
+SVG_ATT(STROKE_WIDTH, "stroke-width")
+SVG_ATT(TEXT_ANCHOR, "text-anchor")
+SVG_ATT(TRANSFORM, "transform")
+SVG_ATT(VERSION, "version")
+SVG_ATT(VIEW_BOX, "viewBox")
+SVG_ATT(WIDTH, "width")
+SVG_ATT(X, "x")
+SVG_ATT(X1, "x1")
+SVG_ATT(X2, "x2")
+SVG_ATT(XLINK_HREF, "xlink:href")
+SVG_ATT(Y, "y")
+SVG_ATT(Y1, "y1")
+SVG_ATT(Y2, "y2")
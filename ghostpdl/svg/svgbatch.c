@@ -0,0 +1,108 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - batch mode timing */
+
+#include "ghostsvg.h"
+#include "gp.h"
+
+/*
+ * In batch mode one interpreter instance, with its device, halftone,
+ * color spaces, fonts and XML parser, is kept for a whole run of small
+ * documents. Each document is timed from the moment the parser is
+ * ready for it until its page has been output, and the latencies are
+ * summarized when the instance goes away.
+ */
+
+void
+svg_start_batch_timer(svg_context_t *ctx)
+{
+    gp_get_realtime(ctx->batch_start);
+}
+
+void
+svg_end_batch_document(svg_context_t *ctx, int code)
+{
+    long now[2];
+    float ms;
+    float *latency;
+    int cap;
+
+    gp_get_realtime(now);
+    ms = (now[0] - ctx->batch_start[0]) * 1000.0 +
+	(now[1] - ctx->batch_start[1]) / 1000000.0;
+
+    ctx->batch_pending = 0;
+    if (code < 0)
+	ctx->batch_errors ++;
+
+    if (ctx->latency_count == ctx->latency_cap)
+    {
+	cap = ctx->latency_cap ? ctx->latency_cap * 2 : 256;
+	latency = svg_realloc(ctx, ctx->latency, cap * sizeof(float));
+	if (!latency)
+	    return; /* the timing is only advisory */
+	ctx->latency = latency;
+	ctx->latency_cap = cap;
+    }
+
+    ctx->latency[ctx->latency_count++] = ms;
+}
+
+static int
+svg_compare_latency(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/* nearest rank */
+static float
+svg_percentile(const float *sorted, int n, int p)
+{
+    int i = (n * p + 99) / 100 - 1;
+    return sorted[MAX(0, MIN(i, n - 1))];
+}
+
+void
+svg_report_batch(svg_context_t *ctx)
+{
+    int n = ctx->latency_count;
+    double total = 0;
+    int i;
+
+    if (n > 0)
+    {
+	qsort(ctx->latency, n, sizeof(float), svg_compare_latency);
+	for (i = 0; i < n; i++)
+	    total += ctx->latency[i];
+
+	/* dprintf is silent in release builds, and this report is not */
+	errprintf(ctx->memory, "svg batch: %d documents, %d failed, %.1f ms total\n",
+		n, ctx->batch_errors, total);
+	errprintf(ctx->memory, "svg batch: latency ms: p50 %.3f p90 %.3f p99 %.3f max %.3f mean %.3f\n",
+		svg_percentile(ctx->latency, n, 50),
+		svg_percentile(ctx->latency, n, 90),
+		svg_percentile(ctx->latency, n, 99),
+		ctx->latency[n - 1],
+		total / n);
+    }
+
+    if (ctx->latency)
+	svg_free(ctx, ctx->latency);
+    ctx->latency = NULL;
+    ctx->latency_count = 0;
+    ctx->latency_cap = 0;
+    ctx->batch_errors = 0;
+}
@@ -54,13 +54,23 @@ svg_set_color(svg_context_t *ctx, float *rgb)
     gs_setcolor(ctx->pgs, &cc);
 }
 
+/* The constant alpha only matters when the compositor is in use. */
+void
+svg_set_alpha(svg_context_t *ctx, float alpha)
+{
+    if (ctx->use_transparency)
+	gs_setopacityalpha(ctx->pgs, alpha * ctx->opacity);
+}
+
 void svg_set_fill_color(svg_context_t *ctx)
 {
+    svg_set_alpha(ctx, ctx->fill_opacity);
     svg_set_color(ctx, ctx->fill_color);
 }
 
 void svg_set_stroke_color(svg_context_t *ctx)
 {
+    svg_set_alpha(ctx, ctx->stroke_opacity);
     svg_set_color(ctx, ctx->stroke_color);
 }
 
@@ -141,7 +151,7 @@ svg_parse_color(char *str, float *rgb)
     else
     {
 	l = 0;
-	r = sizeof(svg_predefined_colors) / sizeof(svg_predefined_colors[0]);
+	r = countof(svg_predefined_colors) - 1;
 
 	while (l <= r)
 	{
@@ -153,9 +163,9 @@ svg_parse_color(char *str, float *rgb)
 		l = m + 1;
 	    else
 	    {
-		rgb[0] = svg_predefined_colors[m].red;
-		rgb[1] = svg_predefined_colors[m].green;
-		rgb[2] = svg_predefined_colors[m].blue;
+		rgb[0] = svg_predefined_colors[m].red / 255.0;
+		rgb[1] = svg_predefined_colors[m].green / 255.0;
+		rgb[2] = svg_predefined_colors[m].blue / 255.0;
 		return 0;
 	    }
 	}
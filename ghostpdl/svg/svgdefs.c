@@ -0,0 +1,510 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - referenced content (defs, symbol and use) */
+
+#include "ghostsvg.h"
+
+/*
+ * Definitions are compiled once, when they are parsed, into a display
+ * list of user space path segments and paint operations. A <use> then
+ * replays the list under its own CTM and paint, which costs no attribute
+ * lookups or path string parsing per instance.
+ *
+ * The lists live on the gs heap rather than in the xml arena, so that
+ * they outlive their subtree when streaming.
+ */
+
+typedef struct svg_def_s svg_def_t;
+
+struct svg_def_s
+{
+    char *id;
+    int is_symbol;
+    int has_viewbox;
+    float viewbox[4];
+    svg_display_list_t list;
+};
+
+/*
+ * Recording.
+ */
+
+int
+svg_record_segment(svg_context_t *ctx, svg_display_list_t *list,
+	int cmd, const float *coords, int n)
+{
+    if (list->cmd_count == list->cmd_cap)
+    {
+	int cap = list->cmd_cap ? list->cmd_cap * 2 : 64;
+	byte *cmds = svg_realloc(ctx, list->cmds, cap);
+	if (!cmds)
+	    return gs_throw(-1, "out of memory: display list commands");
+	list->cmds = cmds;
+	list->cmd_cap = cap;
+    }
+
+    if (list->coord_count + n > list->coord_cap)
+    {
+	int cap = list->coord_cap ? list->coord_cap * 2 : 256;
+	float *c = svg_realloc(ctx, list->coords, cap * sizeof(float));
+	if (!c)
+	    return gs_throw(-1, "out of memory: display list coordinates");
+	list->coords = c;
+	list->coord_cap = cap;
+    }
+
+    list->cmds[list->cmd_count++] = cmd;
+    memcpy(list->coords + list->coord_count, coords, n * sizeof(float));
+    list->coord_count += n;
+    return 0;
+}
+
+int
+svg_record_paint(svg_context_t *ctx, int paint)
+{
+    svg_display_list_t *list = ctx->record;
+    svg_display_op_t *op;
+
+    if (!paint || list->cmd_count == list->path_cmd_first)
+	return 0;
+
+    if (list->op_count == list->op_cap)
+    {
+	int cap = list->op_cap ? list->op_cap * 2 : 16;
+	svg_display_op_t *ops = svg_realloc(ctx, list->ops, cap * sizeof(svg_display_op_t));
+	if (!ops)
+	    return gs_throw(-1, "out of memory: display list operations");
+	list->ops = ops;
+	list->op_cap = cap;
+    }
+
+    op = &list->ops[list->op_count++];
+    op->ctm = list->path_ctm;
+    op->paint = paint;
+    op->cmd_first = list->path_cmd_first;
+    op->cmd_count = list->cmd_count - list->path_cmd_first;
+    op->coord_first = list->path_coord_first;
+
+    op->fill_rule = ctx->fill_rule;
+    op->fill_is_set = ctx->fill_is_set;
+    memcpy(op->fill_color, ctx->fill_color, sizeof op->fill_color);
+    op->fill_gradient = ctx->fill_gradient;
+    op->stroke_is_set = ctx->stroke_is_set;
+    memcpy(op->stroke_color, ctx->stroke_color, sizeof op->stroke_color);
+    op->stroke_gradient = ctx->stroke_gradient;
+    op->fill_opacity = ctx->fill_opacity;
+    op->stroke_opacity = ctx->stroke_opacity;
+    op->opacity = ctx->opacity;
+
+    op->line_width = gs_currentlinewidth(ctx->pgs);
+    op->line_cap = gs_currentlinecap(ctx->pgs);
+    op->line_join = gs_currentlinejoin(ctx->pgs);
+    op->miter_limit = gs_currentmiterlimit(ctx->pgs);
+
+    /* painting consumes the path */
+    list->path_cmd_first = list->cmd_count;
+    list->path_coord_first = list->coord_count;
+
+    return 0;
+}
+
+/*
+ * Replay a display list under the current CTM and paint.
+ */
+
+int
+svg_replay_list(svg_context_t *ctx, svg_display_list_t *list)
+{
+    svg_paint_state_t base_paint;
+    gs_matrix base, ctm;
+    svg_path_builder_t pb;
+    int i, k, code = 0;
+
+    gs_currentmatrix(ctx->pgs, &base);
+    svg_save_paint(ctx, &base_paint);
+
+    for (i = 0; i < list->op_count; i++)
+    {
+	const svg_display_op_t *op = &list->ops[i];
+	const byte *cmd = list->cmds + op->cmd_first;
+	const float *c = list->coords + op->coord_first;
+
+	gs_matrix_multiply(&op->ctm, &base, &ctm);
+	gs_setmatrix(ctx->pgs, &ctm);
+
+	gs_setlinewidth(ctx->pgs, op->line_width);
+	gs_setlinecap(ctx->pgs, op->line_cap);
+	gs_setlinejoin(ctx->pgs, op->line_join);
+	gs_setmiterlimit(ctx->pgs, op->miter_limit);
+
+	ctx->fill_rule = op->fill_rule;
+	ctx->opacity = base_paint.opacity * op->opacity;
+	if (op->fill_opacity != SVG_INHERIT)
+	    ctx->fill_opacity = op->fill_opacity;
+	if (op->stroke_opacity != SVG_INHERIT)
+	    ctx->stroke_opacity = op->stroke_opacity;
+	if (op->fill_is_set != SVG_INHERIT)
+	{
+	    ctx->fill_is_set = op->fill_is_set;
+	    memcpy(ctx->fill_color, op->fill_color, sizeof op->fill_color);
+	    ctx->fill_gradient = op->fill_gradient;
+	}
+	if (op->stroke_is_set != SVG_INHERIT)
+	{
+	    ctx->stroke_is_set = op->stroke_is_set;
+	    memcpy(ctx->stroke_color, op->stroke_color, sizeof op->stroke_color);
+	    ctx->stroke_gradient = op->stroke_gradient;
+	}
+
+	svg_begin_path(ctx, &pb);
+	for (k = 0; k < op->cmd_count && code >= 0; k++)
+	{
+	    switch (cmd[k])
+	    {
+	    case 'M': code = svg_path_moveto(&pb, c[0], c[1]); c += 2; break;
+	    case 'L': code = svg_path_lineto(&pb, c[0], c[1]); c += 2; break;
+	    case 'C': code = svg_path_curveto(&pb, c[0], c[1], c[2], c[3], c[4], c[5]); c += 6; break;
+	    case 'Z': code = svg_path_closepath(&pb); break;
+	    }
+	}
+	svg_end_path(&pb);
+	if (code < 0)
+	    break;
+
+	code = svg_paint_path(ctx,
+		(op->paint & SVG_PAINT_FILL) && ctx->fill_is_set,
+		(op->paint & SVG_PAINT_STROKE) && ctx->stroke_is_set);
+	if (code < 0)
+	    break;
+
+	svg_restore_paint(ctx, &base_paint);
+    }
+
+    svg_restore_paint(ctx, &base_paint);
+    gs_setmatrix(ctx->pgs, &base);
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot replay display list");
+    return 0;
+}
+
+/*
+ * Bounding box of everything painted by a display list, in the user
+ * space it was recorded in. Strokes are allowed for generously.
+ */
+int
+svg_display_list_bbox(svg_display_list_t *list, gs_rect *box)
+{
+    int i, k, n, empty = 1;
+
+    for (i = 0; i < list->op_count; i++)
+    {
+	const svg_display_op_t *op = &list->ops[i];
+	const byte *cmd = list->cmds + op->cmd_first;
+	const float *c = list->coords + op->coord_first;
+	const gs_matrix *m = &op->ctm;
+	float ext = 0;
+
+	if (op->paint & SVG_PAINT_STROKE)
+	{
+	    ext = op->line_width / 2;
+	    if (op->line_join == gs_join_miter)
+		ext *= MAX(op->miter_limit, 1.5);
+	    else
+		ext *= 1.5; /* square caps */
+	    ext *= MAX(ABS(m->xx) + ABS(m->yx), ABS(m->xy) + ABS(m->yy));
+	}
+
+	for (k = 0; k < op->cmd_count; k++)
+	{
+	    n = cmd[k] == 'C' ? 3 : cmd[k] == 'Z' ? 0 : 1;
+	    while (n--)
+	    {
+		float x = c[0] * m->xx + c[1] * m->yx + m->tx;
+		float y = c[0] * m->xy + c[1] * m->yy + m->ty;
+		if (empty || x - ext < box->p.x) box->p.x = x - ext;
+		if (empty || y - ext < box->p.y) box->p.y = y - ext;
+		if (empty || x + ext > box->q.x) box->q.x = x + ext;
+		if (empty || y + ext > box->q.y) box->q.y = y + ext;
+		empty = 0;
+		c += 2;
+	    }
+	}
+    }
+
+    return !empty;
+}
+
+void
+svg_free_display_list(svg_context_t *ctx, svg_display_list_t *list)
+{
+    if (list->ops)
+	svg_free(ctx, list->ops);
+    if (list->cmds)
+	svg_free(ctx, list->cmds);
+    if (list->coords)
+	svg_free(ctx, list->coords);
+    memset(list, 0, sizeof(svg_display_list_t));
+}
+
+/*
+ * Record an element, or the contents of a symbol, relative to the
+ * current CTM and with unset paint, so that the list can be replayed
+ * under the CTM and paint of whatever references it. The opacity is
+ * folded into each paint operation.
+ */
+int
+svg_record_element(svg_context_t *ctx, svg_item_t *node, svg_display_list_t *list,
+	int is_symbol, float opacity)
+{
+    svg_display_list_t *saved_record;
+    svg_paint_state_t saved_paint;
+    svg_item_t *child;
+    gs_matrix identity;
+    int code = 0;
+
+    svg_save_paint(ctx, &saved_paint);
+    saved_record = ctx->record;
+
+    gs_gsave(ctx->pgs);
+    gs_make_identity(&identity);
+    gs_setmatrix(ctx->pgs, &identity);
+
+    ctx->fill_is_set = SVG_INHERIT;
+    ctx->fill_gradient = NULL;
+    ctx->fill_opacity = SVG_INHERIT;
+    ctx->stroke_is_set = SVG_INHERIT;
+    ctx->stroke_gradient = NULL;
+    ctx->stroke_opacity = SVG_INHERIT;
+    ctx->opacity = opacity;
+    ctx->record = list;
+    list->path_ctm = identity;
+
+    if (is_symbol)
+    {
+	code = svg_parse_common(ctx, node);
+	for (child = svg_down(node); child && code >= 0; child = svg_next(child))
+	    code = svg_parse_element(ctx, child);
+    }
+    else
+    {
+	code = svg_draw_element(ctx, node);
+    }
+
+    ctx->record = saved_record;
+    gs_grestore(ctx->pgs);
+    svg_restore_paint(ctx, &saved_paint);
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot record element");
+
+    return 0;
+}
+
+/*
+ * Compile a definition.
+ */
+
+static void
+svg_free_def(svg_context_t *ctx, void *value)
+{
+    svg_def_t *def = value;
+    svg_free_display_list(ctx, &def->list);
+    svg_free(ctx, def->id);
+    svg_free(ctx, def);
+}
+
+static int
+svg_compile_def(svg_context_t *ctx, svg_item_t *node, const char *id, int is_symbol)
+{
+    svg_def_t *def;
+    int code = 0;
+
+    if (!ctx->defs)
+    {
+	ctx->defs = svg_hash_new(ctx);
+	if (!ctx->defs)
+	    return gs_rethrow(-1, "cannot create definition table");
+    }
+
+    /* the first element with a given id wins */
+    if (svg_hash_lookup(ctx->defs, id))
+	return 0;
+
+    def = svg_alloc(ctx, sizeof(svg_def_t));
+    if (!def)
+	return gs_throw(-1, "out of memory: definition");
+    memset(def, 0, sizeof(svg_def_t));
+    def->is_symbol = is_symbol;
+    def->id = svg_strdup(ctx, id);
+    if (!def->id)
+    {
+	svg_free(ctx, def);
+	return gs_throw(-1, "out of memory: definition id");
+    }
+
+    if (is_symbol)
+    {
+	char *view_box_att = svg_att_atom(node, SVG_ATT_VIEW_BOX);
+	if (view_box_att)
+	{
+	    sscanf(view_box_att, "%g %g %g %g",
+		    &def->viewbox[0], &def->viewbox[1],
+		    &def->viewbox[2], &def->viewbox[3]);
+	    def->has_viewbox = def->viewbox[2] > 0 && def->viewbox[3] > 0;
+	}
+    }
+
+    code = svg_record_element(ctx, node, &def->list, is_symbol,
+	    is_symbol ? 1 : svg_element_opacity(ctx, node));
+
+    if (code >= 0)
+	code = svg_hash_insert(ctx, ctx->defs, def->id, def);
+    if (code < 0)
+    {
+	svg_free_def(ctx, def);
+	return gs_rethrow1(code, "cannot compile definition '%s'", id);
+    }
+
+    ctx->def_count ++;
+    return 0;
+}
+
+int
+svg_parse_defs(svg_context_t *ctx, svg_item_t *node)
+{
+    svg_item_t *child;
+    char *id;
+    int code;
+
+    for (child = svg_down(node); child; child = svg_next(child))
+    {
+	id = svg_att_atom(child, SVG_ATT_ID);
+	if (!id)
+	    continue;
+	if (svg_tag_atom(child) == SVG_TAG_LINEAR_GRADIENT ||
+		svg_tag_atom(child) == SVG_TAG_RADIAL_GRADIENT)
+	    code = svg_parse_gradient(ctx, child);
+	else
+	    code = svg_compile_def(ctx, child, id,
+		    svg_tag_atom(child) == SVG_TAG_SYMBOL);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot parse <defs> element");
+    }
+
+    return 0;
+}
+
+int
+svg_parse_symbol(svg_context_t *ctx, svg_item_t *node)
+{
+    char *id = svg_att_atom(node, SVG_ATT_ID);
+    int code;
+
+    /* symbols are never drawn directly */
+    if (!id)
+	return 0;
+
+    code = svg_compile_def(ctx, node, id, 1);
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse <symbol> element");
+
+    return 0;
+}
+
+int
+svg_parse_use(svg_context_t *ctx, svg_item_t *node)
+{
+    char *href_att = svg_att_atom(node, SVG_ATT_XLINK_HREF);
+    char *x_att = svg_att_atom(node, SVG_ATT_X);
+    char *y_att = svg_att_atom(node, SVG_ATT_Y);
+    char *w_att = svg_att_atom(node, SVG_ATT_WIDTH);
+    char *h_att = svg_att_atom(node, SVG_ATT_HEIGHT);
+
+    svg_paint_state_t saved_paint;
+    svg_def_t *def = NULL;
+    float x = 0;
+    float y = 0;
+    int code;
+
+    if (!href_att)
+	href_att = svg_att_atom(node, SVG_ATT_HREF);
+
+    if (href_att && href_att[0] == '#' && ctx->defs)
+	def = svg_hash_lookup(ctx->defs, href_att + 1);
+
+    if (!def)
+    {
+	/* forward and external references are not supported */
+	ctx->use_misses ++;
+	gs_warn1("cannot resolve <use> reference '%s'", href_att ? href_att : "");
+	return 0;
+    }
+
+    ctx->use_count ++;
+
+    if (x_att) x = svg_parse_length(x_att, ctx->viewbox_width, 12);
+    if (y_att) y = svg_parse_length(y_att, ctx->viewbox_height, 12);
+
+    svg_save_paint(ctx, &saved_paint);
+    gs_gsave(ctx->pgs);
+
+    code = svg_parse_common(ctx, node);
+    if (code >= 0)
+    {
+	gs_translate(ctx->pgs, x, y);
+
+	/* fit the symbol viewBox into the viewport, centered */
+	if (def->is_symbol && def->has_viewbox && w_att && h_att)
+	{
+	    float w = svg_parse_length(w_att, ctx->viewbox_width, 12);
+	    float h = svg_parse_length(h_att, ctx->viewbox_height, 12);
+	    float sx = w / def->viewbox[2];
+	    float sy = h / def->viewbox[3];
+	    float s = sx < sy ? sx : sy;
+
+	    gs_translate(ctx->pgs,
+		    (w - def->viewbox[2] * s) / 2,
+		    (h - def->viewbox[3] * s) / 2);
+	    gs_scale(ctx->pgs, s, s);
+	    gs_translate(ctx->pgs, -def->viewbox[0], -def->viewbox[1]);
+	}
+
+	code = svg_replay_list(ctx, &def->list);
+    }
+
+    gs_grestore(ctx->pgs);
+    svg_restore_paint(ctx, &saved_paint);
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse <use> element");
+
+    return 0;
+}
+
+void
+svg_free_defs(svg_context_t *ctx)
+{
+    if (gs_debug_c('|') && (ctx->def_count || ctx->use_count || ctx->use_misses))
+	dprintf3("svg: %d definitions, %d uses, %d unresolved\n",
+		ctx->def_count, ctx->use_count, ctx->use_misses);
+
+    if (ctx->defs)
+	svg_hash_free(ctx, ctx->defs, NULL, svg_free_def);
+
+    ctx->defs = NULL;
+    ctx->def_count = 0;
+    ctx->use_count = 0;
+    ctx->use_misses = 0;
+}
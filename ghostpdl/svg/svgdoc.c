@@ -15,50 +15,121 @@
 
 #include "ghostsvg.h"
 
-int
-svg_parse_common(svg_context_t *ctx, svg_item_t *node)
+/*
+ * Fill and stroke are tracked in the context rather than the gs_state,
+ * so elements that scope them have to save and restore them by hand.
+ */
+
+void
+svg_save_paint(svg_context_t *ctx, svg_paint_state_t *ps)
 {
-    char *fill_att = svg_att(node, "fill");
-    char *stroke_att = svg_att(node, "stroke");
-    char *transform_att = svg_att(node, "transform");
-    char *fill_rule_att = svg_att(node, "fill-rule");
-    char *stroke_width_att = svg_att(node, "stroke-width");
-    char *stroke_linecap_att = svg_att(node, "stroke-linecap");
-    char *stroke_linejoin_att = svg_att(node, "stroke-linejoin");
-    char *stroke_miterlimit_att = svg_att(node, "stroke-miterlimit");
+    ps->fill_rule = ctx->fill_rule;
+    ps->fill_is_set = ctx->fill_is_set;
+    memcpy(ps->fill_color, ctx->fill_color, sizeof ps->fill_color);
+    ps->fill_gradient = ctx->fill_gradient;
+    ps->stroke_is_set = ctx->stroke_is_set;
+    memcpy(ps->stroke_color, ctx->stroke_color, sizeof ps->stroke_color);
+    ps->stroke_gradient = ctx->stroke_gradient;
+    ps->fill_opacity = ctx->fill_opacity;
+    ps->stroke_opacity = ctx->stroke_opacity;
+    ps->opacity = ctx->opacity;
+}
 
-    int code;
+void
+svg_restore_paint(svg_context_t *ctx, const svg_paint_state_t *ps)
+{
+    ctx->fill_rule = ps->fill_rule;
+    ctx->fill_is_set = ps->fill_is_set;
+    memcpy(ctx->fill_color, ps->fill_color, sizeof ps->fill_color);
+    ctx->fill_gradient = ps->fill_gradient;
+    ctx->stroke_is_set = ps->stroke_is_set;
+    memcpy(ctx->stroke_color, ps->stroke_color, sizeof ps->stroke_color);
+    ctx->stroke_gradient = ps->stroke_gradient;
+    ctx->fill_opacity = ps->fill_opacity;
+    ctx->stroke_opacity = ps->stroke_opacity;
+    ctx->opacity = ps->opacity;
+}
 
-    if (fill_att)
+/*
+ * Parse a fill or stroke value: none, a color, or a gradient
+ * reference with an optional fallback color.
+ */
+static int
+svg_parse_paint(svg_context_t *ctx, char *str, int *is_set, float *color, svg_gradient_t **grad)
+{
+    char *fallback;
+
+    *grad = NULL;
+
+    if (!strncmp(str, "url(", 4))
     {
-	if (!strcmp(fill_att, "none"))
+	if (svg_lookup_gradient(ctx, str, grad))
 	{
-	    ctx->fill_is_set = 0;
+	    *is_set = 1;
+	    return 0;
 	}
-	else
+
+	fallback = strchr(str, ')');
+	if (fallback)
+	    fallback ++;
+	while (fallback && svg_is_whitespace(*fallback))
+	    fallback ++;
+	if (!fallback || !*fallback)
 	{
-	    ctx->fill_is_set = 1;
-	    code = svg_parse_color(fill_att, ctx->fill_color);
-	    if (code < 0)
-		return gs_rethrow(code, "cannot parse fill attribute");
+	    *is_set = 0;
+	    return 0;
 	}
+	str = fallback;
+    }
+
+    if (!strcmp(str, "none"))
+    {
+	*is_set = 0;
+	return 0;
+    }
+
+    *is_set = 1;
+    return svg_parse_color(str, color);
+}
+
+int
+svg_parse_common(svg_context_t *ctx, svg_item_t *node)
+{
+    char *fill_att = svg_att_atom(node, SVG_ATT_FILL);
+    char *stroke_att = svg_att_atom(node, SVG_ATT_STROKE);
+    char *transform_att = svg_att_atom(node, SVG_ATT_TRANSFORM);
+    char *fill_rule_att = svg_att_atom(node, SVG_ATT_FILL_RULE);
+    char *fill_opacity_att = svg_att_atom(node, SVG_ATT_FILL_OPACITY);
+    char *stroke_opacity_att = svg_att_atom(node, SVG_ATT_STROKE_OPACITY);
+    char *stroke_width_att = svg_att_atom(node, SVG_ATT_STROKE_WIDTH);
+    char *stroke_linecap_att = svg_att_atom(node, SVG_ATT_STROKE_LINECAP);
+    char *stroke_linejoin_att = svg_att_atom(node, SVG_ATT_STROKE_LINEJOIN);
+    char *stroke_miterlimit_att = svg_att_atom(node, SVG_ATT_STROKE_MITERLIMIT);
+
+    int code;
+
+    if (fill_att)
+    {
+	code = svg_parse_paint(ctx, fill_att, &ctx->fill_is_set,
+		ctx->fill_color, &ctx->fill_gradient);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot parse fill attribute");
     }
 
     if (stroke_att)
     {
-	if (!strcmp(stroke_att, "none"))
-	{
-	    ctx->stroke_is_set = 0;
-	}
-	else
-	{
-	    ctx->stroke_is_set = 1;
-	    code = svg_parse_color(stroke_att, ctx->stroke_color);
-	    if (code < 0)
-		return gs_rethrow(code, "cannot parse stroke attribute");
-	}
+	code = svg_parse_paint(ctx, stroke_att, &ctx->stroke_is_set,
+		ctx->stroke_color, &ctx->stroke_gradient);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot parse stroke attribute");
     }
 
+    if (fill_opacity_att && strcmp(fill_opacity_att, "inherit"))
+	ctx->fill_opacity = MAX(0, MIN(1, atof(fill_opacity_att)));
+
+    if (stroke_opacity_att && strcmp(stroke_opacity_att, "inherit"))
+	ctx->stroke_opacity = MAX(0, MIN(1, atof(stroke_opacity_att)));
+
     if (transform_att)
     {
 	code = svg_parse_transform(ctx, transform_att);
@@ -129,104 +200,183 @@ svg_parse_common(svg_context_t *ctx, svg_item_t *node)
     return 0;
 }
 
+int
+svg_begin_group(svg_context_t *ctx, svg_item_t *node)
+{
+    int code;
+
+    code = gs_gsave(ctx->pgs);
+    if (code < 0)
+	return gs_rethrow(code, "cannot save graphics state for <g> element");
+
+    svg_parse_common(ctx, node);
+
+    return 0;
+}
+
+int
+svg_end_group(svg_context_t *ctx, svg_item_t *node)
+{
+    int code;
+
+    code = gs_grestore(ctx->pgs);
+    if (code < 0)
+	return gs_rethrow(code, "cannot restore graphics state for <g> element");
+
+    return 0;
+}
+
 static int
 svg_parse_g(svg_context_t *ctx, svg_item_t *root)
 {
-    gs_matrix mtx;
     svg_item_t *node;
     int code;
 
-    gs_currentmatrix(ctx->pgs, &mtx);
-
-    svg_parse_common(ctx, root);
+    code = svg_begin_group(ctx, root);
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse <g> element");
 
     for (node = svg_down(root); node; node = svg_next(node))
     {
 	code = svg_parse_element(ctx, node);
 	if (code < 0)
+	{
+	    svg_end_group(ctx, root);
 	    return gs_rethrow(code, "cannot parse <g> element");
+	}
     }
 
-    gs_setmatrix(ctx->pgs, &mtx);
+    return svg_end_group(ctx, root);
+}
+
+/*
+ * Draw an element, in a transparency group if it has an opacity.
+ * The paint and transform of an element do not carry over to its
+ * siblings; the other graphics state parameters are always set.
+ */
+int
+svg_parse_element(svg_context_t *ctx, svg_item_t *root)
+{
+    float opacity = svg_element_opacity(ctx, root);
+    svg_paint_state_t saved_paint;
+    gs_matrix saved_ctm;
+    int code;
+
+    svg_save_paint(ctx, &saved_paint);
+    gs_currentmatrix(ctx->pgs, &saved_ctm);
+
+    if (opacity < 1)
+	code = svg_parse_translucent_element(ctx, root, opacity);
+    else
+	code = svg_draw_element(ctx, root);
+
+    gs_setmatrix(ctx->pgs, &saved_ctm);
+    svg_restore_paint(ctx, &saved_paint);
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse svg element");
 
     return 0;
 }
 
 int
-svg_parse_element(svg_context_t *ctx, svg_item_t *root)
+svg_draw_element(svg_context_t *ctx, svg_item_t *root)
 {
-    char *tag = svg_tag(root);
     int code;
 
-    if (!strcmp(tag, "g"))
+    switch (svg_tag_atom(root))
+    {
+    case SVG_TAG_G:
 	code = svg_parse_g(ctx, root);
+	break;
 
-    else if (!strcmp(tag, "title"))
+    case SVG_TAG_TITLE:
 	return 0;
-    else if (!strcmp(tag, "desc"))
+    case SVG_TAG_DESC:
 	return 0;
 
-#if 0
-    else if (!strcmp(tag, "defs"))
+    case SVG_TAG_DEFS:
 	code = svg_parse_defs(ctx, root);
-    else if (!strcmp(tag, "symbol"))
+	break;
+    case SVG_TAG_SYMBOL:
 	code = svg_parse_symbol(ctx, root);
-    else if (!strcmp(tag, "use"))
+	break;
+    case SVG_TAG_USE:
 	code = svg_parse_use(ctx, root);
+	break;
+
+    case SVG_TAG_LINEAR_GRADIENT:
+    case SVG_TAG_RADIAL_GRADIENT:
+	code = svg_parse_gradient(ctx, root);
+	break;
 
-    else if (!strcmp(tag, "image"))
+#if 0
+    case SVG_TAG_IMAGE:
 	code = svg_parse_image(ctx, root);
+	break;
 #endif
 
-    else if (!strcmp(tag, "path"))
+    case SVG_TAG_PATH:
 	code = svg_parse_path(ctx, root);
-    else if (!strcmp(tag, "rect"))
+	break;
+    case SVG_TAG_RECT:
 	code = svg_parse_rect(ctx, root);
-    else if (!strcmp(tag, "circle"))
+	break;
+    case SVG_TAG_CIRCLE:
 	code = svg_parse_circle(ctx, root);
-    else if (!strcmp(tag, "ellipse"))
+	break;
+    case SVG_TAG_ELLIPSE:
 	code = svg_parse_ellipse(ctx, root);
-    else if (!strcmp(tag, "line"))
+	break;
+    case SVG_TAG_LINE:
 	code = svg_parse_line(ctx, root);
-    else if (!strcmp(tag, "polyline"))
+	break;
+    case SVG_TAG_POLYLINE:
 	code = svg_parse_polyline(ctx, root);
-    else if (!strcmp(tag, "polygon"))
+	break;
+    case SVG_TAG_POLYGON:
 	code = svg_parse_polygon(ctx, root);
+	break;
 
-#if 0
-    else if (!strcmp(tag, "text"))
+    case SVG_TAG_TEXT:
 	code = svg_parse_text(ctx, root);
-    else if (!strcmp(tag, "tspan"))
-	code = svg_parse_text_span(ctx, root);
-    else if (!strcmp(tag, "tref"))
+	break;
+
+#if 0
+    case SVG_TAG_TREF:
 	code = svg_parse_text_ref(ctx, root);
-    else if (!strcmp(tag, "textPath"))
+	break;
+    case SVG_TAG_TEXT_PATH:
 	code = svg_parse_text_path(ctx, root);
+	break;
 #endif
 
-    else
-    {
+    default:
 	/* debug print unrecognized tags */
 	code = 0;
 	svg_debug_item(root, 0);
+	break;
     }
 
     if (code < 0)
-	return gs_rethrow(code, "cannot parse svg element");
+	return gs_rethrow(code, "cannot draw svg element");
 
     return 0;
 }
 
+/*
+ * Set up the page for a document from the attributes of the root
+ * <svg> element. The contents are drawn by the caller, either from
+ * the complete tree or as they are streamed in by the xml parser.
+ */
 int
-svg_parse_document(svg_context_t *ctx, svg_item_t *root)
+svg_begin_document(svg_context_t *ctx, svg_item_t *root)
 {
     char *version_att;
     char *width_att;
     char *height_att;
     char *view_box_att;
 
-    int use_transparency = 0;
-    svg_item_t *node;
     int code;
 
     int version;
@@ -238,13 +388,13 @@ svg_parse_document(svg_context_t *ctx, svg_item_t *root)
     float vb_width = 595;
     float vb_height = 842;
 
-    if (strcmp(svg_tag(root), "svg"))
+    if (svg_tag_atom(root) != SVG_TAG_SVG)
 	return gs_throw1(-1, "expected svg element (found %s)", svg_tag(root));
 
-    version_att = svg_att(root, "version");
-    width_att = svg_att(root, "width");
-    height_att = svg_att(root, "height");
-    view_box_att = svg_att(root, "viewBox");
+    version_att = svg_att_atom(root, SVG_ATT_VERSION);
+    width_att = svg_att_atom(root, SVG_ATT_WIDTH);
+    height_att = svg_att_atom(root, SVG_ATT_HEIGHT);
+    view_box_att = svg_att_atom(root, SVG_ATT_VIEW_BOX);
 
     version = 10;
     if (version_att)
@@ -258,11 +408,11 @@ svg_parse_document(svg_context_t *ctx, svg_item_t *root)
     }
 
     width = vb_width;
-    if (!width_att)
+    if (width_att)
 	width = svg_parse_length(width_att, vb_width, 12);
 
     height = vb_height;
-    if (!height_att)
+    if (height_att)
 	height = svg_parse_length(height_att, vb_height, 12);
 
     if (version > 12)
@@ -278,21 +428,25 @@ svg_parse_document(svg_context_t *ctx, svg_item_t *root)
 	gs_c_param_list list;
 	int code;
 
-	gs_c_param_list_write(&list, mem);
-
-	fv[0] = width;
-	fv[1] = height;
-	fa.persistent = false;
-	fa.data = fv;
-	fa.size = 2;
-
-	code = param_write_float_array((gs_param_list *)&list, ".MediaSize", &fa);
-	if ( code >= 0 )
+	/* runs of same sized pages (as in batch mode) keep the device as is */
+	if (dev->MediaSize[0] != width || dev->MediaSize[1] != height)
 	{
-	    gs_c_param_list_read(&list);
-	    code = gs_putdeviceparams(dev, (gs_param_list *)&list);
+	    gs_c_param_list_write(&list, mem);
+
+	    fv[0] = width;
+	    fv[1] = height;
+	    fa.persistent = false;
+	    fa.data = fv;
+	    fa.size = 2;
+
+	    code = param_write_float_array((gs_param_list *)&list, ".MediaSize", &fa);
+	    if ( code >= 0 )
+	    {
+		gs_c_param_list_read(&list);
+		code = gs_putdeviceparams(dev, (gs_param_list *)&list);
+	    }
+	    gs_c_param_list_release(&list);
 	}
-	gs_c_param_list_release(&list);
 
 	/* nb this is for the demo it is wrong and should be removed */
 	gs_initgraphics(pgs);
@@ -324,27 +478,43 @@ svg_parse_document(svg_context_t *ctx, svg_item_t *root)
     /* save the state with the original device before we push */
     gs_gsave(ctx->pgs);
 
-    if (use_transparency)
+    /* the caller decides whether the page needs the compositor */
+    ctx->opacity_groups = 0;
+    if (ctx->use_transparency)
     {
 	code = gs_push_pdf14trans_device(ctx->pgs);
 	if (code < 0)
+	{
+	    gs_grestore(ctx->pgs);
 	    return gs_rethrow(code, "cannot install transparency device");
+	}
     }
 
-    /* Draw contents */
+    return 0;
+}
 
-    for (node = svg_down(root); node; node = svg_next(node))
-    {
-	code = svg_parse_element(ctx, node);
-	if (code < 0)
-	    break;
-    }
+/*
+ * Finish the page begun by svg_begin_document.
+ */
+int
+svg_end_document(svg_context_t *ctx)
+{
+    int code;
+
+    svg_free_defs(ctx);
+    svg_free_gradients(ctx);
+    svg_debug_text(ctx);
 
-    if (use_transparency)
+    if (ctx->use_transparency)
     {
+	if_debug1('|', "svg: pdf14 compositor used, %d transparency groups\n",
+		ctx->opacity_groups);
 	code = gs_pop_pdf14trans_device(ctx->pgs);
 	if (code < 0)
+	{
+	    gs_grestore(ctx->pgs);
 	    return gs_rethrow(code, "cannot uninstall transparency device");
+	}
     }
 
     /* Flush page */
@@ -360,3 +530,44 @@ svg_parse_document(svg_context_t *ctx, svg_item_t *root)
     return 0;
 }
 
+/*
+ * Discard a page begun by svg_begin_document without outputting it.
+ */
+void
+svg_abort_document(svg_context_t *ctx)
+{
+    svg_free_defs(ctx);
+    svg_free_gradients(ctx);
+    svg_debug_text(ctx);
+    if (ctx->use_transparency)
+	gs_pop_pdf14trans_device(ctx->pgs);
+    gs_grestore(ctx->pgs);
+}
+
+int
+svg_parse_document(svg_context_t *ctx, svg_item_t *root)
+{
+    svg_item_t *node;
+    int code;
+
+    /* only pay for the compositor when something is translucent */
+    if (ctx->transparency < 0)
+	ctx->use_transparency = svg_needs_transparency(root);
+    else
+	ctx->use_transparency = ctx->transparency;
+
+    code = svg_begin_document(ctx, root);
+    if (code < 0)
+	return gs_rethrow(code, "cannot begin svg document");
+
+    /* Draw contents */
+
+    for (node = svg_down(root); node; node = svg_next(node))
+    {
+	code = svg_parse_element(ctx, node);
+	if (code < 0)
+	    break;
+    }
+
+    return svg_end_document(ctx);
+}
@@ -0,0 +1,306 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - font selection */
+
+#include "ghostsvg.h"
+#include "gp.h"
+#include "gscdefs.h"
+#include "plfont.h"
+
+/*
+ * SVG documents name fonts by CSS family lists, which we map onto the
+ * URW TrueType fonts that ship with the PCL interpreters. Faces are
+ * loaded once per job and shared by every family that maps to them;
+ * resolved family lists are remembered so each distinct font-family
+ * string is only parsed and searched for once.
+ *
+ * Sizes and transforms are applied with the char matrix at show time,
+ * so one face serves all sizes and the character cache keys its
+ * rasters on the resulting font/matrix pair.
+ *
+ * Faces are searched for on -sSVGFontPath if it is given. Otherwise
+ * they come from the ROM file system, where BUNDLE_FONTS=1 puts them
+ * as it does for PCL, and then from the library search path.
+ */
+
+#define SVG_ROM_FONT_PATH "%rom%ttfonts/"
+#define SVG_DEFAULT_FONT_FAMILY "serif"
+
+typedef struct svg_font_family_s
+{
+    const char *name; /* lower case */
+    const char *faces[4]; /* regular, italic, bold, bold italic */
+} svg_font_family_t;
+
+#define TIMES { "NimbusRomNo9L-Regu", "NimbusRomNo9L-ReguItal", "NimbusRomNo9L-Medi", "NimbusRomNo9L-MediItal" }
+#define HELVETICA { "NimbusSanL-Regu", "NimbusSanL-ReguItal", "NimbusSanL-Bold", "NimbusSanL-BoldItal" }
+#define COURIER { "NimbusMonL-Regu", "NimbusMonL-ReguObli", "NimbusMonL-Bold", "NimbusMonL-BoldObli" }
+#define SCHOOLBOOK { "CenturySchL-Roma", "CenturySchL-Ital", "CenturySchL-Bold", "CenturySchL-BoldItal" }
+#define CHANCERY { "URWChanceryL-MediItal", "URWChanceryL-MediItal", "URWChanceryL-MediItal", "URWChanceryL-MediItal" }
+#define DINGBATS { "Dingbats", "Dingbats", "Dingbats", "Dingbats" }
+
+/* Sorted by name for the binary search. */
+static const svg_font_family_t svg_font_families[] =
+{
+    { "arial", HELVETICA },
+    { "avant garde", { "URWGothicL-Book", "URWGothicL-BookObli", "URWGothicL-Demi", "URWGothicL-DemiObli" } },
+    { "bookman", { "URWBookmanL-Ligh", "URWBookmanL-LighItal", "URWBookmanL-DemiBold", "URWBookmanL-DemiBoldItal" } },
+    { "century schoolbook", SCHOOLBOOK },
+    { "courier", COURIER },
+    { "courier new", COURIER },
+    { "cursive", CHANCERY },
+    { "dingbats", DINGBATS },
+    { "helvetica", HELVETICA },
+    { "monospace", COURIER },
+    { "new century schoolbook", SCHOOLBOOK },
+    { "palatino", { "URWPalladioL-Roma", "URWPalladioL-Ital", "URWPalladioL-Bold", "URWPalladioL-BoldItal" } },
+    { "sans-serif", HELVETICA },
+    { "serif", TIMES },
+    { "symbol", { "StandardSymL", "StandardSymL", "StandardSymL", "StandardSymL" } },
+    { "times", TIMES },
+    { "times new roman", TIMES },
+    { "zapf chancery", CHANCERY },
+    { "zapf dingbats", DINGBATS },
+};
+
+static const svg_font_family_t *
+svg_lookup_font_family(const char *name)
+{
+    int l = 0;
+    int r = countof(svg_font_families) - 1;
+    while (l <= r)
+    {
+	int m = (l + r) / 2;
+	int c = strcmp(name, svg_font_families[m].name);
+	if (c < 0)
+	    r = m - 1;
+	else if (c > 0)
+	    l = m + 1;
+	else
+	    return &svg_font_families[m];
+    }
+    return NULL;
+}
+
+int
+svg_init_font_cache(svg_context_t *ctx)
+{
+    ctx->fontdir = gs_font_dir_alloc(ctx->memory);
+    if (!ctx->fontdir)
+	return gs_throw(-1, "cannot allocate font directory");
+    gs_setaligntopixels(ctx->fontdir, 1); /* no subpixels */
+    gs_setgridfittt(ctx->fontdir, 1); /* see gx_ttf_outline in gxttfn.c for values */
+    return 0;
+}
+
+static void
+svg_free_font_key(svg_context_t *ctx, void *key)
+{
+    svg_free(ctx, key);
+}
+
+static void
+svg_free_font_face(svg_context_t *ctx, void *face)
+{
+    pl_free_font(ctx->memory, face, "svg_free_font_face");
+}
+
+void
+svg_free_font_cache(svg_context_t *ctx)
+{
+    /* the resolved table only holds borrowed pointers to the faces */
+    if (ctx->font_table)
+	svg_hash_free(ctx, ctx->font_table, svg_free_font_key, NULL);
+    if (ctx->font_faces)
+	svg_hash_free(ctx, ctx->font_faces, svg_free_font_key, svg_free_font_face);
+    ctx->font_table = NULL;
+    ctx->font_faces = NULL;
+}
+
+/*
+ * Load a face by file name (without extension) from the first directory
+ * on a list that has it.
+ */
+static pl_font_t *
+svg_load_font_face_from(svg_context_t *ctx, const char *font_path, const char *name)
+{
+    const char *sep = gp_file_name_directory_separator();
+    char path[gp_file_name_sizeof];
+    const char *p, *e;
+    pl_font_t *face;
+    stream *in;
+    char *key;
+    int code, n;
+
+    for (p = font_path; *p; p = *e ? e + 1 : e)
+    {
+	e = strchr(p, gp_file_name_list_separator);
+	if (!e)
+	    e = p + strlen(p);
+	n = e - p;
+	if (n == 0 || n + strlen(sep) + strlen(name) + 5 > sizeof path)
+	    continue;
+
+	memcpy(path, p, n);
+	path[n] = 0;
+	if (path[n - 1] != sep[0])
+	    svg_strlcat(path, sep, sizeof path);
+	svg_strlcat(path, name, sizeof path);
+	svg_strlcat(path, ".ttf", sizeof path);
+
+	in = sfopen(path, gp_fmode_rb, ctx->memory);
+	if (!in)
+	    continue;
+
+	/* this closes the stream */
+	code = pl_load_tt_font(in, ctx->fontdir, ctx->memory,
+		gs_next_ids(ctx->memory, 1), &face, (char *)name);
+	if (code < 0)
+	{
+	    gs_catch1(code, "cannot load font '%s'", path);
+	    continue;
+	}
+
+	key = svg_strdup(ctx, name);
+	if (!key || svg_hash_insert(ctx, ctx->font_faces, key, face) < 0)
+	{
+	    if (key)
+		svg_free(ctx, key);
+	    pl_free_font(ctx->memory, face, "svg_load_font_face");
+	    return NULL;
+	}
+
+	if_debug1('|', "svg: loaded font %s\n", path);
+	return face;
+    }
+
+    return NULL;
+}
+
+static pl_font_t *
+svg_load_font_face(svg_context_t *ctx, const char *name)
+{
+    pl_font_t *face;
+
+    face = svg_hash_lookup(ctx->font_faces, name);
+    if (face)
+	return face;
+
+    if (ctx->font_path)
+	return svg_load_font_face_from(ctx, ctx->font_path, name);
+
+    face = svg_load_font_face_from(ctx, SVG_ROM_FONT_PATH, name);
+    if (!face)
+	face = svg_load_font_face_from(ctx, gs_lib_default_path, name);
+    return face;
+}
+
+/*
+ * Try one family name from a font-family list. Quotes and surrounding
+ * spaces are stripped, and the match is case insensitive.
+ */
+static pl_font_t *
+svg_try_font_family(svg_context_t *ctx, const char *s, int n, int style)
+{
+    const svg_font_family_t *family;
+    char name[64];
+    int i;
+
+    while (n > 0 && (svg_is_whitespace(*s) || *s == '\'' || *s == '"'))
+	s++, n--;
+    while (n > 0 && (svg_is_whitespace(s[n-1]) || s[n-1] == '\'' || s[n-1] == '"'))
+	n--;
+    if (n <= 0 || n >= sizeof name)
+	return NULL;
+
+    for (i = 0; i < n; i++)
+	name[i] = tolower((unsigned char)s[i]);
+    name[n] = 0;
+
+    family = svg_lookup_font_family(name);
+    if (!family)
+	return NULL;
+
+    return svg_load_font_face(ctx, family->faces[style]);
+}
+
+gs_font *
+svg_select_font(svg_context_t *ctx, const char *family, int bold, int italic)
+{
+    int style = (bold ? 2 : 0) + (italic ? 1 : 0);
+    pl_font_t *face;
+    const char *p, *e;
+    char buf[128];
+    char *key = buf;
+    int n;
+
+    if (!family)
+	family = SVG_DEFAULT_FONT_FAMILY;
+
+    if (!ctx->font_table)
+    {
+	ctx->font_faces = svg_hash_new(ctx);
+	ctx->font_table = svg_hash_new(ctx);
+	if (!ctx->font_faces || !ctx->font_table)
+	{
+	    svg_free_font_cache(ctx);
+	    gs_throw(-1, "cannot create font tables");
+	    return NULL;
+	}
+    }
+
+    /* key is the style digit followed by the family list as written */
+    n = strlen(family);
+    if (n + 2 > sizeof buf)
+    {
+	key = svg_alloc(ctx, n + 2);
+	if (!key)
+	    return NULL;
+    }
+    key[0] = '0' + style;
+    memcpy(key + 1, family, n + 1);
+
+    face = svg_hash_lookup(ctx->font_table, key);
+    if (!face)
+    {
+	for (p = family; *p && !face; p = *e ? e + 1 : e)
+	{
+	    e = strchr(p, ',');
+	    if (!e)
+		e = p + strlen(p);
+	    face = svg_try_font_family(ctx, p, e - p, style);
+	}
+
+	if (!face)
+	    face = svg_try_font_family(ctx, SVG_DEFAULT_FONT_FAMILY,
+		    strlen(SVG_DEFAULT_FONT_FAMILY), style);
+
+	if (face)
+	{
+	    if (key == buf)
+		key = svg_strdup(ctx, buf);
+	    if (key && svg_hash_insert(ctx, ctx->font_table, key, face) == 0)
+		key = buf; /* now owned by the table */
+	}
+	else
+	{
+	    gs_warn1("cannot find a font for font-family '%s'", family);
+	}
+    }
+
+    if (key != buf)
+	svg_free(ctx, key);
+
+    return face ? face->pfont : NULL;
+}
@@ -0,0 +1,963 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - linear and radial gradients */
+
+#include "ghostsvg.h"
+
+/*
+ * Gradients are compiled when they are parsed into a stitching function
+ * of linear segments, one per pair of stops, and kept by id until the
+ * end of the document. Linear gradients become Axial (type 2) shadings
+ * and radial gradients Radial (type 3) shadings.
+ *
+ * The shading for a pad gradient does not depend on the element it
+ * paints: objectBoundingBox units are applied as a transform. So it is
+ * built on first use and reused by every later fill.
+ *
+ * Repeat and reflect are drawn as shadings over runs of the periods
+ * that cover the painted area. Their function stitches copies of the
+ * stop function, with every other copy reversed for reflect. A run
+ * spans at most SVG_GRADIENT_RUN periods and starts on an even one, so
+ * that every run of a fill, and of later fills, shares the function.
+ */
+
+#define SVG_MAX_GRADIENT_STOPS 256
+#define SVG_GRADIENT_RUN 256 /* must be even */
+
+enum { SVG_SPREAD_PAD, SVG_SPREAD_REFLECT, SVG_SPREAD_REPEAT };
+
+typedef struct svg_gradient_stop_s svg_gradient_stop_t;
+
+struct svg_gradient_stop_s
+{
+    float offset;
+    float color[3];
+};
+
+struct svg_gradient_s
+{
+    char *id;
+    int is_radial;
+    int spread;
+    int user_space; /* gradientUnits="userSpaceOnUse" */
+    gs_matrix transform;
+    float coords[6]; /* x1 y1 x2 y2, or fx fy 0 cx cy r */
+    int is_degenerate; /* paint the last stop color */
+
+    int stop_count;
+    svg_gradient_stop_t *stops;
+    gs_function_t *func;
+
+    gs_shading_t *shading; /* pad */
+    gs_function_t *periodic_func; /* repeat and reflect */
+    int period_count;
+};
+
+/*
+ * Create a Function object to map [0..1] to RGB colors
+ * based on the gradient stop arrays.
+ *
+ * We do this by creating a stitching function that joins
+ * a series of linear functions (one linear function
+ * for each gradient stop-pair).
+ */
+
+static void
+svg_free_gradient_function(svg_context_t *ctx, gs_function_t *func, int free_subfunctions)
+{
+    gs_function_1ItSg_params_t *sparams;
+    gs_function_ElIn_params_t *lparams;
+    gs_function_t *lfunc;
+    int i;
+
+    sparams = (gs_function_1ItSg_params_t*) &func->params;
+
+    if (free_subfunctions)
+    {
+	for (i = 0; i < sparams->k; i++)
+	{
+	    lfunc = (gs_function_t*) sparams->Functions[i]; /* discard const */
+	    if (!lfunc)
+		continue;
+	    lparams = (gs_function_ElIn_params_t*) &lfunc->params;
+	    svg_free(ctx, (void*)lparams->Domain);
+	    svg_free(ctx, (void*)lparams->C0);
+	    svg_free(ctx, (void*)lparams->C1);
+	    svg_free(ctx, lfunc);
+	}
+    }
+
+    svg_free(ctx, (void*)sparams->Domain);
+    svg_free(ctx, (void*)sparams->Bounds);
+    svg_free(ctx, (void*)sparams->Encode);
+    svg_free(ctx, (void*)sparams->Functions);
+    svg_free(ctx, func);
+}
+
+static gs_function_t *
+svg_create_gradient_function(svg_context_t *ctx, svg_gradient_stop_t *stops, int count)
+{
+    gs_function_1ItSg_params_t sparams;
+    gs_function_ElIn_params_t lparams;
+    gs_function_t *sfunc;
+    gs_function_t *lfunc;
+    const gs_function_t **functions;
+    float *domain, *c0, *c1, *bounds, *encode;
+    int code;
+    int k;
+    int i;
+
+    k = count - 1; /* number of intervals / functions */
+
+    domain = svg_alloc(ctx, 2 * sizeof(float));
+    functions = svg_alloc(ctx, k * sizeof(void*));
+    bounds = svg_alloc(ctx, k * sizeof(float));
+    encode = svg_alloc(ctx, k * 2 * sizeof(float));
+    if (!domain || !functions || !bounds || !encode)
+    {
+	svg_free(ctx, domain);
+	svg_free(ctx, functions);
+	svg_free(ctx, bounds);
+	svg_free(ctx, encode);
+	gs_throw(-1, "out of memory: gradient function");
+	return NULL;
+    }
+
+    domain[0] = 0.0;
+    domain[1] = 1.0;
+    sparams.m = 1;
+    sparams.Domain = domain;
+    sparams.n = 3;
+    sparams.Range = NULL;
+    sparams.k = k;
+    sparams.Functions = functions;
+    sparams.Bounds = bounds;
+    sparams.Encode = encode;
+
+    memset(functions, 0, k * sizeof(void*));
+
+    for (i = 0; i < k; i++)
+    {
+	domain = svg_alloc(ctx, 2 * sizeof(float));
+	c0 = svg_alloc(ctx, 3 * sizeof(float));
+	c1 = svg_alloc(ctx, 3 * sizeof(float));
+	if (!domain || !c0 || !c1)
+	{
+	    svg_free(ctx, domain);
+	    svg_free(ctx, c0);
+	    svg_free(ctx, c1);
+	    code = gs_throw(-1, "out of memory: gradient function");
+	    goto fail;
+	}
+
+	domain[0] = 0.0;
+	domain[1] = 1.0;
+	lparams.m = 1;
+	lparams.Domain = domain;
+	lparams.n = 3;
+	lparams.Range = NULL;
+
+	memcpy(c0, stops[i].color, 3 * sizeof(float));
+	memcpy(c1, stops[i+1].color, 3 * sizeof(float));
+	lparams.C0 = c0;
+	lparams.C1 = c1;
+	lparams.N = 1;
+
+	code = gs_function_ElIn_init(&lfunc, &lparams, ctx->memory);
+	if (code < 0)
+	{
+	    svg_free(ctx, domain);
+	    svg_free(ctx, c0);
+	    svg_free(ctx, c1);
+	    gs_rethrow(code, "gs_function_ElIn_init failed");
+	    goto fail;
+	}
+
+	functions[i] = lfunc;
+
+	if (i > 0)
+	    bounds[i - 1] = stops[i].offset;
+
+	encode[i * 2 + 0] = 0.0;
+	encode[i * 2 + 1] = 1.0;
+    }
+
+    code = gs_function_1ItSg_init(&sfunc, &sparams, ctx->memory);
+    if (code < 0)
+    {
+	gs_rethrow(code, "gs_function_1ItSg_init failed");
+	goto fail;
+    }
+
+    return sfunc;
+
+fail:
+    for (i = 0; i < k; i++)
+    {
+	lfunc = (gs_function_t*) functions[i];
+	if (lfunc)
+	{
+	    lparams = *(gs_function_ElIn_params_t*) &lfunc->params;
+	    svg_free(ctx, (void*)lparams.Domain);
+	    svg_free(ctx, (void*)lparams.C0);
+	    svg_free(ctx, (void*)lparams.C1);
+	    svg_free(ctx, lfunc);
+	}
+    }
+    svg_free(ctx, (void*)sparams.Domain);
+    svg_free(ctx, functions);
+    svg_free(ctx, bounds);
+    svg_free(ctx, encode);
+    return NULL;
+}
+
+/*
+ * Stitch k copies of the stop function over the periods [0..k), so
+ * that the value at t is the stop function at the fraction of t,
+ * mirrored in odd periods when reflecting.
+ */
+static gs_function_t *
+svg_create_periodic_function(svg_context_t *ctx, gs_function_t *func,
+	int k, int reflect)
+{
+    gs_function_1ItSg_params_t sparams;
+    gs_function_t *sfunc;
+    const gs_function_t **functions;
+    float *domain, *bounds, *encode;
+    int code;
+    int i;
+
+    domain = svg_alloc(ctx, 2 * sizeof(float));
+    functions = svg_alloc(ctx, k * sizeof(void*));
+    bounds = svg_alloc(ctx, k * sizeof(float));
+    encode = svg_alloc(ctx, k * 2 * sizeof(float));
+    if (!domain || !functions || !bounds || !encode)
+    {
+	svg_free(ctx, domain);
+	svg_free(ctx, functions);
+	svg_free(ctx, bounds);
+	svg_free(ctx, encode);
+	gs_throw(-1, "out of memory: gradient function");
+	return NULL;
+    }
+
+    domain[0] = 0;
+    domain[1] = k;
+
+    for (i = 0; i < k; i++)
+    {
+	int flip = reflect && (i & 1);
+	functions[i] = func;
+	bounds[i] = i + 1;
+	encode[i * 2 + 0] = flip ? 1.0 : 0.0;
+	encode[i * 2 + 1] = flip ? 0.0 : 1.0;
+    }
+
+    sparams.m = 1;
+    sparams.Domain = domain;
+    sparams.n = 3;
+    sparams.Range = NULL;
+    sparams.k = k;
+    sparams.Functions = functions;
+    sparams.Bounds = bounds;
+    sparams.Encode = encode;
+
+    code = gs_function_1ItSg_init(&sfunc, &sparams, ctx->memory);
+    if (code < 0)
+    {
+	svg_free(ctx, domain);
+	svg_free(ctx, functions);
+	svg_free(ctx, bounds);
+	svg_free(ctx, encode);
+	gs_rethrow(code, "gs_function_1ItSg_init failed");
+	return NULL;
+    }
+
+    return sfunc;
+}
+
+/*
+ * Build a shading over the periods [lo..hi) of the gradient vector,
+ * which maps them onto [0..hi-lo) of the function. Pad gradients use
+ * the single period [0..1) and extend both its ends.
+ */
+static gs_shading_t *
+svg_create_gradient_shading(svg_context_t *ctx, svg_gradient_t *grad,
+	gs_function_t *func, int lo, int hi, int extend_lo, int extend_hi)
+{
+    const float *c = grad->coords;
+    gs_shading_t *shading;
+    int code;
+
+    if (grad->is_radial)
+    {
+	gs_shading_R_params_t params;
+
+	/* circle t is centered on f + t(c - f) with radius t r */
+	gs_shading_R_params_init(&params);
+	params.ColorSpace = ctx->srgb;
+	params.Coords[0] = c[0] + (c[3] - c[0]) * lo;
+	params.Coords[1] = c[1] + (c[4] - c[1]) * lo;
+	params.Coords[2] = c[5] * lo;
+	params.Coords[3] = c[0] + (c[3] - c[0]) * hi;
+	params.Coords[4] = c[1] + (c[4] - c[1]) * hi;
+	params.Coords[5] = c[5] * hi;
+	params.Domain[0] = 0;
+	params.Domain[1] = hi - lo;
+	params.Extend[0] = extend_lo;
+	params.Extend[1] = extend_hi;
+	params.Function = func;
+
+	code = gs_shading_R_init(&shading, &params, ctx->memory);
+	if (code < 0)
+	{
+	    gs_rethrow(code, "gs_shading_R_init failed");
+	    return NULL;
+	}
+    }
+    else
+    {
+	gs_shading_A_params_t params;
+	float dx = c[2] - c[0];
+	float dy = c[3] - c[1];
+
+	gs_shading_A_params_init(&params);
+	params.ColorSpace = ctx->srgb;
+	params.Coords[0] = c[0] + dx * lo;
+	params.Coords[1] = c[1] + dy * lo;
+	params.Coords[2] = c[0] + dx * hi;
+	params.Coords[3] = c[1] + dy * hi;
+	params.Domain[0] = 0;
+	params.Domain[1] = hi - lo;
+	params.Extend[0] = extend_lo;
+	params.Extend[1] = extend_hi;
+	params.Function = func;
+
+	code = gs_shading_A_init(&shading, &params, ctx->memory);
+	if (code < 0)
+	{
+	    gs_rethrow(code, "gs_shading_A_init failed");
+	    return NULL;
+	}
+    }
+
+    ctx->gradient_shadings ++;
+    return shading;
+}
+
+/*
+ * Find the periods of the gradient vector that cover the box,
+ * which is in gradient space.
+ */
+static void
+svg_gradient_periods(svg_gradient_t *grad, const gs_rect *box, int *lo, int *hi)
+{
+    const float *c = grad->coords;
+    float corners[4][2];
+    double t0 = 0, t1 = 0;
+    int i;
+
+    corners[0][0] = box->p.x; corners[0][1] = box->p.y;
+    corners[1][0] = box->q.x; corners[1][1] = box->p.y;
+    corners[2][0] = box->q.x; corners[2][1] = box->q.y;
+    corners[3][0] = box->p.x; corners[3][1] = box->q.y;
+
+    if (grad->is_radial)
+    {
+	/* any point within |p - f| of f is inside circle |p - f| / (r - |c - f|) */
+	double fc = hypot(c[3] - c[0], c[4] - c[1]);
+	for (i = 0; i < 4; i++)
+	{
+	    double d = hypot(corners[i][0] - c[0], corners[i][1] - c[1]);
+	    t1 = MAX(t1, d / (c[5] - fc));
+	}
+    }
+    else
+    {
+	double dx = c[2] - c[0];
+	double dy = c[3] - c[1];
+	double len2 = dx * dx + dy * dy;
+	for (i = 0; i < 4; i++)
+	{
+	    double t = ((corners[i][0] - c[0]) * dx + (corners[i][1] - c[1]) * dy) / len2;
+	    if (i == 0 || t < t0) t0 = t;
+	    if (i == 0 || t > t1) t1 = t;
+	}
+    }
+
+    /* keep the period numbers well inside an int */
+    t0 = MAX(floor(t0), -(double)(1 << 30));
+    t1 = MIN(ceil(t1), (double)(1 << 30));
+    if (t1 <= t0)
+	t1 = t0 + 1;
+
+    *lo = t0;
+    *hi = t1;
+}
+
+static int
+svg_paint_pad_gradient(svg_context_t *ctx, svg_gradient_t *grad)
+{
+    int code;
+
+    if (!grad->shading)
+    {
+	grad->shading = svg_create_gradient_shading(ctx, grad, grad->func, 0, 1, 1, 1);
+	if (!grad->shading)
+	    return gs_rethrow(-1, "cannot create gradient shading");
+    }
+
+    code = gs_shfill(ctx->pgs, grad->shading);
+    if (code < 0)
+	return gs_rethrow(code, "gs_shfill failed");
+
+    return 0;
+}
+
+/*
+ * Paint the periods that cover the clip, one run of them at a time.
+ * Only the outermost runs extend their end colors, since the others
+ * would paint over their neighbours.
+ */
+static int
+svg_paint_periodic_gradient(svg_context_t *ctx, svg_gradient_t *grad)
+{
+    gs_function_t *func;
+    gs_shading_t *shading;
+    gs_rect box;
+    int lo, hi, run, i;
+    int code;
+
+    code = svg_bounds_in_user_space(ctx, &box);
+    if (code < 0)
+	return gs_rethrow(code, "cannot find the gradient area");
+
+    svg_gradient_periods(grad, &box, &lo, &hi);
+
+    /* a run that starts on an even period is a copy of the first */
+    lo -= lo & 1;
+    run = MIN(hi - lo, SVG_GRADIENT_RUN);
+
+    if (grad->period_count < run)
+    {
+	func = svg_create_periodic_function(ctx, grad->func, run,
+		grad->spread == SVG_SPREAD_REFLECT);
+	if (!func)
+	    return gs_rethrow(-1, "cannot create gradient function");
+	if (grad->periodic_func)
+	    svg_free_gradient_function(ctx, grad->periodic_func, 0);
+	grad->periodic_func = func;
+	grad->period_count = run;
+    }
+
+    for (i = lo; i < hi; i += run)
+    {
+	shading = svg_create_gradient_shading(ctx, grad, grad->periodic_func,
+		i, i + run, i == lo, i + run >= hi);
+	if (!shading)
+	    return gs_rethrow(-1, "cannot create gradient shading");
+
+	code = gs_shfill(ctx->pgs, shading);
+	gs_free_object(ctx->memory, shading, "svg_paint_periodic_gradient");
+	if (code < 0)
+	    return gs_rethrow(code, "gs_shfill failed");
+    }
+
+    return 0;
+}
+
+/*
+ * Compute the bounding box of the current path in user space,
+ * for objectBoundingBox units.
+ */
+static int
+svg_path_bbox(svg_context_t *ctx, gs_rect *box)
+{
+    gs_path_enum penum;
+    gs_point pts[3];
+    int op, n, i;
+    int empty = 1;
+
+    gs_path_enum_copy_init(&penum, ctx->pgs, false);
+    while ((op = gs_path_enum_next(&penum, pts)) > 0)
+    {
+	if (op == gs_pe_closepath)
+	    continue;
+	n = op == gs_pe_curveto ? 3 : 1;
+	for (i = 0; i < n; i++)
+	{
+	    if (empty || pts[i].x < box->p.x) box->p.x = pts[i].x;
+	    if (empty || pts[i].y < box->p.y) box->p.y = pts[i].y;
+	    if (empty || pts[i].x > box->q.x) box->q.x = pts[i].x;
+	    if (empty || pts[i].y > box->q.y) box->q.y = pts[i].y;
+	    empty = 0;
+	}
+    }
+    gs_path_enum_cleanup(&penum);
+
+    return !empty;
+}
+
+/*
+ * Paint the current path (or its outline, when stroking) with a gradient.
+ */
+int
+svg_paint_gradient(svg_context_t *ctx, svg_gradient_t *grad, int stroke)
+{
+    gs_matrix bbox_matrix;
+    gs_rect box;
+    int code = 0;
+
+    if (grad->is_degenerate)
+    {
+	svg_set_color(ctx, grad->stops[grad->stop_count - 1].color);
+	if (stroke)
+	    return gs_stroke(ctx->pgs);
+	if (ctx->fill_rule == 0)
+	    return gs_eofill(ctx->pgs);
+	return gs_fill(ctx->pgs);
+    }
+
+    /* objectBoundingBox is the geometry, without the stroke */
+    if (!grad->user_space)
+    {
+	if (!svg_path_bbox(ctx, &box) || box.q.x <= box.p.x || box.q.y <= box.p.y)
+	{
+	    gs_newpath(ctx->pgs);
+	    return 0;
+	}
+	gs_make_identity(&bbox_matrix);
+	bbox_matrix.xx = box.q.x - box.p.x;
+	bbox_matrix.yy = box.q.y - box.p.y;
+	bbox_matrix.tx = box.p.x;
+	bbox_matrix.ty = box.p.y;
+    }
+
+    gs_gsave(ctx->pgs);
+
+    if (stroke)
+    {
+	code = gs_strokepath(ctx->pgs);
+	if (code >= 0)
+	    code = gs_clip(ctx->pgs);
+    }
+    else
+    {
+	if (ctx->fill_rule == 0)
+	    code = gs_eoclip(ctx->pgs);
+	else
+	    code = gs_clip(ctx->pgs);
+    }
+    if (code < 0)
+    {
+	gs_grestore(ctx->pgs);
+	return gs_rethrow(code, "cannot clip to gradient area");
+    }
+
+    gs_newpath(ctx->pgs);
+
+    if (!grad->user_space)
+	gs_concat(ctx->pgs, &bbox_matrix);
+    gs_concat(ctx->pgs, &grad->transform);
+
+    gs_setsmoothness(ctx->pgs, 0.02);
+
+    if (grad->spread == SVG_SPREAD_PAD)
+	code = svg_paint_pad_gradient(ctx, grad);
+    else
+	code = svg_paint_periodic_gradient(ctx, grad);
+
+    gs_grestore(ctx->pgs);
+
+    /* like gs_fill and gs_stroke, consume the path */
+    gs_newpath(ctx->pgs);
+
+    ctx->gradient_fills ++;
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot paint gradient");
+
+    return 0;
+}
+
+/*
+ * Parsing.
+ */
+
+static float
+svg_parse_gradient_length(svg_gradient_t *grad, char *str, float percent)
+{
+    /* fractions and percentages of the bounding box are the same thing */
+    if (!grad->user_space)
+	percent = 1;
+    return svg_parse_length(str, percent, 12);
+}
+
+static int
+svg_parse_gradient_stops(svg_context_t *ctx, svg_item_t *root, svg_gradient_t *grad)
+{
+    svg_gradient_stop_t *stops;
+    svg_item_t *node;
+    char *offset_att;
+    char *color_att;
+    float offset;
+    int count = 0;
+
+    for (node = svg_down(root); node; node = svg_next(node))
+	if (svg_tag_atom(node) == SVG_TAG_STOP)
+	    count ++;
+
+    if (count == 0)
+	return 0;
+
+    if (count > SVG_MAX_GRADIENT_STOPS)
+    {
+	gs_warn("too many gradient stops");
+	count = SVG_MAX_GRADIENT_STOPS;
+    }
+
+    /* room for the duplicates at 0 and 1 */
+    stops = svg_alloc(ctx, (count + 2) * sizeof(svg_gradient_stop_t));
+    if (!stops)
+	return gs_throw(-1, "out of memory: gradient stops");
+
+    count = 0;
+    for (node = svg_down(root); node && count < SVG_MAX_GRADIENT_STOPS; node = svg_next(node))
+    {
+	if (svg_tag_atom(node) != SVG_TAG_STOP)
+	    continue;
+
+	offset_att = svg_att_atom(node, SVG_ATT_OFFSET);
+	color_att = svg_att_atom(node, SVG_ATT_STOP_COLOR);
+
+	offset = offset_att ? svg_parse_length(offset_att, 1, 12) : 0;
+	offset = MAX(offset, 0);
+	offset = MIN(offset, 1);
+
+	/* offsets never decrease */
+	if (count > 0)
+	    offset = MAX(offset, stops[count - 1].offset);
+
+	stops[count].offset = offset;
+	stops[count].color[0] = 0;
+	stops[count].color[1] = 0;
+	stops[count].color[2] = 0;
+	if (color_att && svg_parse_color(color_att, stops[count].color) < 0)
+	    gs_catch(-1, "ignoring stop-color");
+
+	count ++;
+    }
+
+    /* First stop > 0 -- insert a duplicate at 0 */
+    if (stops[0].offset > 0)
+    {
+	memmove(stops + 1, stops, count * sizeof(svg_gradient_stop_t));
+	stops[0].offset = 0;
+	count ++;
+    }
+
+    /* Last stop < 1 -- insert a duplicate at 1 */
+    if (stops[count - 1].offset < 1)
+    {
+	stops[count] = stops[count - 1];
+	stops[count].offset = 1;
+	count ++;
+    }
+
+    grad->stops = stops;
+    grad->stop_count = count;
+    return 0;
+}
+
+static void
+svg_free_gradient(svg_context_t *ctx, void *value)
+{
+    svg_gradient_t *grad = value;
+
+    if (grad->shading)
+	gs_free_object(ctx->memory, grad->shading, "svg_free_gradient");
+    if (grad->periodic_func)
+	svg_free_gradient_function(ctx, grad->periodic_func, 0);
+    if (grad->func)
+	svg_free_gradient_function(ctx, grad->func, 1);
+    if (grad->stops)
+	svg_free(ctx, grad->stops);
+    svg_free(ctx, grad->id);
+    svg_free(ctx, grad);
+}
+
+/*
+ * Parse a <linearGradient> or <radialGradient> element and add it to
+ * the gradient table. Attributes and stops that are not given are
+ * inherited from a gradient referenced with xlink:href, which must
+ * have been seen already.
+ */
+int
+svg_parse_gradient(svg_context_t *ctx, svg_item_t *node)
+{
+    char *id_att = svg_att_atom(node, SVG_ATT_ID);
+    char *href_att = svg_att_atom(node, SVG_ATT_XLINK_HREF);
+    char *units_att = svg_att_atom(node, SVG_ATT_GRADIENT_UNITS);
+    char *transform_att = svg_att_atom(node, SVG_ATT_GRADIENT_TRANSFORM);
+    char *spread_att = svg_att_atom(node, SVG_ATT_SPREAD_METHOD);
+    char *x1_att = svg_att_atom(node, SVG_ATT_X1);
+    char *y1_att = svg_att_atom(node, SVG_ATT_Y1);
+    char *x2_att = svg_att_atom(node, SVG_ATT_X2);
+    char *y2_att = svg_att_atom(node, SVG_ATT_Y2);
+    char *cx_att = svg_att_atom(node, SVG_ATT_CX);
+    char *cy_att = svg_att_atom(node, SVG_ATT_CY);
+    char *r_att = svg_att_atom(node, SVG_ATT_R);
+    char *fx_att = svg_att_atom(node, SVG_ATT_FX);
+    char *fy_att = svg_att_atom(node, SVG_ATT_FY);
+
+    svg_gradient_t *grad;
+    svg_gradient_t *base = NULL;
+    float *c;
+    float w, h;
+    int code;
+
+    /* gradients without an id cannot be referenced */
+    if (!id_att)
+	return 0;
+
+    if (!ctx->gradients)
+    {
+	ctx->gradients = svg_hash_new(ctx);
+	if (!ctx->gradients)
+	    return gs_rethrow(-1, "cannot create gradient table");
+    }
+
+    /* the first element with a given id wins */
+    if (svg_hash_lookup(ctx->gradients, id_att))
+	return 0;
+
+    grad = svg_alloc(ctx, sizeof(svg_gradient_t));
+    if (!grad)
+	return gs_throw(-1, "out of memory: gradient");
+    memset(grad, 0, sizeof(svg_gradient_t));
+
+    grad->id = svg_strdup(ctx, id_att);
+    if (!grad->id)
+    {
+	svg_free(ctx, grad);
+	return gs_throw(-1, "out of memory: gradient id");
+    }
+
+    grad->is_radial = svg_tag_atom(node) == SVG_TAG_RADIAL_GRADIENT;
+    grad->spread = SVG_SPREAD_PAD;
+    grad->user_space = 0;
+    gs_make_identity(&grad->transform);
+
+    if (grad->is_radial)
+    {
+	grad->coords[0] = grad->coords[3] = 0.5;
+	grad->coords[1] = grad->coords[4] = 0.5;
+	grad->coords[2] = 0;
+	grad->coords[5] = 0.5;
+    }
+    else
+    {
+	grad->coords[0] = 0;
+	grad->coords[1] = 0;
+	grad->coords[2] = 1;
+	grad->coords[3] = 0;
+    }
+
+    if (href_att && href_att[0] == '#')
+    {
+	base = svg_hash_lookup(ctx->gradients, href_att + 1);
+	if (!base)
+	    gs_warn1("cannot resolve gradient reference '%s'", href_att);
+    }
+
+    if (base)
+    {
+	grad->spread = base->spread;
+	grad->user_space = base->user_space;
+	grad->transform = base->transform;
+	if (base->is_radial == grad->is_radial)
+	    memcpy(grad->coords, base->coords, sizeof grad->coords);
+    }
+
+    if (units_att)
+	grad->user_space = !strcmp(units_att, "userSpaceOnUse");
+
+    if (spread_att)
+    {
+	if (!strcmp(spread_att, "pad"))
+	    grad->spread = SVG_SPREAD_PAD;
+	if (!strcmp(spread_att, "reflect"))
+	    grad->spread = SVG_SPREAD_REFLECT;
+	if (!strcmp(spread_att, "repeat"))
+	    grad->spread = SVG_SPREAD_REPEAT;
+    }
+
+    if (transform_att)
+    {
+	gs_matrix identity;
+
+	/* the transform parser works on the gstate */
+	gs_gsave(ctx->pgs);
+	gs_make_identity(&identity);
+	gs_setmatrix(ctx->pgs, &identity);
+	code = svg_parse_transform(ctx, transform_att);
+	gs_currentmatrix(ctx->pgs, &grad->transform);
+	gs_grestore(ctx->pgs);
+	if (code < 0)
+	{
+	    svg_free_gradient(ctx, grad);
+	    return gs_rethrow(code, "cannot parse gradientTransform attribute");
+	}
+    }
+
+    w = ctx->viewbox_width;
+    h = ctx->viewbox_height;
+    c = grad->coords;
+
+    if (grad->is_radial)
+    {
+	float d;
+
+	if (cx_att) c[3] = svg_parse_gradient_length(grad, cx_att, w);
+	if (cy_att) c[4] = svg_parse_gradient_length(grad, cy_att, h);
+	if (r_att) c[5] = svg_parse_gradient_length(grad, r_att, ctx->viewbox_size);
+
+	/* the focus defaults to the center */
+	if (!base || cx_att || cy_att)
+	{
+	    c[0] = c[3];
+	    c[1] = c[4];
+	}
+	if (fx_att) c[0] = svg_parse_gradient_length(grad, fx_att, w);
+	if (fy_att) c[1] = svg_parse_gradient_length(grad, fy_att, h);
+
+	/* a focus on or outside the circle is moved just inside it */
+	d = hypot(c[0] - c[3], c[1] - c[4]);
+	if (d > c[5] * 0.99)
+	{
+	    float s = d > 0 ? c[5] * 0.99 / d : 0;
+	    c[0] = c[3] + (c[0] - c[3]) * s;
+	    c[1] = c[4] + (c[1] - c[4]) * s;
+	}
+
+	grad->is_degenerate = c[5] <= 0;
+    }
+    else
+    {
+	if (x1_att) c[0] = svg_parse_gradient_length(grad, x1_att, w);
+	if (y1_att) c[1] = svg_parse_gradient_length(grad, y1_att, h);
+	if (x2_att) c[2] = svg_parse_gradient_length(grad, x2_att, w);
+	if (y2_att) c[3] = svg_parse_gradient_length(grad, y2_att, h);
+
+	grad->is_degenerate = c[0] == c[2] && c[1] == c[3];
+    }
+
+    code = svg_parse_gradient_stops(ctx, node, grad);
+    if (code >= 0 && !grad->stops && base && base->stops)
+    {
+	grad->stops = svg_alloc(ctx, base->stop_count * sizeof(svg_gradient_stop_t));
+	if (!grad->stops)
+	    code = gs_throw(-1, "out of memory: gradient stops");
+	else
+	{
+	    memcpy(grad->stops, base->stops, base->stop_count * sizeof(svg_gradient_stop_t));
+	    grad->stop_count = base->stop_count;
+	}
+    }
+
+    if (code >= 0 && grad->stop_count > 0)
+    {
+	/* a single stop paints a solid color */
+	if (grad->stop_count == 2 && !memcmp(grad->stops[0].color,
+		    grad->stops[1].color, sizeof grad->stops[0].color))
+	    grad->is_degenerate = 1;
+
+	if (!grad->is_degenerate)
+	{
+	    grad->func = svg_create_gradient_function(ctx, grad->stops, grad->stop_count);
+	    if (!grad->func)
+		code = gs_rethrow(-1, "cannot create gradient function");
+	}
+    }
+
+    if (code >= 0)
+	code = svg_hash_insert(ctx, ctx->gradients, grad->id, grad);
+    if (code < 0)
+    {
+	svg_free_gradient(ctx, grad);
+	return gs_rethrow1(code, "cannot parse gradient '%s'", id_att);
+    }
+
+    return 0;
+}
+
+/*
+ * Resolve a paint server reference: url(#id), with an optional
+ * fallback color. Returns 1 and sets *grad if it names a gradient,
+ * 0 if the fallback should be used instead.
+ */
+int
+svg_lookup_gradient(svg_context_t *ctx, const char *str, svg_gradient_t **gradp)
+{
+    const char *end;
+    char id[128];
+    svg_gradient_t *grad = NULL;
+
+    *gradp = NULL;
+
+    str += 4; /* url( */
+    while (svg_is_whitespace(*str))
+	str ++;
+    end = strchr(str, ')');
+    if (*str != '#' || !end)
+	return 0;
+    str ++;
+    while (end > str && svg_is_whitespace(end[-1]))
+	end --;
+    if (end - str >= sizeof id)
+	return 0;
+
+    memcpy(id, str, end - str);
+    id[end - str] = 0;
+
+    if (ctx->gradients)
+	grad = svg_hash_lookup(ctx->gradients, id);
+    if (!grad)
+    {
+	gs_warn1("cannot resolve paint server 'url(#%s)'", id);
+	return 0;
+    }
+
+    /* no stops means no paint */
+    if (!grad->stops)
+	return 0;
+
+    *gradp = grad;
+    return 1;
+}
+
+void
+svg_free_gradients(svg_context_t *ctx)
+{
+    if (gs_debug_c('|') && ctx->gradient_fills)
+	dprintf2("svg: %d gradient fills, %d shadings built\n",
+		ctx->gradient_fills, ctx->gradient_shadings);
+
+    if (ctx->gradients)
+	svg_hash_free(ctx, ctx->gradients, NULL, svg_free_gradient);
+
+    ctx->gradients = NULL;
+    ctx->gradient_fills = 0;
+    ctx->gradient_shadings = 0;
+}
@@ -0,0 +1,192 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* Linear probe hash table.
+ *
+ * Simple hashtable with open adressing linear probe.
+ * Keys are case sensitive, as element ids are in SVG.
+ * Does not manage memory of key/value pointers.
+ * Does not support deleting entries.
+ */
+
+#include "ghostsvg.h"
+
+static const unsigned primes[] =
+{
+    61, 127, 251, 509, 1021, 2039, 4093, 8191, 16381, 32749, 65521,
+    131071, 262139, 524287, 1048573, 2097143, 4194301, 8388593, 0
+};
+
+typedef struct svg_hash_entry_s svg_hash_entry_t;
+
+struct svg_hash_entry_s
+{
+    char *key;
+    void *value;
+};
+
+struct svg_hash_table_s
+{
+    unsigned int size;
+    unsigned int load;
+    svg_hash_entry_t *entries;
+};
+
+static unsigned int
+svg_hash(const char *s)
+{
+    unsigned int h = 0;
+    while (*s)
+	h = *s++ + (h << 6) + (h << 16) - h;
+    return h;
+}
+
+svg_hash_table_t *
+svg_hash_new(svg_context_t *ctx)
+{
+    svg_hash_table_t *table;
+
+    table = svg_alloc(ctx, sizeof(svg_hash_table_t));
+    if (!table)
+    {
+	gs_throw(-1, "out of memory: hash table struct");
+	return NULL;
+    }
+
+    table->size = primes[0];
+    table->load = 0;
+
+    table->entries = svg_alloc(ctx, sizeof(svg_hash_entry_t) * table->size);
+    if (!table->entries)
+    {
+	svg_free(ctx, table);
+	gs_throw(-1, "out of memory: hash table entries array");
+	return NULL;
+    }
+
+    memset(table->entries, 0, sizeof(svg_hash_entry_t) * table->size);
+
+    return table;
+}
+
+static int
+svg_hash_double(svg_context_t *ctx, svg_hash_table_t *table)
+{
+    svg_hash_entry_t *old_entries;
+    svg_hash_entry_t *new_entries;
+    unsigned int old_size = table->size;
+    unsigned int new_size = table->size * 2;
+    int i;
+
+    for (i = 0; primes[i] != 0; i++)
+    {
+	if (primes[i] > old_size)
+	{
+	    new_size = primes[i];
+	    break;
+	}
+    }
+
+    old_entries = table->entries;
+    new_entries = svg_alloc(ctx, sizeof(svg_hash_entry_t) * new_size);
+    if (!new_entries)
+	return gs_throw(-1, "out of memory: hash table entries array");
+
+    table->size = new_size;
+    table->entries = new_entries;
+    table->load = 0;
+
+    memset(table->entries, 0, sizeof(svg_hash_entry_t) * table->size);
+
+    for (i = 0; i < old_size; i++)
+	if (old_entries[i].value)
+	    svg_hash_insert(ctx, table, old_entries[i].key, old_entries[i].value);
+
+    svg_free(ctx, old_entries);
+
+    return 0;
+}
+
+void
+svg_hash_free(svg_context_t *ctx, svg_hash_table_t *table,
+    void (*free_key)(svg_context_t *ctx, void *),
+    void (*free_value)(svg_context_t *ctx, void *))
+{
+    int i;
+
+    for (i = 0; i < table->size; i++)
+    {
+	if (table->entries[i].key && free_key)
+	    free_key(ctx, table->entries[i].key);
+	if (table->entries[i].value && free_value)
+	    free_value(ctx, table->entries[i].value);
+    }
+
+    svg_free(ctx, table->entries);
+    svg_free(ctx, table);
+}
+
+void *
+svg_hash_lookup(svg_hash_table_t *table, const char *key)
+{
+    svg_hash_entry_t *entries = table->entries;
+    unsigned int size = table->size;
+    unsigned int pos = svg_hash(key) % size;
+
+    while (1)
+    {
+	if (!entries[pos].value)
+	    return NULL;
+
+	if (strcmp(key, entries[pos].key) == 0)
+	    return entries[pos].value;
+
+	pos = (pos + 1) % size;
+    }
+}
+
+int
+svg_hash_insert(svg_context_t *ctx, svg_hash_table_t *table, char *key, void *value)
+{
+    svg_hash_entry_t *entries;
+    unsigned int size, pos;
+
+    /* Grow the table at 80% load */
+    if (table->load > table->size * 8 / 10)
+    {
+	if (svg_hash_double(ctx, table) < 0)
+	    return gs_rethrow(-1, "cannot grow hash table");
+    }
+
+    entries = table->entries;
+    size = table->size;
+    pos = svg_hash(key) % size;
+
+    while (1)
+    {
+	if (!entries[pos].value)
+	{
+	    entries[pos].key = key;
+	    entries[pos].value = value;
+	    table->load ++;
+	    return 0;
+	}
+
+	if (strcmp(key, entries[pos].key) == 0)
+	{
+	    return 0;
+	}
+
+	pos = (pos + 1) % size;
+    }
+}
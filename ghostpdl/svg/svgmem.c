@@ -0,0 +1,89 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - memory and string functions */
+
+#include "ghostsvg.h"
+
+void *
+svg_realloc_imp(svg_context_t *ctx, void *ptr, int size, const char *func)
+{
+    if (!ptr)
+	return gs_alloc_bytes(ctx->memory, size, func);
+    return gs_resize_object(ctx->memory, ptr, size, func);
+}
+
+char *
+svg_strdup_imp(svg_context_t *ctx, const char *str, const char *cname)
+{
+    char *cpy = NULL;
+    if (str)
+	cpy = (char*) gs_alloc_bytes(ctx->memory, strlen(str) + 1, cname);
+    if (cpy)
+	strcpy(cpy, str);
+    return cpy;
+}
+
+size_t
+svg_strlcpy(char *dst, const char *src, size_t siz)
+{
+    register char *d = dst;
+    register const char *s = src;
+    register int n = siz;
+
+    /* Copy as many bytes as will fit */
+    if (n != 0 && --n != 0) {
+	do {
+	    if ((*d++ = *s++) == 0)
+		break;
+	} while (--n != 0);
+    }
+
+    /* Not enough room in dst, add NUL and traverse rest of src */
+    if (n == 0) {
+	if (siz != 0)
+	    *d = '\0';		/* NUL-terminate dst */
+	while (*s++)
+	    ;
+    }
+
+    return(s - src - 1);	/* count does not include NUL */
+}
+
+size_t
+svg_strlcat(char *dst, const char *src, size_t siz)
+{
+    register char *d = dst;
+    register const char *s = src;
+    register int n = siz;
+    int dlen;
+
+    /* Find the end of dst and adjust bytes left but don't go past end */
+    while (*d != '\0' && n-- != 0)
+	d++;
+    dlen = d - dst;
+    n = siz - dlen;
+
+    if (n == 0)
+	return dlen + strlen(s);
+    while (*s != '\0') {
+	if (n != 1) {
+	    *d++ = *s;
+	    n--;
+	}
+	s++;
+    }
+    *d = '\0';
+
+    return dlen + (s - src);	/* count does not include NUL */
+}
@@ -0,0 +1,246 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - opacity and transparency groups */
+
+#include "ghostsvg.h"
+#include "gzcpath.h"
+
+/*
+ * The pdf14 compositor is costly, so it is only pushed for documents
+ * where the tree scan finds some opacity below 1. In streaming mode
+ * the tree is not available up front, so the compositor is always
+ * pushed. -dSVGTransparency=true or false overrides both choices.
+ *
+ * fill-opacity and stroke-opacity are the constant alpha of each
+ * paint. So is the opacity of an element that only fills or only
+ * strokes, since nothing in it can overlap. Any other translucent
+ * element is drawn in a transparency group. If the element can be
+ * recorded as a display list, the group is bounded by what it paints.
+ * Text and nested opacity cannot be recorded this way, so those groups
+ * are bounded by the clip.
+ */
+
+int
+svg_bounds_in_user_space(svg_context_t *ctx, gs_rect *ubox)
+{
+    gx_clip_path *clip_path;
+    gs_rect dbox;
+    int code;
+
+    code = gx_effective_clip_path(ctx->pgs, &clip_path);
+    if (code < 0)
+	return gs_rethrow(code, "gx_effective_clip_path failed");
+
+    dbox.p.x = fixed2float(clip_path->outer_box.p.x);
+    dbox.p.y = fixed2float(clip_path->outer_box.p.y);
+    dbox.q.x = fixed2float(clip_path->outer_box.q.x);
+    dbox.q.y = fixed2float(clip_path->outer_box.q.y);
+    code = gs_bbox_transform_inverse(&dbox, &ctm_only(ctx->pgs), ubox);
+    if (code < 0)
+	return gs_rethrow(code, "cannot transform the clip bounds");
+
+    return 0;
+}
+
+static int
+svg_is_translucent_value(const char *str)
+{
+    return str && strcmp(str, "inherit") && atof(str) < 1;
+}
+
+static int
+svg_is_translucent(svg_item_t *node)
+{
+    return svg_is_translucent_value(svg_att_atom(node, SVG_ATT_OPACITY)) ||
+	svg_is_translucent_value(svg_att_atom(node, SVG_ATT_FILL_OPACITY)) ||
+	svg_is_translucent_value(svg_att_atom(node, SVG_ATT_STROKE_OPACITY));
+}
+
+int
+svg_needs_transparency(svg_item_t *root)
+{
+    svg_item_t *node;
+
+    if (svg_is_translucent(root))
+	return 1;
+    for (node = svg_down(root); node; node = svg_next(node))
+	if (svg_needs_transparency(node))
+	    return 1;
+    return 0;
+}
+
+/*
+ * Check whether the contents of an element can be recorded and still
+ * be drawn correctly in a single group.
+ */
+static int
+svg_can_record_contents(svg_item_t *root)
+{
+    svg_item_t *node;
+
+    for (node = svg_down(root); node; node = svg_next(node))
+    {
+	if (svg_tag_atom(node) == SVG_TAG_TEXT)
+	    return 0;
+	if (svg_is_translucent_value(svg_att_atom(node, SVG_ATT_OPACITY)))
+	    return 0;
+	if (!svg_can_record_contents(node))
+	    return 0;
+    }
+    return 1;
+}
+
+/*
+ * The opacity of an element that is drawn, or 1 if it can be ignored.
+ */
+float
+svg_element_opacity(svg_context_t *ctx, svg_item_t *node)
+{
+    char *opacity_att;
+
+    if (!ctx->use_transparency)
+	return 1;
+
+    switch (svg_tag_atom(node))
+    {
+    case SVG_TAG_DEFS:
+    case SVG_TAG_SYMBOL:
+    case SVG_TAG_LINEAR_GRADIENT:
+    case SVG_TAG_RADIAL_GRADIENT:
+	return 1;
+    }
+
+    opacity_att = svg_att_atom(node, SVG_ATT_OPACITY);
+    if (!svg_is_translucent_value(opacity_att))
+	return 1;
+
+    return MAX(0, atof(opacity_att));
+}
+
+int
+svg_begin_opacity(svg_context_t *ctx, float opacity, const gs_rect *bbox)
+{
+    gs_transparency_group_params_t tgp;
+    gs_rect clip;
+    int code;
+
+    if (!bbox)
+    {
+	code = svg_bounds_in_user_space(ctx, &clip);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot find the group bounds");
+	bbox = &clip;
+    }
+
+    /* the group is composited with the alpha, its contents are not */
+    gs_setopacityalpha(ctx->pgs, opacity);
+    gs_trans_group_params_init(&tgp);
+    code = gs_begin_transparency_group(ctx->pgs, &tgp, bbox);
+    gs_setopacityalpha(ctx->pgs, 1.0);
+    if (code < 0)
+	return gs_rethrow(code, "cannot begin transparency group");
+
+    ctx->opacity_groups ++;
+    return 0;
+}
+
+void
+svg_end_opacity(svg_context_t *ctx)
+{
+    gs_end_transparency_group(ctx->pgs);
+}
+
+static int
+svg_is_single_paint(svg_context_t *ctx, svg_display_list_t *list)
+{
+    const svg_display_op_t *op;
+    int fill, stroke;
+
+    if (list->op_count != 1)
+	return 0;
+
+    op = &list->ops[0];
+    fill = (op->paint & SVG_PAINT_FILL) &&
+	(op->fill_is_set == SVG_INHERIT ? ctx->fill_is_set : op->fill_is_set);
+    stroke = (op->paint & SVG_PAINT_STROKE) &&
+	(op->stroke_is_set == SVG_INHERIT ? ctx->stroke_is_set : op->stroke_is_set);
+
+    return !(fill && stroke);
+}
+
+int
+svg_parse_translucent_element(svg_context_t *ctx, svg_item_t *node, float opacity)
+{
+    svg_display_list_t list;
+    float saved_opacity;
+    gs_rect bbox;
+    int code;
+
+    /* already inside a recording, which cannot hold groups */
+    if (ctx->record)
+    {
+	saved_opacity = ctx->opacity;
+	ctx->opacity *= opacity;
+	code = svg_draw_element(ctx, node);
+	ctx->opacity = saved_opacity;
+	if (code < 0)
+	    return gs_rethrow(code, "cannot draw translucent element");
+	return 0;
+    }
+
+    if (!svg_can_record_contents(node) || svg_tag_atom(node) == SVG_TAG_TEXT)
+    {
+	code = svg_begin_opacity(ctx, opacity, NULL);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot draw translucent element");
+	code = svg_draw_element(ctx, node);
+	svg_end_opacity(ctx);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot draw translucent element");
+	return 0;
+    }
+
+    memset(&list, 0, sizeof list);
+
+    code = svg_record_element(ctx, node, &list, 0, 1);
+    if (code < 0)
+    {
+	svg_free_display_list(ctx, &list);
+	return gs_rethrow(code, "cannot record translucent element");
+    }
+
+    if (svg_is_single_paint(ctx, &list))
+    {
+	saved_opacity = ctx->opacity;
+	ctx->opacity *= opacity;
+	code = svg_replay_list(ctx, &list);
+	ctx->opacity = saved_opacity;
+    }
+    else if (svg_display_list_bbox(&list, &bbox))
+    {
+	code = svg_begin_opacity(ctx, opacity, &bbox);
+	if (code >= 0)
+	{
+	    code = svg_replay_list(ctx, &list);
+	    svg_end_opacity(ctx);
+	}
+    }
+
+    svg_free_display_list(ctx, &list);
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot draw translucent element");
+
+    return 0;
+}
@@ -17,6 +17,14 @@
 
 static void svg_fill(svg_context_t *ctx)
 {
+    if (ctx->fill_gradient)
+    {
+	svg_set_alpha(ctx, ctx->fill_opacity);
+	if (svg_paint_gradient(ctx, ctx->fill_gradient, 0) < 0)
+	    gs_catch(-1, "cannot fill with gradient");
+	return;
+    }
+
     svg_set_fill_color(ctx);
     if (ctx->fill_rule == 0)
 	gs_eofill(ctx->pgs);
@@ -26,19 +34,231 @@ static void svg_fill(svg_context_t *ctx)
 
 static void svg_stroke(svg_context_t *ctx)
 {
+    if (ctx->stroke_gradient)
+    {
+	svg_set_alpha(ctx, ctx->stroke_opacity);
+	if (svg_paint_gradient(ctx, ctx->stroke_gradient, 1) < 0)
+	    gs_catch(-1, "cannot stroke with gradient");
+	return;
+    }
+
     svg_set_stroke_color(ctx);
     gs_stroke(ctx->pgs);
 }
 
+/*
+ * Fill and/or stroke the current path, or record the paint operation
+ * when compiling a definition.
+ */
+int
+svg_paint_path(svg_context_t *ctx, int fill, int stroke)
+{
+    if (ctx->record)
+	return svg_record_paint(ctx,
+		(fill ? SVG_PAINT_FILL : 0) | (stroke ? SVG_PAINT_STROKE : 0));
+
+    if (fill && stroke)
+    {
+	gs_gsave(ctx->pgs);
+	svg_fill(ctx);
+	gs_grestore(ctx->pgs);
+	svg_stroke(ctx);
+    }
+    else if (fill)
+	svg_fill(ctx);
+    else if (stroke)
+	svg_stroke(ctx);
+
+    return 0;
+}
+
+static void svg_fill_stroke(svg_context_t *ctx)
+{
+    svg_paint_path(ctx, ctx->fill_is_set, ctx->stroke_is_set);
+}
+
+/*
+ * Path builder.
+ */
+
+void
+svg_begin_path(svg_context_t *ctx, svg_path_builder_t *pb)
+{
+    pb->ctx = ctx;
+    pb->pgs = ctx->pgs;
+    pb->ppath = ctx->pgs->path;
+    pb->rec = ctx->record;
+    gs_currentmatrix(ctx->pgs, &pb->ctm);
+    pb->cx = pb->cy = 0;
+    pb->sx = pb->sy = 0;
+    pb->started = 0;
+
+    if (pb->rec)
+    {
+	pb->rec->path_ctm = pb->ctm;
+	pb->rec->path_cmd_first = pb->rec->cmd_count;
+	pb->rec->path_coord_first = pb->rec->coord_count;
+    }
+}
+
+int
+svg_end_path(svg_path_builder_t *pb)
+{
+    /* let the graphics state know where we ended up */
+    if (pb->started && !pb->rec)
+	return gx_setcurrentpoint_from_path((gs_imager_state *)pb->pgs, pb->ppath);
+    return 0;
+}
+
+static inline int
+svg_path_transform(svg_path_builder_t *pb, float x, float y, gs_fixed_point *pt)
+{
+    const gs_matrix *m = &pb->ctm;
+    double dx = x * m->xx + y * m->yx + m->tx;
+    double dy = x * m->xy + y * m->yy + m->ty;
+
+    if (!f_fits_in_bits(dx, fixed_int_bits) || !f_fits_in_bits(dy, fixed_int_bits))
+    {
+	if (!pb->pgs->clamp_coordinates)
+	    return_error(gs_error_limitcheck);
+	pt->x = clamp_coord(dx);
+	pt->y = clamp_coord(dy);
+	return 0;
+    }
+
+    pt->x = float2fixed_rounded(dx);
+    pt->y = float2fixed_rounded(dy);
+    return 0;
+}
+
+int
+svg_path_moveto(svg_path_builder_t *pb, float x, float y)
+{
+    gs_fixed_point pt;
+    int code;
+
+    if (pb->rec)
+    {
+	float c[2] = { x, y };
+	code = svg_record_segment(pb->ctx, pb->rec, 'M', c, 2);
+	if (code < 0)
+	    return code;
+    }
+    else
+    {
+	code = svg_path_transform(pb, x, y, &pt);
+	if (code < 0)
+	    return code;
+	code = gx_path_add_point(pb->ppath, pt.x, pt.y);
+	if (code < 0)
+	    return code;
+	pb->ppath->start_flags = pb->ppath->state_flags;
+    }
+
+    pb->cx = pb->sx = x;
+    pb->cy = pb->sy = y;
+    pb->started = 1;
+    return 0;
+}
+
+int
+svg_path_lineto(svg_path_builder_t *pb, float x, float y)
+{
+    gs_fixed_point pt;
+    int code;
+
+    if (!pb->started)
+    {
+	code = svg_path_moveto(pb, pb->cx, pb->cy);
+	if (code < 0)
+	    return code;
+    }
+
+    if (pb->rec)
+    {
+	float c[2] = { x, y };
+	code = svg_record_segment(pb->ctx, pb->rec, 'L', c, 2);
+    }
+    else
+    {
+	code = svg_path_transform(pb, x, y, &pt);
+	if (code >= 0)
+	    code = gx_path_add_line(pb->ppath, pt.x, pt.y);
+    }
+    if (code < 0)
+	return code;
+
+    pb->cx = x;
+    pb->cy = y;
+    return 0;
+}
+
+int
+svg_path_curveto(svg_path_builder_t *pb,
+	float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    gs_fixed_point p1, p2, p3;
+    int code;
+
+    if (!pb->started)
+    {
+	code = svg_path_moveto(pb, pb->cx, pb->cy);
+	if (code < 0)
+	    return code;
+    }
+
+    if (pb->rec)
+    {
+	float c[6] = { x1, y1, x2, y2, x3, y3 };
+	code = svg_record_segment(pb->ctx, pb->rec, 'C', c, 6);
+    }
+    else
+    {
+	code = svg_path_transform(pb, x1, y1, &p1);
+	if (code >= 0)
+	    code = svg_path_transform(pb, x2, y2, &p2);
+	if (code >= 0)
+	    code = svg_path_transform(pb, x3, y3, &p3);
+	if (code >= 0)
+	    code = gx_path_add_curve(pb->ppath, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y);
+    }
+    if (code < 0)
+	return code;
+
+    pb->cx = x3;
+    pb->cy = y3;
+    return 0;
+}
+
+int
+svg_path_closepath(svg_path_builder_t *pb)
+{
+    int code;
+
+    if (!pb->started)
+	return 0;
+
+    if (pb->rec)
+	code = svg_record_segment(pb->ctx, pb->rec, 'Z', NULL, 0);
+    else
+	code = gx_path_close_subpath(pb->ppath);
+    if (code < 0)
+	return code;
+
+    pb->cx = pb->sx;
+    pb->cy = pb->sy;
+    return 0;
+}
+
 int
 svg_parse_rect(svg_context_t *ctx, svg_item_t *node)
 {
-    char *x_att = svg_att(node, "x");
-    char *y_att = svg_att(node, "y");
-    char *w_att = svg_att(node, "width");
-    char *h_att = svg_att(node, "height");
-    char *rx_att = svg_att(node, "rx");
-    char *ry_att = svg_att(node, "ry");
+    char *x_att = svg_att_atom(node, SVG_ATT_X);
+    char *y_att = svg_att_atom(node, SVG_ATT_Y);
+    char *w_att = svg_att_atom(node, SVG_ATT_WIDTH);
+    char *h_att = svg_att_atom(node, SVG_ATT_HEIGHT);
+    char *rx_att = svg_att_atom(node, SVG_ATT_RX);
+    char *ry_att = svg_att_atom(node, SVG_ATT_RY);
 
     float x = 0;
     float y = 0;
@@ -47,6 +267,7 @@ svg_parse_rect(svg_context_t *ctx, svg_item_t *node)
     float rx = 0;
     float ry = 0;
     int draw_rounded = 1;
+    svg_path_builder_t pb;
 
     svg_parse_common(ctx, node);
 
@@ -71,35 +292,50 @@ svg_parse_rect(svg_context_t *ctx, svg_item_t *node)
 
     /* TODO: we need elliptical arcs to draw rounded corners */
 
-    if (ctx->fill_is_set)
+    if (ctx->fill_is_set || ctx->stroke_is_set)
     {
-	gs_moveto(ctx->pgs, x, y);
-	gs_lineto(ctx->pgs, x + w, y);
-	gs_lineto(ctx->pgs, x + w, y + h);
-	gs_lineto(ctx->pgs, x, y + h);
-	gs_closepath(ctx->pgs);
-	svg_fill(ctx);
-    }
-
-    if (ctx->stroke_is_set)
-    {
-	gs_moveto(ctx->pgs, x, y);
-	gs_lineto(ctx->pgs, x + w, y);
-	gs_lineto(ctx->pgs, x + w, y + h);
-	gs_lineto(ctx->pgs, x, y + h);
-	gs_closepath(ctx->pgs);
-	svg_stroke(ctx);
+	svg_begin_path(ctx, &pb);
+	svg_path_moveto(&pb, x, y);
+	svg_path_lineto(&pb, x + w, y);
+	svg_path_lineto(&pb, x + w, y + h);
+	svg_path_lineto(&pb, x, y + h);
+	svg_path_closepath(&pb);
+	svg_end_path(&pb);
+	svg_fill_stroke(ctx);
     }
 
     return 0;
 }
 
+/*
+ * Circles and ellipses as four cubic bezier quadrants, drawn in the
+ * same direction as the arcs they replace.
+ */
+#define SVG_KAPPA 0.5522847498f
+
+static void
+svg_ellipse_path(svg_context_t *ctx, float cx, float cy, float rx, float ry)
+{
+    float kx = rx * SVG_KAPPA;
+    float ky = ry * SVG_KAPPA;
+    svg_path_builder_t pb;
+
+    svg_begin_path(ctx, &pb);
+    svg_path_moveto(&pb, cx + rx, cy);
+    svg_path_curveto(&pb, cx + rx, cy - ky, cx + kx, cy - ry, cx, cy - ry);
+    svg_path_curveto(&pb, cx - kx, cy - ry, cx - rx, cy - ky, cx - rx, cy);
+    svg_path_curveto(&pb, cx - rx, cy + ky, cx - kx, cy + ry, cx, cy + ry);
+    svg_path_curveto(&pb, cx + kx, cy + ry, cx + rx, cy + ky, cx + rx, cy);
+    svg_path_closepath(&pb);
+    svg_end_path(&pb);
+}
+
 int
 svg_parse_circle(svg_context_t *ctx, svg_item_t *node)
 {
-    char *cx_att = svg_att(node, "cx");
-    char *cy_att = svg_att(node, "cy");
-    char *r_att = svg_att(node, "r");
+    char *cx_att = svg_att_atom(node, SVG_ATT_CX);
+    char *cy_att = svg_att_atom(node, SVG_ATT_CY);
+    char *r_att = svg_att_atom(node, SVG_ATT_R);
 
     float cx = 0;
     float cy = 0;
@@ -114,26 +350,10 @@ svg_parse_circle(svg_context_t *ctx, svg_item_t *node)
     if (r <= 0)
 	return 0;
 
-    if (ctx->fill_is_set)
+    if (ctx->fill_is_set || ctx->stroke_is_set)
     {
-	gs_moveto(ctx->pgs, cx + r, cy);
-	gs_arcn(ctx->pgs, cx, cy, r, 0, 90);
-	gs_arcn(ctx->pgs, cx, cy, r, 90, 180);
-	gs_arcn(ctx->pgs, cx, cy, r, 180, 270);
-	gs_arcn(ctx->pgs, cx, cy, r, 270, 360);
-	gs_closepath(ctx->pgs);
-	svg_fill(ctx);
-    }
-
-    if (ctx->stroke_is_set)
-    {
-	gs_moveto(ctx->pgs, cx + r, cy);
-	gs_arcn(ctx->pgs, cx, cy, r, 0, 90);
-	gs_arcn(ctx->pgs, cx, cy, r, 90, 180);
-	gs_arcn(ctx->pgs, cx, cy, r, 180, 270);
-	gs_arcn(ctx->pgs, cx, cy, r, 270, 360);
-	gs_closepath(ctx->pgs);
-	svg_stroke(ctx);
+	svg_ellipse_path(ctx, cx, cy, r, r);
+	svg_fill_stroke(ctx);
     }
 
     return 0;
@@ -142,10 +362,10 @@ svg_parse_circle(svg_context_t *ctx, svg_item_t *node)
 int
 svg_parse_ellipse(svg_context_t *ctx, svg_item_t *node)
 {
-    char *cx_att = svg_att(node, "cx");
-    char *cy_att = svg_att(node, "cy");
-    char *rx_att = svg_att(node, "rx");
-    char *ry_att = svg_att(node, "ry");
+    char *cx_att = svg_att_atom(node, SVG_ATT_CX);
+    char *cy_att = svg_att_atom(node, SVG_ATT_CY);
+    char *rx_att = svg_att_atom(node, SVG_ATT_RX);
+    char *ry_att = svg_att_atom(node, SVG_ATT_RY);
 
     float cx = 0;
     float cy = 0;
@@ -162,19 +382,11 @@ svg_parse_ellipse(svg_context_t *ctx, svg_item_t *node)
     if (rx <= 0 || ry <= 0)
 	return 0;
 
-    /* TODO: we need elliptic arcs */
-
-#if 0
-    if (ctx->fill_is_set)
+    if (ctx->fill_is_set || ctx->stroke_is_set)
     {
-	svg_fill(ctx);
-    }
-
-    if (ctx->stroke_is_set)
-    {
-	svg_stroke(ctx);
+	svg_ellipse_path(ctx, cx, cy, rx, ry);
+	svg_fill_stroke(ctx);
     }
-#endif
 
     return 0;
 }
@@ -182,15 +394,16 @@ svg_parse_ellipse(svg_context_t *ctx, svg_item_t *node)
 int
 svg_parse_line(svg_context_t *ctx, svg_item_t *node)
 {
-    char *x1_att = svg_att(node, "x1");
-    char *y1_att = svg_att(node, "y1");
-    char *x2_att = svg_att(node, "x2");
-    char *y2_att = svg_att(node, "y2");
+    char *x1_att = svg_att_atom(node, SVG_ATT_X1);
+    char *y1_att = svg_att_atom(node, SVG_ATT_Y1);
+    char *x2_att = svg_att_atom(node, SVG_ATT_X2);
+    char *y2_att = svg_att_atom(node, SVG_ATT_Y2);
 
     float x1 = 0;
     float y1 = 0;
     float x2 = 0;
     float y2 = 0;
+    svg_path_builder_t pb;
 
     svg_parse_common(ctx, node);
 
@@ -201,10 +414,12 @@ svg_parse_line(svg_context_t *ctx, svg_item_t *node)
 
     if (ctx->stroke_is_set)
     {
-	gs_moveto(ctx->pgs, x1, y1);
-	gs_lineto(ctx->pgs, x2, y2);
+	svg_begin_path(ctx, &pb);
+	svg_path_moveto(&pb, x1, y1);
+	svg_path_lineto(&pb, x2, y2);
+	svg_end_path(&pb);
 
-	svg_stroke(ctx);
+	svg_paint_path(ctx, 0, 1);
     }
 
     return 0;
@@ -213,49 +428,58 @@ svg_parse_line(svg_context_t *ctx, svg_item_t *node)
 static int
 svg_parse_polygon_imp(svg_context_t *ctx, svg_item_t *node, int doclose)
 {
-    char *str = svg_att(node, "points");
-    char number[20];
-    int numberlen;
+    const char *str = svg_att_atom(node, SVG_ATT_POINTS);
+    svg_path_builder_t pb;
     float args[2];
     int nargs;
     int isfirst;
+    int code = 0;
 
     if (!str)
 	return 0;
 
+    svg_begin_path(ctx, &pb);
+
     isfirst = 1;
     nargs = 0;
 
-    while (*str)
+    while (1)
     {
 	while (svg_is_whitespace_or_comma(*str))
 	    str ++;
 
-	if (svg_is_digit(*str))
+	if (*str == 0)
+	    break;
+
+	if (!svg_lex_number(&str, &args[nargs++]))
 	{
-	    numberlen = 0;
-	    while (svg_is_digit(*str) && numberlen < sizeof(number) - 1)
-		number[numberlen++] = *str++;
-	    number[numberlen] = 0;
-	    args[nargs++] = atof(number);
+	    code = gs_throw1(-1, "syntax error in points: '%c'", *str);
+	    break;
 	}
 
 	if (nargs == 2)
 	{
 	    if (isfirst)
 	    {
-		gs_moveto(ctx->pgs, args[0], args[1]);
+		code = svg_path_moveto(&pb, args[0], args[1]);
 		isfirst = 0;
 	    }
 	    else
 	    {
-		gs_lineto(ctx->pgs, args[0], args[1]);
+		code = svg_path_lineto(&pb, args[0], args[1]);
 	    }
+	    if (code < 0)
+		break;
 	    nargs = 0;
 	}
     }
 
-    return 0;
+    if (doclose)
+	svg_path_closepath(&pb);
+
+    svg_end_path(&pb);
+
+    return code;
 }
 
 int
@@ -266,7 +490,7 @@ svg_parse_polyline(svg_context_t *ctx, svg_item_t *node)
     if (ctx->stroke_is_set)
     {
 	svg_parse_polygon_imp(ctx, node, 0);
-	svg_stroke(ctx);
+	svg_paint_path(ctx, 0, 1);
     }
 
     return 0;
@@ -277,329 +501,257 @@ svg_parse_polygon(svg_context_t *ctx, svg_item_t *node)
 {
     svg_parse_common(ctx, node);
 
-    if (ctx->fill_is_set)
+    if (ctx->fill_is_set || ctx->stroke_is_set)
     {
 	svg_parse_polygon_imp(ctx, node, 1);
-	svg_fill(ctx);
+	svg_fill_stroke(ctx);
     }
 
-    if (ctx->stroke_is_set)
+    return 0;
+}
+
+/* Number of arguments for each path command, or -1 if unsupported */
+static int
+svg_path_arg_count(int cmd)
+{
+    switch (cmd)
     {
-	svg_parse_polygon_imp(ctx, node, 1);
-	svg_stroke(ctx);
+    case 'M': case 'm': return 2;
+    case 'L': case 'l': return 2;
+    case 'H': case 'h': return 1;
+    case 'V': case 'v': return 1;
+    case 'C': case 'c': return 6;
+    case 'S': case 's': return 4;
+    case 'Q': case 'q': return 4;
+    case 'T': case 't': return 2;
+    case 'Z': case 'z': return 0;
     }
-
-    return 0;
+    return -1;
 }
 
+/*
+ * Tokenize the path data in place and feed the segments to a path
+ * builder. Quadratic curves are converted to cubics.
+ */
 static int
-svg_parse_path_data(svg_context_t *ctx, char *str)
+svg_parse_path_data(svg_context_t *ctx, const char *str)
 {
-    gs_point pt;
-    float x1, y1, x2, y2;
+    svg_path_builder_t pb;
+    float x0, y0, x1, y1, x2, y2;
 
     int cmd;
-    int numberlen;
-    char number[20];
+    int need;
     float args[6];
     int nargs;
+    int code;
+
+    /* control point of the previous curve, for smooth curves */
+    int last_curve = 0; /* 'C' or 'Q' */
+    float last_x = 0.0;
+    float last_y = 0.0;
 
-    /* saved control point for smooth curves */
-    int reset_smooth = 1;
-    float smooth_x = 0.0;
-    float smooth_y = 0.0;
+    svg_begin_path(ctx, &pb);
 
     cmd = 0;
+    need = 0;
     nargs = 0;
+    code = 0;
 
-    gs_moveto(ctx->pgs, 0.0, 0.0); /* for the case of opening 'm' */
-
-    while (*str)
+    while (1)
     {
 	while (svg_is_whitespace_or_comma(*str))
 	    str ++;
 
-	if (svg_is_digit(*str))
-	{
-	    numberlen = 0;
-	    while (svg_is_digit(*str) && numberlen < sizeof(number) - 1)
-		number[numberlen++] = *str++;
-	    number[numberlen] = 0;
-	    if (nargs == 6)
-		return gs_throw(-1, "stack overflow in path data");
-	    args[nargs++] = atof(number);
-	}
-	else if (svg_is_alpha(*str))
+	if (*str == 0)
+	    break;
+
+	if (svg_is_alpha(*str))
 	{
+	    if (nargs != 0)
+	    {
+		code = gs_throw1(-1, "missing arguments for path command: '%c'", cmd);
+		break;
+	    }
+
 	    cmd = *str++;
+	    need = svg_path_arg_count(cmd);
+	    if (need < 0)
+	    {
+		code = gs_throw1(-1, "unrecognized command in path data: '%c'", cmd);
+		break;
+	    }
+
+	    if (need == 0)
+	    {
+		code = svg_path_closepath(&pb);
+		if (code < 0)
+		    break;
+		last_curve = 0;
+	    }
+
+	    continue;
 	}
-	else if (*str == 0)
-	{
-	    return 0;
-	}
-	else
+
+	if (cmd == 0)
 	{
-	    return gs_throw1(-1, "syntax error in path data: '%c'", *str);
+	    code = gs_throw(-1, "path data must begin with a command");
+	    break;
 	}
 
-	if (reset_smooth)
+	if (need == 0 || !svg_lex_number(&str, &args[nargs]))
 	{
-	    smooth_x = 0.0;
-	    smooth_y = 0.0;
+	    code = gs_throw1(-1, "syntax error in path data: '%c'", *str);
+	    break;
 	}
 
-	reset_smooth = 1;
+	if (++nargs < need)
+	    continue;
+
+	nargs = 0;
+
+	x0 = pb.cx;
+	y0 = pb.cy;
 
 	switch (cmd)
 	{
 	case 'M':
-	    if (nargs == 2)
-	    {
-		// dprintf2("moveto %g %g\n", args[0], args[1]);
-		gs_moveto(ctx->pgs, args[0], args[1]);
-		nargs = 0;
-		cmd = 'L'; /* implicit lineto after */
-	    }
+	    code = svg_path_moveto(&pb, args[0], args[1]);
+	    cmd = 'L'; /* implicit lineto after */
+	    last_curve = 0;
 	    break;
 
 	case 'm':
-	    if (nargs == 2)
-	    {
-		// dprintf2("rmoveto %g %g\n", args[0], args[1]);
-		gs_rmoveto(ctx->pgs, args[0], args[1]);
-		nargs = 0;
-		cmd = 'l'; /* implicit lineto after */
-	    }
-	    break;
-
-
-	case 'Z':
-	case 'z':
-	    if (nargs == 0)
-	    {
-		// dprintf("closepath\n");
-		gs_closepath(ctx->pgs);
-	    }
+	    code = svg_path_moveto(&pb, x0 + args[0], y0 + args[1]);
+	    cmd = 'l'; /* implicit lineto after */
+	    last_curve = 0;
 	    break;
 
 	case 'L':
-	    if (nargs == 2)
-	    {
-		// dprintf2("lineto %g %g\n", args[0], args[1]);
-		gs_lineto(ctx->pgs, args[0], args[1]);
-		nargs = 0;
-	    }
+	    code = svg_path_lineto(&pb, args[0], args[1]);
+	    last_curve = 0;
 	    break;
 
 	case 'l':
-	    if (nargs == 2)
-	    {
-		// dprintf2("rlineto %g %g\n", args[0], args[1]);
-		gs_rlineto(ctx->pgs, args[0], args[1]);
-		nargs = 0;
-	    }
+	    code = svg_path_lineto(&pb, x0 + args[0], y0 + args[1]);
+	    last_curve = 0;
 	    break;
 
 	case 'H':
-	    if (nargs == 1)
-	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		// dprintf1("hlineto %g\n", args[0]);
-		gs_lineto(ctx->pgs, args[0], pt.y);
-		nargs = 0;
-	    }
+	    code = svg_path_lineto(&pb, args[0], y0);
+	    last_curve = 0;
 	    break;
 
 	case 'h':
-	    if (nargs == 1)
-	    {
-		// dprintf1("rhlineto %g\n", args[0]);
-		gs_rlineto(ctx->pgs, args[0], 0.0);
-		nargs = 0;
-	    }
+	    code = svg_path_lineto(&pb, x0 + args[0], y0);
+	    last_curve = 0;
 	    break;
 
 	case 'V':
-	    if (nargs == 1)
-	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		// dprintf1("vlineto %g\n", args[0]);
-		gs_lineto(ctx->pgs, pt.x, args[0]);
-		nargs = 0;
-	    }
+	    code = svg_path_lineto(&pb, x0, args[0]);
+	    last_curve = 0;
 	    break;
 
 	case 'v':
-	    if (nargs == 1)
-	    {
-		// dprintf1("rvlineto %g\n", args[0]);
-		gs_rlineto(ctx->pgs, 0.0, args[0]);
-		nargs = 0;
-	    }
-	    break;
-
-	case 'C':
-	    reset_smooth = 0;
-	    if (nargs == 6)
-	    {
-		gs_curveto(ctx->pgs, args[0], args[1], args[2], args[3], args[4], args[5]);
-		smooth_x = args[4] - args[2];
-		smooth_y = args[5] - args[3];
-		nargs = 0;
-	    }
+	    code = svg_path_lineto(&pb, x0, y0 + args[0]);
+	    last_curve = 0;
 	    break;
 
 	case 'c':
-	    reset_smooth = 0;
-	    if (nargs == 6)
-	    {
-		gs_rcurveto(ctx->pgs, args[0], args[1], args[2], args[3], args[4], args[5]);
-		smooth_x = args[4] - args[2];
-		smooth_y = args[5] - args[3];
-		nargs = 0;
-	    }
-	    break;
-
-	case 'S':
-	    reset_smooth = 0;
-	    if (nargs == 4)
-	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		gs_curveto(ctx->pgs,
-			pt.x + smooth_x, pt.y + smooth_y,
-			args[0], args[1],
-			args[2], args[3]);
-		smooth_x = args[2] - args[0];
-		smooth_y = args[3] - args[1];
-		nargs = 0;
-	    }
+	    args[0] += x0; args[1] += y0;
+	    args[2] += x0; args[3] += y0;
+	    args[4] += x0; args[5] += y0;
+	    /* fall through */
+	case 'C':
+	    code = svg_path_curveto(&pb, args[0], args[1], args[2], args[3], args[4], args[5]);
+	    last_curve = 'C';
+	    last_x = args[2];
+	    last_y = args[3];
 	    break;
 
 	case 's':
-	    reset_smooth = 0;
-	    if (nargs == 4)
-	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		gs_curveto(ctx->pgs,
-			pt.x + smooth_x, pt.y + smooth_y,
-			pt.x + args[0], pt.y + args[1],
-			pt.x + args[2], pt.y + args[3]);
-		smooth_x = args[2] - args[0];
-		smooth_y = args[3] - args[1];
-		nargs = 0;
-	    }
-	    break;
-
-	case 'Q':
-	    reset_smooth = 0;
-	    if (nargs == 4)
+	    args[0] += x0; args[1] += y0;
+	    args[2] += x0; args[3] += y0;
+	    /* fall through */
+	case 'S':
+	    x1 = x0;
+	    y1 = y0;
+	    if (last_curve == 'C')
 	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		x1 = args[0];
-		y1 = args[1];
-		x2 = args[2];
-		y2 = args[3];
-		gs_curveto(ctx->pgs,
-			(pt.x + 2 * x1) / 3, (pt.y + 2 * y1) / 3,
-			(x2 + 2 * x1) / 3, (y2 + 2 * y1) / 3,
-			x2, y2);
-		smooth_x = x2 - x1;
-		smooth_y = y2 - y1;
-		nargs = 0;
+		x1 = 2 * x0 - last_x;
+		y1 = 2 * y0 - last_y;
 	    }
+	    code = svg_path_curveto(&pb, x1, y1, args[0], args[1], args[2], args[3]);
+	    last_curve = 'C';
+	    last_x = args[0];
+	    last_y = args[1];
 	    break;
 
 	case 'q':
-	    reset_smooth = 0;
-	    if (nargs == 4)
-	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		x1 = args[0] + pt.x;
-		y1 = args[1] + pt.y;
-		x2 = args[2] + pt.x;
-		y2 = args[3] + pt.y;
-		gs_curveto(ctx->pgs,
-			(pt.x + 2 * x1) / 3, (pt.y + 2 * y1) / 3,
-			(x2 + 2 * x1) / 3, (y2 + 2 * y1) / 3,
-			x2, y2);
-		smooth_x = x2 - x1;
-		smooth_y = y2 - y1;
-		nargs = 0;
-	    }
-	    break;
-
-	case 'T':
-	    reset_smooth = 0;
-	    if (nargs == 4)
-	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		x1 = pt.x + smooth_x;
-		y1 = pt.y + smooth_y;
-		x2 = args[0];
-		y2 = args[1];
-		gs_curveto(ctx->pgs,
-			(pt.x + 2 * x1) / 3, (pt.y + 2 * y1) / 3,
-			(x2 + 2 * x1) / 3, (y2 + 2 * y1) / 3,
-			x2, y2);
-		smooth_x = x2 - x1;
-		smooth_y = y2 - y1;
-		nargs = 0;
-	    }
+	    args[0] += x0; args[1] += y0;
+	    args[2] += x0; args[3] += y0;
+	    /* fall through */
+	case 'Q':
+	    x1 = args[0];
+	    y1 = args[1];
+	    x2 = args[2];
+	    y2 = args[3];
+	    code = svg_path_curveto(&pb,
+		    (x0 + 2 * x1) / 3, (y0 + 2 * y1) / 3,
+		    (x2 + 2 * x1) / 3, (y2 + 2 * y1) / 3,
+		    x2, y2);
+	    last_curve = 'Q';
+	    last_x = x1;
+	    last_y = y1;
 	    break;
 
 	case 't':
-	    reset_smooth = 0;
-	    if (nargs == 4)
+	    args[0] += x0; args[1] += y0;
+	    /* fall through */
+	case 'T':
+	    x1 = x0;
+	    y1 = y0;
+	    if (last_curve == 'Q')
 	    {
-		gs_currentpoint(ctx->pgs, &pt);
-		x1 = pt.x + smooth_x;
-		y1 = pt.y + smooth_y;
-		x2 = args[0] + pt.x;
-		y2 = args[1] + pt.y;
-		gs_curveto(ctx->pgs,
-			(pt.x + 2 * x1) / 3, (pt.y + 2 * y1) / 3,
-			(x2 + 2 * x1) / 3, (y2 + 2 * y1) / 3,
-			x2, y2);
-		smooth_x = x2 - x1;
-		smooth_y = y2 - y1;
-		nargs = 0;
+		x1 = 2 * x0 - last_x;
+		y1 = 2 * y0 - last_y;
 	    }
+	    x2 = args[0];
+	    y2 = args[1];
+	    code = svg_path_curveto(&pb,
+		    (x0 + 2 * x1) / 3, (y0 + 2 * y1) / 3,
+		    (x2 + 2 * x1) / 3, (y2 + 2 * y1) / 3,
+		    x2, y2);
+	    last_curve = 'Q';
+	    last_x = x1;
+	    last_y = y1;
 	    break;
+	}
 
-	case 0:
-	    if (nargs != 0)
-		return gs_throw(-1, "path data must begin with a command");
+	if (code < 0)
 	    break;
-
-	default:
-	    return gs_throw1(-1, "unrecognized command in path data: '%c'", cmd);
-	}
     }
 
-    return 0;
+    svg_end_path(&pb);
+
+    return code;
 }
 
 int
 svg_parse_path(svg_context_t *ctx, svg_item_t *node)
 {
-    char *d_att = svg_att(node, "d");
-    char *path_length_att = svg_att(node, "pathLength");
+    char *d_att = svg_att_atom(node, SVG_ATT_D);
+    char *path_length_att = svg_att_atom(node, SVG_ATT_PATH_LENGTH);
+    int code;
 
     svg_parse_common(ctx, node);
 
-    if (d_att)
+    if (d_att && (ctx->fill_is_set || ctx->stroke_is_set))
     {
-	if (ctx->fill_is_set)
-	{
-	    svg_parse_path_data(ctx, d_att);
-	    svg_fill(ctx);
-	}
-
-	if (ctx->stroke_is_set)
-	{
-	    svg_parse_path_data(ctx, d_att);
-	    svg_stroke(ctx);
-	}
+	/* errors are not fatal: we draw the path up to the first one */
+	code = svg_parse_path_data(ctx, d_att);
+	if (code < 0)
+	    gs_catch(code, "cannot parse path data");
+	svg_fill_stroke(ctx);
     }
 
     return 0;
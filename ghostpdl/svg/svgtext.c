@@ -0,0 +1,365 @@
+/* Copyright (C) 2008 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* SVG interpreter - text support */
+
+#include "ghostsvg.h"
+
+/*
+ * Each chunk of character data is shown as a single glyph run with
+ * gs_text_begin, so the glyphs are drawn from the character cache
+ * instead of being filled as outlines one by one.
+ *
+ * Only the first value of x, y, dx and dy lists is used, and
+ * text-anchor is applied to each run rather than to the whole chunk.
+ */
+
+#define SVG_DEFAULT_FONT_SIZE 12
+
+typedef struct svg_text_state_s svg_text_state_t;
+
+struct svg_text_state_s
+{
+    const char *family;
+    int bold;
+    int italic;
+    float size;
+    int anchor; /* 0=start, 1=middle, 2=end */
+    float x, y;
+    int at_start; /* strip leading white space */
+    int at_end; /* strip trailing white space */
+};
+
+/*
+ * Decode a UTF-8 string, collapsing white space as for xml:space="default".
+ * The output buffer must hold at least strlen(str) characters.
+ */
+static int
+svg_decode_text(svg_text_state_t *ts, const char *str, gs_char *out)
+{
+    int len = strlen(str);
+    int n = 0;
+    int c;
+
+    while (len > 0)
+    {
+	int k = svg_utf8_to_ucs(&c, str, len);
+	str += k;
+	len -= k;
+
+	if (c == '\t' || c == '\r' || c == '\n')
+	    c = ' ';
+	if (c == ' ' && (ts->at_start || (n > 0 && out[n-1] == ' ')))
+	    continue;
+
+	out[n++] = c;
+	ts->at_start = 0;
+    }
+
+    if (ts->at_end)
+	while (n > 0 && out[n-1] == ' ')
+	    n--;
+
+    /* a trailing space swallows leading space in the next run */
+    if (n > 0 && out[n-1] == ' ')
+	ts->at_start = 1;
+
+    return n;
+}
+
+static int
+svg_text_op(svg_context_t *ctx, int operation, const gs_char *chars, int count, gs_point *width)
+{
+    gs_text_params_t params;
+    gs_text_enum_t *textenum;
+    int code;
+
+    params.operation = TEXT_FROM_CHARS | operation;
+    params.data.chars = chars;
+    params.size = count;
+
+    code = gs_text_begin(ctx->pgs, &params, ctx->memory, &textenum);
+    if (code != 0)
+	return gs_throw1(-1, "cannot gs_text_begin() (%d)", code);
+
+    code = gs_text_process(textenum);
+    if (code == 0 && width)
+	gs_text_total_width(textenum, width);
+
+    gs_text_release(textenum, "svg_text_op");
+
+    if (code != 0)
+	return gs_throw1(-1, "cannot gs_text_process() (%d)", code);
+
+    return 0;
+}
+
+static int
+svg_show_run(svg_context_t *ctx, svg_text_state_t *ts, const gs_char *chars, int count)
+{
+    gs_font *font;
+    gs_matrix matrix, charmatrix;
+    gs_point pt;
+    uint cached;
+    int code;
+
+    font = svg_select_font(ctx, ts->family, ts->bold, ts->italic);
+    if (!font)
+	return 0;
+
+    /* glyphs are y-up, user space is y-down */
+    gs_setfont(ctx->pgs, font);
+    gs_make_scaling(ts->size, -ts->size, &matrix);
+    gs_matrix_multiply(&font->orig_FontMatrix, &matrix, &charmatrix);
+    gs_setcharmatrix(ctx->pgs, &charmatrix);
+    gs_matrix_multiply(&matrix, &font->orig_FontMatrix, &font->FontMatrix);
+
+    if (ts->anchor || !(ctx->fill_is_set || ctx->stroke_is_set))
+    {
+	gs_newpath(ctx->pgs);
+	gs_moveto(ctx->pgs, ts->x, ts->y);
+	code = svg_text_op(ctx, TEXT_DO_NONE | TEXT_RETURN_WIDTH, chars, count, &pt);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot measure text");
+
+	ts->x -= pt.x * ts->anchor * 0.5;
+	ts->y -= pt.y * ts->anchor * 0.5;
+
+	/* nothing to draw, just advance */
+	if (!(ctx->fill_is_set || ctx->stroke_is_set))
+	{
+	    ts->x += pt.x;
+	    ts->y += pt.y;
+	    return 0;
+	}
+    }
+
+    ctx->glyph_runs ++;
+    ctx->glyph_count += count;
+
+    if (ctx->fill_is_set && !ctx->fill_gradient)
+    {
+	cached = ctx->fontdir->ccache.csize;
+
+	svg_set_fill_color(ctx);
+	gs_newpath(ctx->pgs);
+	gs_moveto(ctx->pgs, ts->x, ts->y);
+	code = svg_text_op(ctx, TEXT_DO_DRAW, chars, count, NULL);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot draw text");
+
+	if (ctx->fontdir->ccache.csize > cached)
+	    ctx->glyph_renders += ctx->fontdir->ccache.csize - cached;
+    }
+
+    /* gradients are painted through the glyph outlines */
+    if (ctx->stroke_is_set || ctx->fill_gradient)
+    {
+	gs_newpath(ctx->pgs);
+	gs_moveto(ctx->pgs, ts->x, ts->y);
+	code = svg_text_op(ctx, TEXT_DO_TRUE_CHARPATH, chars, count, NULL);
+	if (code < 0)
+	    return gs_rethrow(code, "cannot stroke text");
+	gs_currentpoint(ctx->pgs, &pt);
+	svg_paint_path(ctx, ctx->fill_gradient != NULL, ctx->stroke_is_set);
+    }
+    else
+    {
+	gs_currentpoint(ctx->pgs, &pt);
+	gs_newpath(ctx->pgs);
+    }
+
+    ts->x = pt.x;
+    ts->y = pt.y;
+
+    return 0;
+}
+
+static int
+svg_text_run(svg_context_t *ctx, svg_text_state_t *ts, const char *str)
+{
+    gs_char buf[256];
+    gs_char *chars = buf;
+    int len = strlen(str);
+    int count;
+    int code;
+
+    if (len > countof(buf))
+    {
+	chars = svg_alloc(ctx, len * sizeof(gs_char));
+	if (!chars)
+	    return gs_throw(-1, "out of memory: text run");
+    }
+
+    count = svg_decode_text(ts, str, chars);
+    code = count > 0 ? svg_show_run(ctx, ts, chars, count) : 0;
+
+    if (chars != buf)
+	svg_free(ctx, chars);
+
+    return code;
+}
+
+static void
+svg_parse_text_style(svg_context_t *ctx, svg_item_t *node, svg_text_state_t *ts)
+{
+    char *x_att = svg_att_atom(node, SVG_ATT_X);
+    char *y_att = svg_att_atom(node, SVG_ATT_Y);
+    char *dx_att = svg_att_atom(node, SVG_ATT_DX);
+    char *dy_att = svg_att_atom(node, SVG_ATT_DY);
+    char *family_att = svg_att_atom(node, SVG_ATT_FONT_FAMILY);
+    char *size_att = svg_att_atom(node, SVG_ATT_FONT_SIZE);
+    char *weight_att = svg_att_atom(node, SVG_ATT_FONT_WEIGHT);
+    char *style_att = svg_att_atom(node, SVG_ATT_FONT_STYLE);
+    char *anchor_att = svg_att_atom(node, SVG_ATT_TEXT_ANCHOR);
+
+    if (family_att && strcmp(family_att, "inherit"))
+	ts->family = family_att;
+
+    if (size_att && strcmp(size_att, "inherit"))
+	ts->size = svg_parse_length(size_att, ts->size, ts->size);
+
+    if (weight_att)
+    {
+	if (!strcmp(weight_att, "bold") || !strcmp(weight_att, "bolder"))
+	    ts->bold = 1;
+	else if (!strcmp(weight_att, "normal") || !strcmp(weight_att, "lighter"))
+	    ts->bold = 0;
+	else if (svg_is_digit(weight_att[0]))
+	    ts->bold = atoi(weight_att) >= 600;
+    }
+
+    if (style_att)
+    {
+	if (!strcmp(style_att, "italic") || !strcmp(style_att, "oblique"))
+	    ts->italic = 1;
+	else if (!strcmp(style_att, "normal"))
+	    ts->italic = 0;
+    }
+
+    if (anchor_att)
+    {
+	if (!strcmp(anchor_att, "start"))
+	    ts->anchor = 0;
+	if (!strcmp(anchor_att, "middle"))
+	    ts->anchor = 1;
+	if (!strcmp(anchor_att, "end"))
+	    ts->anchor = 2;
+    }
+
+    if (x_att) ts->x = svg_parse_length(x_att, ctx->viewbox_width, ts->size);
+    if (y_att) ts->y = svg_parse_length(y_att, ctx->viewbox_height, ts->size);
+    if (dx_att) ts->x += svg_parse_length(dx_att, ctx->viewbox_width, ts->size);
+    if (dy_att) ts->y += svg_parse_length(dy_att, ctx->viewbox_height, ts->size);
+}
+
+static int
+svg_parse_text_content(svg_context_t *ctx, svg_item_t *root, svg_text_state_t *ts)
+{
+    svg_paint_state_t saved_paint;
+    svg_text_state_t sub;
+    svg_item_t *node;
+    int at_end = ts->at_end;
+    int code = 0;
+
+    for (node = svg_down(root); node && code >= 0; node = svg_next(node))
+    {
+	ts->at_end = at_end && !svg_next(node);
+
+	if (svg_tag_atom(node) == SVG_TAG_TSPAN)
+	{
+	    sub = *ts;
+
+	    svg_save_paint(ctx, &saved_paint);
+	    gs_gsave(ctx->pgs);
+
+	    code = svg_parse_common(ctx, node);
+	    if (code >= 0)
+	    {
+		svg_parse_text_style(ctx, node, &sub);
+		code = svg_parse_text_content(ctx, node, &sub);
+	    }
+
+	    gs_grestore(ctx->pgs);
+	    svg_restore_paint(ctx, &saved_paint);
+
+	    ts->x = sub.x;
+	    ts->y = sub.y;
+	    ts->at_start = sub.at_start;
+	}
+	else if (node->name[0] == 0 && node->atts[0])
+	{
+	    /* character data, see on_text */
+	    code = svg_text_run(ctx, ts, node->atts[1]);
+	}
+    }
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse text content");
+
+    return 0;
+}
+
+int
+svg_parse_text(svg_context_t *ctx, svg_item_t *node)
+{
+    svg_paint_state_t saved_paint;
+    svg_text_state_t ts;
+    int code;
+
+    if (ctx->record)
+    {
+	gs_warn("text in referenced content is not supported");
+	return 0;
+    }
+
+    ts.family = NULL;
+    ts.bold = 0;
+    ts.italic = 0;
+    ts.size = SVG_DEFAULT_FONT_SIZE;
+    ts.anchor = 0;
+    ts.x = 0;
+    ts.y = 0;
+    ts.at_start = 1;
+    ts.at_end = 1;
+
+    svg_save_paint(ctx, &saved_paint);
+    gs_gsave(ctx->pgs);
+
+    code = svg_parse_common(ctx, node);
+    if (code >= 0)
+    {
+	svg_parse_text_style(ctx, node, &ts);
+	code = svg_parse_text_content(ctx, node, &ts);
+    }
+
+    gs_grestore(ctx->pgs);
+    svg_restore_paint(ctx, &saved_paint);
+
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse <text> element");
+
+    return 0;
+}
+
+void
+svg_debug_text(svg_context_t *ctx)
+{
+    if (gs_debug_c('|') && ctx->glyph_count)
+	dprintf3("svg: %ld glyphs in %ld runs, %ld rendered into the cache\n",
+		ctx->glyph_count, ctx->glyph_runs, ctx->glyph_renders);
+
+    ctx->glyph_count = 0;
+    ctx->glyph_runs = 0;
+    ctx->glyph_renders = 0;
+}
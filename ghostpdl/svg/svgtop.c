@@ -119,7 +119,7 @@ svg_imp_allocate_interp_instance(pl_interp_instance_t **ppinstance,
 
     ctx->fill_rule = 1; /* 0=evenodd, 1=nonzero */
 
-    ctx->fill_is_set = 0;
+    ctx->fill_is_set = 1; /* the initial fill is black */
     ctx->fill_color[0] = 0.0;
     ctx->fill_color[1] = 0.0;
     ctx->fill_color[2] = 0.0;
@@ -129,6 +129,10 @@ svg_imp_allocate_interp_instance(pl_interp_instance_t **ppinstance,
     ctx->stroke_color[1] = 0.0;
     ctx->stroke_color[2] = 0.0;
 
+    ctx->fill_opacity = 1.0;
+    ctx->stroke_opacity = 1.0;
+    ctx->opacity = 1.0;
+
     instance->pre_page_action = 0;
     instance->pre_page_closure = 0;
     instance->post_page_action = 0;
@@ -136,7 +140,7 @@ svg_imp_allocate_interp_instance(pl_interp_instance_t **ppinstance,
 
     instance->ctx = ctx;
 
-    // XXX - svg_init_font_cache(ctx);
+    svg_init_font_cache(ctx);
 
     *ppinstance = (pl_interp_instance_t *)instance;
 
@@ -264,6 +268,22 @@ svg_imp_process_file(pl_interp_instance_t *pinstance, char *filename)
 	}
     }
 
+    if (ctx->batch)
+    {
+	code = svg_close_xml_batch(ctx);
+	fclose(file);
+	return code;
+    }
+
+    if (ctx->streaming)
+    {
+	code = svg_close_xml_stream(ctx);
+	if (code < 0)
+	    gs_catch(code, "cannot parse SVG document");
+	fclose(file);
+	return code;
+    }
+
     root = svg_close_xml_parser(ctx);
     if (!root)
     {
@@ -320,6 +340,17 @@ svg_imp_process_eof(pl_interp_instance_t *pinstance)
 
     dputs("-- svg_imp_process_eof --\n");
 
+    if (ctx->batch)
+	return svg_close_xml_batch(ctx);
+
+    if (ctx->streaming)
+    {
+	code = svg_close_xml_stream(ctx);
+	if (code < 0)
+	    gs_catch(code, "cannot parse SVG document");
+	return code;
+    }
+
     root = svg_close_xml_parser(ctx);
     if (!root)
 	return gs_rethrow(-1, "cannot parse xml document");
@@ -353,6 +384,16 @@ svg_imp_init_job(pl_interp_instance_t *pinstance)
 
     dputs("-- svg_imp_init_job --\n");
 
+    /* draw elements as they are parsed instead of building the whole tree */
+    ctx->streaming = instance->pl.svg_streaming;
+
+    /* accept back to back documents and time each one, see svgbatch.c */
+    ctx->batch = instance->pl.svg_batch;
+
+    ctx->transparency = instance->pl.svg_transparency;
+
+    ctx->font_path = instance->pl.svg_font_path;
+
     return svg_open_xml_parser(ctx);
 }
 
@@ -401,6 +442,12 @@ svg_imp_deallocate_interp_instance(pl_interp_instance_t *pinstance)
 
     /* language clients don't free the font cache machinery */
 
+    svg_report_batch(ctx);
+
+    svg_free_font_cache(ctx);
+    svg_free_xml_parser(ctx);
+    svg_free_xml_memory(ctx);
+
     // free gstate?
     gs_free_object(mem, ctx, "svg_imp_deallocate_interp_instance");
     gs_free_object(mem, instance, "svg_imp_deallocate_interp_instance");
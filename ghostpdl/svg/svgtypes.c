@@ -92,3 +92,100 @@ svg_parse_angle(char *str)
     return val;
 }
 
+
+/*
+ * Read a number in place, without copying it to a buffer or going
+ * through strtod and the locale machinery. Up to 15 significant digits
+ * are accumulated exactly in a double, and when the decimal exponent
+ * is small enough for the power of ten to be exact the result is the
+ * correctly rounded double. Advances *sp past the number, and returns
+ * 0 if there is no number there.
+ */
+int
+svg_lex_number(const char **sp, float *val)
+{
+    static const double powers[] =
+    {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *s = *sp;
+    double mant = 0.0;
+    int ndigits = 0; /* significant digits in mant */
+    int seen = 0; /* any digits at all */
+    int neg = 0;
+    int exp = 0;
+    double v;
+
+    if (*s == '+' || *s == '-')
+	neg = *s++ == '-';
+
+    while (*s >= '0' && *s <= '9')
+    {
+	if (ndigits < 15)
+	{
+	    mant = mant * 10 + (*s - '0');
+	    if (mant != 0)
+		ndigits ++;
+	}
+	else
+	    exp ++;
+	seen = 1;
+	s ++;
+    }
+
+    if (*s == '.')
+    {
+	s ++;
+	while (*s >= '0' && *s <= '9')
+	{
+	    if (ndigits < 15)
+	    {
+		mant = mant * 10 + (*s - '0');
+		if (mant != 0)
+		    ndigits ++;
+		exp --;
+	    }
+	    seen = 1;
+	    s ++;
+	}
+    }
+
+    if (!seen)
+	return 0;
+
+    if (*s == 'e' || *s == 'E')
+    {
+	const char *e = s + 1;
+	int eneg = 0;
+	int eval = 0;
+
+	if (*e == '+' || *e == '-')
+	    eneg = *e++ == '-';
+
+	if (*e >= '0' && *e <= '9')
+	{
+	    while (*e >= '0' && *e <= '9')
+	    {
+		if (eval < 10000)
+		    eval = eval * 10 + (*e - '0');
+		e ++;
+	    }
+	    exp += eneg ? -eval : eval;
+	    s = e;
+	}
+    }
+
+    v = mant;
+    if (exp > 0 && exp <= 22)
+	v *= powers[exp];
+    else if (exp < 0 && exp >= -22)
+	v /= powers[-exp];
+    else if (exp != 0 && mant != 0)
+	v *= pow(10.0, exp);
+
+    *val = neg ? -v : v;
+    *sp = s;
+    return 1;
+}
@@ -19,15 +19,180 @@
 
 #define XMLBUFLEN 4096
 
+/*
+ * Items are allocated from a simple bump allocator. Since an item is
+ * only ever freed together with everything that was parsed after it
+ * (the whole tree, or in streaming mode the subtree that was just
+ * drawn) releasing memory is a matter of resetting the top pointer.
+ */
+
+#define SVG_ARENA_BLOCK_SIZE (64 * 1024)
+#define SVG_ARENA_ALIGN(n) (((n) + 7) & ~7)
+
+struct svg_arena_block_s
+{
+    svg_arena_block_t *prev;
+    int size;
+    int used;
+};
+
+#define svg_arena_data(blk) (((byte*)(blk)) + SVG_ARENA_ALIGN(sizeof(svg_arena_block_t)))
+
+static void *
+svg_arena_alloc(svg_context_t *ctx, int size)
+{
+    svg_arena_block_t *blk = ctx->arena;
+    void *ptr;
+
+    size = SVG_ARENA_ALIGN(size);
+
+    if (!blk || blk->used + size > blk->size)
+    {
+	if (ctx->arena_spare && size <= ctx->arena_spare->size)
+	{
+	    blk = ctx->arena_spare;
+	    ctx->arena_spare = NULL;
+	}
+	else
+	{
+	    int cap = MAX(size, SVG_ARENA_BLOCK_SIZE);
+	    blk = svg_alloc(ctx, SVG_ARENA_ALIGN(sizeof(svg_arena_block_t)) + cap);
+	    if (!blk)
+		return NULL;
+	    blk->size = cap;
+	    ctx->arena_blocks ++;
+	}
+	blk->used = 0;
+	blk->prev = ctx->arena;
+	ctx->arena = blk;
+    }
+
+    ptr = svg_arena_data(blk) + blk->used;
+    blk->used += size;
+    return ptr;
+}
+
+static void
+svg_arena_drop_block(svg_context_t *ctx, svg_arena_block_t *blk)
+{
+    /* hang on to one block, so that streaming does not thrash */
+    if (!ctx->arena_spare && blk->size == SVG_ARENA_BLOCK_SIZE)
+	ctx->arena_spare = blk;
+    else
+	svg_free(ctx, blk);
+}
+
+/* Release ptr and everything allocated after it. */
+static void
+svg_arena_release(svg_context_t *ctx, void *ptr)
+{
+    svg_arena_block_t *blk = ctx->arena;
+    svg_arena_block_t *prev;
+    byte *p = ptr;
+
+    while (blk)
+    {
+	if (p >= svg_arena_data(blk) && p < svg_arena_data(blk) + blk->size)
+	{
+	    blk->used = p - svg_arena_data(blk);
+	    break;
+	}
+	prev = blk->prev;
+	svg_arena_drop_block(ctx, blk);
+	blk = prev;
+    }
+
+    ctx->arena = blk;
+}
+
+void
+svg_free_xml_memory(svg_context_t *ctx)
+{
+    svg_arena_block_t *blk = ctx->arena;
+    svg_arena_block_t *prev;
+
+    while (blk)
+    {
+	prev = blk->prev;
+	svg_free(ctx, blk);
+	blk = prev;
+    }
+
+    if (ctx->arena_spare)
+	svg_free(ctx, ctx->arena_spare);
+
+    ctx->arena = NULL;
+    ctx->arena_spare = NULL;
+}
+
+static void
+svg_debug_xml_memory(svg_context_t *ctx)
+{
+    if (gs_debug_c('|'))
+	dprintf2("svg: parsed %ld items using %ld block allocations\n",
+		ctx->arena_items, ctx->arena_blocks);
+}
+
+/*
+ * Tables of known names, indexed by atom.
+ */
+
+static const char *svg_tag_names[] =
+{
+    "",
+#define SVG_TAG(id, name) name,
+#define SVG_ATT(id, name)
+#include "svgatomlist.h"
+#undef SVG_TAG
+#undef SVG_ATT
+};
+
+static const char *svg_att_names[] =
+{
+    "",
+#define SVG_TAG(id, name)
+#define SVG_ATT(id, name) name,
+#include "svgatomlist.h"
+#undef SVG_TAG
+#undef SVG_ATT
+};
+
+/* binary search, skipping the empty NONE entry */
+static int
+svg_lookup_atom(const char **table, int count, const char *name)
+{
+    int l = 1;
+    int r = count - 1;
+    int m, c;
+
+    while (l <= r)
+    {
+	m = (l + r) / 2;
+	c = strcmp(name, table[m]);
+	if (c < 0)
+	    r = m - 1;
+	else if (c > 0)
+	    l = m + 1;
+	else
+	    return m;
+    }
+
+    return 0;
+}
+
+static void svg_stream_open_tag(svg_context_t *ctx, svg_item_t *item);
+static void svg_stream_close_tag(svg_context_t *ctx, svg_item_t *item);
+
 static void on_open_tag(void *zp, const char *name, const char **atts)
 {
     svg_context_t *ctx = zp;
     svg_item_t *item;
-    svg_item_t *tail;
     int namelen;
     int attslen;
+    int slotslen;
     int textlen;
     char *p;
+    int att;
     int i;
 
     if (ctx->error)
@@ -43,18 +208,21 @@ static void on_open_tag(void *zp, const char *name, const char **atts)
 	attslen += sizeof(char*);
 	textlen += strlen(atts[i]) + 1;
     }
+    slotslen = i / 2 * sizeof(svg_att_slot_t);
 
-    item = svg_alloc(ctx, sizeof(svg_item_t) + attslen + namelen + textlen);
+    item = svg_arena_alloc(ctx, sizeof(svg_item_t) + attslen + slotslen + namelen + textlen);
     if (!item)
     {
 	ctx->error = "out of memory";
+	return;
     }
 
     /* copy strings to new memory */
 
     item->atts = (char**) (((char*)item) + sizeof(svg_item_t));
-    item->name = ((char*)item) + sizeof(svg_item_t) + attslen;
-    p = ((char*)item) + sizeof(svg_item_t) + attslen + namelen;
+    item->slots = (svg_att_slot_t*) (((char*)item) + sizeof(svg_item_t) + attslen);
+    item->name = ((char*)item) + sizeof(svg_item_t) + attslen + slotslen;
+    p = ((char*)item) + sizeof(svg_item_t) + attslen + slotslen + namelen;
 
     strcpy(item->name, name);
     for (i = 0; atts[i]; i++)
@@ -66,42 +234,183 @@ static void on_open_tag(void *zp, const char *name, const char **atts)
 
     item->atts[i] = 0;
 
+    /* intern the names */
+
+    item->tag = svg_lookup_atom(svg_tag_names, SVG_TAG_COUNT, name);
+    item->nslots = 0;
+    for (i = 0; atts[i] && i < 0xffff; i += 2)
+    {
+	att = svg_lookup_atom(svg_att_names, SVG_ATT_COUNT, atts[i]);
+	if (att)
+	{
+	    item->slots[item->nslots].att = att;
+	    item->slots[item->nslots].value = i + 1;
+	    item->nslots ++;
+	}
+    }
+
+    ctx->arena_items ++;
+
     /* link item into tree */
 
     item->up = ctx->head;
     item->down = NULL;
+    item->tail = NULL;
     item->next = NULL;
 
     if (!ctx->head)
-    {
 	ctx->root = item;
-	ctx->head = item;
+    else if (!ctx->head->down)
+	ctx->head->down = item;
+    else
+	ctx->head->tail->next = item;
+
+    if (ctx->head)
+	ctx->head->tail = item;
+
+    ctx->head = item;
+
+    if (ctx->streaming)
+	svg_stream_open_tag(ctx, item);
+}
+
+static void on_close_tag(void *zp, const char *name)
+{
+    svg_context_t *ctx = zp;
+    svg_item_t *item;
+
+    if (ctx->error)
 	return;
+
+    item = ctx->head;
+    if (item)
+    {
+	svg_item_t *up = item->up;
+
+	ctx->head = up;
+	if (ctx->streaming)
+	    svg_stream_close_tag(ctx, item);
+
+	/* in batch mode the next document may follow, see svg_feed_xml_parser */
+	if (!up && ctx->batch)
+	{
+	    ctx->batch_end = XML_GetCurrentByteIndex(ctx->parser) +
+		XML_GetCurrentByteCount(ctx->parser);
+	    XML_StopParser(ctx->parser, XML_FALSE);
+	}
     }
+}
 
-    if (!ctx->head->down)
+/*
+ * Streaming mode. The root <svg> element and the <g> elements directly
+ * inside it (recursively) are begun as soon as they are opened. Any
+ * other element that is a child of one of these is drawn when it is
+ * closed, and then freed along with its subtree. Only the chain of open
+ * elements and the subtree currently being read are kept in memory.
+ */
+
+static void
+svg_stream_open_tag(svg_context_t *ctx, svg_item_t *item)
+{
+    int code;
+
+    if (!item->up)
     {
-	ctx->head->down = item;
-	ctx->head = item;
+	/* the tree cannot be scanned for opacity ahead of drawing */
+	ctx->use_transparency = ctx->transparency != 0;
+	code = svg_begin_document(ctx, item);
+	if (code < 0)
+	    ctx->stream_code = gs_rethrow(code, "cannot begin streamed svg document");
+	else
+	    ctx->stream_head = item;
 	return;
     }
 
-    tail = ctx->head->down;
-    while (tail->next)
-	tail = tail->next;
-    tail->next = item;
-    ctx->head = item;
+    if (item->up == ctx->stream_head && item->tag == SVG_TAG_G)
+    {
+	code = svg_begin_group(ctx, item);
+	if (code >= 0 && svg_element_opacity(ctx, item) < 1)
+	{
+	    /* the contents are not known yet, so bound the group by the clip */
+	    code = svg_begin_opacity(ctx, svg_element_opacity(ctx, item), NULL);
+	    if (code < 0)
+		svg_end_group(ctx, item);
+	}
+	if (code < 0)
+	    ctx->stream_code = gs_rethrow(code, "cannot begin streamed <g> element");
+	else
+	    ctx->stream_head = item;
+    }
 }
 
-static void on_close_tag(void *zp, const char *name)
+static void
+svg_stream_close_tag(svg_context_t *ctx, svg_item_t *item)
 {
-    svg_context_t *ctx = zp;
+    svg_item_t *up = item->up;
+    int code = 0;
 
-    if (ctx->error)
+    if (item == ctx->stream_head)
+    {
+	ctx->stream_head = up;
+	if (up)
+	{
+	    if (svg_element_opacity(ctx, item) < 1)
+		svg_end_opacity(ctx);
+	    code = svg_end_group(ctx, item);
+	}
+	else
+	    code = svg_end_document(ctx);
+    }
+    else if (up && up == ctx->stream_head)
+    {
+	/* after the first error we only keep track of the structure */
+	if (ctx->stream_code >= 0)
+	    code = svg_parse_element(ctx, item);
+    }
+    else
+    {
+	/* part of a subtree that is still being read */
 	return;
+    }
 
-    if (ctx->head)
-	ctx->head = ctx->head->up;
+    if (code < 0 && ctx->stream_code >= 0)
+	ctx->stream_code = gs_rethrow(code, "cannot draw streamed element");
+
+    /* all earlier siblings have already been drawn and freed */
+    if (up)
+    {
+	up->down = NULL;
+	up->tail = NULL;
+    }
+    else
+	ctx->root = NULL;
+
+    svg_free_item(ctx, item);
+}
+
+/* Undo the page and group setup for any elements still open. */
+static void
+svg_abort_stream(svg_context_t *ctx)
+{
+    svg_item_t *item;
+
+    for (item = ctx->stream_head; item; item = item->up)
+    {
+	if (item->up)
+	{
+	    if (svg_element_opacity(ctx, item) < 1)
+		svg_end_opacity(ctx);
+	    svg_end_group(ctx, item);
+	}
+	else
+	    svg_abort_document(ctx);
+    }
+
+    ctx->stream_head = NULL;
+
+    if (ctx->root)
+	svg_free_item(ctx, ctx->root);
+    ctx->root = NULL;
 }
 
 static inline int is_svg_space(int c)
@@ -143,15 +452,29 @@ static void on_text(void *zp, const char *buf, int len)
     }
 }
 
-int
-svg_open_xml_parser(svg_context_t *ctx)
+/*
+ * The parser is created once per context and reset for each document,
+ * which keeps its buffers and hash tables from one job to the next.
+ * XML_ParserReset clears the handlers and user data along with
+ * the parse state, so they are installed again every time.
+ */
+static int
+svg_reset_xml_parser(svg_context_t *ctx)
 {
-    XML_Parser xp;
+    XML_Parser xp = ctx->parser;
 
-    /* xp = XML_ParserCreateNS(NULL, ns); */
-    xp = XML_ParserCreate(NULL);
-    if (!xp)
-	return gs_throw(-1, "xml error: could not create expat parser");
+    if (xp)
+    {
+	if (!XML_ParserReset(xp, NULL))
+	    return gs_throw(-1, "xml error: could not reset expat parser");
+    }
+    else
+    {
+	/* xp = XML_ParserCreateNS(NULL, ns); */
+	xp = XML_ParserCreate(NULL);
+	if (!xp)
+	    return gs_throw(-1, "xml error: could not create expat parser");
+    }
 
     XML_SetUserData(xp, ctx);
     XML_SetParamEntityParsing(xp, XML_PARAM_ENTITY_PARSING_NEVER);
@@ -164,6 +487,101 @@ svg_open_xml_parser(svg_context_t *ctx)
     ctx->error = NULL;
     ctx->parser = xp;
 
+    ctx->stream_head = NULL;
+    ctx->stream_code = 0;
+
+    ctx->arena_items = 0;
+    ctx->arena_blocks = 0;
+
+    ctx->batch_pending = 0;
+    ctx->batch_offset = 0;
+    ctx->batch_end = -1;
+
+    return 0;
+}
+
+int
+svg_open_xml_parser(svg_context_t *ctx)
+{
+    int code;
+
+    code = svg_reset_xml_parser(ctx);
+    if (code < 0)
+	return gs_rethrow(code, "cannot open xml parser");
+
+    ctx->batch_code = 0;
+    if (ctx->batch)
+	svg_start_batch_timer(ctx);
+
+    return 0;
+}
+
+void
+svg_free_xml_parser(svg_context_t *ctx)
+{
+    if (ctx->parser)
+	XML_ParserFree(ctx->parser);
+    ctx->parser = NULL;
+}
+
+/* Throw away whatever was parsed after an error. */
+static void
+svg_discard_xml_document(svg_context_t *ctx)
+{
+    if (ctx->streaming)
+	svg_abort_stream(ctx);
+    else if (ctx->root)
+	svg_free_item(ctx, ctx->root);
+    ctx->root = NULL;
+    ctx->head = NULL;
+    ctx->error = NULL;
+}
+
+/*
+ * Batch mode. A stream may hold any number of documents one after
+ * the other, as when small files are concatenated or piped in. The
+ * parser is stopped at the end of each root element; the document is
+ * drawn, the parser is reset, and the rest of the data is fed to it
+ * as a new document. White space between documents is skipped, so
+ * each one can start with its own XML declaration.
+ *
+ * An error in one document is reported and counted, and the job goes
+ * on with the next one. Only errors in the XML itself stop the job,
+ * since the end of the broken document cannot be found.
+ */
+static int
+svg_finish_batch_document(svg_context_t *ctx)
+{
+    svg_item_t *root = ctx->root;
+    int code;
+
+    if (ctx->streaming)
+    {
+	code = ctx->stream_code;
+	if (code >= 0 && ctx->error)
+	    code = gs_throw1(-1, "xml error: %s", ctx->error);
+    }
+    else
+    {
+	code = svg_parse_document(ctx, root);
+	svg_free_item(ctx, root);
+    }
+
+    if (code < 0)
+    {
+	gs_catch(code, "cannot parse SVG document");
+	if (ctx->batch_code >= 0)
+	    ctx->batch_code = code;
+    }
+
+    svg_debug_xml_memory(ctx);
+    svg_end_batch_document(ctx, code);
+
+    code = svg_reset_xml_parser(ctx);
+    if (code < 0)
+	return gs_rethrow(code, "cannot parse next document in batch");
+
+    svg_start_batch_timer(ctx);
     return 0;
 }
 
@@ -171,20 +589,50 @@ int
 svg_feed_xml_parser(svg_context_t *ctx, const char *buf, int len)
 {
     XML_Parser xp = ctx->parser;
-    int code = XML_Parse(xp, buf, len, 0);
-    if (code == 0)
+    int code;
+    int n;
+
+    while (len > 0)
     {
-	ctx->root = NULL;
-	ctx->head = NULL;
-	ctx->error = NULL;
-	ctx->parser = NULL;
-	gs_throw3(-1, "xml error: %s (line %d, column %d)",
-		XML_ErrorString(XML_GetErrorCode(xp)),
-		XML_GetCurrentLineNumber(xp),
-		XML_GetCurrentColumnNumber(xp));
-	XML_ParserFree(xp);
-	return -1;
+	if (ctx->batch && !ctx->batch_pending)
+	{
+	    while (len > 0 && is_svg_space(*buf))
+		buf++, len--;
+	    if (len == 0)
+		return 0;
+	    ctx->batch_pending = 1;
+	}
+
+	code = XML_Parse(xp, buf, len, 0);
+
+	if (ctx->batch_end >= 0)
+	{
+	    n = ctx->batch_end - ctx->batch_offset;
+	    buf += n;
+	    len -= n;
+	    code = svg_finish_batch_document(ctx);
+	    if (code < 0)
+		return gs_rethrow(code, "cannot continue batch");
+	    xp = ctx->parser;
+	    continue;
+	}
+
+	if (code == 0)
+	{
+	    svg_discard_xml_document(ctx);
+	    code = gs_throw3(-1, "xml error: %s (line %lu, column %lu)",
+		    XML_ErrorString(XML_GetErrorCode(xp)),
+		    (unsigned long)XML_GetCurrentLineNumber(xp),
+		    (unsigned long)XML_GetCurrentColumnNumber(xp));
+	    if (ctx->batch)
+		svg_end_batch_document(ctx, code);
+	    return code;
+	}
+
+	ctx->batch_offset += len;
+	return 0;
     }
+
     return 0;
 }
 
@@ -201,19 +649,93 @@ svg_close_xml_parser(svg_context_t *ctx)
 		XML_ErrorString(XML_GetErrorCode(xp)),
 		XML_GetCurrentLineNumber(xp),
 		XML_GetCurrentColumnNumber(xp));
+	if (root)
+	    svg_free_item(ctx, root);
 	root = NULL;
     }
 
     ctx->root = NULL;
     ctx->head = NULL;
     ctx->error = NULL;
-    ctx->parser = NULL;
 
-    XML_ParserFree(xp);
+    svg_debug_xml_memory(ctx);
 
     return root;
 }
 
+/*
+ * Finish parsing a document in streaming mode. Everything has
+ * already been drawn by the time this returns.
+ */
+int
+svg_close_xml_stream(svg_context_t *ctx)
+{
+    XML_Parser xp = ctx->parser;
+    int code;
+
+    code = XML_Parse(xp, "", 0, 1); /* finish parsing */
+    if (code == 0)
+    {
+	code = gs_throw3(-1, "xml error: %s (line %lu, column %lu)",
+		XML_ErrorString(XML_GetErrorCode(xp)),
+		(unsigned long)XML_GetCurrentLineNumber(xp),
+		(unsigned long)XML_GetCurrentColumnNumber(xp));
+    }
+    else if (ctx->error)
+    {
+	code = gs_throw1(-1, "xml error: %s", ctx->error);
+    }
+    else if (ctx->stream_code < 0)
+    {
+	code = gs_rethrow(ctx->stream_code, "cannot draw streamed document");
+    }
+    else
+    {
+	code = 0;
+    }
+
+    svg_abort_stream(ctx);
+
+    ctx->root = NULL;
+    ctx->head = NULL;
+    ctx->error = NULL;
+
+    svg_debug_xml_memory(ctx);
+
+    return code;
+}
+
+/*
+ * Finish a batch job. All complete documents have been drawn by
+ * svg_feed_xml_parser; anything left over is an unterminated document.
+ * Returns the first error of the job.
+ */
+int
+svg_close_xml_batch(svg_context_t *ctx)
+{
+    XML_Parser xp = ctx->parser;
+    int code;
+
+    if (ctx->batch_pending)
+    {
+	XML_Parse(xp, "", 0, 1);
+	code = gs_throw3(-1, "xml error: %s (line %lu, column %lu)",
+		XML_ErrorString(XML_GetErrorCode(xp)),
+		(unsigned long)XML_GetCurrentLineNumber(xp),
+		(unsigned long)XML_GetCurrentColumnNumber(xp));
+	svg_discard_xml_document(ctx);
+	svg_end_batch_document(ctx, code);
+	if (ctx->batch_code >= 0)
+	    ctx->batch_code = code;
+    }
+
+    ctx->batch_pending = 0;
+
+    code = ctx->batch_code;
+    ctx->batch_code = 0;
+    return code;
+}
+
 svg_item_t *
 svg_next(svg_item_t *item)
 {
@@ -242,18 +764,36 @@ svg_att(svg_item_t *item, const char *att)
     return NULL;
 }
 
+int
+svg_tag_atom(svg_item_t *item)
+{
+    return item->tag;
+}
+
+/*
+ * Lookup for the attributes in svgatomlist.h. An element has few known
+ * attributes, so a scan of its slots compares small integers only.
+ */
+char *
+svg_att_atom(svg_item_t *item, int att)
+{
+    int i;
+    for (i = 0; i < item->nslots; i++)
+	if (item->slots[i].att == att)
+	    return item->atts[item->slots[i].value];
+    return NULL;
+}
+
+/*
+ * Free an item, its children and its following siblings. Since items
+ * live in the arena this releases everything parsed after the item,
+ * which must therefore be the root or the last subtree of the tree.
+ */
 void
 svg_free_item(svg_context_t *ctx, svg_item_t *item)
 {
-    svg_item_t *next;
-    while (item)
-    {
-	next = item->next;
-	if (item->down)
-	    svg_free_item(ctx, item->down);
-	svg_free(ctx, item);
-	item = next;
-    }
+    if (item)
+	svg_arena_release(ctx, item);
 }
 
 static void indent(int n)
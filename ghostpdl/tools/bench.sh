@@ -0,0 +1,328 @@
+#!/bin/sh
+# Timing runs for the SVG and XPS interpreters.  Run from the ghostpdl
+# directory after building the interpreters:
+#
+#   sh tools/bench.sh [<case>...]
+#
+# With no case named every case is run.  The inputs are made by
+# tools/mkbench.py the first time they are needed and kept in $BENCHDIR;
+# remove them to make them again.  For each run one line is printed:
+# the case, the variant, the real time in seconds, the peak resident
+# size in Mbytes and, where it applies, a rate, followed by any report
+# the interpreter printed (the SVG batch mode latencies, for example).
+#
+# The runs with worker processes are made with each count in $WORKERS.
+#
+# With STATS=1 each run is repeated with -Z| to print the statistics
+# the interpreters keep (cache hits and the like).  The SVG interpreter
+# only prints them when built for debugging: make svg-debug, and set
+# GSVG=./svg/debugobj/gsvg.
+
+BENCHDIR=${BENCHDIR:-/tmp/plbench}
+GSVG=${GSVG:-./svg/obj/gsvg}
+GXPS=${GXPS:-./xps/obj/gxps}
+PYTHON=${PYTHON:-python}
+RES=${RES:-72}
+OPTS="-dNOPAUSE -sDEVICE=ppmraw -r$RES -sOutputFile=/dev/null"
+WORKERS=${WORKERS:-"1 2 4 8 16 32"}
+
+CASES="svg-parse svg-atoms svg-paths svg-text svg-gradients\
+    svg-use svg-opacity svg-batch svg-workers xps-images\
+    xps-zip xps-pages xps-workers\
+    xps-huge xps-opacity xps-resources\
+    xps-tiles xps-text clist-bands\
+    clist-codec clist-threads"
+
+# input <kind> <file> [<n>]: make $BENCHDIR/<file> unless it is there,
+# and set INPUT to its name and COUNT to the number of items in it
+input() {
+    INPUT=$BENCHDIR/$2
+    if test ! -r $INPUT.count; then
+        $PYTHON tools/mkbench.py $1 $INPUT $3 > $INPUT.count ||
+            { rm -f $INPUT.count; exit 1; }
+    fi
+    COUNT=`cat $INPUT.count`
+}
+
+# run <case> <variant> <unit> <command>...: time one run of the command,
+# printing COUNT per second as the rate when the unit is not -
+run() {
+    name=$1; variant=$2; unit=$3; shift 3
+    result=`$PYTHON tools/mkbench.py time "$@" 2>$BENCHDIR/stderr`
+    if test $? != 0; then
+        echo "$name $variant: failed"
+        tail -5 $BENCHDIR/stderr
+        return 1
+    fi
+    set -- $result "$@"
+    secs=$1; mbytes=$2; shift 2
+    if test "$unit" = "-"; then
+        rate=""
+    else
+        rate=`echo $COUNT $secs | awk '{ r = $1 / ($2 > 0 ? $2 : 0.001); printf r < 100 ? "%.1f" : "%.0f", r }'`
+        rate="$rate $unit/s"
+    fi
+    printf "%-14s %-24s %8ss %6s MB  %s\n" $name "$variant" $secs $mbytes "$rate"
+    grep -E '^(svg|xps)[ :]' $BENCHDIR/stderr | sed 's/^/    /'
+    if test -n "$STATS"; then
+        exe=$1; shift
+        $exe -Z'|' "$@" 2>&1 >/dev/null | grep -E '^(svg|xps)[ :]' | sed 's/^/    /'
+    fi
+}
+
+# Parsing: a million small elements under the root of one document,
+# allocated from the item arena.
+bench_svg_parse() {
+    input svg-flat svg-flat.svg
+    run svg-parse default elements $GSVG $OPTS $INPUT
+}
+
+# Name lookups: shapes of every kind, each with a dozen attributes, most
+# of which the interpreter looks up; drawn at a low resolution so that
+# the time is spent per element rather than per pixel.
+bench_svg_atoms() {
+    input svg-attrs svg-attrs.svg
+    run svg-atoms default elements $GSVG $OPTS -r10 $INPUT
+}
+
+# Path data: 32 Mbytes of path data using every command and number
+# form, stroked with thin lines at a low resolution, so that the time
+# goes to tokenizing the data and building the paths.  Tiger, whose
+# paths are more typical, is run as well.
+bench_svg_paths() {
+    input svg-paths svg-paths.svg
+    run svg-paths generated KB $GSVG $OPTS -r10 $INPUT
+    COUNT=`wc -c < tools/tiger.svg | awk '{ print int($1 / 1024) }'`
+    run svg-paths tiger KB $GSVG $OPTS tools/tiger.svg
+}
+
+# Text: a table of 100,000 numbers and labels in four fonts, drawn as
+# glyph runs through the character cache.
+bench_svg_text() {
+    input svg-text svg-text.svg
+    run svg-text default glyphs $GSVG $OPTS $INPUT
+}
+
+# Gradients: 2,000 small shapes filled with linear and radial gradients
+# in every spread method, drawn with shadings.
+bench_svg_gradients() {
+    input svg-gradients svg-gradients.svg
+    run svg-gradients default fills $GSVG $OPTS $INPUT
+}
+
+# References: 100,000 <use> elements drawing a path, a group and a
+# symbol from <defs>, each compiled once into a display list.
+bench_svg_use() {
+    input svg-use svg-use.svg
+    run svg-use default uses $GSVG $OPTS $INPUT
+}
+
+# Opacity: 20 pages of 1,000 circles, all opaque or with one in a hundred
+# translucent.  The opaque pages are also drawn with the compositor
+# forced on, which is what every page cost before the document was
+# checked for transparency first.  A streamed document can't be checked
+# before it is drawn, so it always has the compositor.
+bench_svg_opacity() {
+    input svg-opaque svg-opaque.svg
+    pages="$INPUT $INPUT $INPUT $INPUT $INPUT"
+    pages="$pages $pages $pages $pages"
+    COUNT=20
+    run svg-opacity opaque pages $GSVG $OPTS $pages
+    run svg-opacity "opaque, compositor" pages $GSVG $OPTS -dSVGTransparency=true $pages
+    input svg-translucent svg-translucent.svg
+    pages="$INPUT $INPUT $INPUT $INPUT $INPUT"
+    pages="$pages $pages $pages $pages"
+    COUNT=20
+    run svg-opacity translucent pages $GSVG $OPTS $pages
+    run svg-opacity "translucent, streaming" pages $GSVG $OPTS -dSVGStreaming $pages
+}
+
+# Batch mode: 200 small documents on one command line, one in ten of
+# them larger, with and without -dSVGBatch.  The batch mode prints the
+# latency percentiles of the documents.
+bench_svg_batch() {
+    input svg-docs svg-docs
+    run svg-batch default docs $GSVG $OPTS $INPUT/*.svg
+    run svg-batch batch docs $GSVG $OPTS -dSVGBatch $INPUT/*.svg
+}
+
+# Worker processes: the 200 documents of svg-batch shared out among
+# worker processes.  The workers need page numbered output files, which
+# are removed after each run.
+bench_svg_workers() {
+    input svg-docs svg-docs
+    mkdir -p $BENCHDIR/out
+    for n in $WORKERS; do
+        run svg-workers "$n workers" docs $GSVG $OPTS -dNumWorkers=$n \
+            -sOutputFile=$BENCHDIR/out/%d.ppm $INPUT/*.svg
+        rm -f $BENCHDIR/out/*
+    done
+}
+
+# Images: 50 pages of twelve image tiles drawn from three images that
+# every page shares, with the decoded image cache and without it.
+bench_xps_images() {
+    input xps-images xps-images.xps
+    run xps-images default pages $GXPS $OPTS $INPUT
+    run xps-images "no image cache" pages $GXPS $OPTS -dXPSImageCacheSize=0 $INPUT
+}
+
+# Package reading: 500 pages of 1,000 triangles, in a package whose parts
+# are stored and in one whose parts are deflated, drawn at a low
+# resolution so that the time goes to reading the package.
+bench_xps_zip() {
+    input xps-stored xps-stored.xps
+    run xps-zip stored pages $GXPS $OPTS -r10 $INPUT
+    input xps-deflated xps-deflated.xps
+    run xps-zip deflated pages $GXPS $OPTS -r10 $INPUT
+}
+
+# Page selection: one page, and three pages spread over the document,
+# picked out of the 500 pages of xps-zip, against the whole document.
+bench_xps_pages() {
+    input xps-deflated xps-deflated.xps
+    run xps-pages "all pages" pages $GXPS $OPTS $INPUT
+    run xps-pages "page 250" - $GXPS $OPTS -dFirstPage=250 -dLastPage=250 $INPUT
+    run xps-pages "pages 1,250,500" - $GXPS $OPTS -sPageList=1,250,500 $INPUT
+}
+
+# Page workers: the 500 pages of xps-zip shared out among worker
+# processes, which need page numbered output files as svg-workers does.
+bench_xps_workers() {
+    input xps-deflated xps-deflated.xps
+    mkdir -p $BENCHDIR/out
+    for n in $WORKERS; do
+        run xps-workers "$n workers" pages $GXPS $OPTS -dNumWorkers=$n \
+            -sOutputFile=$BENCHDIR/out/%d.ppm $INPUT
+        rm -f $BENCHDIR/out/*
+    done
+}
+
+# A huge page: one FixedPage of 64 Mbytes, streamed through the parser
+# as it is inflated, and read whole by setting the stream threshold
+# above its size.  The peak size is the thing to compare.
+bench_xps_huge() {
+    input xps-huge xps-huge.xps
+    run xps-huge streamed MB $GXPS $OPTS $INPUT
+    run xps-huge whole MB $GXPS $OPTS -dXPSStreamSize=1000000000 $INPUT
+}
+
+# Transparency: 20 pages that use a remote resource dictionary holding a
+# translucent brush, which only one page draws with, at 150 dpi.  They
+# are drawn as they should be, and with the compositor turned off for
+# every page, which is as fast as the check for transparency can make
+# the opaque pages.
+bench_xps_opacity() {
+    input xps-remote xps-remote.xps
+    run xps-opacity default pages $GXPS $OPTS -r150 $INPUT
+    (XPS_DISABLE_TRANSPARENCY=1; export XPS_DISABLE_TRANSPARENCY
+     run xps-opacity "no transparency" pages $GXPS $OPTS -r150 $INPUT)
+}
+
+# Remote resources: 200 pages of the kind xps-opacity draws, at a low
+# resolution, with the cache of parsed remote dictionaries and without.
+bench_xps_resources() {
+    input xps-remote xps-remote-200.xps 200
+    run xps-resources default pages $GXPS $OPTS -r10 $INPUT
+    run xps-resources "no resource cache" pages $GXPS $OPTS -r10 \
+        -dXPSResourceCacheSize=0 $INPUT
+}
+
+# Tiles: 100 pages of 400 rectangles filled with the same few tiled
+# brushes.  With STATS=1 the tile cache shows how many of the fills
+# reused a tile.
+bench_xps_tiles() {
+    input xps-tiles xps-tiles.xps
+    run xps-tiles default pages $GXPS $OPTS $INPUT
+}
+
+# Text: 100 pages of a table of numbers and labels, 540 glyph runs
+# a page, in a font embedded in the package.
+bench_xps_text() {
+    input xps-text xps-text.xps
+    run xps-text default glyphs $GXPS $OPTS $INPUT
+}
+
+# Band heights: 100 pages whose marks are bunched in one strip, banded at
+# 300 dpi, with the band height fixed and adapted to the marks.
+bench_clist_bands() {
+    input xps-sparse xps-sparse.xps
+    for adapt in false true; do
+        run clist-bands "AdaptiveBandHeight=$adapt" pages $GXPS $OPTS -r300 \
+            -dMaxBitmap=10000 -dAdaptiveBandHeight=$adapt $INPUT
+    done
+}
+
+# Band list codecs: the pages of xps-text and xps-tiles banded at 300 dpi
+# with each BandListCompressor, and 0, 1 and 3 rendering threads, which
+# each decompress the bands they render.  Under -Z: the band list prints
+# how much the codec compressed and decompressed and the time it took;
+# below each run are the sum of the band list sizes, raw and compressed,
+# and the encode and decode rates over the raw size.  A band list is
+# only compressed once it passes 500 Mbytes, so gxps has to be built
+# with -DTEST_BAND_LIST_COMPRESSION in XCFLAGS, which compresses every
+# band list; the case stops if nothing was compressed.
+bench_clist_codec() {
+    for kind in xps-text xps-tiles; do
+        input $kind $kind.xps
+        COUNT=20
+        for threads in 0 1 3; do
+            for codec in 0 1; do
+                run clist-codec "$kind c=$codec t=$threads" pages $GXPS $OPTS -Z: -r300 \
+                    -dMaxBitmap=10000 -dBandListCompressor=$codec \
+                    -dNumRenderingThreads=$threads -dLastPage=20 $INPUT &&
+                    codec_report
+            done
+        done
+    done
+}
+
+# Render threads: 40 pages of xps-text banded at 300 dpi with 0, 1 and 3
+# rendering threads, which are kept from band to band and page to page
+# and take whichever band is next.  With -Z: the band list prints each
+# thread's share of the bands.  Each count is also run with one and two
+# pages printed in the background while the next is written.
+bench_clist_threads() {
+    input xps-text xps-text.xps
+    COUNT=40
+    for threads in 0 1 3; do
+        for inflight in 0 1 2; do
+            run clist-threads "t=$threads pages=$inflight" pages $GXPS $OPTS -r300 \
+                -dMaxBitmap=10000 -dNumRenderingThreads=$threads \
+                -dMaxPagesInFlight=$inflight -dLastPage=40 $INPUT
+        done
+    done
+}
+
+# codec_report: sum the band list codec lines of the last run
+codec_report() {
+    awk '
+    /^% Band list codec .*: compressed/ { raw += $7; packed += $10; wus += $12 }
+    /^% Band list codec .*: decompressed/ { unpacked += $7; rus += $10 }
+    END {
+        if (raw == 0) {
+            print "clist-codec: no band list was compressed; build gxps with"
+            print "XCFLAGS=-DTEST_BAND_LIST_COMPRESSION to compress every one"
+            exit 1
+        }
+        mb = 1024 * 1024
+        printf "    band lists %.1f MB, compressed %.1f MB (%.0f%%)\n",
+            raw / mb, packed / mb, 100 * packed / raw
+        printf "    encode %.0f MB/s, decode %.0f MB/s\n",
+            raw / mb / (wus > 0 ? wus : 1) * 1e6,
+            unpacked / mb / (rus > 0 ? rus : 1) * 1e6
+    }' $BENCHDIR/stderr || exit 1
+}
+
+if test ! -x "$GSVG" && test ! -x "$GXPS"; then
+    echo "build the interpreters first, or set GSVG and GXPS"
+    exit 1
+fi
+mkdir -p $BENCHDIR || exit 1
+test $# = 0 && set -- $CASES
+for c in "$@"; do
+    case " $CASES " in
+    *" $c "*) bench_`echo $c | tr - _` ;;
+    *) echo "unknown case $c, the cases are: $CASES"; exit 1 ;;
+    esac
+done
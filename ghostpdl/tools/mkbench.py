@@ -0,0 +1,515 @@
+#!/usr/bin/env python
+
+# Makes the input files for tools/bench.sh, and times the runs.
+#
+#   mkbench.py <kind> <output> [<n>]
+#
+# writes a generated file of the given kind and prints the number of
+# items in it (elements, glyphs, pages or bytes, as the kind says), which
+# bench.sh uses to turn a run time into a rate.  The files are made from
+# a fixed seed, so the same command always makes the same file.
+#
+#   mkbench.py time <command> [<arg>...]
+#
+# runs a command with its output thrown away and prints the real time it
+# took in seconds and its peak resident size in Mbytes.  Unix only.
+
+import sys, os, random, time, struct, zlib, zipfile
+
+# ---------------- SVG ----------------
+
+SVG_HEAD = '<?xml version="1.0" encoding="utf-8"?>\n' \
+    '<svg xmlns="http://www.w3.org/2000/svg" ' \
+    'xmlns:xlink="http://www.w3.org/1999/xlink" ' \
+    'width="612" height="792" viewBox="0 0 612 792">\n'
+
+def svg_flat(out, n):
+    """n small shapes as direct children of the root."""
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    for i in range(n):
+        x = (i * 37) % 600
+        y = (i * 53) % 780
+        f.write('<rect x="%d" y="%d" width="4" height="3" fill="#%06x"/>\n' %
+                (x, y, (i * 2654435761) & 0xffffff))
+    f.write('</svg>\n')
+    f.close()
+    return n
+
+def svg_attrs(out, n):
+    """n shapes of every kind, each with a dozen presentation attributes,
+    in groups of ten."""
+    shapes = [
+        '<rect x="%d" y="%d" width="6" height="4" rx="1" ry="1"',
+        '<circle cx="%d" cy="%d" r="3"',
+        '<ellipse cx="%d" cy="%d" rx="4" ry="2"',
+        '<line x1="%d" y1="%d" x2="610" y2="790"',
+        '<polyline points="%d,%d 20,30 40,10 60,30"',
+        '<path d="M %d %d l 5 0 l 0 5 z"',
+    ]
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    for i in range(n):
+        if i % 10 == 0:
+            f.write('<g stroke-linecap="round" stroke-miterlimit="4">\n')
+        shape = shapes[i % len(shapes)] % ((i * 37) % 600, (i * 53) % 780)
+        f.write('%s fill="#%06x" fill-rule="evenodd" stroke="none" '
+                'stroke-width="0.5" stroke-linejoin="miter" '
+                'stroke-dasharray="none" stroke-dashoffset="0" '
+                'visibility="visible" display="inline" id="e%d" '
+                'class="c%d" data-unknown="x"/>\n' %
+                (shape, (i * 2654435761) & 0xffffff, i, i % 7))
+        if i % 10 == 9 or i == n - 1:
+            f.write('</g>\n')
+    f.write('</svg>\n')
+    f.close()
+    return n
+
+def svg_paths(out, n):
+    """Paths with long data strings using every command and number form,
+    about n Kbytes of path data in all."""
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    f.write('<g fill="none" stroke="#203040" stroke-width="0.2">\n')
+    total = 0
+    while total < n * 1024:
+        x = random.uniform(0, 600)
+        y = random.uniform(0, 780)
+        d = ['M%.3f,%.3f' % (x, y)]
+        for k in range(200):
+            r = lambda: random.uniform(-20, 20)
+            c = k % 10
+            if c == 0: d.append('L %.2f %.2f' % (x + r(), y + r()))
+            elif c == 1: d.append('l%.1f-%.1f' % (abs(r()), abs(r())))
+            elif c == 2: d.append('C%.2f,%.2f %.2f,%.2f %.2f,%.2f' % (x + r(), y + r(), x + r(), y + r(), x + r(), y + r()))
+            elif c == 3: d.append('s%.3e %.3e,%.2f %.2f' % (r(), r(), r(), r()))
+            elif c == 4: d.append('Q %.2f %.2f %.2f %.2f' % (x + r(), y + r(), x + r(), y + r()))
+            elif c == 5: d.append('t.5-.25')
+            elif c == 6: d.append('H%.2f' % (x + r()))
+            elif c == 7: d.append('v%.2f' % r())
+            elif c == 8: d.append('c1,2,3,4 %.2f,%.2f' % (r(), r()))
+            else: d.append('z m1,1')
+        d = ' '.join(d)
+        f.write('<path d="%s"/>\n' % d)
+        total += len(d)
+    f.write('</g>\n</svg>\n')
+    f.close()
+    return total // 1024
+
+def svg_text(out, n):
+    """A table of n text cells in a few fonts; the rows wrap round the
+    page, so the glyphs are drawn over one another."""
+    fonts = ['font-family="Helvetica"', 'font-family="Times" font-weight="bold"',
+             'font-family="Courier"', 'font-family="Arial" font-style="italic"']
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    glyphs = 0
+    for i in range(n):
+        row = i // 6
+        col = i % 6
+        if col == 0:
+            s = 'Item %d %s' % (row, random.choice(['net', 'gross', 'total', 'tax']))
+        else:
+            s = '%.2f' % random.uniform(-1e5, 1e6)
+        f.write('<text x="%d" y="%d" %s font-size="9">%s</text>\n' %
+                (6 + col * 100, 12 + (row % 78) * 10, fonts[row % len(fonts)], s))
+        glyphs += len(s)
+    f.write('</svg>\n')
+    f.close()
+    return glyphs
+
+def svg_gradients(out, n):
+    """n shapes filled with linear and radial gradients, in every spread
+    method and both unit systems."""
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    f.write('<defs>\n'
+            '<linearGradient id="l0"><stop offset="0" stop-color="red"/>'
+            '<stop offset="0.5" stop-color="orange"/>'
+            '<stop offset="1" stop-color="blue"/></linearGradient>\n'
+            '<linearGradient id="l1" xlink:href="#l0" x2="0.25" spreadMethod="reflect"/>\n'
+            '<linearGradient id="l2" xlink:href="#l0" x2="0.2" spreadMethod="repeat" '
+            'gradientTransform="rotate(30)"/>\n'
+            '<linearGradient id="l3" xlink:href="#l0" gradientUnits="userSpaceOnUse" '
+            'x1="0" y1="0" x2="612" y2="792"/>\n'
+            '<radialGradient id="r0"><stop offset="0" stop-color="white"/>'
+            '<stop offset="1" stop-color="green" stop-opacity="1"/></radialGradient>\n'
+            '<radialGradient id="r1" xlink:href="#r0" r="0.2" fx="0.4" fy="0.4" '
+            'spreadMethod="repeat"/>\n'
+            '<radialGradient id="r2" xlink:href="#r0" gradientUnits="userSpaceOnUse" '
+            'cx="300" cy="400" r="200"/>\n'
+            '</defs>\n')
+    ids = ['l0', 'l1', 'l2', 'l3', 'r0', 'r1', 'r2']
+    for i in range(n):
+        f.write('<rect x="%d" y="%d" width="40" height="30" fill="url(#%s)"/>\n' %
+                ((i * 37) % 570, (i * 53) % 760, ids[i % len(ids)]))
+    f.write('</svg>\n')
+    f.close()
+    return n
+
+def svg_use(out, n):
+    """n references to a few shapes and symbols in <defs>, which are
+    compiled once and replayed at each <use>."""
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    f.write('<defs>\n'
+            '<path id="tri" d="M 0 0 l 12 0 l -6 10 z" fill="orange" stroke="black"/>\n'
+            '<g id="pair"><circle cx="4" cy="4" r="4" fill="blue"/>'
+            '<rect x="6" y="0" width="8" height="8" fill="green" opacity="0.9"/></g>\n'
+            '<symbol id="star" viewBox="0 0 100 100">'
+            '<path d="M 50 0 L 61 35 L 98 35 L 68 57 L 79 91 L 50 70 L 21 91 '
+            'L 32 57 L 2 35 L 39 35 z" fill="gold" stroke="red" stroke-width="4"/>'
+            '</symbol>\n'
+            '</defs>\n')
+    ids = ['tri', 'pair', 'star']
+    for i in range(n):
+        ref = ids[i % len(ids)]
+        size = ' width="14" height="14"' if ref == 'star' else ''
+        f.write('<use xlink:href="#%s" x="%d" y="%d"%s/>\n' %
+                (ref, (i * 37) % 596, (i * 53) % 778, size))
+    f.write('</svg>\n')
+    f.close()
+    return n
+
+def svg_shapes(out, n, opacity):
+    f = open(out, "w")
+    f.write(SVG_HEAD)
+    for i in range(n):
+        f.write('<circle cx="%d" cy="%d" r="12" fill="#%06x" stroke="black"%s/>\n' %
+                ((i * 37) % 600, (i * 53) % 780, (i * 2654435761) & 0xffffff,
+                 ' opacity="0.5"' if opacity and i % 100 == 0 else ''))
+    f.write('</svg>\n')
+    f.close()
+    return n
+
+def svg_opaque(out, n):
+    """n circles, all opaque."""
+    return svg_shapes(out, n, False)
+
+def svg_translucent(out, n):
+    """n circles, one in a hundred of them translucent."""
+    return svg_shapes(out, n, True)
+
+def svg_docs(out, n):
+    """A directory of n small documents, one in ten of them larger."""
+    if not os.path.isdir(out):
+        os.mkdir(out)
+    for i in range(n):
+        f = open(os.path.join(out, "%04d.svg" % i), "w")
+        f.write(SVG_HEAD)
+        for k in range(2000 if i % 10 == 0 else 50):
+            f.write('<path d="M %d %d l 40 0 l -20 30 z" fill="#%06x" stroke="black"/>\n' %
+                    ((k * 37) % 570, (k * 53) % 760, ((i + k) * 2654435761) & 0xffffff))
+        f.write('<text x="20" y="770" font-family="Helvetica" font-size="12">'
+                'Document %d</text>\n</svg>\n' % i)
+        f.close()
+    return n
+
+# ---------------- XPS ----------------
+
+XPS_CONTENT_TYPES = '<?xml version="1.0" encoding="utf-8"?>' \
+    '<Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">' \
+    '<Default Extension="rels" ContentType="application/vnd.openxmlformats-package.relationships+xml"/>' \
+    '<Default Extension="fdseq" ContentType="application/vnd.ms-package.xps-fixeddocumentsequence+xml"/>' \
+    '<Default Extension="fdoc" ContentType="application/vnd.ms-package.xps-fixeddocument+xml"/>' \
+    '<Default Extension="fpage" ContentType="application/vnd.ms-package.xps-fixedpage+xml"/>' \
+    '<Default Extension="dict" ContentType="application/vnd.ms-package.xps-resourcedictionary+xml"/>' \
+    '<Default Extension="png" ContentType="image/png"/>' \
+    '<Default Extension="jpg" ContentType="image/jpeg"/>' \
+    '<Default Extension="ttf" ContentType="application/vnd.ms-opentype"/>' \
+    '</Types>'
+
+XPS_RELS = '<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">' \
+    '<Relationship Type="http://schemas.microsoft.com/xps/2005/06/fixedrepresentation" ' \
+    'Target="/FixedDocumentSequence.fdseq" Id="R0"/></Relationships>'
+
+XPS_SEQ = '<FixedDocumentSequence xmlns="http://schemas.microsoft.com/xps/2005/06">' \
+    '<DocumentReference Source="/Documents/1/FixedDocument.fdoc"/></FixedDocumentSequence>'
+
+XPS_PAGE_HEAD = '<FixedPage xmlns="http://schemas.microsoft.com/xps/2005/06" ' \
+    'xmlns:x="http://schemas.microsoft.com/winfx/2006/xaml" ' \
+    'Width="816" Height="1056" xml:lang="en">'
+
+def xps_package(out, pages, parts, compression=zipfile.ZIP_DEFLATED):
+    """Writes a package of one document.  pages is a list of FixedPage
+    bodies, or a pair of a function returning the body of a page and
+    the number of pages; parts is a list of (name, data) for the resources, named
+    relative to Documents/1."""
+    if isinstance(pages, tuple):
+        make_page, npages = pages
+    else:
+        make_page, npages = (lambda i: pages[i]), len(pages)
+    z = zipfile.ZipFile(out, "w", compression)
+    z.writestr("[Content_Types].xml", XPS_CONTENT_TYPES)
+    z.writestr("_rels/.rels", XPS_RELS)
+    z.writestr("FixedDocumentSequence.fdseq", XPS_SEQ)
+    z.writestr("Documents/1/FixedDocument.fdoc",
+               '<FixedDocument xmlns="http://schemas.microsoft.com/xps/2005/06">' +
+               "".join('<PageContent Source="/Documents/1/Pages/%d.fpage"/>' % (i + 1)
+                       for i in range(npages)) +
+               '</FixedDocument>')
+    for name, data in parts:
+        z.writestr("Documents/1/" + name, data)
+    for i in range(npages):
+        z.writestr("Documents/1/Pages/%d.fpage" % (i + 1),
+                   XPS_PAGE_HEAD + make_page(i) + '</FixedPage>')
+    z.close()
+
+def png(w, h, alpha):
+    """An RGB or RGBA PNG image of a colour ramp."""
+    def chunk(t, d):
+        return struct.pack(">I", len(d)) + t + d + \
+            struct.pack(">I", zlib.crc32(t + d) & 0xffffffff)
+    raw = bytearray()
+    for y in range(h):
+        raw.append(0)
+        for x in range(w):
+            raw.extend([x * 255 // w, y * 255 // h, (x * y) & 255])
+            if alpha:
+                raw.append((x + y) & 255)
+    return b"\x89PNG\r\n\x1a\n" + \
+        chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, alpha and 6 or 2, 0, 0, 0)) + \
+        chunk(b"IDAT", zlib.compress(bytes(raw))) + chunk(b"IEND", b"")
+
+def xps_images(out, n):
+    """n pages of twelve image tiles each, drawn from three images (two
+    PNG, one JPEG) that every page shares."""
+    colorcirc = os.path.join(os.path.dirname(os.path.abspath(__file__)), "colorcirc.xps")
+    jpg = zipfile.ZipFile(colorcirc).read("Documents/1/Metadata/Page1_Thumbnail.JPG")
+    images = [("a.png", 200, 150), ("b.png", 300, 300), ("c.jpg", 256, 256)]
+    def page(i):
+        body = ""
+        for k in range(12):
+            name, w, h = images[(i + k) % 3]
+            x = 20 + (k % 4) * 190
+            y = 20 + (k // 4) * 320
+            body += '<Path Data="M %d,%d L %d,%d %d,%d %d,%d Z"><Path.Fill>' \
+                '<ImageBrush ImageSource="../Resources/%s" Viewbox="0,0,%d,%d" ' \
+                'ViewboxUnits="Absolute" Viewport="%d,%d,180,300" ViewportUnits="Absolute"/>' \
+                '</Path.Fill></Path>' % (x, y, x + 180, y, x + 180, y + 300, x, y + 300,
+                                         name, w, h, x, y)
+        return body
+    xps_package(out, (page, n),
+                [("Resources/a.png", png(200, 150, True)),
+                 ("Resources/b.png", png(300, 300, False)),
+                 ("Resources/c.jpg", jpg)])
+    return n
+
+def xps_paths_page(i):
+    body = []
+    for k in range(1000):
+        x = (k * 37) % 760
+        y = (k * 53 + i) % 1000
+        body.append('<Path Data="M %d,%d L %d,%d L %d,%d Z" Fill="#ff%06x"/>' %
+                    (x, y, x + 40, y, x + 20, y + 30, ((i + k) * 2654435761) & 0xffffff))
+    return "".join(body)
+
+def xps_stored(out, n):
+    """n pages of 1,000 triangles, with the parts stored uncompressed."""
+    xps_package(out, (xps_paths_page, n), [], zipfile.ZIP_STORED)
+    return n
+
+def xps_deflated(out, n):
+    """The pages of xps-stored, with the parts deflated."""
+    xps_package(out, (xps_paths_page, n), [])
+    return n
+
+def xps_huge(out, n):
+    """One page of about n Mbytes of small stroked triangles, sharing a
+    brush from the page resources, with a translucent one now and
+    then."""
+    body = ['<FixedPage.Resources><ResourceDictionary>'
+            '<SolidColorBrush x:Key="B" Color="#ff0000ff"/>'
+            '</ResourceDictionary></FixedPage.Resources>']
+    total = 0
+    k = 0
+    while total < n * 1024 * 1024:
+        x = random.randint(0, 800)
+        y = random.randint(0, 1000)
+        s = '<Path Data="M %d,%d L %d,%d L %d,%d Z" Fill="#%06x" ' \
+            'Stroke="{StaticResource B}" StrokeThickness="0.5"/>\n' % \
+            (x, y, x + 10, y, x + 5, y + 8, random.randint(0, 0xffffff))
+        if k % 50000 == 49999:
+            s += '<Canvas Opacity="0.8"><Path Data="M 0,0 L 100,0 L 50,80 Z" ' \
+                'Fill="#80ff0000"/></Canvas>\n'
+        body.append(s)
+        total += len(s)
+        k += 1
+    xps_package(out, ["".join(body)], [])
+    return n
+
+def xps_remote(out, n):
+    """n pages of 200 triangles drawn with brushes and geometry from a
+    remote resource dictionary that every page uses.  The dictionary
+    also has a translucent brush, which only page 3 draws with."""
+    shared = '<ResourceDictionary xmlns="http://schemas.microsoft.com/xps/2005/06" ' \
+        'xmlns:x="http://schemas.microsoft.com/winfx/2006/xaml">' \
+        '<SolidColorBrush x:Key="Red" Color="#ffcc2200"/>' \
+        '<SolidColorBrush x:Key="Blue" Color="#ff0033cc"/>' \
+        '<LinearGradientBrush x:Key="Grad" MappingMode="Absolute" StartPoint="0,0" EndPoint="800,0">' \
+        '<LinearGradientBrush.GradientStops><GradientStop Color="#ff00ff00" Offset="0"/>' \
+        '<GradientStop Color="#ff0000ff" Offset="1"/></LinearGradientBrush.GradientStops>' \
+        '</LinearGradientBrush>' \
+        '<SolidColorBrush x:Key="Glass" Color="#80ffffff"/>' \
+        '<PathGeometry x:Key="Tri" Figures="M 0,0 L 40,0 L 20,30 Z"/>' + \
+        "".join('<PathGeometry x:Key="G%d" Figures="M 0,0 L %d,0 L 20,30 Z"/>' % (k, k)
+                for k in range(200)) + \
+        '</ResourceDictionary>'
+    def page(p):
+        body = ['<FixedPage.Resources><ResourceDictionary Source="../Resources/shared.dict"/>'
+                '</FixedPage.Resources>'
+                '<Path Data="M 0,0 L 816,0 L 816,300 L 0,300 Z" Fill="{StaticResource Grad}"/>']
+        for i in range(200):
+            body.append('<Canvas RenderTransform="1,0,0,1,%d,%d"><Path Data="{StaticResource Tri}" '
+                        'Fill="{StaticResource %s}" Stroke="{StaticResource Blue}" '
+                        'StrokeThickness="1"/></Canvas>' %
+                        ((i * 37) % 760, 320 + (i * 53) % 700, i % 2 and "Red" or "Blue"))
+        if p == 2:
+            body.append('<Path Data="M 100,100 L 700,100 L 700,900 L 100,900 Z" '
+                        'Fill="{StaticResource Glass}"/>')
+        return "".join(body)
+    xps_package(out, (page, n), [("Resources/shared.dict", shared)])
+    return n
+
+def xps_tiles(out, n):
+    """n pages of 400 rectangles filled with the same tiled visual and
+    image brushes, from the page resources, plus one inline brush that
+    is the same on every page."""
+    visual = '<VisualBrush x:Key="Dots" TileMode="FlipXY" Viewbox="0,0,20,20" ' \
+        'ViewboxUnits="Absolute" Viewport="0,0,20,20" ViewportUnits="Absolute">' \
+        '<VisualBrush.Visual><Canvas>' \
+        '<Path Data="M 2,2 L 18,2 L 10,18 Z" Fill="{StaticResource Red}"/>' \
+        '<Path Data="M 0,10 L 20,10" Stroke="#ff000000" StrokeThickness="1"/>' \
+        '</Canvas></VisualBrush.Visual></VisualBrush>'
+    image = '<ImageBrush x:Key="Img" ImageSource="../Resources/tile.png" TileMode="Tile" ' \
+        'Viewbox="0,0,64,64" ViewboxUnits="Absolute" Viewport="0,0,24,24" ' \
+        'ViewportUnits="Absolute"/>'
+    def page(p):
+        body = ['<FixedPage.Resources><ResourceDictionary>'
+                '<SolidColorBrush x:Key="Red" Color="#ffcc2200"/>' + visual + image +
+                '</ResourceDictionary></FixedPage.Resources>']
+        for i in range(400):
+            body.append('<Path Data="M %d,%d l 60,0 l 0,40 l -60,0 Z" Fill="{StaticResource %s}"/>' %
+                        (10 + (i * 37) % 740, 10 + (i * 53) % 980, i % 2 and "Img" or "Dots"))
+        body.append('<Path Data="M 400,400 L 700,400 L 700,700 Z"><Path.Fill>'
+                    '<VisualBrush TileMode="Tile" Viewbox="0,0,10,10" ViewboxUnits="Absolute" '
+                    'Viewport="0,0,10,10" ViewportUnits="Absolute" Visual="{StaticResource Dots}"/>'
+                    '</Path.Fill></Path>')
+        return "".join(body)
+    xps_package(out, (page, n), [("Resources/tile.png", png(64, 64, False))])
+    return n
+
+def xps_text(out, n):
+    """n pages of a table of 90 rows of six cells each, in an embedded
+    font.  Some runs give the advances with Indices, some give glyph
+    indices and cluster maps too, and the rest only a UnicodeString."""
+    fonts = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "urwfonts")
+    font = open(os.path.join(fonts, "NimbusSanL-Regu.ttf"), "rb").read()
+    words = ("Revenue Operating income Net margin Total assets Liabilities "
+             "EBITDA Q1 Q2 Q3 Q4 forecast variance (USD) growth").split()
+    glyphs = [0]
+    def page(p):
+        body = []
+        for row in range(90):
+            y = 20 + row * 11.5
+            for col in range(6):
+                x = 20 + col * 130
+                if col == 0:
+                    s = " ".join(random.choice(words) for k in range(3))[:24]
+                else:
+                    s = "%.2f" % random.uniform(-1e6, 1e7)
+                glyphs[0] += len(s)
+                if row % 3 == 0:
+                    idx = "(1:1)36,55.5e0;37,+45,-3,2.5;,1E1;;,+.5,-.25;" + \
+                        ";".join(",%.3f" % (40 + k) for k in range(len(s) - 5))
+                    idx = ' Indices="%s"' % idx
+                elif (row + col) % 2:
+                    idx = ' Indices="%s"' % ";".join(",%.2f" % random.uniform(40, 60) for c in s)
+                else:
+                    idx = ""
+                body.append('<Glyphs Fill="#ff000000" FontUri="../Resources/sans.ttf" '
+                            'FontRenderingEmSize="9.5" OriginX="%.2f" OriginY="%.2f"%s '
+                            'UnicodeString="%s"/>' % (x, y, idx, s))
+        return "".join(body)
+    xps_package(out, (page, n), [("Resources/sans.ttf", font)])
+    return glyphs[0]
+
+def xps_sparse(out, n):
+    """n pages with 400 triangles bunched in one horizontal strip, which
+    moves down the page from page to page; the rest is blank."""
+    def page(p):
+        body = []
+        y0 = 60 + (p % 3) * 300
+        for i in range(400):
+            x = (i * 37) % 760
+            y = y0 + (i * 13) % 120
+            body.append('<Path Data="M %d,%d L %d,%d L %d,%d Z" Fill="#ff%02x3366" '
+                        'Stroke="#ff000000" StrokeThickness="0.5"/>' %
+                        (x, y, x + 40, y, x + 20, y + 30, (i * 7) % 256))
+        return "".join(body)
+    xps_package(out, (page, n), [])
+    return n
+
+KINDS = {
+    "svg-flat" : (svg_flat, 1000000),
+    "svg-attrs" : (svg_attrs, 300000),
+    "svg-paths" : (svg_paths, 32768),
+    "svg-text" : (svg_text, 100000),
+    "svg-gradients" : (svg_gradients, 2000),
+    "svg-use" : (svg_use, 100000),
+    "svg-opaque" : (svg_opaque, 1000),
+    "svg-translucent" : (svg_translucent, 1000),
+    "svg-docs" : (svg_docs, 200),
+    "xps-images" : (xps_images, 50),
+    "xps-stored" : (xps_stored, 500),
+    "xps-deflated" : (xps_deflated, 500),
+    "xps-huge" : (xps_huge, 64),
+    "xps-remote" : (xps_remote, 20),
+    "xps-tiles" : (xps_tiles, 100),
+    "xps-text" : (xps_text, 100),
+    "xps-sparse" : (xps_sparse, 100),
+}
+
+# ---------------- timing ----------------
+
+def time_command(argv):
+    import resource
+    devnull = open(os.devnull, "w")
+    start = time.time()
+    pid = os.fork()
+    if pid == 0:
+        os.dup2(devnull.fileno(), 1)
+        try:
+            os.execvp(argv[0], argv)
+        finally:
+            os._exit(127)
+    status = os.waitpid(pid, 0)[1]
+    elapsed = time.time() - start
+    usage = resource.getrusage(resource.RUSAGE_CHILDREN)
+    # ru_maxrss is in kbytes on Linux, in bytes on Mac OS X
+    rss = usage.ru_maxrss
+    if sys.platform == "darwin":
+        rss = rss // 1024
+    print("%.3f %d" % (elapsed, rss // 1024))
+    if status != 0:
+        sys.stderr.write("%s failed with status %d\n" % (argv[0], status))
+        return 1
+    return 0
+
+def main(argv):
+    if len(argv) > 2 and argv[1] == "time":
+        return time_command(argv[2:])
+    if len(argv) < 3 or argv[1] not in KINDS:
+        sys.stderr.write("usage: mkbench.py <kind> <output> [<n>]\n"
+                         "       mkbench.py time <command> [<arg>...]\n"
+                         "kinds: %s\n" % " ".join(sorted(KINDS)))
+        return 1
+    make, n = KINDS[argv[1]]
+    if len(argv) > 3:
+        n = int(argv[3])
+    random.seed(1)
+    print(make(argv[2], n))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,58 @@
+#!/bin/sh
+# Check the SVG interpreter's painting defaults.  Each document is drawn
+# and compared with a second one that spells out what the default should
+# be.  Run from the ghostpdl directory after building the interpreter:
+#
+#   sh tools/svg_check.sh
+
+EXE=${GSVG:-./svg/obj/gsvg}
+OPTS="-dNOPAUSE -sDEVICE=pgmraw -r72"
+TMP=${TMPDIR:-/tmp}/svg_check.$$
+
+if test ! -x $EXE; then
+  echo "Couldn't find the interpreter '$EXE'"
+  exit 1
+fi
+mkdir -p $TMP || exit 1
+trap 'rm -rf $TMP' 0
+
+# check <name> <body> <expected body>: draw both bodies on a 100x100
+# page and compare the results
+all=0
+failed=0
+check() {
+ for f in a b; do
+  if test $f = a; then body=$2; else body=$3; fi
+  echo "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">$body</svg>" > $TMP/$f.svg
+  $EXE $OPTS -sOutputFile=$TMP/$f.pgm $TMP/$f.svg > /dev/null 2>&1
+ done
+ all=`expr $all + 1`
+ echo -n "$1: "
+ if test -s $TMP/a.pgm && cmp -s $TMP/a.pgm $TMP/b.pgm; then
+  echo "ok"
+ else
+  echo "DIFFERS"
+  failed=`expr $failed + 1`
+ fi
+ rm -f $TMP/a.pgm $TMP/b.pgm
+}
+
+check "unfilled rect is black" \
+ '<rect x="10" y="20" width="30" height="40"/>' \
+ '<rect x="10" y="20" width="30" height="40" fill="black"/>'
+check "unfilled rect in a group is black" \
+ '<g><rect x="10" y="20" width="30" height="40"/></g>' \
+ '<rect x="10" y="20" width="30" height="40" fill="black"/>'
+check "group fill is inherited" \
+ '<g fill="#808080"><rect x="10" y="20" width="30" height="40"/></g>' \
+ '<rect x="10" y="20" width="30" height="40" fill="#808080"/>'
+check "fill none draws nothing" \
+ '<rect x="10" y="20" width="30" height="40" fill="none"/>' \
+ ''
+
+# report
+if test $failed -gt 0; then
+ echo "differences in $failed of $all checks"
+ exit 1
+fi
+echo "all checks match"
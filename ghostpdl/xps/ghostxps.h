@@ -131,11 +131,66 @@ typedef struct xps_hash_table_s xps_hash_table_t;
 xps_hash_table_t *xps_hash_new(xps_context_t *ctx);
 void *xps_hash_lookup(xps_hash_table_t *table, char *key);
 int xps_hash_insert(xps_context_t *ctx, xps_hash_table_t *table, char *key, void *value);
+void *xps_hash_remove(xps_hash_table_t *table, char *key);
 void xps_hash_free(xps_context_t *ctx, xps_hash_table_t *table,
     void (*free_key)(xps_context_t *ctx, void *),
     void (*free_value)(xps_context_t *ctx, void *));
 void xps_hash_debug(xps_hash_table_t *table);
 
+/*
+ * Interned strings. Element names, attribute names and resource keys
+ * are atoms, so equal names are the same pointer. The element names
+ * below are the atoms for those names.
+ */
+
+typedef struct xps_atom_table_s xps_atom_table_t;
+
+int xps_init_atoms(xps_context_t *ctx);
+void xps_free_atoms(xps_context_t *ctx);
+char *xps_atom(xps_context_t *ctx, const char *s);
+char *xps_lookup_atom(xps_context_t *ctx, const char *s);
+
+extern const char xps_ArcSegment[];
+extern const char xps_Canvas[];
+extern const char xps_Canvas_Clip[];
+extern const char xps_Canvas_OpacityMask[];
+extern const char xps_Canvas_RenderTransform[];
+extern const char xps_Canvas_Resources[];
+extern const char xps_FixedPage[];
+extern const char xps_FixedPage_Resources[];
+extern const char xps_Glyphs[];
+extern const char xps_Glyphs_Clip[];
+extern const char xps_Glyphs_Fill[];
+extern const char xps_Glyphs_OpacityMask[];
+extern const char xps_Glyphs_RenderTransform[];
+extern const char xps_GradientStop[];
+extern const char xps_ImageBrush[];
+extern const char xps_ImageBrush_Transform[];
+extern const char xps_LinearGradientBrush[];
+extern const char xps_LinearGradientBrush_GradientStops[];
+extern const char xps_LinearGradientBrush_Transform[];
+extern const char xps_MatrixTransform[];
+extern const char xps_Path[];
+extern const char xps_Path_Clip[];
+extern const char xps_Path_Data[];
+extern const char xps_Path_Fill[];
+extern const char xps_Path_OpacityMask[];
+extern const char xps_Path_RenderTransform[];
+extern const char xps_Path_Stroke[];
+extern const char xps_PathFigure[];
+extern const char xps_PathGeometry_Transform[];
+extern const char xps_PolyBezierSegment[];
+extern const char xps_PolyLineSegment[];
+extern const char xps_PolyQuadraticBezierSegment[];
+extern const char xps_RadialGradientBrush[];
+extern const char xps_RadialGradientBrush_GradientStops[];
+extern const char xps_RadialGradientBrush_Transform[];
+extern const char xps_ResourceDictionary[];
+extern const char xps_SolidColorBrush[];
+extern const char xps_VisualBrush[];
+extern const char xps_VisualBrush_Transform[];
+extern const char xps_VisualBrush_Visual[];
+
 /*
  * Container parts.
  */
@@ -148,10 +203,14 @@ struct xps_part_s
     int size;
     int cap;
     byte *data;
+    int mapped; /* data is a view into the mapped package */
 };
 
 xps_part_t *xps_new_part(xps_context_t *ctx, char *name, int size);
+xps_part_t *xps_new_mapped_part(xps_context_t *ctx, char *name, byte *data, int size);
+int xps_own_part_data(xps_context_t *ctx, xps_part_t *part);
 xps_part_t *xps_read_part(xps_context_t *ctx, char *partname);
+int xps_part_size(xps_context_t *ctx, char *partname);
 void xps_free_part(xps_context_t *ctx, xps_part_t *part);
 
 /*
@@ -216,6 +275,27 @@ int xps_jpegxr_has_alpha(xps_context_t *ctx, byte *buf, int len);
 
 void xps_free_image(xps_context_t *ctx, xps_image_t *image);
 
+/* decoded images, keyed by part and profile name, bounded in bytes */
+
+typedef struct xps_image_cache_s xps_image_cache_t;
+typedef struct xps_cached_image_s xps_cached_image_t;
+
+struct xps_image_cache_s
+{
+    xps_hash_table_t *table;
+    xps_cached_image_t *head; /* most recently used */
+    xps_cached_image_t *tail;
+    int size;
+    int limit;
+    int peak;
+    int hits;
+    int misses;
+    int evictions;
+};
+
+int xps_init_image_cache(xps_context_t *ctx, int limit);
+void xps_free_image_cache(xps_context_t *ctx);
+
 /*
  * Fonts.
  */
@@ -235,6 +315,14 @@ struct xps_font_s
     int cmapsubtable;
     int usepua;
 
+    /* glyph ids of the BMP in the selected cmap, filled 256 at a time */
+    gs_memory_t *memory;
+    int *bmpcache[256];
+
+    /* the tables xps_measure_font_glyph needs, looked up once */
+    int head, hhea, hmtx, os2, vhea, vmtx, glyf, loca, vorg;
+    int hhealen, os2len, vhealen;
+
     /* these are for CFF opentypes only */
     byte *cffdata;
     byte *cffend;
@@ -280,10 +368,26 @@ void xps_set_color(xps_context_t *ctx, gs_color_space *colorspace, float *sample
 typedef struct xps_item_s xps_item_t;
 
 xps_item_t * xps_parse_xml(xps_context_t *ctx, byte *buf, int len);
+
+typedef struct xps_parser_s xps_parser_t;
+
+/* what the streaming parser does with a completed child of the root */
+#define XPS_FREE_CHILD 0
+#define XPS_KEEP_CHILD 1
+#define XPS_STOP_PARSING 2
+
+typedef int (xps_child_proc_t)(xps_context_t *ctx, void *user, xps_item_t *root, xps_item_t *item);
+
+xps_parser_t * xps_new_parser(xps_context_t *ctx, xps_child_proc_t *func, void *user);
+int xps_feed_parser(xps_parser_t *parser, byte *buf, int len);
+int xps_close_parser(xps_parser_t *parser, xps_item_t **rootp);
+void xps_free_parser(xps_parser_t *parser);
+int xps_stream_part(xps_context_t *ctx, char *partname, xps_parser_t *parser);
 xps_item_t * xps_next(xps_item_t *item);
 xps_item_t * xps_down(xps_item_t *item);
 char * xps_tag(xps_item_t *item);
 char * xps_att(xps_item_t *item, const char *att);
+char ** xps_att_list(xps_item_t *item);
 void xps_free_item(xps_context_t *ctx, xps_item_t *item);
 void xps_debug_item(xps_item_t *item, int level);
 
@@ -292,17 +396,39 @@ void xps_debug_item(xps_item_t *item, int level);
  */
 
 typedef struct xps_resource_s xps_resource_t;
+typedef struct xps_remote_dict_s xps_remote_dict_t;
 
 struct xps_resource_s
 {
-    char *name;
+    char *name; /* an atom */
     char *base_uri; /* only used in the head nodes */
     xps_item_t *base_xml; /* only used in the head nodes, to free the xml document */
     xps_item_t *data;
     xps_resource_t *next;
     xps_resource_t *parent; /* up to the previous dict in the stack */
+    xps_remote_dict_t *remote; /* only in heads that stand for a cached remote dict */
 };
 
+/* parsed remote dictionaries, keyed by part name, bounded in bytes */
+
+typedef struct xps_resource_cache_s xps_resource_cache_t;
+
+struct xps_resource_cache_s
+{
+    xps_hash_table_t *table;
+    xps_remote_dict_t *head; /* most recently used */
+    xps_remote_dict_t *tail;
+    int size;
+    int limit;
+    int peak;
+    int hits;
+    int misses;
+    int evictions;
+};
+
+int xps_init_resource_cache(xps_context_t *ctx, int limit);
+void xps_free_resource_cache(xps_context_t *ctx);
+
 int xps_parse_resource_dictionary(xps_context_t *ctx, xps_resource_t **dictp, char *base_uri, xps_item_t *root);
 void xps_free_resource_dictionary(xps_context_t *ctx, xps_resource_t *dict);
 void xps_resolve_resource_reference(xps_context_t *ctx, xps_resource_t *dict, char **attp, xps_item_t **tagp, char **urip);
@@ -314,6 +440,7 @@ void xps_debug_resource_dictionary(xps_resource_t *dict);
  */
 
 int xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part);
+int xps_stream_fixed_page(xps_context_t *ctx, char *partname);
 int xps_parse_canvas(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node);
 int xps_parse_path(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node);
 int xps_parse_glyphs(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node);
@@ -325,6 +452,25 @@ int xps_parse_radial_gradient_brush(xps_context_t *ctx, char *base_uri, xps_reso
 
 int xps_parse_tiling_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root, int (*func)(xps_context_t*, char*, xps_resource_t*, xps_item_t*, void*), void *user);
 
+/* pattern ids for tiling brushes, keyed by content and device placement */
+
+typedef struct xps_tile_cache_s xps_tile_cache_t;
+
+struct xps_tile_cache_s
+{
+    xps_hash_table_t *table;
+    int count;
+    int size; /* bytes of brush keys held */
+    int hits;
+    int misses;
+    int collisions; /* hash matched but the key did not */
+    int painted; /* tiles drawn, the rest came from the pattern cache */
+    int resets;
+};
+
+int xps_init_tile_cache(xps_context_t *ctx);
+void xps_free_tile_cache(xps_context_t *ctx);
+
 void xps_parse_matrix_transform(xps_context_t *ctx, xps_item_t *root, gs_matrix *matrix);
 void xps_parse_render_transform(xps_context_t *ctx, char *text, gs_matrix *matrix);
 void xps_parse_rectangle(xps_context_t *ctx, char *text, gs_rect *rect);
@@ -341,8 +487,7 @@ void xps_clip(xps_context_t *ctx);
 void xps_fill(xps_context_t *ctx);
 void xps_bounds_in_user_space(xps_context_t *ctx, gs_rect *user);
 
-int xps_element_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *node);
-int xps_resource_dictionary_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *node);
+int xps_element_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node);
 int xps_image_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root);
 
 /*
@@ -375,6 +520,9 @@ struct xps_context_s
     FILE *file;
     int zip_count;
     xps_entry_t *zip_table;
+    xps_hash_table_t *zip_index; /* zip_table entries by name */
+    byte *zip_data; /* the package mapped into memory, or NULL */
+    int zip_size;
 
     char *start_part; /* fixed document sequence */
     xps_document_t *first_fixdoc; /* first fixed document */
@@ -382,12 +530,29 @@ struct xps_context_s
     xps_page_t *first_page; /* first page of document */
     xps_page_t *last_page; /* last page of document */
 
+    /* Pages to render, see pl_page_selected */
+    int page_first;
+    int page_last;
+    const char *page_list;
+
+    /* Number of processes to render pages with */
+    int workers;
+
+    /* Pages larger than this are parsed while they are inflated */
+    int stream_size;
+
     char *base_uri; /* base uri for parsing XML and resolving relative paths */
     char *part_uri; /* part uri for parsing metadata relations */
 
+    /* Interned element names, attribute names and resource keys */
+    xps_atom_table_t *atoms;
+
     /* We cache font and colorspace resources */
     xps_hash_table_t *font_table;
     xps_hash_table_t *colorspace_table;
+    xps_image_cache_t image_cache;
+    xps_resource_cache_t resource_cache;
+    xps_tile_cache_t tile_cache;
 
     /* Global toggle for transparency */
     int use_transparency;
@@ -407,6 +572,12 @@ struct xps_context_s
 };
 
 int xps_process_file(xps_context_t *ctx, char *filename);
+int xps_read_and_process_metadata_part(xps_context_t *ctx, char *name);
+int xps_read_and_process_page_part(xps_context_t *ctx, char *name);
+
+int xps_can_use_workers(xps_context_t *ctx);
+int xps_process_pages_in_workers(xps_context_t *ctx);
+int xps_install_worker_device(xps_context_t *ctx);
 
 /* end of page device callback foo */
 int xps_show_page(xps_context_t *ctx, int num_copies, int flush);
@@ -49,6 +49,9 @@ $(XPSOBJ)xpscrc.$(OBJ): $(XPSSRC)xpscrc.c $(XPSINCLUDES)
 $(XPSOBJ)xpshash.$(OBJ): $(XPSSRC)xpshash.c $(XPSINCLUDES)
 	$(XPSCCC) $(XPSSRC)xpshash.c $(XPSO_)xpshash.$(OBJ)
 
+$(XPSOBJ)xpsatom.$(OBJ): $(XPSSRC)xpsatom.c $(XPSINCLUDES)
+	$(XPSCCC) $(XPSSRC)xpsatom.c $(XPSO_)xpsatom.$(OBJ)
+
 $(XPSOBJ)xpsjpeg.$(OBJ): $(XPSSRC)xpsjpeg.c $(XPSINCLUDES)
 	$(XPSCCC) $(XPSSRC)xpsjpeg.c $(XPSO_)xpsjpeg.$(OBJ)
 
@@ -61,9 +64,13 @@ $(XPSOBJ)xpstiff.$(OBJ): $(XPSSRC)xpstiff.c $(XPSINCLUDES)
 $(XPSOBJ)xpsjxr.$(OBJ): $(XPSSRC)xpsjxr.c $(XPSINCLUDES)
 	$(XPSCCC) $(XPSSRC)xpsjxr.c $(XPSO_)xpsjxr.$(OBJ)
 
-$(XPSOBJ)xpszip.$(OBJ): $(XPSSRC)xpszip.c $(XPSINCLUDES)
+$(XPSOBJ)xpszip.$(OBJ): $(XPSSRC)xpszip.c $(XPSINCLUDES) $(pltop_h)
 	$(XPSCCC) $(XPSSRC)xpszip.c $(XPSO_)xpszip.$(OBJ)
 
+$(XPSOBJ)xpsworker.$(OBJ): $(XPSSRC)xpsworker.c $(XPSINCLUDES) $(pltop_h)\
+    $(errno__h) $(unistd__h) $(gsfname_h) $(gxdevice_h) $(gxiodev_h)
+	$(XPSCCC) $(XPSSRC)xpsworker.c $(XPSO_)xpsworker.$(OBJ)
+
 $(XPSOBJ)xpsxml.$(OBJ): $(XPSSRC)xpsxml.c $(XPSINCLUDES)
 	$(XPSCCC) $(XPSSRC)xpsxml.c $(XPSO_)xpsxml.$(OBJ)
 
@@ -125,11 +132,13 @@ XPS_OBJS=\
     $(XPSOBJ)xpsutf.$(OBJ) \
     $(XPSOBJ)xpscrc.$(OBJ) \
     $(XPSOBJ)xpshash.$(OBJ) \
+    $(XPSOBJ)xpsatom.$(OBJ) \
     $(XPSOBJ)xpsjpeg.$(OBJ) \
     $(XPSOBJ)xpspng.$(OBJ) \
     $(XPSOBJ)xpstiff.$(OBJ) \
     $(XPSOBJ)xpsjxr.$(OBJ) \
     $(XPSOBJ)xpszip.$(OBJ) \
+    $(XPSOBJ)xpsworker.$(OBJ) \
     $(XPSOBJ)xpsxml.$(OBJ) \
     $(XPSOBJ)xpsdoc.$(OBJ) \
     $(XPSOBJ)xpspage.$(OBJ) \
@@ -14,33 +14,34 @@
 /* XPS interpreter - analyze page checking for transparency.
  * This is a stripped down parser that looks for alpha values < 1.0 in
  * any part of the page.
+ *
+ * Resource references are followed through the same dictionaries that
+ * the page will be drawn with, so a translucent resource only counts
+ * if something on the page uses it.
  */
 
 #include "ghostxps.h"
 
-static int
-xps_remote_resource_dictionary_has_transparency(xps_context_t *ctx, char *base_uri, char *source_att)
-{
-    //dputs("page has transparency: uses a remote resource; not parsed; being conservative\n");
-    return 1;
-}
+static int xps_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root);
 
-int
-xps_resource_dictionary_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
+/*
+ * A Fill or Stroke attribute, which is either a color or a reference
+ * to a brush resource.
+ */
+static int
+xps_paint_att_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, char *att)
 {
-    char *source;
-    xps_item_t *node;
-
-    source = xps_att(root, "Source");
-    if (source)
-        return xps_remote_resource_dictionary_has_transparency(ctx, base_uri, source);
+    xps_item_t *tag = NULL;
+    char *uri = base_uri;
+    gs_color_space *colorspace;
+    float samples[32];
 
-    for (node = xps_down(root); node; node = xps_next(node))
-    {
-        // TODO: ... all kinds of stuff can be here, brushes, elements, whatnot
-    }
+    xps_resolve_resource_reference(ctx, dict, &att, &tag, &uri);
+    if (tag)
+        return xps_brush_has_transparency(ctx, uri, dict, tag);
 
-    return 1;
+    xps_parse_color(ctx, base_uri, att, &colorspace, samples);
+    return samples[0] < 1.0;
 }
 
 static int
@@ -53,7 +54,7 @@ xps_gradient_stops_have_transparency(xps_context_t *ctx, char *base_uri, xps_ite
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "GradientStop"))
+        if (xps_tag(node) == xps_GradientStop)
         {
             color_att = xps_att(node, "Color");
             if (color_att)
@@ -75,26 +76,15 @@ static int
 xps_gradient_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
 {
     xps_item_t *node;
-    char *opacity_att;
-
-    opacity_att = xps_att(root, "Opacity");
-    if (opacity_att)
-    {
-        if (atof(opacity_att) < 1.0)
-        {
-            //dputs("page has transparency: GradientBrush Opacity\n");
-            return 1;
-        }
-    }
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "RadialGradientBrush.GradientStops"))
+        if (xps_tag(node) == xps_RadialGradientBrush_GradientStops)
         {
             if (xps_gradient_stops_have_transparency(ctx, base_uri, node))
                 return 1;
         }
-        if (!strcmp(xps_tag(node), "LinearGradientBrush.GradientStops"))
+        if (xps_tag(node) == xps_LinearGradientBrush_GradientStops)
         {
             if (xps_gradient_stops_have_transparency(ctx, base_uri, node))
                 return 1;
@@ -105,27 +95,32 @@ xps_gradient_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item
 }
 
 static int
-xps_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
+xps_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root)
 {
     char *opacity_att;
     char *color_att;
+    char *visual_att;
+    xps_item_t *visual_tag;
     xps_item_t *node;
 
     gs_color_space *colorspace;
     float samples[32];
 
-    if (!strcmp(xps_tag(root), "SolidColorBrush"))
+    if (!root)
+        return 0;
+
+    opacity_att = xps_att(root, "Opacity");
+    if (opacity_att)
     {
-        opacity_att = xps_att(root, "Opacity");
-        if (opacity_att)
+        if (atof(opacity_att) < 1.0)
         {
-            if (atof(opacity_att) < 1.0)
-            {
-                //dputs("page has transparency: SolidColorBrush Opacity\n");
-                return 1;
-            }
+            //dputs("page has transparency: Brush Opacity\n");
+            return 1;
         }
+    }
 
+    if (xps_tag(root) == xps_SolidColorBrush)
+    {
         color_att = xps_att(root, "Color");
         if (color_att)
         {
@@ -138,41 +133,37 @@ xps_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
         }
     }
 
-    if (!strcmp(xps_tag(root), "VisualBrush"))
+    if (xps_tag(root) == xps_VisualBrush)
     {
-        char *opacity_att = xps_att(root, "Opacity");
-        if (opacity_att)
-        {
-            if (atof(opacity_att) < 1.0)
-            {
-                //dputs("page has transparency: VisualBrush Opacity\n");
-                return 1;
-            }
-        }
+        visual_att = xps_att(root, "Visual");
+        visual_tag = NULL;
 
         for (node = xps_down(root); node; node = xps_next(node))
         {
-            if (!strcmp(xps_tag(node), "VisualBrush.Visual"))
-            {
-                if (xps_element_has_transparency(ctx, base_uri, xps_down(node)))
-                    return 1;
-            }
+            if (xps_tag(node) == xps_VisualBrush_Visual)
+                visual_tag = xps_down(node);
         }
+
+        xps_resolve_resource_reference(ctx, dict, &visual_att, &visual_tag, &base_uri);
+
+        if (visual_tag)
+            if (xps_element_has_transparency(ctx, base_uri, dict, visual_tag))
+                return 1;
     }
 
-    if (!strcmp(xps_tag(root), "ImageBrush"))
+    if (xps_tag(root) == xps_ImageBrush)
     {
         if (xps_image_brush_has_transparency(ctx, base_uri, root))
             return 1;
     }
 
-    if (!strcmp(xps_tag(root), "LinearGradientBrush"))
+    if (xps_tag(root) == xps_LinearGradientBrush)
     {
         if (xps_gradient_brush_has_transparency(ctx, base_uri, root))
             return 1;
     }
 
-    if (!strcmp(xps_tag(root), "RadialGradientBrush"))
+    if (xps_tag(root) == xps_RadialGradientBrush)
     {
         if (xps_gradient_brush_has_transparency(ctx, base_uri, root))
             return 1;
@@ -182,27 +173,27 @@ xps_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
 }
 
 static int
-xps_path_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
+xps_path_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root)
 {
     xps_item_t *node;
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "Path.OpacityMask"))
+        if (xps_tag(node) == xps_Path_OpacityMask)
         {
             //dputs("page has transparency: Path.OpacityMask\n");
             return 1;
         }
 
-        if (!strcmp(xps_tag(node), "Path.Stroke"))
+        if (xps_tag(node) == xps_Path_Stroke)
         {
-            if (xps_brush_has_transparency(ctx, base_uri, xps_down(node)))
+            if (xps_brush_has_transparency(ctx, base_uri, dict, xps_down(node)))
                 return 1;
         }
 
-        if (!strcmp(xps_tag(node), "Path.Fill"))
+        if (xps_tag(node) == xps_Path_Fill)
         {
-            if (xps_brush_has_transparency(ctx, base_uri, xps_down(node)))
+            if (xps_brush_has_transparency(ctx, base_uri, dict, xps_down(node)))
                 return 1;
         }
     }
@@ -211,21 +202,21 @@ xps_path_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
 }
 
 static int
-xps_glyphs_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
+xps_glyphs_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root)
 {
     xps_item_t *node;
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "Glyphs.OpacityMask"))
+        if (xps_tag(node) == xps_Glyphs_OpacityMask)
         {
             //dputs("page has transparency: Glyphs.OpacityMask\n");
             return 1;
         }
 
-        if (!strcmp(xps_tag(node), "Glyphs.Fill"))
+        if (xps_tag(node) == xps_Glyphs_Fill)
         {
-            if (xps_brush_has_transparency(ctx, base_uri, xps_down(node)))
+            if (xps_brush_has_transparency(ctx, base_uri, dict, xps_down(node)))
                 return 1;
         }
     }
@@ -234,48 +225,63 @@ xps_glyphs_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root
 }
 
 static int
-xps_canvas_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
+xps_canvas_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root)
 {
+    xps_resource_t *new_dict = NULL;
     xps_item_t *node;
+    int code;
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "Canvas.Resources"))
+        if (xps_tag(node) == xps_Canvas_Resources && xps_down(node))
         {
-            if (xps_resource_dictionary_has_transparency(ctx, base_uri, xps_down(node)))
-                return 1;
+            code = xps_parse_resource_dictionary(ctx, &new_dict, base_uri, xps_down(node));
+            if (code)
+            {
+                gs_catch(code, "cannot load Canvas.Resources");
+                return 1; /* being conservative */
+            }
+            if (new_dict)
+            {
+                new_dict->parent = dict;
+                dict = new_dict;
+            }
         }
 
-        if (!strcmp(xps_tag(node), "Canvas.OpacityMask"))
+        if (xps_tag(node) == xps_Canvas_OpacityMask)
         {
             //dputs("page has transparency: Canvas.OpacityMask\n");
-            return 1;
+            break;
         }
+    }
 
-        if (xps_element_has_transparency(ctx, base_uri, node))
-            return 1;
+    for (node = xps_down(root); node; node = xps_next(node))
+    {
+        if (xps_tag(node) == xps_Canvas_OpacityMask)
+            break;
+        if (xps_element_has_transparency(ctx, base_uri, dict, node))
+            break;
     }
 
-    return 0;
+    if (new_dict)
+        xps_free_resource_dictionary(ctx, new_dict);
+
+    return node != NULL;
 }
 
 int
-xps_element_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *node)
+xps_element_has_transparency(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node)
 {
     char *opacity_att;
     char *stroke_att;
     char *fill_att;
 
-    gs_color_space *colorspace;
-    float samples[32];
-
     stroke_att = xps_att(node, "Stroke");
     if (stroke_att)
     {
-        xps_parse_color(ctx, base_uri, stroke_att, &colorspace, samples);
-        if (samples[0] < 1.0)
+        if (xps_paint_att_has_transparency(ctx, base_uri, dict, stroke_att))
         {
-            //dprintf1("page has transparency: Stroke alpha=%g\n", samples[0]);
+            //dputs("page has transparency: Stroke\n");
             return 1;
         }
     }
@@ -283,10 +289,9 @@ xps_element_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *nod
     fill_att = xps_att(node, "Fill");
     if (fill_att)
     {
-        xps_parse_color(ctx, base_uri, fill_att, &colorspace, samples);
-        if (samples[0] < 1.0)
+        if (xps_paint_att_has_transparency(ctx, base_uri, dict, fill_att))
         {
-            //dprintf1("page has transparency: Fill alpha=%g\n", samples[0]);
+            //dputs("page has transparency: Fill\n");
             return 1;
         }
     }
@@ -307,14 +312,14 @@ xps_element_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *nod
         return 1;
     }
 
-    if (!strcmp(xps_tag(node), "Path"))
-        if (xps_path_has_transparency(ctx, base_uri, node))
+    if (xps_tag(node) == xps_Path)
+        if (xps_path_has_transparency(ctx, base_uri, dict, node))
             return 1;
-    if (!strcmp(xps_tag(node), "Glyphs"))
-        if (xps_glyphs_has_transparency(ctx, base_uri, node))
+    if (xps_tag(node) == xps_Glyphs)
+        if (xps_glyphs_has_transparency(ctx, base_uri, dict, node))
             return 1;
-    if (!strcmp(xps_tag(node), "Canvas"))
-        if (xps_canvas_has_transparency(ctx, base_uri, node))
+    if (xps_tag(node) == xps_Canvas)
+        if (xps_canvas_has_transparency(ctx, base_uri, dict, node))
             return 1;
 
     return 0;
@@ -0,0 +1,286 @@
+/* Copyright (C) 2006-2010 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* XPS interpreter - interned strings
+ *
+ * Element and attribute names, and resource keys, are interned once
+ * per job so that the parser need not copy them into every element
+ * and so that they can be compared with ==. The element names the
+ * interpreter looks for are seeded from the static strings below,
+ * which are therefore the atoms for those names.
+ */
+
+#include "ghostxps.h"
+
+const char xps_ArcSegment[] = "ArcSegment";
+const char xps_Canvas[] = "Canvas";
+const char xps_Canvas_Clip[] = "Canvas.Clip";
+const char xps_Canvas_OpacityMask[] = "Canvas.OpacityMask";
+const char xps_Canvas_RenderTransform[] = "Canvas.RenderTransform";
+const char xps_Canvas_Resources[] = "Canvas.Resources";
+const char xps_FixedPage[] = "FixedPage";
+const char xps_FixedPage_Resources[] = "FixedPage.Resources";
+const char xps_Glyphs[] = "Glyphs";
+const char xps_Glyphs_Clip[] = "Glyphs.Clip";
+const char xps_Glyphs_Fill[] = "Glyphs.Fill";
+const char xps_Glyphs_OpacityMask[] = "Glyphs.OpacityMask";
+const char xps_Glyphs_RenderTransform[] = "Glyphs.RenderTransform";
+const char xps_GradientStop[] = "GradientStop";
+const char xps_ImageBrush[] = "ImageBrush";
+const char xps_ImageBrush_Transform[] = "ImageBrush.Transform";
+const char xps_LinearGradientBrush[] = "LinearGradientBrush";
+const char xps_LinearGradientBrush_GradientStops[] = "LinearGradientBrush.GradientStops";
+const char xps_LinearGradientBrush_Transform[] = "LinearGradientBrush.Transform";
+const char xps_MatrixTransform[] = "MatrixTransform";
+const char xps_Path[] = "Path";
+const char xps_Path_Clip[] = "Path.Clip";
+const char xps_Path_Data[] = "Path.Data";
+const char xps_Path_Fill[] = "Path.Fill";
+const char xps_Path_OpacityMask[] = "Path.OpacityMask";
+const char xps_Path_RenderTransform[] = "Path.RenderTransform";
+const char xps_Path_Stroke[] = "Path.Stroke";
+const char xps_PathFigure[] = "PathFigure";
+const char xps_PathGeometry_Transform[] = "PathGeometry.Transform";
+const char xps_PolyBezierSegment[] = "PolyBezierSegment";
+const char xps_PolyLineSegment[] = "PolyLineSegment";
+const char xps_PolyQuadraticBezierSegment[] = "PolyQuadraticBezierSegment";
+const char xps_RadialGradientBrush[] = "RadialGradientBrush";
+const char xps_RadialGradientBrush_GradientStops[] = "RadialGradientBrush.GradientStops";
+const char xps_RadialGradientBrush_Transform[] = "RadialGradientBrush.Transform";
+const char xps_ResourceDictionary[] = "ResourceDictionary";
+const char xps_SolidColorBrush[] = "SolidColorBrush";
+const char xps_VisualBrush[] = "VisualBrush";
+const char xps_VisualBrush_Transform[] = "VisualBrush.Transform";
+const char xps_VisualBrush_Visual[] = "VisualBrush.Visual";
+
+static const char *const xps_known_atoms[] =
+{
+    xps_ArcSegment,
+    xps_Canvas,
+    xps_Canvas_Clip,
+    xps_Canvas_OpacityMask,
+    xps_Canvas_RenderTransform,
+    xps_Canvas_Resources,
+    xps_FixedPage,
+    xps_FixedPage_Resources,
+    xps_Glyphs,
+    xps_Glyphs_Clip,
+    xps_Glyphs_Fill,
+    xps_Glyphs_OpacityMask,
+    xps_Glyphs_RenderTransform,
+    xps_GradientStop,
+    xps_ImageBrush,
+    xps_ImageBrush_Transform,
+    xps_LinearGradientBrush,
+    xps_LinearGradientBrush_GradientStops,
+    xps_LinearGradientBrush_Transform,
+    xps_MatrixTransform,
+    xps_Path,
+    xps_Path_Clip,
+    xps_Path_Data,
+    xps_Path_Fill,
+    xps_Path_OpacityMask,
+    xps_Path_RenderTransform,
+    xps_Path_Stroke,
+    xps_PathFigure,
+    xps_PathGeometry_Transform,
+    xps_PolyBezierSegment,
+    xps_PolyLineSegment,
+    xps_PolyQuadraticBezierSegment,
+    xps_RadialGradientBrush,
+    xps_RadialGradientBrush_GradientStops,
+    xps_RadialGradientBrush_Transform,
+    xps_ResourceDictionary,
+    xps_SolidColorBrush,
+    xps_VisualBrush,
+    xps_VisualBrush_Transform,
+    xps_VisualBrush_Visual,
+    NULL
+};
+
+typedef struct xps_atom_entry_s xps_atom_entry_t;
+
+struct xps_atom_entry_s
+{
+    unsigned int hash;
+    char *name; /* NULL for an empty slot */
+    int owned; /* name is a copy made by xps_atom */
+};
+
+struct xps_atom_table_s
+{
+    unsigned int size; /* always a power of two */
+    unsigned int load;
+    xps_atom_entry_t *entries;
+};
+
+#define XPS_ATOM_TABLE_SIZE 256
+
+static unsigned int
+xps_atom_hash(const char *s)
+{
+    unsigned int h = 2166136261u;
+    while (*s)
+        h = (h ^ (byte)*s++) * 16777619u;
+    return h;
+}
+
+static xps_atom_entry_t *
+xps_find_atom_entry(xps_atom_table_t *table, const char *s, unsigned int hash)
+{
+    unsigned int mask = table->size - 1;
+    unsigned int pos = hash & mask;
+
+    while (table->entries[pos].name)
+    {
+        if (table->entries[pos].hash == hash && !strcmp(table->entries[pos].name, s))
+            break;
+        pos = (pos + 1) & mask;
+    }
+
+    return &table->entries[pos];
+}
+
+static int
+xps_grow_atoms(xps_context_t *ctx, xps_atom_table_t *table)
+{
+    xps_atom_entry_t *old_entries = table->entries;
+    unsigned int old_size = table->size;
+    unsigned int new_size = old_size * 2;
+    unsigned int i;
+
+    table->entries = xps_alloc(ctx, sizeof(xps_atom_entry_t) * new_size);
+    if (!table->entries)
+    {
+        table->entries = old_entries;
+        return gs_throw(-1, "out of memory: atom table entries");
+    }
+
+    memset(table->entries, 0, sizeof(xps_atom_entry_t) * new_size);
+    table->size = new_size;
+
+    for (i = 0; i < old_size; i++)
+        if (old_entries[i].name)
+            *xps_find_atom_entry(table, old_entries[i].name, old_entries[i].hash) = old_entries[i];
+
+    xps_free(ctx, old_entries);
+    return 0;
+}
+
+int
+xps_init_atoms(xps_context_t *ctx)
+{
+    xps_atom_table_t *table;
+    xps_atom_entry_t *entry;
+    int i;
+
+    table = xps_alloc(ctx, sizeof(xps_atom_table_t));
+    if (!table)
+        return gs_throw(-1, "out of memory: atom table");
+
+    table->size = XPS_ATOM_TABLE_SIZE;
+    table->load = 0;
+    table->entries = xps_alloc(ctx, sizeof(xps_atom_entry_t) * table->size);
+    if (!table->entries)
+    {
+        xps_free(ctx, table);
+        return gs_throw(-1, "out of memory: atom table entries");
+    }
+    memset(table->entries, 0, sizeof(xps_atom_entry_t) * table->size);
+
+    for (i = 0; xps_known_atoms[i]; i++)
+    {
+        unsigned int hash = xps_atom_hash(xps_known_atoms[i]);
+        entry = xps_find_atom_entry(table, xps_known_atoms[i], hash);
+        entry->hash = hash;
+        entry->name = (char*)xps_known_atoms[i];
+        entry->owned = 0;
+        table->load ++;
+    }
+
+    ctx->atoms = table;
+    return 0;
+}
+
+void
+xps_free_atoms(xps_context_t *ctx)
+{
+    xps_atom_table_t *table = ctx->atoms;
+    unsigned int i;
+
+    if (!table)
+        return;
+
+    if_debug2('|', "xps: %d atoms in a table of %d\n", table->load, table->size);
+
+    for (i = 0; i < table->size; i++)
+        if (table->entries[i].owned)
+            xps_free(ctx, table->entries[i].name);
+    xps_free(ctx, table->entries);
+    xps_free(ctx, table);
+    ctx->atoms = NULL;
+}
+
+/* Return the atom for a string, adding it if need be, or NULL if out of memory. */
+char *
+xps_atom(xps_context_t *ctx, const char *s)
+{
+    xps_atom_table_t *table = ctx->atoms;
+    xps_atom_entry_t *entry;
+    unsigned int hash;
+    char *name;
+
+    if (!table)
+    {
+        gs_throw(-1, "atom table is not initialized");
+        return NULL;
+    }
+
+    hash = xps_atom_hash(s);
+    entry = xps_find_atom_entry(table, s, hash);
+    if (entry->name)
+        return entry->name;
+
+    /* Grow the table at 50% load */
+    if (table->load >= table->size / 2)
+    {
+        if (xps_grow_atoms(ctx, table) < 0)
+        {
+            gs_rethrow(-1, "cannot grow atom table");
+            return NULL;
+        }
+        entry = xps_find_atom_entry(table, s, hash);
+    }
+
+    name = xps_strdup(ctx, s);
+    if (!name)
+    {
+        gs_throw(-1, "out of memory: atom");
+        return NULL;
+    }
+
+    entry->hash = hash;
+    entry->name = name;
+    entry->owned = 1;
+    table->load ++;
+    return name;
+}
+
+/* Return the atom for a string without adding it, or NULL if there is none. */
+char *
+xps_lookup_atom(xps_context_t *ctx, const char *s)
+{
+    if (!ctx->atoms)
+        return NULL;
+    return xps_find_atom_entry(ctx->atoms, s, xps_atom_hash(s))->name;
+}
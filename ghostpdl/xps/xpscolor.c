@@ -184,6 +184,14 @@ xps_read_icc_colorspace(xps_context_t *ctx, char *base_uri, char *profilename)
             return NULL;
         }
 
+        /* The profile keeps the data */
+        if (xps_own_part_data(ctx, part) < 0)
+        {
+            xps_free_part(ctx, part);
+            gs_warn1("cannot copy icc profile part: %s", partname);
+            return NULL;
+        }
+
         /* Create the profile */
         profile = gsicc_profile_new(NULL, ctx->memory, NULL, 0);
 
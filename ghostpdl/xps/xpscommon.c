@@ -18,20 +18,20 @@
 int
 xps_parse_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node)
 {
-    if (!strcmp(xps_tag(node), "SolidColorBrush"))
+    if (xps_tag(node) == xps_SolidColorBrush)
         return xps_parse_solid_color_brush(ctx, base_uri, dict, node);
-    if (!strcmp(xps_tag(node), "ImageBrush"))
+    if (xps_tag(node) == xps_ImageBrush)
     {
         int code = xps_parse_image_brush(ctx, base_uri, dict, node);
         if (code)
             gs_catch(code, "ignoring error in image brush");
         return gs_okay;
     }
-    if (!strcmp(xps_tag(node), "VisualBrush"))
+    if (xps_tag(node) == xps_VisualBrush)
         return xps_parse_visual_brush(ctx, base_uri, dict, node);
-    if (!strcmp(xps_tag(node), "LinearGradientBrush"))
+    if (xps_tag(node) == xps_LinearGradientBrush)
         return xps_parse_linear_gradient_brush(ctx, base_uri, dict, node);
-    if (!strcmp(xps_tag(node), "RadialGradientBrush"))
+    if (xps_tag(node) == xps_RadialGradientBrush)
         return xps_parse_radial_gradient_brush(ctx, base_uri, dict, node);
     return gs_throw1(-1, "unknown brush tag: %s", xps_tag(node));
 }
@@ -39,11 +39,11 @@ xps_parse_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_it
 int
 xps_parse_element(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *node)
 {
-    if (!strcmp(xps_tag(node), "Path"))
+    if (xps_tag(node) == xps_Path)
         return xps_parse_path(ctx, base_uri, dict, node);
-    if (!strcmp(xps_tag(node), "Glyphs"))
+    if (xps_tag(node) == xps_Glyphs)
         return xps_parse_glyphs(ctx, base_uri, dict, node);
-    if (!strcmp(xps_tag(node), "Canvas"))
+    if (xps_tag(node) == xps_Canvas)
         return xps_parse_canvas(ctx, base_uri, dict, node);
     /* skip unknown tags (like Foo.Resources and similar) */
     return 0;
@@ -81,7 +81,7 @@ xps_parse_matrix_transform(xps_context_t *ctx, xps_item_t *root, gs_matrix *matr
 
     gs_make_identity(matrix);
 
-    if (!strcmp(xps_tag(root), "MatrixTransform"))
+    if (xps_tag(root) == xps_MatrixTransform)
     {
         transform = xps_att(root, "Matrix");
         if (transform)
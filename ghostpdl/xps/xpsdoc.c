@@ -26,15 +26,58 @@ xps_new_part(xps_context_t *ctx, char *name, int size)
     part->name = xps_strdup(ctx, name);
     part->size = size;
     part->data = xps_alloc(ctx, size);
+    part->mapped = 0;
 
     return part;
 }
 
+/*
+ * A part whose data lives in the mapped package. It must not outlive
+ * the package, and its data must not be kept after the part is freed.
+ */
+xps_part_t *
+xps_new_mapped_part(xps_context_t *ctx, char *name, byte *data, int size)
+{
+    xps_part_t *part;
+
+    part = xps_alloc(ctx, sizeof(xps_part_t));
+    part->name = xps_strdup(ctx, name);
+    part->size = size;
+    part->data = data;
+    part->mapped = 1;
+
+    return part;
+}
+
+/*
+ * Give the part a private copy of its data, for callers that keep
+ * the data after the part is freed.
+ */
+int
+xps_own_part_data(xps_context_t *ctx, xps_part_t *part)
+{
+    byte *data;
+
+    if (!part->mapped)
+        return 0;
+
+    data = xps_alloc(ctx, part->size);
+    if (!data)
+        return gs_throw(-1, "out of memory: part data");
+
+    memcpy(data, part->data, part->size);
+    part->data = data;
+    part->mapped = 0;
+
+    return 0;
+}
+
 void
 xps_free_part(xps_context_t *ctx, xps_part_t *part)
 {
     xps_free(ctx, part->name);
-    xps_free(ctx, part->data);
+    if (!part->mapped)
+        xps_free(ctx, part->data);
     xps_free(ctx, part);
 }
 
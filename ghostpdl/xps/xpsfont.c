@@ -16,6 +16,8 @@
 #include "ghostxps.h"
 
 static void xps_load_sfnt_cmap(xps_font_t *font);
+static void xps_load_sfnt_metrics(xps_font_t *font);
+static void xps_flush_encoding_cache(xps_font_t *font);
 
 /*
  * Big-endian memory accessor functions
@@ -64,6 +66,9 @@ xps_new_font(xps_context_t *ctx, byte *buf, int buflen, int index)
     font->cmapsubtable = 0;
     font->usepua = 0;
 
+    font->memory = ctx->memory;
+    memset(font->bmpcache, 0, sizeof font->bmpcache);
+
     font->cffdata = 0;
     font->cffend = 0;
     font->gsubrs = 0;
@@ -93,6 +98,7 @@ xps_new_font(xps_context_t *ctx, byte *buf, int buflen, int index)
     }
 
     xps_load_sfnt_cmap(font);
+    xps_load_sfnt_metrics(font);
 
     return font;
 }
@@ -100,6 +106,7 @@ xps_new_font(xps_context_t *ctx, byte *buf, int buflen, int index)
 void
 xps_free_font(xps_context_t *ctx, xps_font_t *font)
 {
+    xps_flush_encoding_cache(font);
     if (font->font)
     {
         gs_font_finalize(font->font);
@@ -237,6 +244,28 @@ xps_load_sfnt_cmap(xps_font_t *font)
     font->cmapsubtable = 0;
 }
 
+/*
+ * Locate the tables used to measure glyphs.
+ */
+
+static void
+xps_load_sfnt_metrics(xps_font_t *font)
+{
+    int length;
+
+    font->hhealen = font->os2len = font->vhealen = 0;
+
+    font->head = xps_find_sfnt_table(font, "head", &length);
+    font->hhea = xps_find_sfnt_table(font, "hhea", &font->hhealen);
+    font->hmtx = xps_find_sfnt_table(font, "hmtx", &length);
+    font->os2 = xps_find_sfnt_table(font, "OS/2", &font->os2len);
+    font->vhea = xps_find_sfnt_table(font, "vhea", &font->vhealen);
+    font->vmtx = xps_find_sfnt_table(font, "vmtx", &length);
+    font->glyf = xps_find_sfnt_table(font, "glyf", &length);
+    font->loca = xps_find_sfnt_table(font, "loca", &length);
+    font->vorg = xps_find_sfnt_table(font, "VORG", &length);
+}
+
 /*
  * Return the number of cmap subtables.
  */
@@ -280,6 +309,7 @@ xps_select_font_encoding(xps_font_t *font, int idx)
     eid = u16(entry + 2);
     font->cmapsubtable = font->cmaptable + u32(entry + 4);
     font->usepua = (pid == 3 && eid == 0);
+    xps_flush_encoding_cache(font);
 }
 
 /*
@@ -301,6 +331,8 @@ xps_encode_font_char_imp(xps_font_t *font, int code)
     switch (u16(table))
     {
     case 0: /* Apple standard 1-to-1 mapping. */
+        if (code < 0 || code > 255)
+            return 0;
         return table[code + 6];
 
     case 4: /* Microsoft/Adobe segmented mapping. */
@@ -390,8 +422,8 @@ xps_encode_font_char_imp(xps_font_t *font, int code)
     return 0;
 }
 
-int
-xps_encode_font_char(xps_font_t *font, int code)
+static int
+xps_encode_font_char_pua(xps_font_t *font, int code)
 {
     int gid = xps_encode_font_char_imp(font, code);
     if (gid == 0 && font->usepua)
@@ -399,6 +431,56 @@ xps_encode_font_char(xps_font_t *font, int code)
     return gid;
 }
 
+/*
+ * Searching the cmap subtable for every character is slow for text
+ * heavy pages, so the glyph ids of the BMP are kept in pages of 256
+ * that are filled in the first time one of their characters is used.
+ */
+
+static void
+xps_flush_encoding_cache(xps_font_t *font)
+{
+    int i;
+
+    for (i = 0; i < 256; i++)
+    {
+        if (font->bmpcache[i])
+            gs_free_object(font->memory, font->bmpcache[i], "xps_flush_encoding_cache");
+        font->bmpcache[i] = NULL;
+    }
+}
+
+int
+xps_encode_font_char(xps_font_t *font, int code)
+{
+    int *page;
+    int i;
+
+    if (code < 0 || code > 0xFFFF)
+        return xps_encode_font_char_pua(font, code);
+
+    /* leave the warnings about unknown formats to the slow path */
+    if (font->cmapsubtable > 0)
+    {
+        int format = u16(font->data + font->cmapsubtable);
+        if (format != 0 && format != 4 && format != 6 && format != 10 && format != 12)
+            return xps_encode_font_char_pua(font, code);
+    }
+
+    page = font->bmpcache[code >> 8];
+    if (!page)
+    {
+        page = (int*)gs_alloc_bytes(font->memory, 256 * sizeof(int), "xps_encode_font_char");
+        if (!page)
+            return xps_encode_font_char_pua(font, code);
+        for (i = 0; i < 256; i++)
+            page[i] = xps_encode_font_char_pua(font, (code & 0xFF00) | i);
+        font->bmpcache[code >> 8] = page;
+    }
+
+    return page[code & 0xFF];
+}
+
 /*
  * Get glyph metrics by parsing TTF tables manually.
  * XPS needs more and different metrics than postscript/ghostscript
@@ -409,8 +491,8 @@ void
 xps_measure_font_glyph(xps_context_t *ctx, xps_font_t *font, int gid, xps_glyph_metrics_t *mtx)
 {
 
-    int head, format, loca, glyf;
-    int ofs, len;
+    int format;
+    int ofs;
     int idx, i, n;
     int hadv, vadv, vorg;
     int vtop, ymax, desc;
@@ -427,8 +509,8 @@ xps_measure_font_glyph(xps_context_t *ctx, xps_font_t *font, int gid, xps_glyph_
      * Horizontal metrics are easy.
      */
 
-    ofs = xps_find_sfnt_table(font, "hhea", &len);
-    if (ofs < 0 || len < 2 * 18)
+    ofs = font->hhea;
+    if (ofs < 0 || font->hhealen < 2 * 18)
     {
         gs_warn("hhea table is too short");
         return;
@@ -440,7 +522,7 @@ xps_measure_font_glyph(xps_context_t *ctx, xps_font_t *font, int gid, xps_glyph_
         desc = -desc;
     n = u16(font->data + ofs + 17 * 2);
 
-    ofs = xps_find_sfnt_table(font, "hmtx", &len);
+    ofs = font->hmtx;
     if (ofs < 0)
     {
         gs_warn("cannot find hmtx table");
@@ -458,14 +540,13 @@ xps_measure_font_glyph(xps_context_t *ctx, xps_font_t *font, int gid, xps_glyph_
      * Vertical metrics are hairy (with missing tables).
      */
 
-    head = xps_find_sfnt_table(font, "head", &len);
-    if (head > 0)
+    if (font->head > 0)
     {
-        scale = u16(font->data + head + 18); /* units per em */
+        scale = u16(font->data + font->head + 18); /* units per em */
     }
 
-    ofs = xps_find_sfnt_table(font, "OS/2", &len);
-    if (ofs > 0 && len > 70)
+    ofs = font->os2;
+    if (ofs > 0 && font->os2len > 70)
     {
         vorg = s16(font->data + ofs + 68); /* sTypoAscender */
         desc = s16(font->data + ofs + 70); /* sTypoDescender */
@@ -473,12 +554,12 @@ xps_measure_font_glyph(xps_context_t *ctx, xps_font_t *font, int gid, xps_glyph_
             desc = -desc;
     }
 
-    ofs = xps_find_sfnt_table(font, "vhea", &len);
-    if (ofs > 0 && len >= 2 * 18)
+    ofs = font->vhea;
+    if (ofs > 0 && font->vhealen >= 2 * 18)
     {
         n = u16(font->data + ofs + 17 * 2);
 
-        ofs = xps_find_sfnt_table(font, "vmtx", &len);
+        ofs = font->vmtx;
         if (ofs < 0)
         {
             gs_warn("cannot find vmtx table");
@@ -492,24 +573,22 @@ xps_measure_font_glyph(xps_context_t *ctx, xps_font_t *font, int gid, xps_glyph_
         vadv = u16(font->data + ofs + idx * 4);
         vtop = u16(font->data + ofs + idx * 4 + 2);
 
-        glyf = xps_find_sfnt_table(font, "glyf", &len);
-        loca = xps_find_sfnt_table(font, "loca", &len);
-        if (head > 0 && glyf > 0 && loca > 0)
+        if (font->head > 0 && font->glyf > 0 && font->loca > 0)
         {
-            format = u16(font->data + head + 50); /* indexToLocaFormat */
+            format = u16(font->data + font->head + 50); /* indexToLocaFormat */
 
             if (format == 0)
-                ofs = u16(font->data + loca + gid * 2) * 2;
+                ofs = u16(font->data + font->loca + gid * 2) * 2;
             else
-                ofs = u32(font->data + loca + gid * 4);
+                ofs = u32(font->data + font->loca + gid * 4);
 
-            ymax = u16(font->data + glyf + ofs + 8); /* yMax */
+            ymax = u16(font->data + font->glyf + ofs + 8); /* yMax */
 
             vorg = ymax + vtop;
         }
     }
 
-    ofs = xps_find_sfnt_table(font, "VORG", &len);
+    ofs = font->vorg;
     if (ofs > 0)
     {
         vorg = u16(font->data + ofs + 6);
@@ -243,13 +243,53 @@ static inline int is_real_num_char(int c)
     return (c >= '0' && c <= '9') || c == 'e' || c == 'E' || c == '+' || c == '-' || c == '.';
 }
 
+/*
+ * Advances and offsets are nearly always short decimals, which can be
+ * converted exactly without going through atof: up to 15 digits fit a
+ * double, and one division by an exact power of ten rounds correctly,
+ * so the result is the same as atof's.
+ */
+
+static const double xps_pow10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
 static char *
 xps_parse_real_num(char *s, float *number)
 {
     char buf[64];
     char *p = buf;
+    char *t = s;
+    double value = 0;
+    int digits = 0;
+    int fraction = 0;
+    int neg = 0;
+
+    if (*t == '+' || *t == '-')
+        neg = *t++ == '-';
+    while (*t >= '0' && *t <= '9')
+        value = value * 10 + (*t++ - '0'), digits++;
+    if (*t == '.')
+    {
+        t++;
+        while (*t >= '0' && *t <= '9')
+            value = value * 10 + (*t++ - '0'), digits++, fraction++;
+    }
+    if (digits > 0 && digits <= 15 && !is_real_num_char(*t))
+    {
+        value = value / xps_pow10[fraction];
+        *number = neg ? -value : value;
+        return t;
+    }
+
+    /* exponents and anything unusual */
     while (is_real_num_char(*s))
-        *p++ = *s++;
+    {
+        if (p < buf + sizeof buf - 1)
+            *p++ = *s;
+        s++;
+    }
     *p = 0;
     if (buf[0])
         *number = atof(buf);
@@ -480,16 +520,16 @@ xps_parse_glyphs(xps_context_t *ctx,
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "Glyphs.RenderTransform"))
+        if (xps_tag(node) == xps_Glyphs_RenderTransform)
             transform_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Glyphs.OpacityMask"))
+        if (xps_tag(node) == xps_Glyphs_OpacityMask)
             opacity_mask_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Glyphs.Clip"))
+        if (xps_tag(node) == xps_Glyphs_Clip)
             clip_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Glyphs.Fill"))
+        if (xps_tag(node) == xps_Glyphs_Fill)
             fill_tag = xps_down(node);
     }
 
@@ -536,6 +576,13 @@ xps_parse_glyphs(xps_context_t *ctx,
         if (!part)
             return gs_throw1(-1, "cannot find font resource part '%s'", partname);
 
+        /* the font keeps the data */
+        if (xps_own_part_data(ctx, part) < 0)
+        {
+            xps_free_part(ctx, part);
+            return gs_rethrow1(-1, "cannot load font resource '%s'", partname);
+        }
+
         /* deobfuscate if necessary */
         if (strstr(part->name, ".odttf"))
             xps_deobfuscate_font_resource(ctx, part);
@@ -603,7 +650,7 @@ xps_parse_glyphs(xps_context_t *ctx,
      * If it's a solid color brush fill/stroke do a simple fill
      */
 
-    if (fill_tag && !strcmp(xps_tag(fill_tag), "SolidColorBrush"))
+    if (fill_tag && xps_tag(fill_tag) == xps_SolidColorBrush)
     {
         fill_opacity_att = xps_att(fill_tag, "Opacity");
         fill_att = xps_att(fill_tag, "Color");
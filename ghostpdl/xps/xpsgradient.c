@@ -67,7 +67,7 @@ xps_parse_gradient_stops(xps_context_t *ctx, char *base_uri, xps_item_t *node,
     count = 0;
     while (node && count < maxcount)
     {
-        if (!strcmp(xps_tag(node), "GradientStop"))
+        if (xps_tag(node) == xps_GradientStop)
         {
             char *offset = xps_att(node, "Offset");
             char *color = xps_att(node, "Color");
@@ -838,13 +838,13 @@ xps_parse_gradient_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dic
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "LinearGradientBrush.Transform"))
+        if (xps_tag(node) == xps_LinearGradientBrush_Transform)
             transform_tag = xps_down(node);
-        if (!strcmp(xps_tag(node), "RadialGradientBrush.Transform"))
+        if (xps_tag(node) == xps_RadialGradientBrush_Transform)
             transform_tag = xps_down(node);
-        if (!strcmp(xps_tag(node), "LinearGradientBrush.GradientStops"))
+        if (xps_tag(node) == xps_LinearGradientBrush_GradientStops)
             stop_tag = xps_down(node);
-        if (!strcmp(xps_tag(node), "RadialGradientBrush.GradientStops"))
+        if (xps_tag(node) == xps_RadialGradientBrush_GradientStops)
             stop_tag = xps_down(node);
     }
 
@@ -15,7 +15,10 @@
  *
  * Simple hashtable with open adressing linear probe.
  * Does not manage memory of key/value pointers.
- * Does not support deleting entries.
+ * Deleting an entry shifts the rest of its probe run back.
+ * Keys are compared without case. The hash of the folded key is kept
+ * with each entry, so that the key is folded once when it is inserted,
+ * and only an entry whose hash matches is compared character by character.
  */
 
 #include "ghostxps.h"
@@ -31,6 +34,7 @@ typedef struct xps_hash_entry_s xps_hash_entry_t;
 struct xps_hash_entry_s
 {
     char *key;
+    unsigned int hash;
     void *value;
 };
 
@@ -50,7 +54,7 @@ xps_tolower(int c)
     return c;
 }
 
-static unsigned int
+static inline unsigned int
 xps_hash(char *s)
 {
     unsigned int h = 0;
@@ -117,8 +121,16 @@ xps_hash_double(xps_context_t *ctx, xps_hash_table_t *table)
     memset(table->entries, 0, sizeof(xps_hash_entry_t) * table->size);
 
     for (i = 0; i < old_size; i++)
+    {
         if (old_entries[i].value)
-            xps_hash_insert(ctx, table, old_entries[i].key, old_entries[i].value);
+        {
+            unsigned int pos = old_entries[i].hash % new_size;
+            while (new_entries[pos].value)
+                pos = (pos + 1) % new_size;
+            new_entries[pos] = old_entries[i];
+            table->load ++;
+        }
+    }
 
     xps_free(ctx, old_entries);
 
@@ -149,14 +161,15 @@ xps_hash_lookup(xps_hash_table_t *table, char *key)
 {
     xps_hash_entry_t *entries = table->entries;
     unsigned int size = table->size;
-    unsigned int pos = xps_hash(key) % size;
+    unsigned int hash = xps_hash(key);
+    unsigned int pos = hash % size;
 
     while (1)
     {
         if (!entries[pos].value)
             return NULL;
 
-        if (xps_strcasecmp(key, entries[pos].key) == 0)
+        if (entries[pos].hash == hash && xps_strcasecmp(key, entries[pos].key) == 0)
             return entries[pos].value;
 
         pos = (pos + 1) % size;
@@ -167,7 +180,7 @@ int
 xps_hash_insert(xps_context_t *ctx, xps_hash_table_t *table, char *key, void *value)
 {
     xps_hash_entry_t *entries;
-    unsigned int size, pos;
+    unsigned int size, pos, hash;
 
     /* Grow the table at 80% load */
     if (table->load > table->size * 8 / 10)
@@ -178,19 +191,21 @@ xps_hash_insert(xps_context_t *ctx, xps_hash_table_t *table, char *key, void *va
 
     entries = table->entries;
     size = table->size;
-    pos = xps_hash(key) % size;
+    hash = xps_hash(key);
+    pos = hash % size;
 
     while (1)
     {
         if (!entries[pos].value)
         {
             entries[pos].key = key;
+            entries[pos].hash = hash;
             entries[pos].value = value;
             table->load ++;
             return 0;
         }
 
-        if (xps_strcasecmp(key, entries[pos].key) == 0)
+        if (entries[pos].hash == hash && xps_strcasecmp(key, entries[pos].key) == 0)
         {
             return 0;
         }
@@ -199,6 +214,53 @@ xps_hash_insert(xps_context_t *ctx, xps_hash_table_t *table, char *key, void *va
     }
 }
 
+/* Remove an entry and return its value; the key is not freed. */
+void *
+xps_hash_remove(xps_hash_table_t *table, char *key)
+{
+    xps_hash_entry_t *entries = table->entries;
+    unsigned int size = table->size;
+    unsigned int hash = xps_hash(key);
+    unsigned int pos = hash % size;
+    unsigned int hole, home;
+    void *value;
+
+    while (1)
+    {
+        if (!entries[pos].value)
+            return NULL;
+
+        if (entries[pos].hash == hash && xps_strcasecmp(key, entries[pos].key) == 0)
+            break;
+
+        pos = (pos + 1) % size;
+    }
+
+    value = entries[pos].value;
+    hole = pos;
+
+    /* Move back any later entry that could not be found past the hole */
+    while (1)
+    {
+        pos = (pos + 1) % size;
+        if (!entries[pos].value)
+            break;
+
+        home = entries[pos].hash % size;
+        if (hole <= pos ? (home <= hole || home > pos) : (home <= hole && home > pos))
+        {
+            entries[hole] = entries[pos];
+            hole = pos;
+        }
+    }
+
+    entries[hole].key = NULL;
+    entries[hole].value = NULL;
+    table->load --;
+
+    return value;
+}
+
 void
 xps_hash_debug(xps_hash_table_t *table)
 {
@@ -333,13 +333,11 @@ xps_paint_image_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
 }
 
 static int
-xps_find_image_brush_source_part(xps_context_t *ctx, char *base_uri, xps_item_t *root,
-    xps_part_t **partp, char **profilep)
+xps_find_image_brush_source(xps_context_t *ctx, char *base_uri, xps_item_t *root,
+    char *partname, int partname_size, char **profilep)
 {
-    xps_part_t *part;
     char *image_source_att;
     char buf[1024];
-    char partname[1024];
     char *image_name;
     char *profile_name;
     char *p;
@@ -379,37 +377,237 @@ xps_find_image_brush_source_part(xps_context_t *ctx, char *base_uri, xps_item_t
     if (!image_name)
         return gs_throw1(-1, "cannot parse image resource name '%s'", image_source_att);
 
-    xps_absolute_path(partname, base_uri, image_name, sizeof partname);
-    part = xps_read_part(ctx, partname);
-    if (!part)
-        return gs_throw1(-1, "cannot find image resource part '%s'", partname);
-
-    *partp = part;
+    xps_absolute_path(partname, base_uri, image_name, partname_size);
     *profilep = xps_strdup(ctx, profile_name);
 
     return 0;
 }
 
+/*
+ * Decoded images are kept in a cache so that a page, or a run of pages,
+ * that paints the same image many times only inflates and decodes it
+ * once. The cache is bounded by the size of the decoded samples, and
+ * the least recently used images are dropped to make room.
+ */
+
+#define XPS_IMAGE_CACHE_LIMIT (32 * 1024 * 1024)
+
+struct xps_cached_image_s
+{
+    char *key; /* part name, then profile name */
+    xps_image_t *image;
+    int size;
+    xps_cached_image_t *prev;
+    xps_cached_image_t *next;
+};
+
 int
-xps_parse_image_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root)
+xps_init_image_cache(xps_context_t *ctx, int limit)
+{
+    xps_image_cache_t *cache = &ctx->image_cache;
+
+    memset(cache, 0, sizeof(xps_image_cache_t));
+
+    /* -1 for the default, 0 to turn the cache off */
+    cache->limit = limit < 0 ? XPS_IMAGE_CACHE_LIMIT : limit;
+
+    cache->table = xps_hash_new(ctx);
+    if (!cache->table)
+        return gs_rethrow(-1, "cannot create image cache");
+
+    return 0;
+}
+
+static void
+xps_unlink_cached_image(xps_image_cache_t *cache, xps_cached_image_t *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void
+xps_link_cached_image(xps_image_cache_t *cache, xps_cached_image_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+    cache->head = entry;
+}
+
+static void
+xps_drop_cached_image(xps_context_t *ctx, xps_cached_image_t *entry)
+{
+    xps_image_cache_t *cache = &ctx->image_cache;
+
+    xps_hash_remove(cache->table, entry->key);
+    xps_unlink_cached_image(cache, entry);
+    cache->size -= entry->size;
+
+    xps_free_image(ctx, entry->image);
+    xps_free(ctx, entry->key);
+    xps_free(ctx, entry);
+}
+
+static int
+xps_image_size(xps_image_t *image)
+{
+    int size = sizeof(xps_image_t) + image->profilesize;
+    if (image->samples)
+        size += image->stride * image->height;
+    if (image->alpha)
+        size += (image->width * image->bits + 7) / 8 * image->height;
+    return size;
+}
+
+static char *
+xps_image_cache_key(xps_context_t *ctx, char *partname, char *profilename)
+{
+    char *key;
+    int len = strlen(partname) + (profilename ? strlen(profilename) : 0) + 2;
+
+    key = xps_alloc(ctx, len);
+    if (!key)
+        return NULL;
+
+    xps_strlcpy(key, partname, len);
+    xps_strlcat(key, " ", len);
+    if (profilename)
+        xps_strlcat(key, profilename, len);
+
+    return key;
+}
+
+static xps_image_t *
+xps_lookup_cached_image(xps_context_t *ctx, char *partname, char *profilename)
+{
+    xps_image_cache_t *cache = &ctx->image_cache;
+    xps_cached_image_t *entry;
+    char *key;
+
+    if (!cache->table)
+        return NULL;
+
+    key = xps_image_cache_key(ctx, partname, profilename);
+    if (!key)
+        return NULL;
+    entry = xps_hash_lookup(cache->table, key);
+    xps_free(ctx, key);
+
+    if (!entry)
+        return NULL;
+
+    xps_unlink_cached_image(cache, entry);
+    xps_link_cached_image(cache, entry);
+    return entry->image;
+}
+
+/*
+ * Hand a decoded image over to the cache. Returns 1 if the cache now
+ * owns the image, or 0 if the caller must still free it.
+ */
+static int
+xps_insert_cached_image(xps_context_t *ctx, char *partname, char *profilename, xps_image_t *image)
+{
+    xps_image_cache_t *cache = &ctx->image_cache;
+    xps_cached_image_t *entry;
+    int size = xps_image_size(image);
+
+    if (!cache->table || size > cache->limit)
+        return 0;
+
+    while (cache->tail && cache->size + size > cache->limit)
+    {
+        xps_drop_cached_image(ctx, cache->tail);
+        cache->evictions ++;
+    }
+
+    entry = xps_alloc(ctx, sizeof(xps_cached_image_t));
+    if (!entry)
+        return 0;
+
+    entry->key = xps_image_cache_key(ctx, partname, profilename);
+    if (!entry->key)
+    {
+        xps_free(ctx, entry);
+        return 0;
+    }
+
+    if (xps_hash_insert(ctx, cache->table, entry->key, entry) < 0)
+    {
+        gs_catch(-1, "cannot cache image");
+        xps_free(ctx, entry->key);
+        xps_free(ctx, entry);
+        return 0;
+    }
+
+    entry->image = image;
+    entry->size = size;
+    xps_link_cached_image(cache, entry);
+
+    cache->size += size;
+    if (cache->size > cache->peak)
+        cache->peak = cache->size;
+
+    return 1;
+}
+
+void
+xps_free_image_cache(xps_context_t *ctx)
+{
+    xps_image_cache_t *cache = &ctx->image_cache;
+
+    if (gs_debug_c('|'))
+        dprintf6("xps: image cache %d hits, %d misses, %d evictions, %d bytes (peak %d, limit %d)\n",
+                cache->hits, cache->misses, cache->evictions,
+                cache->size, cache->peak, cache->limit);
+
+    while (cache->head)
+        xps_drop_cached_image(ctx, cache->head);
+
+    if (cache->table)
+        xps_hash_free(ctx, cache->table, NULL, NULL);
+
+    memset(cache, 0, sizeof(xps_image_cache_t));
+}
+
+static int
+xps_decode_image_part(xps_context_t *ctx, char *base_uri, char *partname, char *profilename,
+    xps_image_t **imagep)
 {
     xps_part_t *part;
     xps_image_t *image;
     gs_color_space *colorspace;
-    char *profilename;
     int code;
 
-    code = xps_find_image_brush_source_part(ctx, base_uri, root, &part, &profilename);
-    if (code < 0)
-        return gs_rethrow(code, "cannot find image source");
+    part = xps_read_part(ctx, partname);
+    if (!part)
+        return gs_throw1(-1, "cannot find image resource part '%s'", partname);
 
     image = xps_alloc(ctx, sizeof(xps_image_t));
     if (!image)
+    {
+        xps_free_part(ctx, part);
         return gs_throw(-1, "out of memory: image struct");
+    }
 
     code = xps_decode_image(ctx, part, image);
+    xps_free_part(ctx, part);
     if (code < 0)
-        return gs_rethrow1(code, "cannot decode image '%s'", part->name);
+    {
+        xps_free(ctx, image);
+        return gs_rethrow1(code, "cannot decode image '%s'", partname);
+    }
 
     /* Override any embedded colorspace profiles if the external one matches. */
     if (profilename)
@@ -422,14 +620,51 @@ xps_parse_image_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
         }
     }
 
-    code = xps_parse_tiling_brush(ctx, base_uri, dict, root, xps_paint_image_brush, image);
+    *imagep = image;
+    return 0;
+}
+
+int
+xps_parse_image_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root)
+{
+    xps_image_t *image;
+    char partname[1024];
+    char *profilename;
+    int cached;
+    int code;
+
+    code = xps_find_image_brush_source(ctx, base_uri, root, partname, sizeof partname, &profilename);
     if (code < 0)
-        return gs_rethrow(-1, "cannot parse tiling brush");
+        return gs_rethrow(code, "cannot find image source");
+
+    image = xps_lookup_cached_image(ctx, partname, profilename);
+    if (image)
+    {
+        ctx->image_cache.hits ++;
+        cached = 1;
+    }
+    else
+    {
+        ctx->image_cache.misses ++;
+        code = xps_decode_image_part(ctx, base_uri, partname, profilename, &image);
+        if (code < 0)
+        {
+            if (profilename)
+                xps_free(ctx, profilename);
+            return gs_rethrow(code, "cannot decode image source");
+        }
+        cached = xps_insert_cached_image(ctx, partname, profilename, image);
+    }
+
+    code = xps_parse_tiling_brush(ctx, base_uri, dict, root, xps_paint_image_brush, image);
 
     if (profilename)
         xps_free(ctx, profilename);
-    xps_free_image(ctx, image);
-    xps_free_part(ctx, part);
+    if (!cached)
+        xps_free_image(ctx, image);
+
+    if (code < 0)
+        return gs_rethrow(-1, "cannot parse tiling brush");
 
     return 0;
 }
@@ -438,17 +673,33 @@ int
 xps_image_brush_has_transparency(xps_context_t *ctx, char *base_uri, xps_item_t *root)
 {
     xps_part_t *imagepart;
+    xps_image_t *image;
+    char partname[1024];
+    char *profilename;
     int code;
     int has_alpha;
-    char *profilename;
 
-    code = xps_find_image_brush_source_part(ctx, base_uri, root, &imagepart, &profilename);
+    code = xps_find_image_brush_source(ctx, base_uri, root, partname, sizeof partname, &profilename);
     if (code < 0)
     {
         gs_catch(code, "cannot find image source");
         return 0;
     }
 
+    /* A decoded image already knows, without reading the part again. */
+    image = xps_lookup_cached_image(ctx, partname, profilename);
+    if (profilename)
+        xps_free(ctx, profilename);
+    if (image)
+        return image->alpha != NULL || image->hasalpha;
+
+    imagepart = xps_read_part(ctx, partname);
+    if (!imagepart)
+    {
+        gs_catch1(-1, "cannot find image resource part '%s'", partname);
+        return 0;
+    }
+
     has_alpha = xps_image_has_alpha(ctx, imagepart);
 
     xps_free_part(ctx, imagepart);
@@ -41,7 +41,7 @@ xps_parse_canvas(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_i
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "Canvas.Resources") && xps_down(node))
+        if (xps_tag(node) == xps_Canvas_Resources && xps_down(node))
         {
             code = xps_parse_resource_dictionary(ctx, &new_dict, base_uri, xps_down(node));
             if (code)
@@ -50,11 +50,11 @@ xps_parse_canvas(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_i
             dict = new_dict;
         }
 
-        if (!strcmp(xps_tag(node), "Canvas.RenderTransform"))
+        if (xps_tag(node) == xps_Canvas_RenderTransform)
             transform_tag = xps_down(node);
-        if (!strcmp(xps_tag(node), "Canvas.Clip"))
+        if (xps_tag(node) == xps_Canvas_Clip)
             clip_tag = xps_down(node);
-        if (!strcmp(xps_tag(node), "Canvas.OpacityMask"))
+        if (xps_tag(node) == xps_Canvas_OpacityMask)
             opacity_mask_tag = xps_down(node);
     }
 
@@ -109,30 +109,18 @@ xps_parse_canvas(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_i
     return 0;
 }
 
-int
-xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
+/*
+ * Set up the device for a new page, and push the transparency
+ * compositor if the page needs it.
+ */
+static int
+xps_begin_fixed_page(xps_context_t *ctx, xps_item_t *root, int has_transparency)
 {
-    xps_item_t *root, *node;
-    xps_resource_t *dict;
     char *width_att;
     char *height_att;
-    int has_transparency;
-    char base_uri[1024];
-    char *s;
     int code;
 
-    if_debug1('|', "doc: parsing page %s\n", part->name);
-
-    xps_strlcpy(base_uri, part->name, sizeof base_uri);
-    s = strrchr(base_uri, '/');
-    if (s)
-        s[1] = 0;
-
-    root = xps_parse_xml(ctx, part->data, part->size);
-    if (!root)
-        return gs_rethrow(-1, "cannot parse xml");
-
-    if (strcmp(xps_tag(root), "FixedPage"))
+    if (xps_tag(root) != xps_FixedPage)
         return gs_throw1(-1, "expected FixedPage element (found %s)", xps_tag(root));
 
     width_att = xps_att(root, "Width");
@@ -143,8 +131,6 @@ xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
     if (!height_att)
         return gs_throw(-1, "FixedPage missing required attribute: Height");
 
-    dict = NULL;
-
     /* Setup new page */
     {
         gs_memory_t *mem = ctx->memory;
@@ -190,19 +176,6 @@ xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
             return gs_rethrow(code, "cannot clear page");
     }
 
-    /* Pre-parse looking for transparency */
-
-    has_transparency = 0;
-
-    for (node = xps_down(root); node; node = xps_next(node))
-    {
-        if (!strcmp(xps_tag(node), "FixedPage.Resources") && xps_down(node))
-            if (xps_resource_dictionary_has_transparency(ctx, base_uri, xps_down(node)))
-                has_transparency = 1;
-        if (xps_element_has_transparency(ctx, base_uri, node))
-            has_transparency = 1;
-    }
-
     /* save the state with the original device before we push */
     gs_gsave(ctx->pgs);
 
@@ -224,28 +197,38 @@ xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
     ctx->scrgb->cmm_icc_profile_data = ctx->pgs->icc_manager->default_rgb;
     ctx->cmyk->cmm_icc_profile_data = ctx->pgs->icc_manager->default_cmyk;
 
-    /* Draw contents */
+    return 0;
+}
 
-    for (node = xps_down(root); node; node = xps_next(node))
-    {
-        if (!strcmp(xps_tag(node), "FixedPage.Resources") && xps_down(node))
-        {
-            code = xps_parse_resource_dictionary(ctx, &dict, base_uri, xps_down(node));
-            if (code)
-            {
-                gs_pop_pdf14trans_device(ctx->pgs);
-                gs_grestore(ctx->pgs);
-                return gs_rethrow(code, "cannot load FixedPage.Resources");
-            }
-        }
-        code = xps_parse_element(ctx, base_uri, dict, node);
-        if (code)
-        {
-            gs_pop_pdf14trans_device(ctx->pgs);
-            gs_grestore(ctx->pgs);
-            return gs_rethrow(code, "cannot parse child of FixedPage");
-        }
-    }
+/*
+ * Load the page resource dictionary, if node is FixedPage.Resources.
+ */
+static int
+xps_parse_fixed_page_resources(xps_context_t *ctx, char *base_uri, xps_resource_t **dictp, xps_item_t *node)
+{
+    int code;
+
+    if (xps_tag(node) != xps_FixedPage_Resources || !xps_down(node) || *dictp)
+        return 0;
+
+    code = xps_parse_resource_dictionary(ctx, dictp, base_uri, xps_down(node));
+    if (code)
+        return gs_rethrow(code, "cannot load FixedPage.Resources");
+
+    return 0;
+}
+
+static void
+xps_abort_fixed_page(xps_context_t *ctx)
+{
+    gs_pop_pdf14trans_device(ctx->pgs);
+    gs_grestore(ctx->pgs);
+}
+
+static int
+xps_end_fixed_page(xps_context_t *ctx, int has_transparency)
+{
+    int code;
 
     if (ctx->use_transparency && has_transparency)
     {
@@ -270,6 +253,71 @@ xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
     /* restore the original device, discarding the pdf14 compositor */
     gs_grestore(ctx->pgs);
 
+    return 0;
+}
+
+static void
+xps_page_base_uri(char *base_uri, char *name, int size)
+{
+    char *s;
+
+    xps_strlcpy(base_uri, name, size);
+    s = strrchr(base_uri, '/');
+    if (s)
+        s[1] = 0;
+}
+
+int
+xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
+{
+    xps_item_t *root, *node;
+    xps_resource_t *dict;
+    int has_transparency;
+    char base_uri[1024];
+    int code;
+
+    if_debug1('|', "doc: parsing page %s\n", part->name);
+
+    xps_page_base_uri(base_uri, part->name, sizeof base_uri);
+
+    root = xps_parse_xml(ctx, part->data, part->size);
+    if (!root)
+        return gs_rethrow(-1, "cannot parse xml");
+
+    /* Pre-parse looking for transparency */
+
+    dict = NULL;
+    has_transparency = 0;
+
+    for (node = xps_down(root); node; node = xps_next(node))
+    {
+        code = xps_parse_fixed_page_resources(ctx, base_uri, &dict, node);
+        if (code)
+            return gs_rethrow(code, "cannot load page resources");
+        if (ctx->use_transparency && !has_transparency)
+            has_transparency = xps_element_has_transparency(ctx, base_uri, dict, node);
+    }
+
+    code = xps_begin_fixed_page(ctx, root, has_transparency);
+    if (code)
+        return gs_rethrow(code, "cannot begin page");
+
+    /* Draw contents */
+
+    for (node = xps_down(root); node; node = xps_next(node))
+    {
+        code = xps_parse_element(ctx, base_uri, dict, node);
+        if (code)
+        {
+            xps_abort_fixed_page(ctx);
+            return gs_rethrow(code, "cannot parse child of FixedPage");
+        }
+    }
+
+    code = xps_end_fixed_page(ctx, has_transparency);
+    if (code)
+        return gs_rethrow(code, "cannot end page");
+
     if (dict)
     {
         xps_free_resource_dictionary(ctx, dict);
@@ -279,3 +327,162 @@ xps_parse_fixed_page(xps_context_t *ctx, xps_part_t *part)
 
     return 0;
 }
+
+/*
+ * Large pages are streamed: each child of the FixedPage is drawn and
+ * freed as soon as the parser has completed it, so only the resources
+ * and the element being drawn are ever held. Transparency has to be
+ * known before anything is drawn, so when it is enabled the part is
+ * first streamed once just to look for it, stopping at the first
+ * element that needs it.
+ */
+
+typedef struct xps_page_stream_s xps_page_stream_t;
+
+struct xps_page_stream_s
+{
+    char *base_uri;
+    xps_resource_t *dict;
+    int has_transparency;
+    int started;
+};
+
+static int
+xps_scan_streamed_page_child(xps_context_t *ctx, void *user, xps_item_t *root, xps_item_t *node)
+{
+    xps_page_stream_t *ps = user;
+    int code;
+
+    code = xps_parse_fixed_page_resources(ctx, ps->base_uri, &ps->dict, node);
+    if (code)
+        return gs_rethrow(code, "cannot load page resources");
+
+    if (xps_element_has_transparency(ctx, ps->base_uri, ps->dict, node))
+    {
+        ps->has_transparency = 1;
+        return XPS_STOP_PARSING;
+    }
+
+    /* the resource dictionary points into its element */
+    if (xps_tag(node) == xps_FixedPage_Resources)
+        return XPS_KEEP_CHILD;
+
+    return XPS_FREE_CHILD;
+}
+
+static int
+xps_draw_streamed_page_child(xps_context_t *ctx, void *user, xps_item_t *root, xps_item_t *node)
+{
+    xps_page_stream_t *ps = user;
+    int code;
+
+    if (!ps->started)
+    {
+        code = xps_begin_fixed_page(ctx, root, ps->has_transparency);
+        if (code)
+            return gs_rethrow(code, "cannot begin page");
+        ps->started = 1;
+    }
+
+    code = xps_parse_fixed_page_resources(ctx, ps->base_uri, &ps->dict, node);
+    if (code)
+        return gs_rethrow(code, "cannot load page resources");
+
+    code = xps_parse_element(ctx, ps->base_uri, ps->dict, node);
+    if (code)
+        return gs_rethrow(code, "cannot parse child of FixedPage");
+
+    /* the resource dictionary points into its element */
+    if (xps_tag(node) == xps_FixedPage_Resources)
+        return XPS_KEEP_CHILD;
+
+    return XPS_FREE_CHILD;
+}
+
+static int
+xps_stream_fixed_page_pass(xps_context_t *ctx, char *name, xps_child_proc_t *func,
+    xps_page_stream_t *ps, xps_item_t **rootp)
+{
+    xps_parser_t *parser;
+    int code;
+
+    *rootp = NULL;
+
+    parser = xps_new_parser(ctx, func, ps);
+    if (!parser)
+        return gs_rethrow(-1, "cannot create xml parser");
+
+    code = xps_stream_part(ctx, name, parser);
+    if (code < 0)
+    {
+        xps_free_parser(parser);
+        return gs_rethrow(code, "cannot parse xml");
+    }
+
+    code = xps_close_parser(parser, rootp);
+    if (code < 0)
+        return gs_rethrow(code, "cannot parse xml");
+    if (!*rootp)
+        return gs_throw(-1, "xml error: no root element");
+
+    return 0;
+}
+
+int
+xps_stream_fixed_page(xps_context_t *ctx, char *name)
+{
+    xps_page_stream_t ps;
+    xps_item_t *root;
+    char base_uri[1024];
+    int code;
+
+    if_debug1('|', "doc: streaming page %s\n", name);
+
+    xps_page_base_uri(base_uri, name, sizeof base_uri);
+
+    memset(&ps, 0, sizeof ps);
+    ps.base_uri = base_uri;
+
+    if (ctx->use_transparency)
+    {
+        code = xps_stream_fixed_page_pass(ctx, name, xps_scan_streamed_page_child, &ps, &root);
+        if (ps.dict)
+            xps_free_resource_dictionary(ctx, ps.dict);
+        ps.dict = NULL;
+        if (root)
+            xps_free_item(ctx, root);
+        if (code)
+            return gs_rethrow(code, "cannot scan page for transparency");
+    }
+
+    code = xps_stream_fixed_page_pass(ctx, name, xps_draw_streamed_page_child, &ps, &root);
+
+    /* a page with nothing on it */
+    if (!code && !ps.started)
+    {
+        code = xps_begin_fixed_page(ctx, root, ps.has_transparency);
+        if (code)
+            code = gs_rethrow(code, "cannot begin page");
+        else
+            ps.started = 1;
+    }
+
+    if (code)
+    {
+        if (ps.started)
+            xps_abort_fixed_page(ctx);
+    }
+    else
+    {
+        code = xps_end_fixed_page(ctx, ps.has_transparency);
+        if (code)
+            code = gs_rethrow(code, "cannot end page");
+    }
+
+    if (ps.dict)
+        xps_free_resource_dictionary(ctx, ps.dict);
+    if (root)
+        xps_free_item(ctx, root);
+
+    return code;
+}
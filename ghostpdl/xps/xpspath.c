@@ -651,13 +651,13 @@ xps_parse_path_figure(xps_context_t *ctx, xps_item_t *root, int stroking)
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "ArcSegment"))
+        if (xps_tag(node) == xps_ArcSegment)
             xps_parse_arc_segment(ctx, node, stroking, &skipped_stroke);
-        if (!strcmp(xps_tag(node), "PolyBezierSegment"))
+        if (xps_tag(node) == xps_PolyBezierSegment)
             xps_parse_poly_bezier_segment(ctx, node, stroking, &skipped_stroke);
-        if (!strcmp(xps_tag(node), "PolyLineSegment"))
+        if (xps_tag(node) == xps_PolyLineSegment)
             xps_parse_poly_line_segment(ctx, node, stroking, &skipped_stroke);
-        if (!strcmp(xps_tag(node), "PolyQuadraticBezierSegment"))
+        if (xps_tag(node) == xps_PolyQuadraticBezierSegment)
             xps_parse_poly_quadratic_bezier_segment(ctx, node, stroking, &skipped_stroke);
     }
 
@@ -693,7 +693,7 @@ xps_parse_path_geometry(xps_context_t *ctx, xps_resource_t *dict, xps_item_t *ro
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "PathGeometry.Transform"))
+        if (xps_tag(node) == xps_PathGeometry_Transform)
             transform_tag = xps_down(node);
     }
 
@@ -732,7 +732,7 @@ xps_parse_path_geometry(xps_context_t *ctx, xps_resource_t *dict, xps_item_t *ro
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "PathFigure"))
+        if (xps_tag(node) == xps_PathFigure)
             xps_parse_path_figure(ctx, node, stroking);
     }
 
@@ -827,22 +827,22 @@ xps_parse_path(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_ite
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "Path.RenderTransform"))
+        if (xps_tag(node) == xps_Path_RenderTransform)
             transform_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Path.OpacityMask"))
+        if (xps_tag(node) == xps_Path_OpacityMask)
             opacity_mask_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Path.Clip"))
+        if (xps_tag(node) == xps_Path_Clip)
             clip_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Path.Fill"))
+        if (xps_tag(node) == xps_Path_Fill)
             fill_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Path.Stroke"))
+        if (xps_tag(node) == xps_Path_Stroke)
             stroke_tag = xps_down(node);
 
-        if (!strcmp(xps_tag(node), "Path.Data"))
+        if (xps_tag(node) == xps_Path_Data)
             data_tag = xps_down(node);
     }
 
@@ -861,14 +861,14 @@ xps_parse_path(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_ite
      * Act on the information we have gathered:
      */
 
-    if (fill_tag && !strcmp(xps_tag(fill_tag), "SolidColorBrush"))
+    if (fill_tag && xps_tag(fill_tag) == xps_SolidColorBrush)
     {
         fill_opacity_att = xps_att(fill_tag, "Opacity");
         fill_att = xps_att(fill_tag, "Color");
         fill_tag = NULL;
     }
 
-    if (stroke_tag && !strcmp(xps_tag(stroke_tag), "SolidColorBrush"))
+    if (stroke_tag && xps_tag(stroke_tag) == xps_SolidColorBrush)
     {
         stroke_opacity_att = xps_att(stroke_tag, "Opacity");
         stroke_att = xps_att(stroke_tag, "Color");
@@ -19,11 +19,17 @@ static xps_item_t *
 xps_find_resource(xps_context_t *ctx, xps_resource_t *dict, char *name, char **urip)
 {
     xps_resource_t *head, *node;
+
+    /* keys are atoms, so a name that was never interned has no resource */
+    name = xps_lookup_atom(ctx, name);
+    if (!name)
+        return NULL;
+
     for (head = dict; head; head = head->parent)
     {
         for (node = head; node; node = node->next)
         {
-            if (!strcmp(node->name, name))
+            if (node->name == name)
             {
                 if (urip && head->base_uri)
                     *urip = head->base_uri;
@@ -66,19 +72,232 @@ xps_resolve_resource_reference(xps_context_t *ctx, xps_resource_t *dict,
     }
 }
 
+/*
+ * Remote dictionaries are usually shared by many pages, so once parsed
+ * they are kept for the rest of the package. A page gets a head node
+ * of its own that stands for the cached dictionary, so that it can be
+ * chained to the page's other dictionaries without touching the cached
+ * one, and the cached dictionary is not dropped while any such head is
+ * in use. The cache is bounded by the size of the parts, and the least
+ * recently used dictionaries that are not in use are dropped to make
+ * room.
+ */
+
+#define XPS_RESOURCE_CACHE_LIMIT (16 * 1024 * 1024)
+
+struct xps_remote_dict_s
+{
+    char *name; /* part name */
+    xps_resource_t *dict; /* owns the xml */
+    int size;
+    int refs;
+    xps_remote_dict_t *prev;
+    xps_remote_dict_t *next;
+};
+
+int
+xps_init_resource_cache(xps_context_t *ctx, int limit)
+{
+    xps_resource_cache_t *cache = &ctx->resource_cache;
+
+    memset(cache, 0, sizeof(xps_resource_cache_t));
+
+    /* -1 for the default, 0 to turn the cache off */
+    cache->limit = limit < 0 ? XPS_RESOURCE_CACHE_LIMIT : limit;
+
+    cache->table = xps_hash_new(ctx);
+    if (!cache->table)
+        return gs_rethrow(-1, "cannot create resource cache");
+
+    return 0;
+}
+
+static void
+xps_unlink_remote_dict(xps_resource_cache_t *cache, xps_remote_dict_t *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void
+xps_link_remote_dict(xps_resource_cache_t *cache, xps_remote_dict_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+    cache->head = entry;
+}
+
+static void
+xps_drop_remote_dict(xps_context_t *ctx, xps_remote_dict_t *entry)
+{
+    xps_resource_cache_t *cache = &ctx->resource_cache;
+
+    xps_hash_remove(cache->table, entry->name);
+    xps_unlink_remote_dict(cache, entry);
+    cache->size -= entry->size;
+
+    xps_free_resource_dictionary(ctx, entry->dict);
+    xps_free(ctx, entry->name);
+    xps_free(ctx, entry);
+}
+
+/* Drop unused dictionaries until there is room for size more bytes. */
+static void
+xps_trim_resource_cache(xps_context_t *ctx, int size)
+{
+    xps_resource_cache_t *cache = &ctx->resource_cache;
+    xps_remote_dict_t *entry, *prev;
+
+    for (entry = cache->tail; entry && cache->size + size > cache->limit; entry = prev)
+    {
+        prev = entry->prev;
+        if (entry->refs == 0)
+        {
+            xps_drop_remote_dict(ctx, entry);
+            cache->evictions ++;
+        }
+    }
+}
+
+static xps_resource_t *
+xps_new_remote_dict_head(xps_context_t *ctx, xps_remote_dict_t *entry)
+{
+    xps_resource_t *head;
+
+    head = xps_alloc(ctx, sizeof(xps_resource_t));
+    if (!head)
+        return NULL;
+
+    head->name = NULL; /* no key; atoms are never NULL, so it never matches */
+    head->base_uri = entry->dict->base_uri;
+    head->base_xml = NULL;
+    head->data = NULL;
+    head->next = entry->dict;
+    head->parent = NULL;
+    head->remote = entry;
+
+    entry->refs ++;
+    return head;
+}
+
+static void
+xps_release_remote_dict(xps_context_t *ctx, xps_remote_dict_t *entry)
+{
+    entry->refs --;
+    if (entry->refs == 0)
+        xps_trim_resource_cache(ctx, 0);
+}
+
+void
+xps_free_resource_cache(xps_context_t *ctx)
+{
+    xps_resource_cache_t *cache = &ctx->resource_cache;
+
+    if (gs_debug_c('|'))
+        dprintf6("xps: resource cache %d hits, %d misses, %d evictions, %d bytes (peak %d, limit %d)\n",
+                cache->hits, cache->misses, cache->evictions,
+                cache->size, cache->peak, cache->limit);
+
+    while (cache->head)
+        xps_drop_remote_dict(ctx, cache->head);
+
+    if (cache->table)
+        xps_hash_free(ctx, cache->table, NULL, NULL);
+
+    memset(cache, 0, sizeof(xps_resource_cache_t));
+}
+
+/*
+ * Hand a parsed remote dictionary over to the cache, and return the
+ * head the caller should use instead of it. If it cannot be cached the
+ * dictionary is returned as it is.
+ */
+static xps_resource_t *
+xps_insert_remote_dict(xps_context_t *ctx, char *part_name, xps_resource_t *dict, int size)
+{
+    xps_resource_cache_t *cache = &ctx->resource_cache;
+    xps_remote_dict_t *entry;
+
+    if (!cache->table || size > cache->limit)
+        return dict;
+
+    xps_trim_resource_cache(ctx, size);
+
+    entry = xps_alloc(ctx, sizeof(xps_remote_dict_t));
+    if (!entry)
+        return dict;
+
+    entry->name = xps_strdup(ctx, part_name);
+    if (!entry->name)
+    {
+        xps_free(ctx, entry);
+        return dict;
+    }
+
+    if (xps_hash_insert(ctx, cache->table, entry->name, entry) < 0)
+    {
+        gs_catch(-1, "cannot cache resource dictionary");
+        xps_free(ctx, entry->name);
+        xps_free(ctx, entry);
+        return dict;
+    }
+
+    entry->dict = dict;
+    entry->size = size;
+    entry->refs = 0;
+    xps_link_remote_dict(cache, entry);
+
+    cache->size += size;
+    if (cache->size > cache->peak)
+        cache->peak = cache->size;
+
+    /* on failure the dictionary stays cached for the next page */
+    return xps_new_remote_dict_head(ctx, entry);
+}
+
 static int
 xps_parse_remote_resource_dictionary(xps_context_t *ctx, xps_resource_t **dictp, char *base_uri, char *source_att)
 {
+    xps_resource_cache_t *cache = &ctx->resource_cache;
     char part_name[1024];
     char part_uri[1024];
+    xps_remote_dict_t *entry;
     xps_resource_t *dict;
     xps_part_t *part;
     xps_item_t *xml;
     char *s;
+    int size;
     int code;
 
     /* External resource dictionaries MUST NOT reference other resource dictionaries */
     xps_absolute_path(part_name, base_uri, source_att, sizeof part_name);
+
+    entry = cache->table ? xps_hash_lookup(cache->table, part_name) : NULL;
+    if (entry)
+    {
+        *dictp = xps_new_remote_dict_head(ctx, entry);
+        if (!*dictp)
+            return gs_throw(-1, "cannot allocate resource entry");
+        xps_unlink_remote_dict(cache, entry);
+        xps_link_remote_dict(cache, entry);
+        cache->hits ++;
+        return gs_okay;
+    }
+
+    cache->misses ++;
+
     part = xps_read_part(ctx, part_name);
     if (!part)
     {
@@ -92,7 +311,7 @@ xps_parse_remote_resource_dictionary(xps_context_t *ctx, xps_resource_t **dictp,
         return gs_rethrow(-1, "cannot parse xml");
     }
 
-    if (strcmp(xps_tag(xml), "ResourceDictionary"))
+    if (xps_tag(xml) != xps_ResourceDictionary)
     {
         xps_free_item(ctx, xml);
         xps_free_part(ctx, part);
@@ -112,11 +331,23 @@ xps_parse_remote_resource_dictionary(xps_context_t *ctx, xps_resource_t **dictp,
         return gs_rethrow1(code, "cannot parse remote resource dictionary: %s", part_uri);
     }
 
+    size = part->size;
+    xps_free_part(ctx, part);
+
+    /* nothing in it has a key */
+    if (!dict)
+    {
+        xps_free_item(ctx, xml);
+        *dictp = NULL;
+        return gs_okay;
+    }
+
     dict->base_xml = xml; /* pass on ownership */
 
-    xps_free_part(ctx, part);
+    *dictp = xps_insert_remote_dict(ctx, part_name, dict, size);
+    if (!*dictp)
+        return gs_rethrow(-1, "cannot allocate resource entry");
 
-    *dictp = dict;
     return gs_okay;
 }
 
@@ -147,6 +378,9 @@ xps_parse_resource_dictionary(xps_context_t *ctx, xps_resource_t **dictp, char *
         key = xps_att(node, "Key");
         if (key)
         {
+            key = xps_atom(ctx, key);
+            if (!key)
+                return gs_rethrow(-1, "cannot intern resource key");
             entry = xps_alloc(ctx, sizeof(xps_resource_t));
             if (!entry)
                 return gs_throw(-1, "cannot allocate resource entry");
@@ -156,6 +390,7 @@ xps_parse_resource_dictionary(xps_context_t *ctx, xps_resource_t **dictp, char *
             entry->data = node;
             entry->next = head;
             entry->parent = NULL;
+            entry->remote = NULL;
             head = entry;
         }
     }
@@ -173,6 +408,15 @@ void
 xps_free_resource_dictionary(xps_context_t *ctx, xps_resource_t *dict)
 {
     xps_resource_t *next;
+
+    /* the cached dictionary behind it stays */
+    if (dict && dict->remote)
+    {
+        xps_release_remote_dict(ctx, dict->remote);
+        xps_free(ctx, dict);
+        return;
+    }
+
     while (dict)
     {
         next = dict->next;
@@ -192,7 +436,10 @@ xps_debug_resource_dictionary(xps_resource_t *dict)
     {
         if (dict->base_uri)
             dprintf1("URI = '%s'\n", dict->base_uri);
-        dprintf2("KEY = '%s' VAL = %p\n", dict->name, dict->data);
+        if (dict->name)
+            dprintf2("KEY = '%s' VAL = %p\n", dict->name, dict->data);
+        else
+            dprintf1("HEAD VAL = %p\n", dict->data);
         if (dict->parent)
         {
             dputs("PARENT = {\n");
@@ -16,6 +16,259 @@
 #include "ghostxps.h"
 #include "gxdevsop.h"
 
+/*
+ * Tiling brushes are rendered through the pattern cache, which finds
+ * tiles by the id of the pattern instance. Documents often fill many
+ * elements, on many pages, with the same brush, so rather than taking
+ * a new id each time, brushes are described by a key made of their
+ * markup (with any resources they refer to), tile geometry, device
+ * space transform and the device they are drawn on, and the same key
+ * is given the same id. A tile that is still in the pattern cache is
+ * then used again instead of being painted once more.
+ *
+ * The table is indexed by a hash of the key, and the whole key is kept
+ * and compared, so two brushes can only share a tile if they match.
+ */
+
+#define XPS_TILE_CACHE_ENTRIES 4096
+#define XPS_TILE_CACHE_SIZE (8 * 1024 * 1024)
+#define XPS_TILE_KEY_DEPTH 8
+
+typedef struct xps_tile_key_s xps_tile_key_t;
+typedef struct xps_tile_id_s xps_tile_id_t;
+
+struct xps_tile_key_s
+{
+    byte *data;
+    int len;
+    int cap;
+    int error;
+};
+
+struct xps_tile_id_s
+{
+    gs_id id;
+    char hash[28]; /* the table key */
+    byte *data;
+    int len;
+};
+
+int
+xps_init_tile_cache(xps_context_t *ctx)
+{
+    xps_tile_cache_t *cache = &ctx->tile_cache;
+
+    memset(cache, 0, sizeof(xps_tile_cache_t));
+
+    cache->table = xps_hash_new(ctx);
+    if (!cache->table)
+        return gs_rethrow(-1, "cannot create tile cache");
+
+    return 0;
+}
+
+static void
+xps_free_tile_id_func(xps_context_t *ctx, void *ptr)
+{
+    xps_tile_id_t *entry = ptr;
+    xps_free(ctx, entry->data);
+    xps_free(ctx, entry);
+}
+
+void
+xps_free_tile_cache(xps_context_t *ctx)
+{
+    xps_tile_cache_t *cache = &ctx->tile_cache;
+
+    if (gs_debug_c('|'))
+        dprintf6("xps: tile cache %d hits, %d misses, %d collisions, %d resets, %d tiles painted for %d uses\n",
+                cache->hits, cache->misses, cache->collisions, cache->resets,
+                cache->painted, cache->hits + cache->misses + cache->collisions);
+
+    if (cache->table)
+        xps_hash_free(ctx, cache->table, NULL, xps_free_tile_id_func);
+
+    memset(cache, 0, sizeof(xps_tile_cache_t));
+}
+
+static void
+xps_tile_key_bytes(xps_context_t *ctx, xps_tile_key_t *k, const void *data, int len)
+{
+    byte *p;
+    int cap;
+
+    if (k->error)
+        return;
+    if (k->len + len > k->cap)
+    {
+        cap = max(k->cap * 2, k->len + len + 256);
+        p = xps_realloc(ctx, k->data, cap);
+        if (!p)
+        {
+            k->error = 1;
+            return;
+        }
+        k->data = p;
+        k->cap = cap;
+    }
+    memcpy(k->data + k->len, data, len);
+    k->len += len;
+}
+
+static void
+xps_tile_key_string(xps_context_t *ctx, xps_tile_key_t *k, const char *s)
+{
+    /* with the terminator, so that "ab" "c" differs from "a" "bc" */
+    xps_tile_key_bytes(ctx, k, s, strlen(s) + 1);
+}
+
+static void
+xps_tile_key_item(xps_context_t *ctx, xps_resource_t *dict, xps_tile_key_t *k,
+    xps_item_t *item, int depth)
+{
+    xps_item_t *node;
+    xps_item_t *rsrc;
+    char **atts;
+    char *att;
+    char *uri;
+    int i;
+
+    xps_tile_key_string(ctx, k, "<");
+    xps_tile_key_string(ctx, k, xps_tag(item));
+
+    atts = xps_att_list(item);
+    for (i = 0; atts[i]; i += 2)
+    {
+        xps_tile_key_string(ctx, k, atts[i]);
+        xps_tile_key_string(ctx, k, atts[i + 1]);
+
+        /* the resources a brush refers to are as much its content */
+        att = atts[i + 1];
+        rsrc = NULL;
+        uri = NULL;
+        xps_resolve_resource_reference(ctx, dict, &att, &rsrc, &uri);
+        if (rsrc && depth < XPS_TILE_KEY_DEPTH)
+        {
+            if (uri)
+                xps_tile_key_string(ctx, k, uri);
+            xps_tile_key_item(ctx, dict, k, rsrc, depth + 1);
+        }
+    }
+
+    for (node = xps_down(item); node; node = xps_next(node))
+        xps_tile_key_item(ctx, dict, k, node, depth);
+
+    xps_tile_key_string(ctx, k, ">");
+}
+
+/* Find the pattern id for a tiling brush, or take a new one. */
+static gs_id
+xps_find_tile_id(xps_context_t *ctx, char *base_uri, xps_resource_t *dict, xps_item_t *root,
+    int tile_mode, const gs_rect *viewbox, const gs_rect *viewport, const gs_matrix *transform)
+{
+    xps_tile_cache_t *cache = &ctx->tile_cache;
+    gx_device *dev = gs_currentdevice(ctx->pgs);
+    xps_tile_key_t k;
+    xps_tile_id_t *entry;
+    gs_matrix mat;
+    unsigned int a, b;
+    int info[5];
+    char hash[sizeof entry->hash];
+    int i;
+
+    if (!cache->table)
+        return gs_next_ids(ctx->memory, 1);
+
+    memset(&k, 0, sizeof k);
+
+    xps_tile_key_string(ctx, &k, base_uri);
+    xps_tile_key_item(ctx, dict, &k, root, 0);
+
+    /* the tile is rendered in device space, with the page clamping it */
+    gs_matrix_multiply(transform, &ctm_only(ctx->pgs), &mat);
+    xps_tile_key_bytes(ctx, &k, &mat, sizeof mat);
+    xps_tile_key_bytes(ctx, &k, viewbox, sizeof *viewbox);
+    xps_tile_key_bytes(ctx, &k, viewport, sizeof *viewport);
+    info[0] = tile_mode;
+    info[1] = ctx->opacity_only;
+    info[2] = dev->width;
+    info[3] = dev->height;
+    info[4] = dev->color_info.depth;
+    xps_tile_key_bytes(ctx, &k, info, sizeof info);
+    xps_tile_key_string(ctx, &k, dev->dname);
+
+    if (k.error || k.len > XPS_TILE_CACHE_SIZE / 4)
+    {
+        xps_free(ctx, k.data);
+        return gs_next_ids(ctx->memory, 1);
+    }
+
+    /* two unrelated hashes and the length index the table */
+    a = 2166136261u;
+    b = 5381;
+    for (i = 0; i < k.len; i++)
+    {
+        a = (a ^ k.data[i]) * 16777619; /* FNV-1a */
+        b = b * 33 + k.data[i]; /* djb2 */
+    }
+    sprintf(hash, "%08x%08x%08x", a, b, (unsigned int)k.len);
+
+    entry = xps_hash_lookup(cache->table, hash);
+    if (entry)
+    {
+        if (entry->len == k.len && !memcmp(entry->data, k.data, k.len))
+        {
+            cache->hits ++;
+            xps_free(ctx, k.data);
+            return entry->id;
+        }
+
+        /* keep the brush that was there first */
+        cache->collisions ++;
+        xps_free(ctx, k.data);
+        return gs_next_ids(ctx->memory, 1);
+    }
+
+    cache->misses ++;
+
+    /* the ids are cheap, but don't let the table grow without bound */
+    if (cache->count >= XPS_TILE_CACHE_ENTRIES || cache->size + k.len > XPS_TILE_CACHE_SIZE)
+    {
+        xps_hash_free(ctx, cache->table, NULL, xps_free_tile_id_func);
+        cache->table = xps_hash_new(ctx);
+        cache->count = 0;
+        cache->size = 0;
+        cache->resets ++;
+        if (!cache->table)
+        {
+            xps_free(ctx, k.data);
+            return gs_next_ids(ctx->memory, 1);
+        }
+    }
+
+    entry = xps_alloc(ctx, sizeof(xps_tile_id_t));
+    if (!entry)
+    {
+        xps_free(ctx, k.data);
+        return gs_next_ids(ctx->memory, 1);
+    }
+    entry->id = gs_next_ids(ctx->memory, 1);
+    strcpy(entry->hash, hash);
+    entry->data = k.data;
+    entry->len = k.len;
+
+    if (xps_hash_insert(ctx, cache->table, entry->hash, entry) < 0)
+    {
+        gs_catch(-1, "cannot remember tile id");
+        xps_free_tile_id_func(ctx, entry);
+        return gs_next_ids(ctx->memory, 1);
+    }
+    cache->count ++;
+    cache->size += k.len;
+
+    return entry->id;
+}
+
 /*
  * Parse a tiling brush (visual and image brushes at this time) common
  * properties. Use the callback to draw the individual tiles.
@@ -65,6 +318,8 @@ xps_paint_tiling_brush(const gs_client_color *pcc, gs_state *pgs)
     gs_state *saved_pgs;
     int code;
 
+    ctx->tile_cache.painted ++;
+
     saved_pgs = ctx->pgs;
     ctx->pgs = pgs;
 
@@ -134,6 +389,13 @@ xps_high_level_pattern(xps_context_t *ctx)
     if (code < 0)
         return code;
 
+    /* the device may still have the pattern for a brush we've used before,
+     * even though its entry has gone from the pattern cache */
+    code = dev_proc(ctx->pgs->device, dev_spec_op)(ctx->pgs->device,
+                                gxdso_pattern_load, pinst, pinst->id);
+    if (code == 1)
+        return 0;
+
     code = gs_gsave(ctx->pgs);
     if (code < 0)
         return code;
@@ -241,9 +503,9 @@ xps_parse_tiling_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "ImageBrush.Transform"))
+        if (xps_tag(node) == xps_ImageBrush_Transform)
             transform_tag = xps_down(node);
-        if (!strcmp(xps_tag(node), "VisualBrush.Transform"))
+        if (xps_tag(node) == xps_VisualBrush_Transform)
             transform_tag = xps_down(node);
     }
 
@@ -307,6 +569,7 @@ xps_parse_tiling_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
         gs_client_pattern gspat;
         gs_client_color gscolor;
         gs_color_space *cs;
+        gs_id id;
 
         closure.ctx = ctx;
         closure.base_uri = base_uri;
@@ -321,8 +584,14 @@ xps_parse_tiling_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
         closure.viewbox.q.x = viewbox.q.x;
         closure.viewbox.q.y = viewbox.q.y;
 
+        gs_matrix_translate(&transform, viewport.p.x, viewport.p.y, &transform);
+        gs_matrix_scale(&transform, scalex, scaley, &transform);
+        gs_matrix_translate(&transform, -viewbox.p.x, -viewbox.p.y, &transform);
+
+        id = xps_find_tile_id(ctx, base_uri, dict, root, tile_mode, &viewbox, &viewport, &transform);
+
         gs_pattern1_init(&gspat);
-        uid_set_UniqueID(&gspat.uid, gs_next_ids(ctx->memory, 1));
+        uid_set_UniqueID(&gspat.uid, id);
         gspat.PaintType = 1;
         gspat.TilingType = 1;
         gspat.PaintProc = xps_remap_pattern;
@@ -347,13 +616,19 @@ xps_parse_tiling_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
             gspat.YStep *= 2;
         }
 
-        gs_matrix_translate(&transform, viewport.p.x, viewport.p.y, &transform);
-        gs_matrix_scale(&transform, scalex, scaley, &transform);
-        gs_matrix_translate(&transform, -viewbox.p.x, -viewbox.p.y, &transform);
-
         cs = ctx->srgb;
         gs_setcolorspace(ctx->pgs, cs);
-        gs_makepattern(&gscolor, &gspat, &transform, ctx->pgs, NULL);
+        code = gs_makepattern(&gscolor, &gspat, &transform, ctx->pgs, NULL);
+        if (code < 0)
+        {
+            xps_end_opacity(ctx, base_uri, dict, opacity_att, NULL);
+            gs_grestore(ctx->pgs);
+            return gs_rethrow(code, "cannot create tiling pattern");
+        }
+
+        /* gs_makepattern takes a new id; use the one for this brush */
+        ((gs_pattern1_instance_t *)gscolor.pattern)->id = id;
+
         gs_setpattern(ctx->pgs, &gscolor);
 
         xps_fill(ctx);
@@ -31,6 +31,9 @@ static int xps_install_halftone(xps_context_t *ctx, gx_device *pdevice);
 
 #define XPS_PARSER_MIN_INPUT_SIZE (8192 * 4)
 
+/* FixedPages with more markup than this are not read into memory whole */
+#define XPS_STREAM_SIZE (16 * 1024 * 1024)
+
 /*
  * The XPS interpeter is identical to pl_interp_t.
  * The XPS interpreter instance is derived from pl_interp_instance_t.
@@ -67,6 +70,7 @@ xps_imp_characteristics(const pl_interp_implementation_t *pimpl)
         XPS_VERSION,
         XPS_BUILD_DATE,
         XPS_PARSER_MIN_INPUT_SIZE, /* Minimum input size */
+        true, /* FirstPage, LastPage and PageList apply to each package */
     };
     return &xps_characteristics;
 }
@@ -121,9 +125,14 @@ xps_imp_allocate_interp_instance(pl_interp_instance_t **ppinstance,
      */
     ctx->pgs->have_pattern_streams = true;
     ctx->fontdir = NULL;
+    ctx->directory = NULL;
     ctx->file = NULL;
     ctx->zip_count = 0;
     ctx->zip_table = NULL;
+    ctx->zip_index = NULL;
+    ctx->zip_data = NULL;
+    ctx->zip_size = 0;
+    ctx->atoms = NULL;
 
     /* Gray, RGB and CMYK profiles set when color spaces installed in graphics lib */
     ctx->gray = gs_cspace_new_DeviceGray(ctx->memory);
@@ -230,6 +239,64 @@ cleanup_setdevice:
     return code;
 }
 
+/*
+ * Give a page worker its own instance of the output device, made from
+ * the device prototype with the parameters of the current device. The
+ * current device, and the band list files it may have open, are left
+ * alone for the parent process.
+ */
+int
+xps_install_worker_device(xps_context_t *ctx)
+{
+    gx_device *pdevice = gs_currentdevice(ctx->pgs);
+    const gx_device *proto;
+    gx_device *copy;
+    gs_c_param_list list;
+    int code, i;
+
+    for (i = 0; (proto = gs_getdevice(i)) != NULL; i++)
+        if (!strcmp(proto->dname, pdevice->dname))
+            break;
+    if (!proto)
+        return gs_throw1(-1, "cannot find device prototype '%s'", pdevice->dname);
+
+    code = gs_copydevice(&copy, proto, ctx->memory);
+    if (code < 0)
+        return gs_rethrow(code, "cannot copy device");
+
+    gs_c_param_list_write(&list, ctx->memory);
+    code = gs_getdeviceparams(pdevice, (gs_param_list *)&list);
+    if (code >= 0)
+    {
+        gs_c_param_list_read(&list);
+        code = gs_putdeviceparams(copy, (gs_param_list *)&list);
+    }
+    gs_c_param_list_release(&list);
+    if (code < 0)
+        return gs_rethrow(code, "cannot copy device parameters");
+
+    code = gs_opendevice(copy);
+    if (code < 0)
+        return gs_rethrow(code, "cannot open worker device");
+
+    code = gsicc_init_device_profile(ctx->pgs, copy);
+    if (code < 0)
+        return gs_rethrow(code, "cannot set worker device profile");
+
+    /* never close the shared device from here */
+    rc_increment(pdevice);
+
+    code = gs_setdevice_no_erase(ctx->pgs, copy);
+    if (code < 0)
+        return gs_rethrow(code, "cannot set worker device");
+
+    code = xps_install_halftone(ctx, copy);
+    if (code < 0)
+        return gs_rethrow(code, "cannot install worker halftone");
+
+    return 0;
+}
+
 static int
 xps_imp_get_device_memory(pl_interp_instance_t *pinstance, gs_memory_t **ppmem)
 {
@@ -343,15 +410,29 @@ xps_imp_init_job(pl_interp_instance_t *pinstance)
     if (gs_debug_c('|'))
         xps_doc_trace = 1;
 
+    xps_init_atoms(ctx);
     ctx->font_table = xps_hash_new(ctx);
     ctx->colorspace_table = xps_hash_new(ctx);
+    xps_init_image_cache(ctx, instance->pl.xps_image_cache_size);
+    xps_init_resource_cache(ctx, instance->pl.xps_resource_cache_size);
+    xps_init_tile_cache(ctx);
 
     ctx->start_part = NULL;
 
+    ctx->page_first = instance->pl.first_page;
+    ctx->page_last = instance->pl.last_page;
+    ctx->page_list = instance->pl.page_list;
+
     ctx->use_transparency = 1;
     if (getenv("XPS_DISABLE_TRANSPARENCY"))
         ctx->use_transparency = 0;
 
+    ctx->workers = instance->pl.workers;
+
+    ctx->stream_size = XPS_STREAM_SIZE;
+    if (instance->pl.xps_stream_size > 0)
+        ctx->stream_size = instance->pl.xps_stream_size;
+
     ctx->opacity_only = 0;
     ctx->fill_rule = 0;
 
@@ -382,14 +463,22 @@ xps_imp_dnit_job(pl_interp_instance_t *pinstance)
     for (i = 0; i < ctx->zip_count; i++)
         xps_free(ctx, ctx->zip_table[i].name);
     xps_free(ctx, ctx->zip_table);
+    if (ctx->zip_index)
+        xps_hash_free(ctx, ctx->zip_index, NULL, NULL);
+    ctx->zip_index = NULL;
 
     /* TODO: free resources too */
     xps_hash_free(ctx, ctx->font_table, xps_free_key_func, xps_free_font_func);
     xps_hash_free(ctx, ctx->colorspace_table, xps_free_key_func, NULL);
+    xps_free_tile_cache(ctx);
+    xps_free_resource_cache(ctx);
+    xps_free_image_cache(ctx);
 
     xps_free_fixed_pages(ctx);
     xps_free_fixed_documents(ctx);
 
+    xps_free_atoms(ctx);
+
     return 0;
 }
 
@@ -44,7 +44,7 @@ xps_parse_visual_brush(xps_context_t *ctx, char *base_uri, xps_resource_t *dict,
 
     for (node = xps_down(root); node; node = xps_next(node))
     {
-        if (!strcmp(xps_tag(node), "VisualBrush.Visual"))
+        if (xps_tag(node) == xps_VisualBrush_Visual)
             visual_tag = xps_down(node);
     }
 
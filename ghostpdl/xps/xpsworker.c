@@ -0,0 +1,268 @@
+/* Copyright (C) 2006-2010 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen  Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* XPS interpreter - rendering pages in worker processes */
+
+#include "ghostxps.h"
+#include "pltop.h" /* for pl_page_selected */
+
+/*
+ * FixedPages are independent of each other, so with -dNumWorkers=<n>
+ * the pages of a package are shared out among n processes. The
+ * graphics library keeps global state and is not reentrant, so the
+ * workers are forked processes rather than threads. Each has its own
+ * graphics state and its own instance of the output device, and sees
+ * the mapped package and the font and colorspace caches as they were
+ * when it was started.
+ *
+ * Workers take the next page from a counter in shared memory, and
+ * write it straight to its own file by setting the device PageCount
+ * first. The output must therefore be one file per page. A failed page
+ * stops any later page from being started, and is reported as the
+ * serial renderer would report it.
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "errno_.h"
+#include "unistd_.h"
+#include "gsfname.h"
+#include "gxdevice.h"
+#include "gxiodev.h"
+
+typedef struct xps_worker_state_s xps_worker_state_t;
+
+struct xps_worker_state_s
+{
+    volatile int next; /* next page to render */
+    volatile int failed; /* first page that failed, or the page count */
+};
+
+int
+xps_can_use_workers(xps_context_t *ctx)
+{
+    gx_device *dev = gs_currentdevice(ctx->pgs);
+    gs_c_param_list list;
+    gs_param_string output;
+    gs_parsed_file_name_t parsed;
+    const char *fmt = NULL;
+    char name[gp_file_name_sizeof];
+    int code;
+
+    /* stdio would share the file position with the workers */
+    if (!ctx->zip_data && !ctx->directory)
+    {
+        gs_warn("-dNumWorkers needs a package that can be mapped into memory");
+        return 0;
+    }
+
+    gs_c_param_list_write(&list, ctx->memory);
+    code = gs_getdeviceparams(dev, (gs_param_list *)&list);
+    if (code >= 0)
+    {
+        gs_c_param_list_read(&list);
+        code = param_read_string((gs_param_list *)&list, "OutputFile", &output);
+    }
+    if (code == 0 && output.size < sizeof name)
+    {
+        memcpy(name, output.data, output.size);
+        name[output.size] = 0;
+        code = gx_parse_output_file_name(&parsed, &fmt, name, output.size, ctx->memory);
+    }
+    else
+        code = -1;
+    gs_c_param_list_release(&list);
+
+    if (code < 0 || !fmt || parsed.iodev != iodev_default(ctx->memory))
+    {
+        gs_warn("-dNumWorkers needs an OutputFile with a %%d page number");
+        return 0;
+    }
+
+    return 1;
+}
+
+static void
+xps_worker_fail(xps_worker_state_t *state, int k)
+{
+    int failed;
+
+    do
+        failed = state->failed;
+    while (failed > k && !__sync_bool_compare_and_swap(&state->failed, failed, k));
+}
+
+static void
+xps_worker_main(xps_context_t *ctx, xps_page_t **pages, int count, long base,
+    xps_worker_state_t *state)
+{
+    gx_device *dev;
+    int code, k;
+
+    code = xps_install_worker_device(ctx);
+    if (code < 0)
+    {
+        gs_catch(code, "cannot start page worker");
+        _exit(1);
+    }
+    dev = gs_currentdevice(ctx->pgs);
+
+    while (1)
+    {
+        k = __sync_fetch_and_add(&state->next, 1);
+        if (k >= count || k > state->failed)
+            break;
+
+        dev->PageCount = base + k;
+        code = xps_read_and_process_page_part(ctx, pages[k]->name);
+        if (code)
+        {
+            gs_catch1(code, "cannot process FixedPage part '%s'", pages[k]->name);
+            xps_worker_fail(state, k);
+        }
+    }
+
+    /* the output files are closed after each page */
+    _exit(0);
+}
+
+int
+xps_process_pages_in_workers(xps_context_t *ctx)
+{
+    gx_device *dev = gs_currentdevice(ctx->pgs);
+    xps_worker_state_t *state;
+    xps_document_t *doc;
+    xps_page_t *page;
+    xps_page_t **pages;
+    pid_t *pids;
+    long base = dev->PageCount;
+    int count, number, selected;
+    int started, broken;
+    int code, status, i;
+    pid_t pid;
+
+    for (doc = ctx->first_fixdoc; doc; doc = doc->next)
+    {
+        code = xps_read_and_process_metadata_part(ctx, doc->name);
+        if (code)
+            return gs_rethrow(code, "cannot process FixedDocument part");
+    }
+
+    count = 0;
+    for (page = ctx->first_page; page; page = page->next)
+        count ++;
+
+    pages = xps_alloc(ctx, sizeof(xps_page_t*) * max(count, 1));
+    pids = xps_alloc(ctx, sizeof(pid_t) * ctx->workers);
+    if (!pages || !pids)
+    {
+        xps_free(ctx, pages);
+        xps_free(ctx, pids);
+        return gs_throw(-1, "out of memory: page worker tables");
+    }
+
+    count = 0;
+    number = 0;
+    for (page = ctx->first_page; page; page = page->next)
+    {
+        selected = pl_page_selected(ctx->page_first, ctx->page_last, ctx->page_list, ++number);
+        if (selected < 0)
+            break;
+        if (selected)
+            pages[count++] = page;
+    }
+
+    state = mmap(NULL, sizeof(xps_worker_state_t), PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (state == MAP_FAILED)
+    {
+        xps_free(ctx, pages);
+        xps_free(ctx, pids);
+        return gs_throw(-1, "cannot map page worker state");
+    }
+    state->next = 0;
+    state->failed = count;
+
+    /* don't let the workers write out our buffers too */
+    fflush(NULL);
+
+    for (started = 0; started < min(ctx->workers, count); started++)
+    {
+        pids[started] = fork();
+        if (pids[started] < 0)
+            break;
+        if (pids[started] == 0)
+            xps_worker_main(ctx, pages, count, base, state);
+    }
+
+    if (started == 0)
+        gs_warn("cannot start page workers, rendering serially");
+
+    broken = 0;
+    for (i = 0; i < started; i++)
+    {
+        while ((pid = waitpid(pids[i], &status, 0)) < 0 && errno == EINTR)
+            ;
+        if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            broken = 1;
+    }
+
+    /* nothing was started, or the workers stopped early */
+    code = 0;
+    for (i = state->next; i < count && i < state->failed && !broken; i++)
+    {
+        dev->PageCount = base + i;
+        code = xps_read_and_process_page_part(ctx, pages[i]->name);
+        if (code)
+        {
+            state->failed = i;
+            break;
+        }
+    }
+
+    dev->PageCount = base + state->failed;
+    i = state->failed;
+
+    munmap(state, sizeof(xps_worker_state_t));
+
+    if (broken)
+        code = gs_throw(-1, "page worker process failed");
+    else if (i < count && !code)
+        code = gs_throw1(-1, "cannot process FixedPage part '%s'", pages[i]->name);
+    else if (code)
+        code = gs_rethrow(code, "cannot process FixedPage part");
+
+    xps_free(ctx, pages);
+    xps_free(ctx, pids);
+
+    return code;
+}
+
+#else
+
+int
+xps_can_use_workers(xps_context_t *ctx)
+{
+    gs_warn("-dNumWorkers is not supported on this platform");
+    return 0;
+}
+
+int
+xps_process_pages_in_workers(xps_context_t *ctx)
+{
+    return gs_throw(-1, "page workers are not supported on this platform");
+}
+
+#endif
@@ -22,16 +22,22 @@
 #define NS_XPS "http://schemas.microsoft.com/xps/2005/06"
 #define NS_MC "http://schemas.openxmlformats.org/markup-compatibility/2006"
 
-typedef struct xps_parser_s xps_parser_t;
-
 struct xps_parser_s
 {
     xps_context_t *ctx;
     xps_item_t *root;
     xps_item_t *head;
-    char *error;
+    xps_item_t *last; /* element closed most recently */
+    const char *error;
     int compat;
     char *base; /* base of relative URIs */
+
+    /* streaming parsers only */
+    XML_Parser xp;
+    xps_child_proc_t *func;
+    void *user;
+    int code;
+    int stopped;
 };
 
 struct xps_item_s
@@ -58,8 +64,6 @@ on_open_tag(void *zp, char *ns_name, char **atts)
     xps_parser_t *parser = zp;
     xps_context_t *ctx = parser->ctx;
     xps_item_t *item;
-    xps_item_t *tail;
-    int namelen;
     int attslen;
     int textlen;
     char *name, *p;
@@ -91,41 +95,47 @@ on_open_tag(void *zp, char *ns_name, char **atts)
         name = ns_name;
     }
 
-    /* count size to alloc */
+    /* count size to alloc; names are atoms, only values are copied */
 
-    namelen = strlen(name) + 1; /* zero terminated */
     attslen = sizeof(char*); /* with space for sentinel */
     textlen = 0;
     for (i = 0; atts[i]; i++)
     {
         attslen += sizeof(char*);
-        if ((i & 1) == 0)
-            textlen += strlen(skip_namespace(atts[i])) + 1;
-        else
+        if (i & 1)
             textlen += strlen(atts[i]) + 1;
     }
 
-    item = xps_alloc(ctx, sizeof(xps_item_t) + attslen + namelen + textlen);
+    item = xps_alloc(ctx, sizeof(xps_item_t) + attslen + textlen);
     if (!item)
     {
         parser->error = "out of memory";
+        return;
     }
 
-    /* copy strings to new memory */
-
     item->atts = (char**) (((char*)item) + sizeof(xps_item_t));
-    item->name = ((char*)item) + sizeof(xps_item_t) + attslen;
-    p = ((char*)item) + sizeof(xps_item_t) + attslen + namelen;
+    p = ((char*)item) + sizeof(xps_item_t) + attslen;
 
-    strcpy(item->name, name);
+    item->name = xps_atom(ctx, name);
     for (i = 0; atts[i]; i++)
     {
-        item->atts[i] = p;
         if ((i & 1) == 0)
-            strcpy(item->atts[i], skip_namespace(atts[i]));
+            item->atts[i] = xps_atom(ctx, skip_namespace(atts[i]));
         else
-            strcpy(item->atts[i], atts[i]);
-        p += strlen(p) + 1;
+        {
+            item->atts[i] = p;
+            strcpy(p, atts[i]);
+            p += strlen(p) + 1;
+        }
+        if (!item->atts[i])
+            break;
+    }
+
+    if (!item->name || atts[i])
+    {
+        xps_free(ctx, item);
+        parser->error = "out of memory";
+        return;
     }
 
     item->atts[i] = 0;
@@ -143,30 +153,76 @@ on_open_tag(void *zp, char *ns_name, char **atts)
         return;
     }
 
-    if (!parser->head->down)
-    {
+    /* the last element closed, if any, is the last child of head */
+    if (parser->last && parser->last->up == parser->head)
+        parser->last->next = item;
+    else
         parser->head->down = item;
-        parser->head = item;
+    parser->head = item;
+}
+
+/*
+ * Hand a child of the root that has just been completed to the
+ * streaming parser's callback, and unlink and free it unless the
+ * callback wants it kept.
+ */
+static void
+on_close_child(xps_parser_t *parser, xps_item_t *item)
+{
+    xps_item_t *root = parser->root;
+    xps_item_t *prev;
+    int code;
+
+    code = parser->func(parser->ctx, parser->user, root, item);
+    if (code < 0)
+    {
+        parser->code = code;
+        parser->error = "cannot process element";
+        XML_StopParser(parser->xp, XML_FALSE);
         return;
     }
 
-    tail = parser->head->down;
-    while (tail->next)
-        tail = tail->next;
-    tail->next = item;
-    parser->head = item;
+    if (code == XPS_STOP_PARSING)
+    {
+        parser->stopped = 1;
+        XML_StopParser(parser->xp, XML_FALSE);
+        return;
+    }
+
+    if (code == XPS_KEEP_CHILD)
+        return;
+
+    /* the completed child is always the last one */
+    if (root->down == item)
+        prev = NULL;
+    else
+        for (prev = root->down; prev->next != item; prev = prev->next)
+            ;
+    if (prev)
+        prev->next = NULL;
+    else
+        root->down = NULL;
+    parser->last = prev;
+    xps_free_item(parser->ctx, item);
 }
 
 static void
 on_close_tag(void *zp, char *name)
 {
     xps_parser_t *parser = zp;
+    xps_item_t *item;
 
     if (parser->error)
         return;
 
     if (parser->head)
-        parser->head = parser->head->up;
+    {
+        item = parser->head;
+        parser->head = item->up;
+        parser->last = item;
+        if (parser->func && item->up && item->up == parser->root)
+            on_close_child(parser, item);
+    }
 }
 
 static inline int
@@ -225,11 +281,8 @@ xps_parse_xml(xps_context_t *ctx, byte *buf, int len)
     XML_Parser xp;
     int code;
 
+    memset(&parser, 0, sizeof parser);
     parser.ctx = ctx;
-    parser.root = NULL;
-    parser.head = NULL;
-    parser.error = NULL;
-    parser.compat = 0;
 
     xp = XML_ParserCreateNS(NULL, ' ');
     if (!xp)
@@ -262,6 +315,119 @@ xps_parse_xml(xps_context_t *ctx, byte *buf, int len)
     return parser.root;
 }
 
+/*
+ * A streaming parser is fed a part a piece at a time, and calls func
+ * as each child of the root element is completed, so that a large page
+ * can be drawn without ever holding all of its markup or its tree.
+ */
+
+xps_parser_t *
+xps_new_parser(xps_context_t *ctx, xps_child_proc_t *func, void *user)
+{
+    xps_parser_t *parser;
+
+    parser = xps_alloc(ctx, sizeof(xps_parser_t));
+    if (!parser)
+    {
+        gs_throw(-1, "out of memory: xml parser");
+        return NULL;
+    }
+
+    memset(parser, 0, sizeof(xps_parser_t));
+    parser->ctx = ctx;
+    parser->func = func;
+    parser->user = user;
+
+    parser->xp = XML_ParserCreateNS(NULL, ' ');
+    if (!parser->xp)
+    {
+        xps_free(ctx, parser);
+        gs_throw(-1, "xml error: could not create expat parser");
+        return NULL;
+    }
+
+    XML_SetUserData(parser->xp, parser);
+    XML_SetParamEntityParsing(parser->xp, XML_PARAM_ENTITY_PARSING_NEVER);
+    XML_SetStartElementHandler(parser->xp, (XML_StartElementHandler)on_open_tag);
+    XML_SetEndElementHandler(parser->xp, (XML_EndElementHandler)on_close_tag);
+    XML_SetCharacterDataHandler(parser->xp, (XML_CharacterDataHandler)on_text);
+
+    return parser;
+}
+
+/*
+ * Returns 1 once the callback has asked for the rest of the part to
+ * be skipped.
+ */
+int
+xps_feed_parser(xps_parser_t *parser, byte *buf, int len)
+{
+    if (parser->stopped)
+        return 1;
+
+    if (XML_Parse(parser->xp, (char*)buf, len, 0) == 0)
+    {
+        if (parser->stopped)
+            return 1;
+        if (parser->code < 0)
+            return gs_rethrow(parser->code, "cannot process xml element");
+        return gs_throw1(-1, "xml error: %s", XML_ErrorString(XML_GetErrorCode(parser->xp)));
+    }
+
+    return 0;
+}
+
+/*
+ * Finish parsing and free the parser. What is left of the tree is
+ * returned in *rootp, and belongs to the caller.
+ */
+int
+xps_close_parser(xps_parser_t *parser, xps_item_t **rootp)
+{
+    xps_context_t *ctx = parser->ctx;
+    int code = 0;
+
+    *rootp = NULL;
+
+    if (!parser->stopped && XML_Parse(parser->xp, NULL, 0, 1) == 0)
+    {
+        if (parser->code < 0)
+            code = gs_rethrow(parser->code, "cannot process xml element");
+        else if (!parser->stopped)
+            code = gs_throw1(-1, "xml error: %s", XML_ErrorString(XML_GetErrorCode(parser->xp)));
+    }
+    else if (parser->error && !parser->stopped)
+        code = gs_throw1(-1, "xml error: %s", parser->error);
+
+    if (code < 0)
+    {
+        xps_free_parser(parser);
+        return code;
+    }
+
+    if (parser->compat)
+        xps_process_compatibility(ctx, parser->root);
+    *rootp = parser->root;
+    parser->root = NULL;
+
+    xps_free_parser(parser);
+    return gs_okay;
+}
+
+/*
+ * Abandon a streaming parse, with whatever is left of its tree.
+ */
+void
+xps_free_parser(xps_parser_t *parser)
+{
+    xps_context_t *ctx = parser->ctx;
+
+    XML_ParserFree(parser->xp);
+    if (parser->root)
+        xps_free_item(ctx, parser->root);
+    xps_free(ctx, parser);
+}
+
 xps_item_t *
 xps_next(xps_item_t *item)
 {
@@ -290,6 +456,13 @@ xps_att(xps_item_t *item, const char *att)
     return NULL;
 }
 
+/* all attributes, as a null terminated list of name, value pairs */
+char **
+xps_att_list(xps_item_t *item)
+{
+    return item->atts;
+}
+
 void
 xps_free_item(xps_context_t *ctx, xps_item_t *item)
 {
@@ -14,6 +14,13 @@
 /* XPS interpreter - zip container parsing */
 
 #include "ghostxps.h"
+#include "stat_.h"
+#include "pltop.h" /* for pl_page_selected */
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define XPS_HAVE_MMAP
+#endif
 
 static int isfile(char *path)
 {
@@ -42,6 +49,16 @@ static inline int getlong(FILE *file)
     return a | (b << 8) | (c << 16) | (d << 24);
 }
 
+static inline int getshort_mem(byte *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline int getlong_mem(byte *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+}
+
 static void *
 xps_zip_alloc_items(xps_context_t *ctx, int items, int size)
 {
@@ -54,48 +71,132 @@ xps_zip_free(xps_context_t *ctx, void *ptr)
     xps_free(ctx, ptr);
 }
 
-static int
-xps_compare_entries(const void *a0, const void *b0)
+static xps_entry_t *
+xps_find_zip_entry(xps_context_t *ctx, char *name)
 {
-    xps_entry_t *a = (xps_entry_t*) a0;
-    xps_entry_t *b = (xps_entry_t*) b0;
-    return xps_strcasecmp(a->name, b->name);
+    if (!ctx->zip_index)
+        return NULL;
+    return xps_hash_lookup(ctx->zip_index, name);
 }
 
-static xps_entry_t *
-xps_find_zip_entry(xps_context_t *ctx, char *name)
+/*
+ * The package is mapped into memory when it is a regular file, so that
+ * stored parts can be used in place and deflated parts inflated straight
+ * from the mapping. The mapping is private and writable, since a few
+ * consumers patch part data in place. Anything that cannot be mapped is
+ * read with stdio instead.
+ */
+
+static void
+xps_map_zip_file(xps_context_t *ctx)
 {
-    int l = 0;
-    int r = ctx->zip_count - 1;
-    while (l <= r)
+#ifdef XPS_HAVE_MMAP
+    struct stat st;
+    void *data;
+
+    if (fstat(fileno(ctx->file), &st) < 0 || !S_ISREG(st.st_mode))
+        return;
+    if (st.st_size <= 0 || st.st_size > max_int)
+        return;
+
+    data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(ctx->file), 0);
+    if (data == MAP_FAILED)
     {
-        int m = (l + r) >> 1;
-        int c = xps_strcasecmp(name, ctx->zip_table[m].name);
-        if (c < 0)
-            r = m - 1;
-        else if (c > 0)
-            l = m + 1;
-        else
-            return &ctx->zip_table[m];
+        if_debug0('|', "zip: cannot map file, using stdio\n");
+        return;
     }
-    return NULL;
+
+    ctx->zip_data = data;
+    ctx->zip_size = st.st_size;
+    if_debug1('|', "zip: mapped %d bytes\n", ctx->zip_size);
+#endif
+}
+
+static void
+xps_unmap_zip_file(xps_context_t *ctx)
+{
+#ifdef XPS_HAVE_MMAP
+    if (ctx->zip_data)
+        munmap(ctx->zip_data, ctx->zip_size);
+#endif
+    ctx->zip_data = NULL;
+    ctx->zip_size = 0;
 }
 
 /*
- * Inflate the data in a zip entry.
+ * Find the data of a zip entry in the mapped package.
  */
 
 static int
-xps_read_zip_entry(xps_context_t *ctx, xps_entry_t *ent, unsigned char *outbuf)
+xps_map_zip_entry(xps_context_t *ctx, xps_entry_t *ent, byte **datap, int *methodp)
+{
+    byte *p;
+    int sig, method, namelength, extralength;
+    int start, size;
+
+    if (ent->offset < 0 || ent->offset > ctx->zip_size - 30)
+        return gs_throw1(-1, "zip entry '%s' is outside the file", ent->name);
+
+    p = ctx->zip_data + ent->offset;
+
+    sig = getlong_mem(p);
+    if (sig != ZIP_LOCAL_FILE_SIG)
+        return gs_throw1(-1, "wrong zip local file signature (0x%x)", sig);
+
+    method = getshort_mem(p + 8);
+    namelength = getshort_mem(p + 26);
+    extralength = getshort_mem(p + 28);
+
+    start = ent->offset + 30 + namelength + extralength;
+    size = method == 0 ? ent->usize : ent->csize;
+    if (size < 0 || start > ctx->zip_size || size > ctx->zip_size - start)
+        return gs_throw1(-1, "zip entry '%s' is truncated", ent->name);
+
+    *datap = ctx->zip_data + start;
+    *methodp = method;
+    return 0;
+}
+
+static int
+xps_inflate_zip_data(xps_context_t *ctx, byte *inbuf, int insize, byte *outbuf, int outsize)
 {
     z_stream stream;
-    unsigned char *inbuf;
-    int sig;
-    int version, general, method;
-    int namelength, extralength;
     int code;
 
-    if_debug1('|', "zip: inflating entry '%s'\n", ent->name);
+    memset(&stream, 0, sizeof(z_stream));
+    stream.zalloc = (alloc_func) xps_zip_alloc_items;
+    stream.zfree = (free_func) xps_zip_free;
+    stream.opaque = ctx;
+    stream.next_in = inbuf;
+    stream.avail_in = insize;
+    stream.next_out = outbuf;
+    stream.avail_out = outsize;
+
+    code = inflateInit2(&stream, -15);
+    if (code != Z_OK)
+        return gs_throw1(-1, "zlib inflateInit2 error: %s", stream.msg);
+    code = inflate(&stream, Z_FINISH);
+    if (code != Z_STREAM_END)
+    {
+        inflateEnd(&stream);
+        return gs_throw1(-1, "zlib inflate error: %s", stream.msg);
+    }
+    code = inflateEnd(&stream);
+    if (code != Z_OK)
+        return gs_throw1(-1, "zlib inflateEnd error: %s", stream.msg);
+
+    return gs_okay;
+}
+
+/*
+ * Read the local header of a zip entry, leaving the file at its data.
+ */
+
+static int
+xps_seek_zip_entry(xps_context_t *ctx, xps_entry_t *ent, int *methodp)
+{
+    int sig;
+    int namelength, extralength;
 
     fseek(ctx->file, ent->offset, 0);
 
@@ -103,9 +204,9 @@ xps_read_zip_entry(xps_context_t *ctx, xps_entry_t *ent, unsigned char *outbuf)
     if (sig != ZIP_LOCAL_FILE_SIG)
         return gs_throw1(-1, "wrong zip local file signature (0x%x)", sig);
 
-    version = getshort(ctx->file);
-    general = getshort(ctx->file);
-    method = getshort(ctx->file);
+    (void) getshort(ctx->file); /* version */
+    (void) getshort(ctx->file); /* general */
+    *methodp = getshort(ctx->file);
     (void) getshort(ctx->file); /* file time */
     (void) getshort(ctx->file); /* file date */
     (void) getlong(ctx->file); /* crc-32 */
@@ -116,6 +217,42 @@ xps_read_zip_entry(xps_context_t *ctx, xps_entry_t *ent, unsigned char *outbuf)
 
     fseek(ctx->file, namelength + extralength, 1);
 
+    return gs_okay;
+}
+
+/*
+ * Inflate the data in a zip entry.
+ */
+
+static int
+xps_read_zip_entry(xps_context_t *ctx, xps_entry_t *ent, unsigned char *outbuf)
+{
+    unsigned char *inbuf;
+    int method;
+    int code;
+
+    if_debug1('|', "zip: inflating entry '%s'\n", ent->name);
+
+    if (ctx->zip_data)
+    {
+        code = xps_map_zip_entry(ctx, ent, &inbuf, &method);
+        if (code < 0)
+            return gs_rethrow(code, "cannot find zip entry data");
+
+        if (method == 0)
+            memcpy(outbuf, inbuf, ent->usize);
+        else if (method == 8)
+            return xps_inflate_zip_data(ctx, inbuf, ent->csize, outbuf, ent->usize);
+        else
+            return gs_throw1(-1, "unknown compression method (%d)", method);
+
+        return gs_okay;
+    }
+
+    code = xps_seek_zip_entry(ctx, ent, &method);
+    if (code < 0)
+        return gs_rethrow(code, "cannot find zip entry data");
+
     if (method == 0)
     {
         fread(outbuf, 1, ent->usize, ctx->file);
@@ -126,29 +263,12 @@ xps_read_zip_entry(xps_context_t *ctx, xps_entry_t *ent, unsigned char *outbuf)
 
         fread(inbuf, 1, ent->csize, ctx->file);
 
-        memset(&stream, 0, sizeof(z_stream));
-        stream.zalloc = (alloc_func) xps_zip_alloc_items;
-        stream.zfree = (free_func) xps_zip_free;
-        stream.opaque = ctx;
-        stream.next_in = inbuf;
-        stream.avail_in = ent->csize;
-        stream.next_out = outbuf;
-        stream.avail_out = ent->usize;
-
-        code = inflateInit2(&stream, -15);
-        if (code != Z_OK)
-            return gs_throw1(-1, "zlib inflateInit2 error: %s", stream.msg);
-        code = inflate(&stream, Z_FINISH);
-        if (code != Z_STREAM_END)
-        {
-            inflateEnd(&stream);
-            return gs_throw1(-1, "zlib inflate error: %s", stream.msg);
-        }
-        code = inflateEnd(&stream);
-        if (code != Z_OK)
-            return gs_throw1(-1, "zlib inflateEnd error: %s", stream.msg);
+        code = xps_inflate_zip_data(ctx, inbuf, ent->csize, outbuf, ent->usize);
 
         xps_free(ctx, inbuf);
+
+        if (code < 0)
+            return code;
     }
     else
     {
@@ -226,10 +346,14 @@ xps_read_zip_dir(xps_context_t *ctx, int start_offset)
         fseek(ctx->file, commentsize, 1);
     }
 
-    qsort(ctx->zip_table, count, sizeof(xps_entry_t), xps_compare_entries);
+    ctx->zip_index = xps_hash_new(ctx);
+    if (!ctx->zip_index)
+        return gs_rethrow(-1, "cannot create zip entry index");
 
     for (i = 0; i < ctx->zip_count; i++)
     {
+        if (xps_hash_insert(ctx, ctx->zip_index, ctx->zip_table[i].name, &ctx->zip_table[i]) < 0)
+            return gs_rethrow(-1, "cannot index zip entry");
         if_debug3('|', "zip entry '%s' csize=%d usize=%d\n",
                 ctx->zip_table[i].name,
                 ctx->zip_table[i].csize,
@@ -281,6 +405,8 @@ xps_read_zip_part(xps_context_t *ctx, char *partname)
     xps_entry_t *ent;
     xps_part_t *part;
     int count, size, offset, i;
+    int method;
+    byte *data;
     char *name;
 
     name = partname;
@@ -291,6 +417,14 @@ xps_read_zip_part(xps_context_t *ctx, char *partname)
     ent = xps_find_zip_entry(ctx, name);
     if (ent)
     {
+        /* Stored parts are used in place */
+        if (ctx->zip_data &&
+                xps_map_zip_entry(ctx, ent, &data, &method) == 0 && method == 0)
+        {
+            if_debug1('|', "zip: mapping entry '%s'\n", ent->name);
+            return xps_new_mapped_part(ctx, partname, data, ent->usize);
+        }
+
         part = xps_new_part(ctx, partname, ent->usize);
         xps_read_zip_entry(ctx, ent, part->data);
         return part;
@@ -414,10 +548,288 @@ xps_read_part(xps_context_t *ctx, char *partname)
 }
 
 /*
- * Read and process the XPS document.
+ * Streaming parts to a parser. The part is fed to the parser a buffer
+ * at a time as it is read and inflated, so the whole of it is never in
+ * memory at once. These return 1 if the parser stopped early.
  */
 
+#define XPS_STREAM_BUFSIZE (64 * 1024)
+
+static int
+xps_stream_zip_entry(xps_context_t *ctx, xps_entry_t *ent, xps_parser_t *parser, byte *buf)
+{
+    byte *inbuf = buf;
+    byte *outbuf = buf + XPS_STREAM_BUFSIZE;
+    byte *data = NULL;
+    z_stream stream;
+    int method, remaining, n;
+    int code, zcode;
+
+    if_debug1('|', "zip: streaming entry '%s'\n", ent->name);
+
+    if (ctx->zip_data)
+        code = xps_map_zip_entry(ctx, ent, &data, &method);
+    else
+        code = xps_seek_zip_entry(ctx, ent, &method);
+    if (code < 0)
+        return gs_rethrow(code, "cannot find zip entry data");
+
+    if (method == 0)
+    {
+        remaining = ent->usize;
+        while (remaining > 0)
+        {
+            n = min(remaining, XPS_STREAM_BUFSIZE);
+            if (data)
+            {
+                code = xps_feed_parser(parser, data, n);
+                data += n;
+            }
+            else if (fread(inbuf, 1, n, ctx->file) == n)
+                code = xps_feed_parser(parser, inbuf, n);
+            else
+                code = gs_throw1(-1, "cannot read zip entry '%s'", ent->name);
+            if (code)
+                return code;
+            remaining -= n;
+        }
+        return gs_okay;
+    }
+
+    if (method != 8)
+        return gs_throw1(-1, "unknown compression method (%d)", method);
+
+    memset(&stream, 0, sizeof(z_stream));
+    stream.zalloc = (alloc_func) xps_zip_alloc_items;
+    stream.zfree = (free_func) xps_zip_free;
+    stream.opaque = ctx;
+
+    remaining = ent->csize;
+    if (data)
+    {
+        stream.next_in = data;
+        stream.avail_in = remaining;
+        remaining = 0;
+    }
+
+    zcode = inflateInit2(&stream, -15);
+    if (zcode != Z_OK)
+        return gs_throw1(-1, "zlib inflateInit2 error: %s", stream.msg);
+
+    code = 0;
+    while (!code && zcode != Z_STREAM_END)
+    {
+        if (stream.avail_in == 0 && remaining > 0)
+        {
+            n = min(remaining, XPS_STREAM_BUFSIZE);
+            if (fread(inbuf, 1, n, ctx->file) != n)
+            {
+                code = gs_throw1(-1, "cannot read zip entry '%s'", ent->name);
+                break;
+            }
+            stream.next_in = inbuf;
+            stream.avail_in = n;
+            remaining -= n;
+        }
+
+        stream.next_out = outbuf;
+        stream.avail_out = XPS_STREAM_BUFSIZE;
+        zcode = inflate(&stream, Z_NO_FLUSH);
+        if (zcode != Z_OK && zcode != Z_STREAM_END)
+        {
+            code = gs_throw1(-1, "zlib inflate error: %s", stream.msg ? stream.msg : "truncated data");
+            break;
+        }
+
+        n = XPS_STREAM_BUFSIZE - stream.avail_out;
+        if (n > 0)
+            code = xps_feed_parser(parser, outbuf, n);
+    }
+
+    inflateEnd(&stream);
+    return code;
+}
+
 static int
+xps_stream_zip_part(xps_context_t *ctx, char *partname, xps_parser_t *parser, byte *buf)
+{
+    char name[2048];
+    xps_entry_t *ent;
+    int code, i;
+
+    if (partname[0] == '/')
+        partname ++;
+
+    ent = xps_find_zip_entry(ctx, partname);
+    if (ent)
+        return xps_stream_zip_entry(ctx, ent, parser, buf);
+
+    for (i = 0; ; i++)
+    {
+        sprintf(name, "%s/[%d].piece", partname, i);
+        ent = xps_find_zip_entry(ctx, name);
+        if (!ent)
+        {
+            sprintf(name, "%s/[%d].last.piece", partname, i);
+            ent = xps_find_zip_entry(ctx, name);
+        }
+        if (!ent)
+            break;
+        code = xps_stream_zip_entry(ctx, ent, parser, buf);
+        if (code)
+            return code;
+    }
+
+    if (i == 0)
+        return gs_throw1(-1, "cannot find zip part '%s'", partname);
+    return gs_okay;
+}
+
+static int
+xps_stream_dir_file(xps_context_t *ctx, FILE *file, xps_parser_t *parser, byte *buf)
+{
+    int n, code;
+
+    while ((n = fread(buf, 1, XPS_STREAM_BUFSIZE, file)) > 0)
+    {
+        code = xps_feed_parser(parser, buf, n);
+        if (code)
+            return code;
+    }
+    return gs_okay;
+}
+
+static int
+xps_stream_dir_part(xps_context_t *ctx, char *partname, xps_parser_t *parser, byte *buf)
+{
+    char name[2048];
+    FILE *file;
+    int code, i;
+
+    xps_strlcpy(name, ctx->directory, sizeof name);
+    xps_strlcat(name, partname, sizeof name);
+
+    file = fopen(name, "rb");
+    if (file)
+    {
+        code = xps_stream_dir_file(ctx, file, parser, buf);
+        fclose(file);
+        return code;
+    }
+
+    for (i = 0; ; i++)
+    {
+        sprintf(name, "%s%s/[%d].piece", ctx->directory, partname, i);
+        file = fopen(name, "rb");
+        if (!file)
+        {
+            sprintf(name, "%s%s/[%d].last.piece", ctx->directory, partname, i);
+            file = fopen(name, "rb");
+        }
+        if (!file)
+            break;
+        code = xps_stream_dir_file(ctx, file, parser, buf);
+        fclose(file);
+        if (code)
+            return code;
+    }
+
+    if (i == 0)
+        return gs_throw1(-1, "cannot find part '%s'", partname);
+    return gs_okay;
+}
+
+int
+xps_stream_part(xps_context_t *ctx, char *partname, xps_parser_t *parser)
+{
+    byte *buf;
+    int code;
+
+    buf = xps_alloc(ctx, XPS_STREAM_BUFSIZE * 2);
+    if (!buf)
+        return gs_throw(-1, "out of memory: stream buffer");
+
+    if (ctx->directory)
+        code = xps_stream_dir_part(ctx, partname, parser, buf);
+    else
+        code = xps_stream_zip_part(ctx, partname, parser, buf);
+
+    xps_free(ctx, buf);
+    return code;
+}
+
+/*
+ * The inflated size of a part, or -1 if there is no such part.
+ */
+
+int
+xps_part_size(xps_context_t *ctx, char *partname)
+{
+    char name[2048];
+    xps_entry_t *ent;
+    struct stat st;
+    int size, i;
+
+    if (ctx->directory)
+    {
+        xps_strlcpy(name, ctx->directory, sizeof name);
+        xps_strlcat(name, partname, sizeof name);
+        if (stat(name, &st) == 0)
+            return st.st_size;
+    }
+    else
+    {
+        if (partname[0] == '/')
+            partname ++;
+        ent = xps_find_zip_entry(ctx, partname);
+        if (ent)
+            return ent->usize;
+    }
+
+    size = 0;
+    for (i = 0; ; i++)
+    {
+        if (ctx->directory)
+        {
+            sprintf(name, "%s%s/[%d].piece", ctx->directory, partname, i);
+            if (stat(name, &st) == 0)
+            {
+                size += st.st_size;
+                continue;
+            }
+            sprintf(name, "%s%s/[%d].last.piece", ctx->directory, partname, i);
+            if (stat(name, &st) == 0)
+            {
+                size += st.st_size;
+                continue;
+            }
+        }
+        else
+        {
+            sprintf(name, "%s/[%d].piece", partname, i);
+            ent = xps_find_zip_entry(ctx, name);
+            if (!ent)
+            {
+                sprintf(name, "%s/[%d].last.piece", partname, i);
+                ent = xps_find_zip_entry(ctx, name);
+            }
+            if (ent)
+            {
+                size += ent->usize;
+                continue;
+            }
+        }
+        break;
+    }
+
+    return i ? size : -1;
+}
+
+/*
+ * Read and process the XPS document.
+ */
+
+int
 xps_read_and_process_metadata_part(xps_context_t *ctx, char *name)
 {
     xps_part_t *part;
@@ -436,12 +848,20 @@ xps_read_and_process_metadata_part(xps_context_t *ctx, char *name)
     return gs_okay;
 }
 
-static int
+int
 xps_read_and_process_page_part(xps_context_t *ctx, char *name)
 {
     xps_part_t *part;
     int code;
 
+    if (xps_part_size(ctx, name) > ctx->stream_size)
+    {
+        code = xps_stream_fixed_page(ctx, name);
+        if (code)
+            return gs_rethrow1(code, "cannot parse fixed page part '%s'", name);
+        return gs_okay;
+    }
+
     part = xps_read_part(ctx, name);
     if (!part)
         return gs_rethrow1(-1, "cannot read zip part '%s'", name);
@@ -459,19 +879,16 @@ xps_read_and_process_page_part(xps_context_t *ctx, char *name)
  * Called by xpstop.c
  */
 
-int
-xps_process_file(xps_context_t *ctx, char *filename)
+static int
+xps_process_package(xps_context_t *ctx, char *filename)
 {
     char buf[2048];
     xps_document_t *doc;
-    xps_page_t *page;
+    xps_page_t *page, *last;
+    int number, selected;
     int code;
     char *p;
 
-    ctx->file = fopen(filename, "rb");
-    if (!ctx->file)
-        return gs_throw1(-1, "cannot open file: '%s'", filename);
-
     if (strstr(filename, ".fpage"))
     {
         xps_part_t *part;
@@ -529,6 +946,8 @@ xps_process_file(xps_context_t *ctx, char *filename)
     }
     else
     {
+        xps_map_zip_file(ctx);
+
         code = xps_find_and_read_zip_dir(ctx);
         if (code < 0)
             return gs_rethrow(code, "cannot read zip central directory");
@@ -545,24 +964,63 @@ xps_process_file(xps_context_t *ctx, char *filename)
     if (code)
         return gs_rethrow(code, "cannot process FixedDocumentSequence part");
 
+    if (ctx->workers > 1 && xps_can_use_workers(ctx))
+        return xps_process_pages_in_workers(ctx);
+
+    /*
+     * Each FixedDocument is read just before its pages, and pages that
+     * are not selected are never read, so the cost of extracting a few
+     * pages does not depend on the length of the package.
+     */
+
+    last = NULL;
+    number = 0;
+
     for (doc = ctx->first_fixdoc; doc; doc = doc->next)
     {
         code = xps_read_and_process_metadata_part(ctx, doc->name);
         if (code)
             return gs_rethrow(code, "cannot process FixedDocument part");
-    }
 
-    for (page = ctx->first_page; page; page = page->next)
-    {
-        code = xps_read_and_process_page_part(ctx, page->name);
-        if (code)
-            return gs_rethrow(code, "cannot process FixedPage part");
+        /* the pages this document added to the list */
+        for (page = last ? last->next : ctx->first_page; page; page = page->next)
+        {
+            last = page;
+            number ++;
+
+            selected = pl_page_selected(ctx->page_first, ctx->page_last, ctx->page_list, number);
+            if (selected < 0)
+                return gs_okay;
+
+            if (selected)
+            {
+                code = xps_read_and_process_page_part(ctx, page->name);
+                if (code)
+                    return gs_rethrow(code, "cannot process FixedPage part");
+            }
+        }
     }
 
+    return gs_okay;
+}
+
+int
+xps_process_file(xps_context_t *ctx, char *filename)
+{
+    int code;
+
+    ctx->file = fopen(filename, "rb");
+    if (!ctx->file)
+        return gs_throw1(-1, "cannot open file: '%s'", filename);
+
+    code = xps_process_package(ctx, filename);
+
+    xps_unmap_zip_file(ctx);
     if (ctx->directory)
         xps_free(ctx, ctx->directory);
-    if (ctx->file)
-        fclose(ctx->file);
+    ctx->directory = NULL;
+    fclose(ctx->file);
+    ctx->file = NULL;
 
-    return gs_okay;
+    return code;
 }
@@ -389,7 +389,9 @@ static const gx_device_procs plibk_procs =
              { 0, /* page_uses_transparency */\
                0, /* Bandwidth */\
                MINBANDHEIGHT, /* BandHeight */\
-               0 /* BandBufferSpace */},\
+               0, /* BandBufferSpace */\
+               0, /* AdaptiveBandHeight */\
+               0 /* BandListCompressor */},\
            0/*false*/,  /* params_are_read_only */\
            BandingAlways        /* banding_type */\
          },\
@@ -401,8 +403,11 @@ static const gx_device_procs plibk_procs =
         0/*false*/, 0, 0, 0, /* file_is_new ... buf */\
         0, 0, 0, 0, 0/*false*/, 0, 0, /* buffer_memory ... clist_dis'_mask */\
         0,              /* num_render_threads_requested */\
+        0,              /* max_pages_in_flight */\
         { 0 },  /* save_procs_while_delaying_erasepage */\
-        { 0 }   /* ... orig_procs */}
+        { 0 },  /* ... orig_procs */\
+        0,      /* render_thread_pool */\
+        0       /* page_pipeline */}
 
 /* The device descriptors themselves */
 const gx_device_plib gs_plib_device =
@@ -84,14 +84,15 @@ int
 gdev_prn_close(gx_device * pdev)
 {
     gx_device_printer * const ppdev = (gx_device_printer *)pdev;
-    int code = 0;
+    int code = clist_free_page_pipeline(pdev);
+    int closecode = 0;
 
     gdev_prn_free_memory(pdev);
     if (ppdev->file != NULL) {
-	code = gx_device_close_output_file(pdev, ppdev->fname, ppdev->file);
+	closecode = gx_device_close_output_file(pdev, ppdev->fname, ppdev->file);
 	ppdev->file = NULL;
     }
-    return code;
+    return (code < 0 ? code : closecode);
 }
 
 static int		/* returns 0 ok, else -ve error cde */
@@ -143,8 +144,11 @@ open_c:
     clist_init_params(pclist_dev, base, space, pdev,
 		      ppdev->printer_procs.buf_procs,
 		      space_params->band, ppdev->is_async_renderer,
-		      (ppdev->bandlist_memory == 0 ? pdev->memory->non_gc_memory:
-		       ppdev->bandlist_memory),
+		      (ppdev->bandlist_memory != 0 ? ppdev->bandlist_memory :
+		       /* saved pages are freed by the page pipeline's thread */
+		       ppdev->max_pages_in_flight > 0 ?
+		       pdev->memory->thread_safe_memory :
+		       pdev->memory->non_gc_memory),
 		      ppdev->free_up_bandlist_memory,
 		      ppdev->clist_disable_mask,
 		      ppdev->page_uses_transparency);
@@ -194,6 +198,8 @@ gdev_prn_tear_down(gx_device *pdev, byte **the_memory)
     bool is_command_list;
 
     if (ppdev->buffer_space != 0) {
+	/* Stop the band rendering threads kept from page to page */
+	clist_free_render_threads(pdev);
 	/* Close cmd list device & point to the storage */
 	(*gs_clist_device_procs.close_device)( (gx_device *)pcldev );
 	*the_memory = ppdev->buf;
@@ -503,7 +509,10 @@ gdev_prn_get_params(gx_device * pdev, gs_param_list * plist)
 	(code = param_write_int(plist, "BandWidth", &ppdev->space_params.band.BandWidth)) < 0 ||
 	(code = param_write_int(plist, "BandHeight", &ppdev->space_params.band.BandHeight)) < 0 ||
 	(code = param_write_long(plist, "BandBufferSpace", &ppdev->space_params.band.BandBufferSpace)) < 0 ||
+	(code = param_write_bool(plist, "AdaptiveBandHeight", &ppdev->space_params.band.AdaptiveBandHeight)) < 0 ||
+	(code = param_write_int(plist, "BandListCompressor", &ppdev->space_params.band.BandListCompressor)) < 0 ||
 	(code = param_write_int(plist, "NumRenderingThreads", &ppdev->num_render_threads_requested)) < 0 ||
+	(code = param_write_int(plist, "MaxPagesInFlight", &ppdev->max_pages_in_flight)) < 0 ||
 	(code = param_write_bool(plist, "OpenOutputFile", &ppdev->OpenOutputFile)) < 0 ||
 	(code = param_write_bool(plist, "ReopenPerPage", &ppdev->ReopenPerPage)) < 0 ||
 	(code = param_write_bool(plist, "PageUsesTransparency",
@@ -550,6 +559,7 @@ gdev_prn_put_params(gx_device * pdev, gs_param_list * plist)
     int width = pdev->width;
     int height = pdev->height;
     int nthreads = ppdev->num_render_threads_requested;
+    int max_pages = ppdev->max_pages_in_flight;
     gdev_prn_space_params sp, save_sp;
     gs_param_string ofs;
     gs_param_dict mdict;
@@ -635,6 +645,16 @@ label:\
 	CHECK_PARAM_CASES(band.BandBufferSpace, sp.band.BandBufferSpace < 0, bbse);
     }
 
+    switch (code = param_read_bool(plist, (param_name = "AdaptiveBandHeight"), &sp.band.AdaptiveBandHeight)) {
+	CHECK_PARAM_CASES(band.AdaptiveBandHeight, false, abhe);
+    }
+
+    switch (code = param_read_int(plist, (param_name = "BandListCompressor"), &sp.band.BandListCompressor)) {
+	CHECK_PARAM_CASES(band.BandListCompressor,
+			  sp.band.BandListCompressor < 0 ||
+			  sp.band.BandListCompressor > CLIST_COMPRESSOR_MAX, blce);
+    }
+
     switch (code = param_read_string(plist, (param_name = "OutputFile"), &ofs)) {
 	case 0:
 	    if (pdev->LockSafetyParams &&
@@ -683,6 +703,18 @@ label:\
 	    ;
     }
 
+    switch (code = param_read_int(plist, (param_name = "MaxPagesInFlight"), &max_pages)) {
+	case 0:
+	    if (max_pages >= 0)
+		break;
+	    code = gs_error_rangecheck;
+	default:
+	    ecode = code;
+	    param_signal_error(plist, param_name, ecode);
+	case 1:
+	    ;
+    }
+
     if (ecode < 0)
 	return ecode;
     /* Prevent gx_default_put_params from closing the printer. */
@@ -701,6 +733,7 @@ label:\
     }
     ppdev->space_params = sp;
     ppdev->num_render_threads_requested = nthreads;
+    ppdev->max_pages_in_flight = max_pages;
 
     /* If necessary, free and reallocate the printer memory. */
     /* Formerly, would not reallocate if device is not open: */
@@ -715,7 +748,11 @@ label:\
 	bytes_compare(ofs.data, ofs.size,
 		      (const byte *)ppdev->fname, strlen(ppdev->fname))
 	) {
-	/* Close the file if it's open. */
+	/* Close the file if it's open, once the pages */
+	/* printed in the background are in it. */
+	code = clist_sync_page_pipeline(pdev);
+	if (code < 0)
+	    return code;
 	if (ppdev->file != NULL)
 	    gx_device_close_output_file(pdev, ppdev->fname, ppdev->file);
 	ppdev->file = NULL;
@@ -724,8 +761,9 @@ label:\
     }
     /* If the device is open and OpenOutputFile is true, */
     /* open the OutputFile now.  (If the device isn't open, */
-    /* this will happen when it is opened.) */
-    if (pdev->is_open && oof) {
+    /* this will happen when it is opened.)  The page pipeline */
+    /* opens it when it prints, if it doesn't have it already. */
+    if (pdev->is_open && oof && ppdev->page_pipeline == NULL) {
 	code = gdev_prn_open_printer(pdev, 1);
 	if (code < 0)
 	    return code;
@@ -751,6 +789,26 @@ gdev_prn_output_page(gx_device * pdev, int num_copies, int flush)
     int outcode = 0, closecode = 0, errcode = 0, endcode;
     bool upgraded_copypage = false;
 
+    if (num_copies > 0 && flush && ppdev->max_pages_in_flight > 0 &&
+	ppdev->buffer_space && !ppdev->is_async_renderer) {
+	/* Print the page in the background, while the next one is written. */
+	int code = clist_pipeline_page(pdev, num_copies);
+
+	if (code < 0)
+	    return code;
+	if (code == 0) {
+	    endcode = gx_finish_output_page(pdev, num_copies, flush);
+	    return (endcode < 0 ? endcode : 0);
+	}
+    }
+    /* Any pages printed in the background come before this one. */
+    if (ppdev->page_pipeline != NULL) {
+	int code = clist_sync_page_pipeline(pdev);
+
+	if (code < 0)
+	    return code;
+    }
+
     if (num_copies > 0 || !flush) {
 	int code = gdev_prn_open_printer(pdev, 1);
 
@@ -247,8 +247,14 @@ struct gdev_prn_space_params_s {
 	uint clist_disable_mask;	/* mask of clist options to disable */\
 		/* ---- End async rendering support --- */\
 	int num_render_threads_requested;	/* for multiple band rendering threads */\
+	int max_pages_in_flight;	/* pages printed in the background, */\
+					/* 0 means print while waiting */\
 	gx_device_procs save_procs_while_delaying_erasepage;	/* save device procs while delaying erasepage. */\
-	gx_device_procs orig_procs	/* original (std_)procs */
+	gx_device_procs orig_procs;	/* original (std_)procs */\
+	clist_render_thread_pool_t *render_thread_pool;	/* band rendering threads kept */\
+					/* from page to page, NOT GC'd */\
+	clist_page_pipeline_t *page_pipeline	/* background page printing, */\
+					/* NOT GC'd */
 
 /* The device descriptor */
 struct gx_device_printer_s {
@@ -386,8 +392,11 @@ extern const gx_device_procs prn_std_procs;
 	0/*false*/, 0, 0, 0, /* file_is_new ... buf */\
 	0, 0, 0, 0, 0/*false*/, 0, 0, /* buffer_memory ... clist_dis'_mask */\
 	0, 		/* num_render_threads_requested */\
+	0, 		/* max_pages_in_flight */\
 	{ 0 },	/* save_procs_while_delaying_erasepage */\
-	{ 0 }	/* ... orig_procs */
+	{ 0 },	/* ... orig_procs */\
+	0,	/* render_thread_pool */\
+	0	/* page_pipeline */
 #define prn_device_body_rest_(print_page)\
   prn_device_body_rest2_(print_page, gx_default_print_page_copies, -1)
 #define prn_device_body_copies_rest_(print_page_copies)\
@@ -116,8 +116,13 @@ gp_semaphore_signal(gp_semaphore * sema)
     scode = pthread_mutex_lock(&sem->mutex);
     if (scode != 0)
 	return SEM_ERROR_CODE(scode);
-    if (sem->count++ == 0)
-	scode = pthread_cond_signal(&sem->cond);
+    /*
+     * Signal even if the count was already positive: a thread woken by
+     * an earlier signal may not have taken its count yet, and if it were
+     * the only one woken, the other waiters would wait for good.
+     */
+    sem->count++;
+    scode = pthread_cond_signal(&sem->cond);
     scode2 = pthread_mutex_unlock(&sem->mutex);
     if (scode == 0)
 	scode = scode2;
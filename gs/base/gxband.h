@@ -27,9 +27,13 @@ typedef struct gx_band_params_s {
     int BandWidth;		/* (optional) band width in pixels */
     int BandHeight;		/* (optional) */
     long BandBufferSpace;	/* (optional) */
+    bool AdaptiveBandHeight;	/* split or merge automatic bands from */
+				/* the profile of the last page */
+    int BandListCompressor;	/* CLIST_COMPRESSOR_ codec for band lists */
+				/* in RAM, see gxclio.h */
 } gx_band_params_t;
 
-#define BAND_PARAMS_INITIAL_VALUES 0, 0, 0, 0
+#define BAND_PARAMS_INITIAL_VALUES 0, 0, 0, 0, 0, 0
 
 /*
  * Define information about the colors used on a page.
@@ -69,10 +73,14 @@ typedef struct gx_band_page_info_s {
     int scan_lines_per_colors_used; /* number of scan lines per colors_used */
 				/* entry (a multiple of the band height) */
     gx_colors_used_t band_colors_used[PAGE_INFO_NUM_COLORS_USED];  /* colors used on the page */
+    gx_color_index blank_color;	/* pure color of the last fillpage, which */
+				/* is all a band without commands shows, */
+				/* or gx_no_color_index if unknown */
+    bool all_bands_composited;	/* a compositor was sent to all bands */
 } gx_band_page_info_t;
 #define PAGE_INFO_NULL_VALUES\
   { 0 }, 0, { 0 }, NULL, 0, 0, 0, { BAND_PARAMS_INITIAL_VALUES },\
-  0x3fffffff, { { 0 } }
+  0x3fffffff, { { 0 } }, gx_no_color_index, false
 
 /*
  * By convention, the structure member containing the above is called
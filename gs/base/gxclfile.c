@@ -30,7 +30,7 @@
 static int
 clist_fopen(char fname[gp_file_name_sizeof], const char *fmode,
 	    clist_file_ptr * pcf, gs_memory_t * mem, gs_memory_t *data_mem,
-	    bool ok_to_compress)
+	    bool ok_to_compress, int compressor)
 {
     if (*fname == 0) {
 	if (fmode[0] == 'r')
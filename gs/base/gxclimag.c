@@ -749,6 +749,7 @@ clist_image_plane_data(gx_image_enum_common_t * info,
         re.pcls->band_complexity.nontrivial_rops |=
             re.pcls->colors_used.slow_rop |= pie->colors_used.slow_rop;
         re.pcls->band_complexity.uses_color |= (pie->colors_used.or != 0 || pie->colors_used.or != 0xffffff);
+        re.pcls->band_complexity.uses_images = true;
 
         /* Write out begin_image & its preamble for this band */
         if (!(re.pcls->known & begin_image_known)) {
@@ -1000,6 +1001,9 @@ clist_create_compositor(gx_device * dev,
 
     if (cropping_op == ALLBANDS) {
         /* overprint applies to all bands */
+        /* Bands without drawing commands must now be played back */
+        cdev->page_info.all_bands_composited = true;
+        cdev->page_info.blank_color = gx_no_color_index;
         size_dummy = size;
         code = set_cmd_put_all_op( dp,
                                    (gx_device_clist_writer *)dev,
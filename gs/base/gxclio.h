@@ -29,6 +29,15 @@
 
 typedef void *clist_file_ptr;	/* We can't do any better than this. */
 
+/*
+ * Define the codecs a RAM-based band list may compress with, selected by
+ * the BandListCompressor device parameter.  Band lists on files are never
+ * compressed.
+ */
+#define CLIST_COMPRESSOR_DEFAULT 0	/* BAND_LIST_COMPRESSOR, LZW or zlib */
+#define CLIST_COMPRESSOR_FLZ 1		/* fast LZ, see sflzx.h */
+#define CLIST_COMPRESSOR_MAX 1
+
 struct clist_io_procs_s {
 
     /* ---------------- Open/close/unlink ---------------- */
@@ -37,12 +46,14 @@ struct clist_io_procs_s {
      * If *fname = 0, generate and store a new scratch file name; otherwise,
      * open an existing file.  Only modes "r" and "w+" are supported,
      * and only binary data (but the caller must append the "b" if needed).
-     * Mode "r" with *fname = 0 is an error.
+     * Mode "r" with *fname = 0 is an error.  compressor (one of the
+     * CLIST_COMPRESSOR_ values above) only matters when creating a file;
+     * reopening a file uses the codec it was written with.
      */
     int (*fopen)(char fname[gp_file_name_sizeof], const char *fmode,
 		    clist_file_ptr * pcf,
 		    gs_memory_t * mem, gs_memory_t *data_mem,
-		    bool ok_to_compress);
+		    bool ok_to_compress, int compressor);
 
     /*
      * Close a file, optionally deleting it.
@@ -124,6 +124,7 @@ static dev_proc_get_band(clist_get_band);
 
 /* Other forward declarations */
 static int clist_put_current_params(gx_device_clist_writer *cldev);
+static void clist_profile_bands(gx_device_clist_writer *cldev);
 
 /* The device procedures */
 const gx_device_procs gs_clist_device_procs = {
@@ -359,6 +360,35 @@ clist_init_states(gx_device * dev, byte * init_data, uint data_size)
     return 0;
 }
 
+/*
+ * Divide the largest band height that fits by the divisor chosen from the
+ * band profile of the last page (see clist_profile_bands), as far as the
+ * bands stay tall enough and their states leave most of the buffer for
+ * commands.  Only called when the band height is automatic.
+ */
+#define CLIST_MIN_SPLIT_BAND_HEIGHT 16
+#define CLIST_MAX_BAND_SPLIT 8
+static int
+clist_split_band_height(gx_device_clist_writer *cdev, int band_height,
+                        uint states_space)
+{
+    int split = (cdev->band_split_next > 0 ? cdev->band_split_next :
+                 cdev->band_split);
+
+    for (; split > 1; split >>= 1) {
+        int height = band_height / split;
+        ulong nbands;
+
+        if (height < CLIST_MIN_SPLIT_BAND_HEIGHT)
+            continue;
+        nbands = (cdev->target->height + height - 1) / height;
+        if (nbands * sizeof(gx_clist_state) <= states_space / 4)
+            break;
+    }
+    cdev->band_split = cdev->band_split_next = max(split, 1);
+    return band_height / cdev->band_split;
+}
+
 /*
  * Initialize all the data allocations.  Requires: target.  Sets:
  * page_tile_cache_size, page_info.band_params.BandWidth,
@@ -432,6 +462,9 @@ clist_init_data(gx_device * dev, byte * init_data, uint data_size)
                 pbdev->finalize(pbdev);
             return_error(gs_error_rangecheck);
         }
+        if (cdev->band_params.AdaptiveBandHeight)
+            band_height = clist_split_band_height(cdev, band_height,
+                                                  data_size - bits_size);
     }
     cdev->ins_count = 0;
     code = clist_init_tile_cache(dev, data, bits_size);
@@ -611,6 +644,8 @@ clist_reset_page(gx_device_clist_writer *cwdev)
     cwdev->page_info.scan_lines_per_colors_used = 0;
     memset(cwdev->page_info.band_colors_used, 0,
            sizeof(cwdev->page_info.band_colors_used));
+    cwdev->page_info.blank_color = gx_no_color_index;
+    cwdev->page_info.all_bands_composited = false;
 }
 
 /* Open the device's bandfiles */
@@ -636,10 +671,10 @@ clist_open_output_file(gx_device *dev)
     clist_reset_page(cdev);
     if ((code = cdev->page_info.io_procs->fopen(cdev->page_cfname, fmode, &cdev->page_cfile,
                             cdev->bandlist_memory, cdev->bandlist_memory,
-                            true)) < 0 ||
+                            true, cdev->band_params.BandListCompressor)) < 0 ||
         (code = cdev->page_info.io_procs->fopen(cdev->page_bfname, fmode, &cdev->page_bfile,
                             cdev->bandlist_memory, cdev->bandlist_memory,
-                            false)) < 0 ||
+                            false, cdev->band_params.BandListCompressor)) < 0 ||
         (code = clist_reinit_output_file(dev)) < 0
         ) {
         clist_close_output_file(dev);
@@ -759,6 +794,8 @@ clist_finish_page(gx_device *dev, bool flush)
             cdev->page_info.io_procs->fseek(cdev->page_cfile, 0L, SEEK_END, cdev->page_cfname);
         if (cdev->page_bfile != 0)
             cdev->page_info.io_procs->fseek(cdev->page_bfile, 0L, SEEK_END, cdev->page_bfname);
+        /* The bands written so far fix the band height */
+        cdev->band_split_next = cdev->band_split;
     }
     code = clist_init(dev);             /* reinitialize */
     if (code >= 0)
@@ -803,6 +840,7 @@ clist_end_page(gx_device_clist_writer * cldev)
     }
     if (code >= 0) {
         clist_compute_colors_used(cldev);
+        clist_profile_bands(cldev);
         ecode |= code;
         cldev->page_bfile_end_pos = cldev->page_info.io_procs->ftell(cldev->page_bfile);
     }
@@ -829,6 +867,54 @@ clist_end_page(gx_device_clist_writer * cldev)
     return 0;
 }
 
+/*
+ * Profile the bands of the page just written, and choose the divisor of an
+ * adaptive band height for the next page.  Splitting the bands pays when
+ * the marks are bunched together: more of the page is filled without
+ * playing back any commands, and render threads share out a heavy region.
+ * Merging them back pays when the marks are spread evenly, since state and
+ * color commands are repeated in every band they touch.
+ */
+static void
+clist_profile_bands(gx_device_clist_writer *cldev)
+{
+    int nbands = cldev->nbands;
+    int nblank = 0;
+    ulong total = 0, most = 0, mean;
+    int band;
+
+    if (IS_CLIST_FOR_PATTERN(cldev))
+        return;
+    for (band = 0; band < nbands; ++band) {
+        const gx_band_complexity_t *bc = &cldev->states[band].band_complexity;
+
+        if (bc->cmd_bytes == 0)
+            ++nblank;
+        total += bc->cmd_bytes;
+        most = max(most, bc->cmd_bytes);
+        if (gs_debug[':'] != 0)
+            dprintf5("%% Band %d: %lu command bytes%s%s%s\n", band,
+                     bc->cmd_bytes, (bc->uses_images ? ", images" : ""),
+                     (bc->uses_patterns ? ", patterns" : ""),
+                     (bc->cmd_bytes == 0 ? ", blank" : ""));
+    }
+    mean = (nblank < nbands ? total / (nbands - nblank) : 0);
+    if (cldev->band_params.AdaptiveBandHeight &&
+        cldev->band_params.BandHeight == 0) {
+        int split = max(cldev->band_split, 1);
+
+        if (nblank < nbands && (nblank * 2 >= nbands || most >= mean * 4))
+            split = min(split * 2, CLIST_MAX_BAND_SPLIT);
+        else if (nblank == 0 && most < mean * 2)
+            split = max(split / 2, 1);
+        cldev->band_split_next = split;
+    }
+    if (gs_debug[':'] != 0)
+        dprintf6("%% %d bands of %d lines, %d blank, %lu command bytes, most %lu, next split %d\n",
+                 nbands, cldev->page_band_height, nblank, total, most,
+                 cldev->band_split_next);
+}
+
 /* Compute the set of used colors in the page_info structure. 
  *
  * NB: Area for improvement, move states[band] and page_info to clist
@@ -990,6 +1076,10 @@ clist_copy_band_complexity(gx_band_complexity_t *this, const gx_band_complexity_
         /* default */
         this->uses_color = false;
         this->nontrivial_rops = false;
+        this->cmd_bytes = 0;
+        this->uses_images = false;
+        this->uses_patterns = false;
+        this->blank = false;
 #if 0
         /* todo: halftone phase */
 
@@ -184,6 +184,10 @@ typedef struct gx_clist_state_s gx_clist_state;
 		/* Following are set when writing, read when reading. */\
 	gx_band_page_info_t page_info;	/* page information */\
 	int nbands;			/* # of bands */\
+	int band_split;			/* divisor of the automatic BandHeight */\
+					/* when it is adaptive */\
+	int band_split_next;		/* divisor chosen from the last page's */\
+					/* band profile */\
         int64_t trans_dev_icc_hash;     /* A special hash code for des color */\
         clist_icctable_t *icc_table;    /* Table that keeps track of ICC profiles.\
                                            It relates the hashcode to the cfile\ 
@@ -381,6 +385,14 @@ typedef struct gx_device_clist_writer_s gx_device_clist_writer;
 #  define clist_render_thread_control_t_DEFINED
 typedef struct clist_render_thread_control_s clist_render_thread_control_t;
 #endif
+#ifndef clist_render_thread_pool_t_DEFINED
+#  define clist_render_thread_pool_t_DEFINED
+typedef struct clist_render_thread_pool_s clist_render_thread_pool_t;
+#endif
+#ifndef clist_page_pipeline_t_DEFINED
+#  define clist_page_pipeline_t_DEFINED
+typedef struct clist_page_pipeline_s clist_page_pipeline_t;
+#endif
 
 /* Define the state of a band list when reading. */
 /* For normal rasterizing, pages and num_pages are both 0. */
@@ -395,7 +407,6 @@ typedef struct gx_device_clist_reader_s {
     int num_render_threads;		/* number of threads being used */
     clist_render_thread_control_t *render_threads;	/* array of threads */
     byte *main_thread_data;		/* saved data pointer of main thread */
-    int curr_render_thread;		/* index into array */
     int thread_lookahead_direction;	/* +1 or -1 */
 
 } gx_device_clist_reader;
@@ -561,10 +572,27 @@ int clist_rasterize_lines(gx_device *dev, int y, int lineCount,
 int
 clist_enable_multi_thread_render(gx_device *dev);
 
-/* Shutdown render threads and free up the related memory */
+/* Stop using the render threads for the current page; they are kept for the next one */
 void
 clist_teardown_render_threads(gx_device *dev);
 
+/* Shutdown render threads and free up the related memory */
+void
+clist_free_render_threads(gx_device *dev);
+
+/* Queue the current page to be printed by the page pipeline. Returns 1 */
+/* if the page can't be queued: the caller must then print it itself. */
+int
+clist_pipeline_page(gx_device *dev, int num_copies);
+
+/* Wait for the pages queued to be printed, and take back the output file */
+int
+clist_sync_page_pipeline(gx_device *dev);
+
+/* Shutdown the page pipeline and free up the related memory */
+int
+clist_free_page_pipeline(gx_device *dev);
+
 #ifdef DEBUG 
 #define clist_debug_rect clist_debug_rect_imp
 void clist_debug_rect_imp(int x, int y, int width, int height);
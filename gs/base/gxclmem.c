@@ -16,7 +16,9 @@
 #include "memory_.h"
 #include "gx.h"
 #include "gserrors.h"
+#include "gp.h"
 #include "gxclmem.h"
+#include "sflzx.h"
 
 /*
  * Based on: memfile.c        Version: 1.4 3/21/95 14:59:33 by Ray Johnston.
@@ -145,6 +147,15 @@ static const int64_t COMPRESSION_THRESHOLD =
 #define NEED_TO_COMPRESS(f)\
   ((f)->ok_to_compress && (f)->total_space > COMPRESSION_THRESHOLD)
 
+/*
+   A block that doesn't compress comes out a little larger than it went
+   in: zlib adds a few bytes, the fast LZ codec up to about 80. Since the
+   compressed data of a block may only spill over into one more physical
+   block, a block isn't started in the last COMPRESSION_SLACK bytes of a
+   physical block.
+ */
+#define COMPRESSION_SLACK 256
+
    /* FOR NOW ALLOCATE 1 raw buffer for every 32 blocks (at least 8, no more than 64)    */
 #define GET_NUM_RAW_BUFFERS( f ) \
 	 min(64, max(f->log_length/MEMFILE_DATA_SIZE/32, 8))
@@ -165,6 +176,74 @@ static int memfile_set_memory_warning(clist_file_ptr cf, int bytes_left);
 static int memfile_fclose(clist_file_ptr cf, const char *fname, bool delete);
 static int memfile_get_pdata(MEMFILE * f);
 
+/*
+ * The default codec is the one linked in (BAND_LIST_COMPRESSOR); the fast
+ * LZ codec is always available.
+ */
+static const stream_template *
+memfile_compressor_template(const MEMFILE * f)
+{
+    return (f->compressor == CLIST_COMPRESSOR_FLZ ? &s_FLZE_template :
+	    clist_compressor_template());
+}
+static const stream_template *
+memfile_decompressor_template(const MEMFILE * f)
+{
+    return (f->compressor == CLIST_COMPRESSOR_FLZ ? &s_FLZD_template :
+	    clist_decompressor_template());
+}
+static void
+memfile_compressor_init(const MEMFILE * f, stream_state * state)
+{
+    if (f->compressor == CLIST_COMPRESSOR_FLZ)
+	state->template = &s_FLZE_template;
+    else
+	clist_compressor_init(state);
+}
+static void
+memfile_decompressor_init(const MEMFILE * f, stream_state * state)
+{
+    if (f->compressor == CLIST_COMPRESSOR_FLZ)
+	state->template = &s_FLZD_template;
+    else
+	clist_decompressor_init(state);
+}
+
+/*
+ * With -Z: each memfile prints how much it compressed and decompressed,
+ * and the time the codec took, when its data is freed or, for a reader
+ * instance, when it is closed.  tools/bench.sh in ghostpdl sums these.
+ */
+
+/* Real time elapsed since 'start', in microseconds */
+static long
+memfile_usec_since(const long start[2])
+{
+    long now[2];
+
+    gp_get_realtime(now);
+    return (now[0] - start[0]) * 1000000 + (now[1] - start[1]) / 1000;
+}
+
+static void
+memfile_report_codec(MEMFILE * f)
+{
+    if (gs_debug[':'] != 0) {
+	if (f->codec_raw_written > 0)
+	    dprintf4("%% Band list codec %d: compressed %.0f bytes to %.0f in %ld usec\n",
+		     f->compressor, (double)f->codec_raw_written,
+		     (double)f->codec_written, f->codec_write_usec);
+	if (f->codec_raw_read > 0)
+	    dprintf3("%% Band list codec %d: decompressed %.0f bytes in %ld usec\n",
+		     f->compressor, (double)f->codec_raw_read, f->codec_read_usec);
+    }
+    f->codec_raw_written = 0;
+    f->codec_written = 0;
+    f->codec_raw_read = 0;
+    f->codec_write_usec = 0;
+    f->codec_read_usec = 0;
+}
+
 /************************************************/
 /*   #define DEBUG      /- force statistics -/  */
 /************************************************/
@@ -233,7 +312,8 @@ allocateWithReserve(
 static int
 memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
 	      clist_file_ptr /*MEMFILE * */  * pf,
-	      gs_memory_t *mem, gs_memory_t *data_mem, bool ok_to_compress)
+	      gs_memory_t *mem, gs_memory_t *data_mem, bool ok_to_compress,
+	      int compressor)
 {
     MEMFILE *f = NULL;
     int code = 0;
@@ -284,6 +364,11 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
 	    f->log_curr_pos = 0;
 	    f->raw_head = NULL;
 	    f->error_code = 0;
+	    f->codec_raw_written = 0;
+	    f->codec_written = 0;
+	    f->codec_raw_read = 0;
+	    f->codec_write_usec = 0;
+	    f->codec_read_usec = 0;
 
 	    if (f->log_head->phys_blk->data_limit != NULL) {
 		/* The file is compressed, so we need to copy the logical block */
@@ -292,7 +377,8 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
 		LOG_MEMFILE_BLK *log_block, *new_log_block;
 		int i;
 		int num_log_blocks = (f->log_length + MEMFILE_DATA_SIZE - 1) / MEMFILE_DATA_SIZE;
-		const stream_template *decompress_template = clist_decompressor_template();
+		const stream_template *decompress_template =
+		    memfile_decompressor_template(f);
 
 		new_log_block = MALLOC(f, num_log_blocks * sizeof(LOG_MEMFILE_BLK), "memfile_fopen" );
 		if (new_log_block == NULL) {
@@ -320,7 +406,7 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
 		    code = gs_note_error(gs_error_VMerror);
 		    goto finish;
 		}
-		clist_decompressor_init(f->decompress_state);
+		memfile_decompressor_init(f, f->decompress_state);
 		f->decompress_state->memory = mem;
 		if (decompress_template->set_defaults)
 		    (*decompress_template->set_defaults) (f->decompress_state);
@@ -349,6 +435,11 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
     f->openlist = NULL;
     f->base_memfile = NULL;
     f->total_space = 0;
+    f->codec_raw_written = 0;
+    f->codec_written = 0;
+    f->codec_raw_read = 0;
+    f->codec_write_usec = 0;
+    f->codec_read_usec = 0;
     f->reservePhysBlockChain = NULL;
     f->reservePhysBlockCount = 0;
     f->reserveLogBlockChain = NULL;
@@ -363,11 +454,14 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
      * a much better criterion for deciding when compression is appropriate.
      */
     f->ok_to_compress = /*ok_to_compress */ true;
+    f->compressor = compressor;
     f->compress_state = 0;      /* make clean for GC */
     f->decompress_state = 0;
     if (f->ok_to_compress) {
-	const stream_template *compress_template = clist_compressor_template();
-	const stream_template *decompress_template = clist_decompressor_template();
+	const stream_template *compress_template =
+	    memfile_compressor_template(f);
+	const stream_template *decompress_template =
+	    memfile_decompressor_template(f);
 
 	f->compress_state =
 	    gs_alloc_struct(mem, stream_state, compress_template->stype,
@@ -382,8 +476,8 @@ memfile_fopen(char fname[gp_file_name_sizeof], const char *fmode,
 	    code = gs_note_error(gs_error_VMerror);
 	    goto finish;
 	}
-	clist_compressor_init(f->compress_state);
-	clist_decompressor_init(f->decompress_state);
+	memfile_compressor_init(f, f->compress_state);
+	memfile_decompressor_init(f, f->decompress_state);
 	f->compress_state->memory = mem;
 	f->decompress_state->memory = mem;
 	if (compress_template->set_defaults)
@@ -444,28 +538,30 @@ memfile_fclose(clist_file_ptr cf, const char *fname, bool delete)
 		return_error(gs_error_invalidfileaccess);
 	    }
 	    prev_f->openlist = f->openlist;     /* link around the one being fclosed */
+	    memfile_report_codec(f);
 	    /* Now delete this MEMFILE reader instance */
 	    /* NB: we don't delete 'base' instances until we delete */
 	    /* If the file is compressed, free the logical blocks, but not */
 	    /* the phys_blk info (that is still used by the base memfile   */
 	    if (f->log_head->phys_blk->data_limit != NULL) {
-		LOG_MEMFILE_BLK *tmpbp, *bp = f->log_head;
-
-		while (bp != NULL) {
-		    tmpbp = bp->link;
-		    FREE(f, bp, "memfile_free_mem(log_blk)");
-		    bp = tmpbp;
-		}
+		/* memfile_fopen copied the logical blocks as one array. */
+		FREE(f, f->log_head, "memfile_free_mem(log_blk)");
 		f->log_head = NULL;
 
-		/* Free any internal compressor state. */
-		if (f->compressor_initialized) {
-		    if (f->decompress_state->template->release != 0)
+		/*
+		 * Free the decompressor state, which memfile_get_pdata
+		 * initialized along with the raw buffers.  Reader instances
+		 * have no compressor state.
+		 */
+		if (f->decompress_state != NULL) {
+		    if (f->raw_head != NULL &&
+			f->decompress_state->template->release != 0)
 			(*f->decompress_state->template->release) (f->decompress_state);
-		    if (f->compress_state->template->release != 0)
-			(*f->compress_state->template->release) (f->compress_state);
-		    f->compressor_initialized = false;
+		    gs_free_object(f->memory, f->decompress_state,
+				   "memfile_fclose(decompress_state)");
+		    f->decompress_state = NULL;
 		}
+		f->compressor_initialized = false;
 		/* free the raw buffers                                           */
 		while (f->raw_head != NULL) {
 		    RAW_BUFFER *tmpraw = f->raw_head->fwd;
@@ -544,14 +640,14 @@ memfile_set_memory_warning(clist_file_ptr cf, int bytes_left)
     /*
      * Determine req'd memory block count from bytes_left.
      * Allocate enough phys & log blocks to hold bytes_left
-     * + 1 phys blk for compress_log_blk + 1 phys blk for decompress.
+     * + 2 phys blks for compress_log_blk + 1 phys blk for decompress.
      */
     int logNeeded =
 	(bytes_left + MEMFILE_DATA_SIZE - 1) / MEMFILE_DATA_SIZE;
     int physNeeded = logNeeded;
 
     if (bytes_left > 0)
-	++physNeeded;
+	physNeeded += 2;
     if (f->raw_head == NULL)
 	++physNeeded;   /* have yet to allocate read buffers */
 
@@ -610,8 +706,25 @@ compress_log_blk(MEMFILE * f, LOG_MEMFILE_BLK * bp)
     long compressed_size;
     byte *start_ptr;
     PHYS_MEMFILE_BLK *newphys;
+    long start_time[2];
+
+    if (f->wt.limit - f->wt.ptr < COMPRESSION_SLACK) {
+	/* start this block in a new physical block */
+	newphys =
+	    allocateWithReserve(f, sizeof(*newphys), &code, "memfile newphys",
+			"compress_log_blk : MALLOC for 'newphys' failed\n");
+	if (code < 0)
+	    return code;
+	ecode |= code;  /* accumulate any low-memory warnings */
+	newphys->link = NULL;
+	f->phys_curr->link = newphys;
+	f->phys_curr = newphys;
+	f->wt.ptr = (byte *) (newphys->data) - 1;
+	f->wt.limit = f->wt.ptr + MEMFILE_DATA_SIZE;
+    }
 
     /* compress this block */
+    gp_get_realtime(start_time);
     f->rd.ptr = (const byte *)(bp->phys_blk->data) - 1;
     f->rd.limit = f->rd.ptr + MEMFILE_DATA_SIZE;
 
@@ -667,6 +780,9 @@ compress_log_blk(MEMFILE * f, LOG_MEMFILE_BLK * bp)
 #ifdef DEBUG
     tot_compressed += compressed_size;
 #endif
+    f->codec_raw_written += MEMFILE_DATA_SIZE;
+    f->codec_written += compressed_size;
+    f->codec_write_usec += memfile_usec_since(start_time);
     return (status < 0 ? gs_note_error(gs_error_ioerror) : ecode);
 }                               /* end "compress_log_blk()"                                     */
 
@@ -839,6 +955,7 @@ memfile_get_pdata(MEMFILE * f)
 {
     int code, i, num_raw_buffers, status;
     LOG_MEMFILE_BLK *bp = f->log_curr_blk;
+    long start_time[2];
 
     if (bp->phys_blk->data_limit == NULL) {
 	/* Not compressed, return this data pointer                       */
@@ -921,6 +1038,7 @@ memfile_get_pdata(MEMFILE * f)
 	    f->raw_head->log_blk = bp;
 
 	    /* Decompress the data into this raw block                     */
+	    gp_get_realtime(start_time);
 	    /* Initialize the decompressor                              */
 	    if (f->decompress_state->template->reinit != 0)
 		(*f->decompress_state->template->reinit) (f->decompress_state);
@@ -964,6 +1082,8 @@ memfile_get_pdata(MEMFILE * f)
 		}
 	    }
 	    bp->raw_block = f->raw_head;        /* point to raw block           */
+	    f->codec_raw_read += MEMFILE_DATA_SIZE;
+	    f->codec_read_usec += memfile_usec_since(start_time);
 	}
 	/* end if( raw_block == NULL ) meaning need to decompress data    */
 	else {
@@ -1120,6 +1240,8 @@ memfile_free_mem(MEMFILE * f)
 {
     LOG_MEMFILE_BLK *bp, *tmpbp;
 
+    memfile_report_codec(f);
+
 #ifdef DEBUG
     /* output some diagnostics about the effectiveness                   */
     if (tot_raw > 100) {
@@ -65,6 +65,7 @@ struct MEMFILE_s {
     gs_memory_t *memory;	/* storage allocator */
     gs_memory_t *data_memory;	/* storage allocator for data */
     bool ok_to_compress;	/* if true, OK to compress this file */
+    int compressor;		/* CLIST_COMPRESSOR_ codec, see gxclio.h */
     bool is_open;		/* track open/closed for each access struct */
  	/*
 	 * We need to maintain a linked list of other structs that
@@ -118,6 +119,12 @@ struct MEMFILE_s {
     bool compressor_initialized;
     stream_state *compress_state;
     stream_state *decompress_state;					/******* READER INSTANCE *******/
+    /* codec statistics, printed with -Z: when they are reset */
+    int64_t codec_raw_written;	/* bytes compressed */
+    int64_t codec_written;	/* what they compressed to */
+    int64_t codec_raw_read;	/* bytes decompressed */			/******* READER INSTANCE *******/
+    long codec_write_usec;
+    long codec_read_usec;						/******* READER INSTANCE *******/
 };
 #ifndef MEMFILE_DEFINED
 #define MEMFILE_DEFINED
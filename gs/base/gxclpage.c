@@ -16,6 +16,7 @@
 #include "gdevprn.h"
 #include "gxcldev.h"
 #include "gxclpage.h"
+#include "gsicc_cache.h"
 
 /* Save a page. */
 int
@@ -52,6 +53,72 @@ gdev_prn_save_page(gx_device_printer * pdev, gx_saved_page * page,
     return (*gs_clist_device_procs.open_device) ((gx_device *) pdev);
 }
 
+/* Make a saved page the current page of a banding device, for reading. */
+int
+gdev_prn_open_saved_page(gx_device_printer * pdev, gx_saved_page * page)
+{
+    gx_device_clist *cdev = (gx_device_clist *) pdev;
+    gx_device_clist_reader * const pcldev = &cdev->reader;
+    gs_memory_t *base_mem = pcldev->memory->thread_safe_memory;
+    char fmode[4];
+    int code;
+
+    /* Make sure the page was saved from a device like this one. */
+    if (!pdev->buffer_space)
+	return_error(gs_error_rangecheck);
+    if (strcmp(page->dname, pdev->dname) != 0 ||
+	page->device.color_info.depth != pdev->color_info.depth ||
+	page->device.color_info.num_components !=
+	    pdev->color_info.num_components ||
+	/* The band height may differ: see AdaptiveBandHeight. */
+	page->info.band_params.BandWidth !=
+	    pcldev->page_info.band_params.BandWidth ||
+	page->info.band_params.BandBufferSpace !=
+	    pcldev->page_info.band_params.BandBufferSpace ||
+	page->info.band_params.page_uses_transparency !=
+	    pcldev->page_info.band_params.page_uses_transparency ||
+	page->info.tile_cache_size != pcldev->page_info.tile_cache_size
+	)
+	return_error(gs_error_rangecheck);
+    pcldev->page_info = page->info;
+    pcldev->nbands = (pdev->height + pcldev->page_band_height - 1) /
+	pcldev->page_band_height;
+    strcpy(fmode, "r");
+    strncat(fmode, gp_fmode_binary_suffix, 1);
+    if ((code = pcldev->page_info.io_procs->fopen(pcldev->page_cfname, fmode,
+			&pcldev->page_cfile, pcldev->bandlist_memory,
+			pcldev->bandlist_memory, true,
+			pcldev->band_params.BandListCompressor)) < 0 ||
+	(code = pcldev->page_info.io_procs->fopen(pcldev->page_bfname, fmode,
+			&pcldev->page_bfile, pcldev->bandlist_memory,
+			pcldev->bandlist_memory, false,
+			pcldev->band_params.BandListCompressor)) < 0 ||
+	(code = clist_render_init(cdev)) < 0 ||
+	(code = clist_read_icctable(pcldev)) < 0
+	)
+	return code;
+    /* The icc cache may be shared by rendering threads. */
+    if ((pcldev->icc_cache_cl = gsicc_cache_new(base_mem)) == NULL)
+	return_error(gs_error_VMerror);
+    return 0;
+}
+
+/* Finish reading a saved page, and delete its files. */
+int
+gdev_prn_close_saved_page(gx_device_printer * pdev)
+{
+    gx_device_clist *cdev = (gx_device_clist *) pdev;
+    gx_device_clist_reader * const pcldev = &cdev->reader;
+
+    gx_clist_reader_free_band_complexity_array(cdev);
+    clist_teardown_render_threads((gx_device *) pdev);
+    clist_icc_freetable(pcldev->icc_table, pcldev->memory);
+    pcldev->icc_table = NULL;
+    rc_decrement(pcldev->icc_cache_cl, "gdev_prn_close_saved_page");
+    pcldev->icc_cache_cl = NULL;
+    return clist_close_page_info(&pcldev->page_info);
+}
+
 /* Render an array of saved pages. */
 int
 gdev_prn_render_pages(gx_device_printer * pdev,
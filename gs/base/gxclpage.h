@@ -32,6 +32,17 @@
 int gdev_prn_save_page(gx_device_printer * pdev, gx_saved_page * page,
 		       int num_copies);
 
+/*
+ * Make a saved page the current page of a banding device, for reading
+ * with the device's normal print_page procedure, as if it had just been
+ * written.  The device must be an instance of the device the page was
+ * saved from, with the same band parameters.  gdev_prn_close_saved_page
+ * must be called when the page has been printed, even if this fails:
+ * it deletes the page's files.
+ */
+int gdev_prn_open_saved_page(gx_device_printer * pdev, gx_saved_page * page);
+int gdev_prn_close_saved_page(gx_device_printer * pdev);
+
 /*
  * Render an array of saved pages by setting up a modified get_bits
  * procedure and then calling the device's normal output_page procedure.
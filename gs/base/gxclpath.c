@@ -235,6 +235,7 @@ cmd_put_drawing_color(gx_device_clist_writer * cldev, gx_clist_state * pcls,
        todo: provide this info with a pattern tile. */
     pcls->band_complexity.uses_color |= is_pattern || 
 		(pdcolor->colors.pure != 0 && pdcolor->colors.pure != 0xffffff);
+    pcls->band_complexity.uses_patterns |= is_pattern;
 
     /* record the color we have just serialized color */
     pdcolor->type->save_dc(pdcolor, &pcls->sdc);
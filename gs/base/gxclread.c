@@ -705,6 +705,22 @@ clist_rasterize_lines(gx_device *dev, int y, int line_count,
     return line_count;
 }
 
+/* Do the bands hold nothing but fillpage, according to their profile? */
+static bool
+clist_bands_are_blank(const gx_device_clist_reader *crdev,
+		      int band_first, int band_last)
+{
+    int band;
+
+    if (crdev->band_complexity_array == NULL)
+	return false;
+    for (band = band_first; band <= band_last; band++)
+	if (band < 0 || band >= crdev->nbands ||
+	    !crdev->band_complexity_array[band].blank)
+	    return false;
+    return true;
+}
+
 /*
  * Render a rectangle to a client-supplied device.  There is no necessary
  * relationship between band boundaries and the region being rendered.
@@ -742,6 +758,16 @@ clist_render_rectangle(gx_device_clist *cldev, const gs_int_rect *prect,
      * a gx_saved_page with non-zero cfile or bfile.
      */
     ppages = crdev->pages;
+    if (ppages == 0 && crdev->yplane.index < 0 &&
+	clist_bands_are_blank(crdev, band_first, band_last)) {
+	/* Playing back would only repeat the last fillpage. */
+	if_debug2('l', "[l]bands (%d,%d) are blank\n", band_first, band_last);
+	bdev->band_offset_x = 0;
+	bdev->band_offset_y = band_first * band_height;
+	return dev_proc(bdev, fill_rectangle)
+	    (bdev, 0, 0, bdev->width, bdev->height,
+	     crdev->page_info.blank_color);
+    }
     if (ppages == 0) {
 	current_page.info = crdev->page_info;
 	placed_page.page = &current_page;
@@ -806,13 +832,15 @@ clist_playback_file_bands(clist_playback_action action,
     if (rs.page_cfile == 0) {
 	code = crdev->page_info.io_procs->fopen(rs.page_cfname,
 			   gp_fmode_rb, &rs.page_cfile, crdev->bandlist_memory,
-			   crdev->bandlist_memory, true);
+			   crdev->bandlist_memory, true,
+			   crdev->band_params.BandListCompressor);
 	opened_cfile = (code >= 0);
     }
     if (rs.page_bfile == 0 && code >= 0) {
 	code = crdev->page_info.io_procs->fopen(rs.page_bfname,
 			   gp_fmode_rb, &rs.page_bfile, crdev->bandlist_memory,
-			   crdev->bandlist_memory, false);
+			   crdev->bandlist_memory, false,
+			   crdev->band_params.BandListCompressor);
 	opened_bfile = (code >= 0);
     }
     if (rs.page_cfile != 0 && rs.page_bfile != 0) {
@@ -900,7 +928,9 @@ void gx_clist_reader_free_band_complexity_array( gx_device_clist *cldev )
 	}
 }
 
-/* call once per read page to read the band complexity from clist file 
+/* call once per read page to read the band complexity from clist file.
+ * The command bytes of all the blocks of a band are summed, so that a band
+ * of an appended page (copypage) counts what earlier pages put in it.
  */
 static int
 gx_clist_reader_read_band_complexity(gx_device_clist *dev)
@@ -910,20 +940,15 @@ gx_clist_reader_read_band_complexity(gx_device_clist *dev)
     if (dev) {
 	gx_device_clist *cldev = (gx_device_clist *)dev;
 	gx_device_clist_reader * const crdev = &cldev->reader;
+	const clist_io_procs_t *io_procs = crdev->page_info.io_procs;
+	clist_file_ptr bfile = crdev->page_info.bfile;
+	int64_t end_pos = crdev->page_info.bfile_end_pos;
 	int i;
-	stream_band_read_state rs;
 	cmd_block cb;
 	int64_t save_pos;
-	int pos = 0;
- 
-	/* setup stream */
-	s_init_state((stream_state *)&rs, &s_band_read_template, (gs_memory_t *)0);
-	rs.band_first = 0;
-	rs.band_last = crdev->nbands;
-	rs.page_info = crdev->page_info;
 
-	save_pos = crdev->page_info.io_procs->ftell(rs.page_bfile);
-	crdev->page_info.io_procs->fseek(rs.page_bfile, pos, SEEK_SET, rs.page_bfname);
+	save_pos = io_procs->ftell(bfile);
+	io_procs->fseek(bfile, 0, SEEK_SET, crdev->page_info.bfname);
 
 	if ( crdev->band_complexity_array == NULL )
 		crdev->band_complexity_array = (gx_band_complexity_t*)
@@ -933,12 +958,29 @@ gx_clist_reader_read_band_complexity(gx_device_clist *dev)
 	if ( crdev->band_complexity_array == NULL )
 		return_error(gs_error_VMerror);
 
-	for (i=0; i < crdev->nbands; i++) {
-	    crdev->page_info.io_procs->fread_chars(&cb, sizeof(cb), rs.page_bfile);
-	    crdev->band_complexity_array[i] = cb.band_complexity;
+	for (i=0; i < crdev->nbands; i++)
+	    clist_copy_band_complexity(&crdev->band_complexity_array[i], NULL);
+	while ((end_pos == 0 || io_procs->ftell(bfile) < end_pos) &&
+	       io_procs->fread_chars(&cb, sizeof(cb), bfile) == sizeof(cb)) {
+	    gx_band_complexity_t *bc;
+
+	    /* Skip band ranges, the ICC table and the end of the page. */
+	    if (cb.band_min != cb.band_max ||
+		cb.band_min < 0 || cb.band_min >= crdev->nbands)
+		continue;
+	    bc = &crdev->band_complexity_array[cb.band_min];
+	    bc->uses_color |= cb.band_complexity.uses_color;
+	    bc->nontrivial_rops |= cb.band_complexity.nontrivial_rops;
+	    bc->uses_images |= cb.band_complexity.uses_images;
+	    bc->uses_patterns |= cb.band_complexity.uses_patterns;
+	    bc->cmd_bytes += cb.band_complexity.cmd_bytes;
 	}
+	for (i=0; i < crdev->nbands; i++)
+	    crdev->band_complexity_array[i].blank =
+		crdev->band_complexity_array[i].cmd_bytes == 0 &&
+		crdev->page_info.blank_color != gx_no_color_index;
 
-	crdev->page_info.io_procs->fseek(rs.page_bfile, save_pos, SEEK_SET, rs.page_bfname);
+	io_procs->fseek(bfile, save_pos, SEEK_SET, crdev->page_info.bfname);
 	code = 0;  
     }
     return code;
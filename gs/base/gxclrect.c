@@ -281,6 +281,11 @@ clist_fillpage(gx_device * dev, gs_imager_state *pis, gx_drawing_color *pdcolor)
 	if (code >= 0)
 	    code = cmd_write_page_rect_cmd(cdev, cmd_op_fill_rect);
     } while (RECT_RECOVER(code));
+    /* Bands that get no commands of their own will show just this color. */
+    if (code >= 0)
+	cdev->page_info.blank_color =
+	    (gx_dc_is_pure(pdcolor) && !cdev->page_info.all_bands_composited ?
+	     gx_dc_pure_color(pdcolor) : gx_no_color_index);
     return code;
 }
 
@@ -31,351 +31,649 @@
 #include "gsmemlok.h"
 #include "gxclthrd.h"
 #include "gdevdevn.h"
+#include "gxclpage.h"
 
 /* Forward reference prototypes */
-static int clist_start_render_thread(gx_device *dev, int thread_index, int band);
 static void clist_render_thread(void *param);
 
-/* Set up and start the render threads */
-static int
-clist_setup_render_threads(gx_device *dev, int y)
+/*
+ * The render threads are kept by the printer device from page to page
+ * (pdev->render_thread_pool), along with their clist device copies,
+ * buffer devices, allocators and band buffers. Between pages the
+ * threads wait on their sema_start with their band files closed, so
+ * that each page only has to open the files and initialize the copies
+ * for reading. The pool is rebuilt when the page geometry or the number
+ * of threads changes, and is freed with the band buffer (see
+ * gdev_prn_tear_down).
+ *
+ * Bands are handed out in order, starting from the first one the main
+ * thread asks for, to whichever thread is free, so that a costly band
+ * does not hold up the threads that could render the following ones.
+ * The rendered bands wait in the pool's buffers until the main thread
+ * asks for them; see gxclthrd.h.
+ */
+
+/* Real time elapsed since 'start', in microseconds */
+static long
+clist_usec_since(const long start[2])
 {
-    gx_device_printer *pdev = (gx_device_printer *)dev;
-    gx_device_clist *cldev = (gx_device_clist *)dev;
-    gx_device_clist_common *cdev = (gx_device_clist_common *)cldev;
-    gx_device_clist_reader *crdev = &cldev->reader;
+    long now[2];
+
+    gp_get_realtime(now);
+    return (now[0] - start[0]) * 1000000 + (now[1] - start[1]) / 1000;
+}
+
+/* Reopen the main thread's band files after the threads have used them */
+static void
+clist_reopen_band_files(gx_device *dev)
+{
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
     gs_memory_t *mem = cdev->bandlist_memory;
-    gs_memory_t *chunk_base_mem = mem->thread_safe_memory;
-    gs_memory_status_t mem_status;
+
+    if (cdev->page_cfile == NULL) {
+        char fmode[4];
+
+        strcpy(fmode, "a+");        /* file already exists and we want to re-use it */
+        strncat(fmode, gp_fmode_binary_suffix, 1);
+        cdev->page_info.io_procs->fopen(cdev->page_cfname, fmode, &cdev->page_cfile,
+                            mem, cdev->bandlist_memory, true,
+                            cdev->band_params.BandListCompressor);
+        cdev->page_info.io_procs->fseek(cdev->page_cfile, 0, SEEK_SET, cdev->page_cfname);
+        cdev->page_info.io_procs->fopen(cdev->page_bfname, fmode, &cdev->page_bfile,
+                            mem, cdev->bandlist_memory, false,
+                            cdev->band_params.BandListCompressor);
+        cdev->page_info.io_procs->fseek(cdev->page_bfile, 0, SEEK_SET, cdev->page_bfname);
+    }
+}
+
+/* Find the prototype of a device, to make copies of it for other threads */
+static gx_device *
+clist_find_prototype(gx_device *dev)
+{
     gx_device *protodev;
-    gs_c_param_list paramlist;
-    int i, code, band;
-    int band_count = cdev->nbands;
-    char fmode[4];
-    gs_devn_params *pclist_devn_params;
+    int i;
 
-    crdev->num_render_threads = pdev->num_render_threads_requested;
+    for (i=0; (protodev = (gx_device *)gs_getdevice(i)) != NULL; i++)
+        if (strcmp(protodev->dname, dev->dname) == 0)
+            break;
+    return protodev;
+}
 
-    if(gs_debug[':'] != 0)
-        dprintf1("%% %d rendering threads requested.\n", pdev->num_render_threads_requested);
+/* Wake up to 'count' threads waiting for a band. The pool's lock must be held. */
+static void
+clist_wake_render_threads(clist_render_thread_pool_t *pool, int count)
+{
+    int i;
 
-    if (crdev->num_render_threads > band_count)
-        crdev->num_render_threads = band_count; /* don't bother starting more threads than bands */
+    for (i = 0; i < pool->num_threads && count > 0; i++) {
+        clist_render_thread_control_t *thread = &(pool->threads[i]);
 
-    /* Allocate and initialize an array of thread control structures */
-    crdev->render_threads = (clist_render_thread_control_t *)
-              gs_alloc_byte_array(mem, crdev->num_render_threads,
-              sizeof(clist_render_thread_control_t), "clist_setup_render_threads" );
-    /* fallback to non-threaded if allocation fails */
-    if (crdev->render_threads == NULL) {
-        emprintf(mem, " VMerror prevented threads from starting.\n");
-        return_error(gs_error_VMerror);
+        if (thread->status == RENDER_THREAD_IDLE) {
+            thread->status = RENDER_THREAD_BUSY;
+            gx_semaphore_signal(thread->sema_start);
+            count--;
+        }
     }
+}
 
+/* Take a free buffer for the next band, if there is one to render. The pool's lock must be held. */
+static clist_render_band_t *
+clist_claim_render_band(clist_render_thread_pool_t *pool)
+{
+    int i;
 
-    memset(crdev->render_threads, 0, crdev->num_render_threads *
-            sizeof(clist_render_thread_control_t));
-    crdev->main_thread_data = cdev->data;               /* save data area */
-    /* Based on the line number requested, decide the order of band rendering */
-    /* Almost all devices go in increasing line order (except the bmp* devices ) */
-    crdev->thread_lookahead_direction = (y < (cdev->height - 1)) ? 1 : -1;
-    band = y / crdev->page_info.band_params.BandHeight;
+    if (pool->next_band < 0 || pool->next_band >= pool->band_count)
+        return NULL;
+    for (i = 0; i < pool->num_buffers; i++) {
+        clist_render_band_t *buf = &(pool->buffers[i]);
 
-    /* Close the files so we can open them in multiple threads */
-    if ((code = cdev->page_info.io_procs->fclose(cdev->page_cfile, cdev->page_cfname, false)) < 0 ||
-        (code = cdev->page_info.io_procs->fclose(cdev->page_bfile, cdev->page_bfname, false)) < 0) {
-        gs_free_object(mem, crdev->render_threads, "clist_setup_render_threads");
-        crdev->render_threads = NULL;
-        emprintf(mem, "Closing clist files prevented threads from starting.\n");
-        return_error(gs_error_unknownerror); /* shouldn't happen */
+        if (buf->status == RENDER_THREAD_IDLE) {
+            buf->band = pool->next_band;
+            buf->status = RENDER_THREAD_BUSY;
+            pool->next_band += pool->direction;
+            return buf;
+        }
     }
-    cdev->page_cfile = cdev->page_bfile = NULL;
-    strcpy(fmode, "r");                 /* read access for threads */
-    strncat(fmode, gp_fmode_binary_suffix, 1);
+    return NULL;
+}
+
+/* Find the buffer holding a band. The pool's lock must be held. */
+static clist_render_band_t *
+clist_find_render_band(clist_render_thread_pool_t *pool, int band)
+{
+    int i;
+
+    for (i = 0; i < pool->num_buffers; i++)
+        if (pool->buffers[i].band == band)
+            return &(pool->buffers[i]);
+    return NULL;
+}
+
+/*
+ * Free the buffers holding rendered bands that come before 'band' in the
+ * order the bands are handed out, since the main thread will not ask for
+ * them now, and let the threads have them. The pool's lock must be held.
+ */
+static void
+clist_drop_render_bands(clist_render_thread_pool_t *pool, int band)
+{
+    int i, freed = 0;
+
+    for (i = 0; i < pool->num_buffers; i++) {
+        clist_render_band_t *buf = &(pool->buffers[i]);
+
+        if (buf->band >= 0 && buf->status != RENDER_THREAD_BUSY &&
+            (buf->band - band) * pool->direction < 0) {
+            buf->status = RENDER_THREAD_IDLE;
+            buf->band = -1;
+            freed++;
+        }
+    }
+    clist_wake_render_threads(pool, freed);
+}
+
+/* Free a render thread's device copy and memory; the thread must have exited */
+static void
+clist_destroy_render_thread(gx_device *dev, clist_render_thread_control_t *thread, int index)
+{
+    gx_device_clist_common *thread_cdev = (gx_device_clist_common *)thread->cdev;
+
+    /* Free control semaphore (free ignores NULL pointers) */
+    gx_semaphore_free(thread->sema_start);
+    thread->sema_start = NULL;
+    if (thread->bdev != NULL)
+        ((gx_device_clist_common *)dev)->buf_procs.destroy_buf_device(thread->bdev);
+    if (thread_cdev != NULL) {
+        /*
+         * Free the BufferSpace. Note that the BufferSpace is freed using
+         * 'ppdev->buf' so the 'data' pointer doesn't need to be the one
+         * that the thread started with. The band files were closed when
+         * the thread was last detached from a page.
+         */
+        thread_cdev->do_not_open_or_close_bandfiles = true;
+        gdev_prn_free_memory((gx_device *)thread_cdev);
+        /* Decrement the rc count on the icc profile */
+        rc_decrement(thread_cdev->device_icc_profile, "clist_destroy_render_thread");
+        /* Free the device copy this thread used.  Note that the
+           deviceN stuff if was allocated and copied earlier for the device
+           will be freed with this call */
+        gs_free_object(thread->memory, thread_cdev, "clist_destroy_render_thread");
+        thread->cdev = NULL;
+    }
+    if (thread->memory != NULL) {
+#ifdef DEBUG
+        if (gs_debug[':'])
+            dprintf2("%% Thread %d total usertime=%ld msec\n", index, thread->cputime);
+        dprintf1("\nthread: %d ending memory state...\n", index);
+        gs_memory_chunk_dump_memory(thread->memory);
+        dprintf("                                    memory dump done.\n");
+#endif
+        gs_memory_chunk_release(thread->memory);
+        thread->memory = NULL;
+    }
+}
+
+/* Create the device copy, buffer device and semaphore for a render thread, and start it */
+static int
+clist_create_render_thread(gx_device *dev, gx_device *protodev, gs_c_param_list *paramlist,
+                           gs_memory_t *chunk_base_mem, clist_render_thread_control_t *thread)
+{
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
+    gx_device *ndev;
+    gx_device_clist_common *ncdev;
+    int code;
+
+    /* Every thread will have a 'chunk allocator' to reduce the interaction
+     * with the 'base' allocator which has 'mutex' (locking) protection.
+     * This improves performance of the threads.
+     */
+    if ((code = gs_memory_chunk_wrap(&(thread->memory), chunk_base_mem )) < 0) {
+        emprintf1(cdev->bandlist_memory, "chunk_wrap returned error code: %d\n", code);
+        return code;
+    }
+
+    thread->band = -1;              /* a value that won't match any valid band */
+    if ((code = gs_copydevice((gx_device **) &ndev, protodev, thread->memory)) < 0)
+        return code;
+    ncdev = (gx_device_clist_common *)ndev;
+    gx_device_fill_in_procs(ndev);
+    ((gx_device_printer *)ncdev)->buffer_memory = ncdev->memory =
+            ncdev->bandlist_memory = thread->memory;
+    gs_c_param_list_read(paramlist);
+    ndev->PageCount = dev->PageCount;       /* copy to prevent mismatch error */
+    if ((code = gs_putdeviceparams(ndev, (gs_param_list *)paramlist)) < 0)
+        return code;
+    /* In the case of a separation device, we need to make sure we get the
+       devn params copied over */
+    if (dev_proc(dev, ret_devn_params)(dev) != NULL) {
+        code = devn_copy_params(dev, (gx_device*) ncdev);
+        if (code < 0)
+            return_error(gs_error_VMerror);
+    }
+    /* A question is, can the clist instances share the device profile.
+       Only doing reads of this from different threads */
+    ncdev->device_icc_profile = cdev->device_icc_profile;
+    rc_increment(ncdev->device_icc_profile);
+    /* gdev_prn_allocate_memory sets the clist for writing, creating new files.
+     * We need to unlink those files; the main thread's files are opened
+     * for each page by clist_attach_render_thread.
+     */
+    if ((code = gdev_prn_allocate_memory(ndev, NULL, ndev->width, ndev->height)) < 0)
+        return code;
+    thread->cdev = ndev;
+    /* close and unlink the temp files just created */
+    cdev->page_info.io_procs->fclose(ncdev->page_cfile, ncdev->page_cfname, true);
+    cdev->page_info.io_procs->fclose(ncdev->page_bfile, ncdev->page_bfname, true);
+    ncdev->page_cfile = ncdev->page_bfile = NULL;
+    /* create the buf device for this thread, and allocate the semaphore */
+    if ((code = gdev_create_buf_device(cdev->buf_procs.create_buf_device,
+                            &(thread->bdev), cdev->target, 0, NULL,
+                            thread->memory, clist_get_band_complexity(dev, 0))) < 0)
+        return code;
+    if ((thread->sema_start = gx_semaphore_alloc(thread->memory)) == NULL)
+        return_error(gs_error_VMerror);
+    /* The thread waits on sema_start for the first page */
+    thread->status = RENDER_THREAD_IDLE;
+    return gp_thread_start(clist_render_thread, thread, &(thread->thread));
+}
+
+/* Free a pool, stopping its threads */
+static void
+clist_free_render_thread_pool(gx_device *dev, clist_render_thread_pool_t *pool)
+{
+    gs_memory_t *mem = pool->memory;
+    int i;
+
+    if (pool->lock != NULL) {
+        gx_monitor_enter(pool->lock);
+        pool->exit = true;
+        clist_wake_render_threads(pool, pool->num_threads);
+        gx_monitor_leave(pool->lock);
+    }
+    for (i = 0; i < pool->num_threads; i++) {
+        if (pool->threads[i].thread != NULL) {
+            gp_thread_finish(pool->threads[i].thread);
+            pool->threads[i].thread = NULL;
+        }
+    }
+    for (i = (pool->num_threads - 1); i >= 0; i--)
+        clist_destroy_render_thread(dev, &(pool->threads[i]), i);
+    gx_semaphore_free(pool->sema_done);
+    gx_monitor_free(pool->lock);
+    gs_free_object(mem, pool->extra_data, "clist_free_render_thread_pool");
+    gs_free_object(mem, pool->buffers, "clist_free_render_thread_pool");
+    gs_free_object(mem, pool->threads, "clist_free_render_thread_pool");
+    gs_free_object(mem, pool, "clist_free_render_thread_pool");
+}
+
+/* Create the pool of render threads for this device */
+static int
+clist_create_render_threads(gx_device *dev, int num_threads)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
+    gs_memory_t *mem = cdev->bandlist_memory;
+    gs_memory_t *chunk_base_mem = mem->thread_safe_memory;
+    gs_memory_status_t mem_status;
+    clist_render_thread_pool_t *pool;
+    gx_device *protodev;
+    gs_c_param_list paramlist;
+    uint buffer_size = ROUND_UP(cdev->data_size, align_bitmap_mod);
+    int i, extra, code = 0;
+
     /* Find the prototype for this device (needed so we can copy from it) */
-    for (i=0; (protodev = (gx_device *)gs_getdevice(i)) != NULL; i++)
-        if (strcmp(protodev->dname, dev->dname) == 0)
-            break;
-    if (protodev == NULL) {
+    if ((protodev = clist_find_prototype(dev)) == NULL) {
         emprintf(mem,
                  "Could not find prototype device. Rendering threads not started.\n");
         return gs_error_rangecheck;
     }
 
+    /* The threads' allocators are wrapped around a thread safe one */
+    gs_memory_status(chunk_base_mem, &mem_status);
+    if (mem_status.is_thread_safe == false)
+        return_error(gs_error_VMerror);
+
+    /* Allocate and initialize the pool and an array of thread control structures */
+    pool = (clist_render_thread_pool_t *)gs_alloc_bytes(mem,
+              sizeof(clist_render_thread_pool_t), "clist_create_render_threads");
+    if (pool == NULL) {
+        emprintf(mem, " VMerror prevented threads from starting.\n");
+        return_error(gs_error_VMerror);
+    }
+    memset(pool, 0, sizeof(clist_render_thread_pool_t));
+    pool->memory = mem;
+    pool->direction = 1;
+    pool->threads = (clist_render_thread_control_t *)
+              gs_alloc_byte_array(mem, num_threads,
+              sizeof(clist_render_thread_control_t), "clist_create_render_threads");
+    pool->lock = gx_monitor_alloc(mem);
+    pool->sema_done = gx_semaphore_alloc(mem);
+    if (pool->threads == NULL || pool->lock == NULL || pool->sema_done == NULL) {
+        clist_free_render_thread_pool(dev, pool);
+        emprintf(mem, " VMerror prevented threads from starting.\n");
+        return_error(gs_error_VMerror);
+    }
+    memset(pool->threads, 0, num_threads * sizeof(clist_render_thread_control_t));
+
     gs_c_param_list_write(&paramlist, mem);
     if ((code = gs_getdeviceparams(dev, (gs_param_list *)&paramlist)) < 0) {
         emprintf1(mem,
                   "Error getting device params, code=%d. Rendering threads not started.\n",
                   code);
+        gs_c_param_list_release(&paramlist);
+        clist_free_render_thread_pool(dev, pool);
         return code;
     }
 
-    /* If the 'mem' is not thread safe, we need to wrap it in a locking memory */
-    gs_memory_status(chunk_base_mem, &mem_status);
-    if (mem_status.is_thread_safe == false) {
-            return_error(gs_error_VMerror);
-    }
-
-    /* Loop creating the devices and semaphores for each thread, then start them */
-    for (i=0; (i < crdev->num_render_threads) && (band >= 0) && (band < band_count);
-            i++, band += crdev->thread_lookahead_direction) {
-        gx_device *ndev;
-        gx_device_clist *ncldev;
-        gx_device_clist_common *ncdev;
-        clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
-
-        /* Every thread will have a 'chunk allocator' to reduce the interaction
-         * with the 'base' allocator which has 'mutex' (locking) protection.
-         * This improves performance of the threads.
-         */
-        if ((code = gs_memory_chunk_wrap(&(thread->memory), chunk_base_mem )) < 0) {
-            emprintf1(mem, "chunk_wrap returned error code: %d\n", code);
-            break;
-        }
-
-        thread->band = -1;              /* a value that won't match any valid band */
-        if ((code = gs_copydevice((gx_device **) &ndev, protodev, thread->memory)) < 0) {
-            code = 0;           /* even though we failed, no cleanup needed */
+    for (i = 0; i < num_threads; i++) {
+        pool->threads[i].pool = pool;
+        if ((code = clist_create_render_thread(dev, protodev, &paramlist,
+                                               chunk_base_mem, &(pool->threads[i]))) < 0) {
+            /* clean up the thread that failed, keep the others */
+            clist_destroy_render_thread(dev, &(pool->threads[i]), i);
             break;
         }
-        ncldev = (gx_device_clist *)ndev;
-        ncdev = (gx_device_clist_common *)ndev;
-        gx_device_fill_in_procs(ndev);
-        ((gx_device_printer *)ncdev)->buffer_memory = ncdev->memory =
-                ncdev->bandlist_memory = thread->memory;
-        gs_c_param_list_read(&paramlist);
-        ndev->PageCount = dev->PageCount;       /* copy to prevent mismatch error */
-        if ((code = gs_putdeviceparams(ndev, (gs_param_list *)&paramlist)) < 0)
-            break;
-        /* In the case of a separation device, we need to make sure we get the
-           devn params copied over */
-        pclist_devn_params = dev_proc(dev, ret_devn_params)(dev);
-        if (pclist_devn_params != NULL) {
-            code = devn_copy_params(dev, (gx_device*) ncdev);
-            if (code < 0) return_error(gs_error_VMerror);
-        }
-        /* A question is, can the clist instances share the device profile.  
-           Only doing reads of this from different threads */
-        ncdev->device_icc_profile = cdev->device_icc_profile;
-        rc_increment(ncdev->device_icc_profile);
-        ncdev->page_uses_transparency = cdev->page_uses_transparency;
-        /* gdev_prn_allocate_memory sets the clist for writing, creating new files.
-         * We need  to unlink those files and open the main thread's files, then
-         * reset the clist state for reading/rendering
-         */
-        if ((code = gdev_prn_allocate_memory(ndev, NULL, ndev->width, ndev->height)) < 0)
-            break;
-        thread->cdev = ndev;
-        /* close and unlink the temp files just created */
-        cdev->page_info.io_procs->fclose(ncdev->page_cfile, ncdev->page_cfname, true);
-        cdev->page_info.io_procs->fclose(ncdev->page_bfile, ncdev->page_bfname, true);
-        /* open the main thread's files for this thread */
-        if ((code=cdev->page_info.io_procs->fopen(cdev->page_cfname, fmode, &ncdev->page_cfile,
-                            thread->memory, thread->memory, true)) < 0 ||
-             (code=cdev->page_info.io_procs->fopen(cdev->page_bfname, fmode, &ncdev->page_bfile,
-                            thread->memory, thread->memory, false)) < 0)
-            break;
-        clist_render_init(ncldev);      /* Initialize clist device for reading */
-        ncdev->page_bfile_end_pos = cdev->page_bfile_end_pos;
-        /* Use the same link cache in each thread and the same profile table.
-           The threads are maintained until clist_finish_page.  At which
-           point, the threads are torn down and the master clist reader device
-           is destroyed along with the icc_table and the icc_cache_cl */
-        ncdev->icc_cache_cl = cdev->icc_cache_cl;
-        ncdev->icc_table = cdev->icc_table;
-        /* create the buf device for this thread, and allocate the semaphores */
-        if ((code = gdev_create_buf_device(cdev->buf_procs.create_buf_device,
-                                &(thread->bdev), cdev->target,
-                                band*crdev->page_band_height, NULL,
-                                thread->memory, clist_get_band_complexity(dev,y)) < 0))
-            break;
-        if ((thread->sema_this = gx_semaphore_alloc(thread->memory)) == NULL ||
-            (thread->sema_group = gx_semaphore_alloc(thread->memory)) == NULL) {
-            code = gs_error_VMerror;
-            break;
-        }
-        /* Start thread 'i' to do band */
-        if ((code = clist_start_render_thread(dev, i, band)) < 0)
-            break;
     }
+    pool->num_threads = i;
     gs_c_param_list_release(&paramlist);
-    /* If the code < 0, the last thread creation failed -- clean it up */
-    if (code < 0) {
-        /* the following relies on 'free' ignoring NULL pointers */
-        gx_semaphore_free(crdev->render_threads[i].sema_group);
-        gx_semaphore_free(crdev->render_threads[i].sema_this);
-        if (crdev->render_threads[i].bdev != NULL)
-            cdev->buf_procs.destroy_buf_device(crdev->render_threads[i].bdev);
-        if (crdev->render_threads[i].cdev != NULL) {
-            gx_device_clist_common *thread_cdev = (gx_device_clist_common *)crdev->render_threads[i].cdev;
-
-            /* Close the file handles, but don't delete (unlink) the files */
-            thread_cdev->page_info.io_procs->fclose(thread_cdev->page_bfile, thread_cdev->page_bfname, false);
-            thread_cdev->page_info.io_procs->fclose(thread_cdev->page_cfile, thread_cdev->page_cfname, false);
-            thread_cdev->do_not_open_or_close_bandfiles = true; /* we already closed the files */
-
-            gdev_prn_free_memory((gx_device *)thread_cdev);
-            gs_free_object(crdev->render_threads[i].memory, thread_cdev,
-            "clist_setup_render_threads");
-        }
-        if (crdev->render_threads[i].memory != NULL)
-            gs_memory_chunk_release(crdev->render_threads[i].memory);
-    }
     /* If we weren't able to create at least one thread, punt   */
     /* Although a single thread isn't any more efficient, the   */
     /* machinery still works, so that's OK.                     */
     if (i == 0) {
-        if (crdev->render_threads[0].memory != NULL) {
-            gs_memory_chunk_release(crdev->render_threads[0].memory);
-            /* free up the locking wrapper if we allocated one */
-            if (chunk_base_mem != mem) {
-                gs_memory_locked_release((gs_memory_locked_t *)chunk_base_mem);
-                gs_free_object(mem, chunk_base_mem, "clist_setup_render_threads(locked allocator)");
-            }
-        }
-        gs_free_object(mem, crdev->render_threads, "clist_setup_render_threads");
-        crdev->render_threads = NULL;
-        /* restore the file pointers */
-        if (cdev->page_cfile == NULL) {
-            char fmode[4];
-
-            strcpy(fmode, "a+");        /* file already exists and we want to re-use it */
-            strncat(fmode, gp_fmode_binary_suffix, 1);
-            cdev->page_info.io_procs->fopen(cdev->page_cfname, fmode, &cdev->page_cfile,
-                                mem, cdev->bandlist_memory, true);
-            cdev->page_info.io_procs->fseek(cdev->page_cfile, 0, SEEK_SET, cdev->page_cfname);
-            cdev->page_info.io_procs->fopen(cdev->page_bfname, fmode, &cdev->page_bfile,
-                                mem, cdev->bandlist_memory, false);
-            cdev->page_info.io_procs->fseek(cdev->page_bfile, 0, SEEK_SET, cdev->page_bfname);
-        }
-        emprintf1(mem, "Rendering threads not started, code=%d.\n", code);
-        return_error(code);
+        clist_free_render_thread_pool(dev, pool);
+        return code < 0 ? code : gs_note_error(gs_error_unknownerror);
     }
-    crdev->num_render_threads = i;
-    crdev->curr_render_thread = 0;
 
-    if(gs_debug[':'] != 0)
-        dprintf1("%% Using %d rendering threads\n", i);
+    /*
+     * The band buffers are those of the threads, and as many again so
+     * that the threads can render ahead while the main thread waits for
+     * a costly band. Rendering ahead is given up if there is no memory
+     * for the extra buffers.
+     */
+    extra = min(pool->num_threads, cdev->nbands - pool->num_threads);
+    if (extra > 0) {
+        pool->extra_data = gs_alloc_bytes(mem, (ulong)extra * buffer_size,
+                                          "clist_create_render_threads");
+        if (pool->extra_data == NULL)
+            extra = 0;
+    }
+    pool->num_buffers = pool->num_threads + max(extra, 0);
+    pool->buffers = (clist_render_band_t *)
+              gs_alloc_byte_array(mem, pool->num_buffers,
+              sizeof(clist_render_band_t), "clist_create_render_threads");
+    if (pool->buffers == NULL) {
+        clist_free_render_thread_pool(dev, pool);
+        emprintf(mem, " VMerror prevented threads from starting.\n");
+        return_error(gs_error_VMerror);
+    }
+    for (i = 0; i < pool->num_buffers; i++) {
+        clist_render_band_t *buf = &(pool->buffers[i]);
 
+        buf->data = (i < pool->num_threads ?
+                     ((gx_device_clist_common *)pool->threads[i].cdev)->data :
+                     pool->extra_data + (ulong)(i - pool->num_threads) * buffer_size);
+        buf->band = -1;
+        buf->status = RENDER_THREAD_IDLE;
+        buf->thread = -1;
+        buf->usec = 0;
+    }
+    pdev->render_thread_pool = pool;
     return 0;
 }
 
+/* Can the pool be used for the page that is about to be rendered? */
+static bool
+clist_render_threads_match(gx_device *dev, int num_threads)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
+    clist_render_thread_pool_t *pool = pdev->render_thread_pool;
+    gx_device_clist_common *ncdev = (gx_device_clist_common *)pool->threads[0].cdev;
+
+    /* The devn params of separation devices are copied with each pool */
+    return pool->num_threads == num_threads &&
+        dev_proc(dev, ret_devn_params)(dev) == NULL &&
+        ncdev->width == dev->width && ncdev->height == dev->height &&
+        ncdev->color_info.depth == dev->color_info.depth &&
+        ncdev->color_info.num_components == dev->color_info.num_components &&
+        ncdev->data_size == cdev->data_size &&
+        ncdev->device_icc_profile == cdev->device_icc_profile;
+}
+
+/* Free the pool of render threads, if the device has one */
 void
-clist_teardown_render_threads(gx_device *dev)
+clist_free_render_threads(gx_device *dev)
 {
+    gx_device_printer *pdev = (gx_device_printer *)dev;
     gx_device_clist *cldev = (gx_device_clist *)dev;
+
+    if (pdev->render_thread_pool == NULL)
+        return;
+    /* Detach the threads from the page they are rendering, if any */
+    if (!CLIST_IS_WRITER(cldev) && cldev->reader.render_threads != NULL)
+        clist_teardown_render_threads(dev);
+    clist_free_render_thread_pool(dev, pdev->render_thread_pool);
+    pdev->render_thread_pool = NULL;
+}
+
+/* Open the main thread's band files in a render thread, and initialize it for reading */
+static int
+clist_attach_render_thread(gx_device *dev, clist_render_thread_control_t *thread,
+                           const char *fmode)
+{
     gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
+    gx_device_clist *ncldev = (gx_device_clist *)thread->cdev;
+    gx_device_clist_common *ncdev = (gx_device_clist_common *)thread->cdev;
+    int code;
+
+    thread->bands = 0;
+    thread->busy_usec = 0;
+    ncdev->page_uses_transparency = cdev->page_uses_transparency;
+    if ((code=cdev->page_info.io_procs->fopen(cdev->page_cfname, fmode, &ncdev->page_cfile,
+                        thread->memory, thread->memory, true,
+                        cdev->band_params.BandListCompressor)) < 0 ||
+         (code=cdev->page_info.io_procs->fopen(cdev->page_bfname, fmode, &ncdev->page_bfile,
+                        thread->memory, thread->memory, false,
+                        cdev->band_params.BandListCompressor)) < 0)
+        return code;
+    /* The band height may change from page to page (AdaptiveBandHeight); */
+    /* the band buffers hold the whole of data_size, so any height fits. */
+    ncdev->page_info.band_params = cdev->page_info.band_params;
+    ncdev->nbands = cdev->nbands;
+    ncdev->page_bfile_end_pos = cdev->page_bfile_end_pos;
+    ncdev->page_info.blank_color = cdev->page_info.blank_color;
+    clist_render_init(ncldev);      /* Initialize clist device for reading */
+    /* Use the same link cache in each thread and the same profile table.
+       These belong to the main thread's reader, and are freed in
+       clist_finish_page after the threads are detached. */
+    ncdev->icc_cache_cl = cdev->icc_cache_cl;
+    ncdev->icc_table = cdev->icc_table;
+    return 0;
+}
+
+/* Close a render thread's band files; it must not be rendering */
+static void
+clist_detach_render_thread(gx_device *dev, clist_render_thread_control_t *thread)
+{
+    gx_device_clist_common *thread_cdev = (gx_device_clist_common *)thread->cdev;
+
+    /* Close the file handles, but don't delete (unlink) the files */
+    if (thread_cdev->page_bfile != NULL)
+        thread_cdev->page_info.io_procs->fclose(thread_cdev->page_bfile, thread_cdev->page_bfname, false);
+    if (thread_cdev->page_cfile != NULL)
+        thread_cdev->page_info.io_procs->fclose(thread_cdev->page_cfile, thread_cdev->page_cfname, false);
+    thread_cdev->page_bfile = thread_cdev->page_cfile = NULL;
+    gx_clist_reader_free_band_complexity_array((gx_device_clist *)thread_cdev);
+    thread_cdev->icc_table = NULL;
+    thread_cdev->icc_cache_cl = NULL;
+}
+
+/* Set up the render threads for a page and start them */
+static int
+clist_setup_render_threads(gx_device *dev, int y)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    gx_device_clist *cldev = (gx_device_clist *)dev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)cldev;
     gx_device_clist_reader *crdev = &cldev->reader;
-    gs_memory_t *mem = cdev->bandlist_memory, *chunk_base_mem;
-    int i;
+    gs_memory_t *mem = cdev->bandlist_memory;
+    clist_render_thread_pool_t *pool;
+    int i, code;
+    int band_count = cdev->nbands;
+    int num_threads = pdev->num_render_threads_requested;
+    char fmode[4];
 
-    if (crdev->render_threads != NULL) {
-
-        chunk_base_mem = gs_memory_chunk_target(crdev->render_threads[0].memory);
-        /* Wait for each thread to finish then free its memory */
-        for (i = (crdev->num_render_threads - 1); i >= 0; i--) {
-            clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
-            gx_device_clist_common *thread_cdev = (gx_device_clist_common *)thread->cdev;
-
-            if (thread->status == RENDER_THREAD_BUSY)
-                gx_semaphore_wait(thread->sema_this);
-            gp_thread_finish(thread->thread);
-            thread->thread = NULL;
-            /* Free control semaphores */
-            gx_semaphore_free(thread->sema_group);
-            gx_semaphore_free(thread->sema_this);
-            /* destroy the thread's buffer device */
-            thread_cdev->buf_procs.destroy_buf_device(thread->bdev);
-            /*
-             * Free the BufferSpace, close the band files
-             * Note that the BufferSpace is freed using 'ppdev->buf' so the 'data'
-             * pointer doesn't need to be the one that the thread started with
-             */
-            /* Close the file handles, but don't delete (unlink) the files */
-            thread_cdev->page_info.io_procs->fclose(thread_cdev->page_bfile, thread_cdev->page_bfname, false);
-            thread_cdev->page_info.io_procs->fclose(thread_cdev->page_cfile, thread_cdev->page_cfname, false);
-            thread_cdev->do_not_open_or_close_bandfiles = true; /* we already closed the files */
-            gdev_prn_free_memory((gx_device *)thread_cdev);
-            /* Decrement the rc count on the icc profile */
-            rc_decrement(thread_cdev->device_icc_profile,"clist_teardown_render_threads");
-            /* Free the device copy this thread used.  Note that the 
-               deviceN stuff if was allocated and copied earlier for the device
-               will be freed with this call */
-            gs_free_object(thread->memory, thread_cdev, "clist_teardown_render_threads");
-#ifdef DEBUG
-            if (gs_debug[':'])
-                dprintf2("%% Thread %d total usertime=%ld msec\n", i, thread->cputime);
-            dprintf1("\nthread: %d ending memory state...\n", i);
-            gs_memory_chunk_dump_memory(thread->memory);
-            dprintf("                                    memory dump done.\n");
-#endif
+    if(gs_debug[':'] != 0)
+        dprintf1("%% %d rendering threads requested.\n", pdev->num_render_threads_requested);
 
-            gs_memory_chunk_release(thread->memory);
+    if (num_threads > band_count)
+        num_threads = band_count; /* don't bother starting more threads than bands */
+
+    /* Rebuild the pool if it was made for a different page */
+    if (pdev->render_thread_pool != NULL && !clist_render_threads_match(dev, num_threads))
+        clist_free_render_threads(dev);
+    if (pdev->render_thread_pool == NULL) {
+        if ((code = clist_create_render_threads(dev, num_threads)) < 0) {
+            emprintf1(mem, "Rendering threads not started, code=%d.\n", code);
+            return code;
         }
-        cdev->data = crdev->main_thread_data;   /* restore the pointer for writing */
-        gs_free_object(mem, crdev->render_threads, "clist_teardown_render_threads");
-        crdev->render_threads = NULL;
-
-        /* Now re-open the clist temp files so we can write to them */
-        if (cdev->page_cfile == NULL) {
-            char fmode[4];
-
-            strcpy(fmode, "a+");        /* file already exists and we want to re-use it */
-            strncat(fmode, gp_fmode_binary_suffix, 1);
-            cdev->page_info.io_procs->fopen(cdev->page_cfname, fmode, &cdev->page_cfile,
-                                mem, cdev->bandlist_memory, true);
-            cdev->page_info.io_procs->fseek(cdev->page_cfile, 0, SEEK_SET, cdev->page_cfname);
-            cdev->page_info.io_procs->fopen(cdev->page_bfname, fmode, &cdev->page_bfile,
-                                mem, cdev->bandlist_memory, false);
-            cdev->page_info.io_procs->fseek(cdev->page_bfile, 0, SEEK_SET, cdev->page_bfname);
+    }
+    pool = pdev->render_thread_pool;
+
+    crdev->main_thread_data = cdev->data;               /* save data area */
+    /* Based on the line number requested, decide the order of band rendering */
+    /* Almost all devices go in increasing line order (except the bmp* devices ) */
+    crdev->thread_lookahead_direction = (y < (cdev->height - 1)) ? 1 : -1;
+
+    /* Close the files so we can open them in multiple threads */
+    if ((code = cdev->page_info.io_procs->fclose(cdev->page_cfile, cdev->page_cfname, false)) < 0 ||
+        (code = cdev->page_info.io_procs->fclose(cdev->page_bfile, cdev->page_bfname, false)) < 0) {
+        emprintf(mem, "Closing clist files prevented threads from starting.\n");
+        return_error(gs_error_unknownerror); /* shouldn't happen */
+    }
+    cdev->page_cfile = cdev->page_bfile = NULL;
+    strcpy(fmode, "r");                 /* read access for threads */
+    strncat(fmode, gp_fmode_binary_suffix, 1);
+
+    for (i = 0; i < pool->num_threads; i++) {
+        if ((code = clist_attach_render_thread(dev, &(pool->threads[i]), fmode)) < 0) {
+            for (; i >= 0; i--)
+                clist_detach_render_thread(dev, &(pool->threads[i]));
+            clist_reopen_band_files(dev);
+            emprintf1(mem, "Rendering threads not started, code=%d.\n", code);
+            return code;
         }
     }
+    crdev->render_threads = pool->threads;
+    crdev->num_render_threads = pool->num_threads;
+
+    /* Hand out the bands from the first one needed */
+    gx_monitor_enter(pool->lock);
+    pool->band_count = band_count;
+    pool->direction = crdev->thread_lookahead_direction;
+    pool->next_band = y / crdev->page_info.band_params.BandHeight;
+    pool->wait_usec = 0;
+    gp_get_realtime(pool->page_start);
+    clist_wake_render_threads(pool, pool->num_threads);
+    gx_monitor_leave(pool->lock);
+
+    if(gs_debug[':'] != 0)
+        dprintf2("%% Using %d rendering threads, %d band buffers\n",
+                 pool->num_threads, pool->num_buffers);
+
+    return 0;
 }
 
-static int
-clist_start_render_thread(gx_device *dev, int thread_index, int band)
+/*
+ * Wait for the render threads to finish with this page, and detach them
+ * from it. The threads themselves are kept for the next page.
+ */
+void
+clist_teardown_render_threads(gx_device *dev)
 {
+    gx_device_printer *pdev = (gx_device_printer *)dev;
     gx_device_clist *cldev = (gx_device_clist *)dev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
-    int code;
+    clist_render_thread_pool_t *pool = pdev->render_thread_pool;
+    int i;
 
-    crdev->render_threads[thread_index].band = band;
-    crdev->render_threads[thread_index].status = RENDER_THREAD_BUSY;
+    if (crdev->render_threads == NULL)
+        return;
 
-    /* Finally, fire it up */
-    code = gp_thread_start(clist_render_thread,
-                           &(crdev->render_threads[thread_index]),
-                           &(crdev->render_threads[thread_index].thread));
+    /* Hand out no more bands, and wait for those being rendered */
+    gx_monitor_enter(pool->lock);
+    pool->band_count = 0;
+    for (;;) {
+        for (i = 0; i < pool->num_buffers; i++)
+            if (pool->buffers[i].status == RENDER_THREAD_BUSY)
+                break;
+        if (i == pool->num_buffers)
+            break;
+        gx_monitor_leave(pool->lock);
+        gx_semaphore_wait(pool->sema_done);
+        gx_monitor_enter(pool->lock);
+    }
+    if (gs_debug[':'] != 0) {
+        long page_usec = clist_usec_since(pool->page_start);
 
-    return code;
+        for (i = 0; i < pool->num_threads; i++)
+            dprintf4("%% Thread %d: %d bands in %ld usec, %d%% busy\n", i,
+                     pool->threads[i].bands, pool->threads[i].busy_usec,
+                     page_usec > 0 ? (int)(100.0 * pool->threads[i].busy_usec / page_usec) : 0);
+        dprintf2("%% Main thread waited %ld usec for bands, in %ld usec\n",
+                 pool->wait_usec, page_usec);
+    }
+    /* Give the main thread its own buffer back */
+    for (i = 0; i < pool->num_buffers; i++) {
+        clist_render_band_t *buf = &(pool->buffers[i]);
+
+        buf->status = RENDER_THREAD_IDLE;
+        buf->band = -1;
+        if (buf->data == crdev->main_thread_data)
+            buf->data = cdev->data;
+    }
+    gx_monitor_leave(pool->lock);
+
+    for (i = (pool->num_threads - 1); i >= 0; i--)
+        clist_detach_render_thread(dev, &(pool->threads[i]));
+    cdev->data = crdev->main_thread_data;   /* restore the pointer for writing */
+    crdev->render_threads = NULL;
+
+    /* Now re-open the clist temp files so we can write to them */
+    clist_reopen_band_files(dev);
 }
 
-static void
-clist_render_thread(void *data)
+/* Render one band in a thread, in the buffer taken for it */
+static int
+clist_render_thread_band(clist_render_thread_control_t *thread, clist_render_band_t *buf)
 {
-    clist_render_thread_control_t *thread = (clist_render_thread_control_t *)data;
     gx_device *dev = thread->cdev;
     gx_device_clist *cldev = (gx_device_clist *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
     gx_device *bdev = thread->bdev;
     gs_int_rect band_rect;
-    byte *mdata = crdev->data + crdev->page_tile_cache_size;
+    byte *mdata;
     uint raster = bitmap_raster(dev->width * dev->color_info.depth);
     int code;
     int band_height = crdev->page_band_height;
-    int band = thread->band;
+    int band = buf->band;
     int band_begin_line = band * band_height;
     int band_end_line = band_begin_line + band_height;
     int band_num_lines;
+    long starttime[2];
 #ifdef DEBUG
-    long starttime[2], endtime[2];
+    long ustarttime[2], uendtime[2];
 
-    gp_get_usertime(starttime); /* thread start time */
+    gp_get_usertime(ustarttime); /* band start time */
 #endif
+    gp_get_realtime(starttime);
     if (band_end_line > dev->height)
         band_end_line = dev->height;
     band_num_lines = band_end_line - band_begin_line;
 
+    crdev->data = buf->data;
+    mdata = crdev->data + crdev->page_tile_cache_size;
     code = crdev->buf_procs.setup_buf_device
             (bdev, mdata, raster, NULL, 0, band_num_lines, band_num_lines);
     band_rect.p.x = 0;
@@ -388,33 +686,56 @@ clist_render_thread(void *data)
     crdev->ymin = band_begin_line;
     crdev->ymax = band_end_line;
     crdev->offset_map = NULL;
-    //crdev->icc_cache_cl = NULL;
-    if (code < 0)
-        thread->status = code;          /* shouldn't happen */
-    else
-        thread->status = RENDER_THREAD_DONE;    /* OK */
 
+    buf->usec = clist_usec_since(starttime);
 #ifdef DEBUG
-    gp_get_usertime(endtime);
-    thread->cputime += (endtime[0] - starttime[0]) * 1000 +
-             (endtime[1] - starttime[1]) / 1000000;
+    gp_get_usertime(uendtime);
+    thread->cputime += (uendtime[0] - ustarttime[0]) * 1000 +
+             (uendtime[1] - ustarttime[1]) / 1000000;
 #endif
-    /*
-     * Signal the semaphores. We signal the 'group' first since even if
-     * the waiter is released on the group, it still needs to check
-     * status on the thread
-     */
-    gx_semaphore_signal(thread->sema_group);
-    gx_semaphore_signal(thread->sema_this);
+    return code;
+}
+
+/* Render bands as they are handed out, until the pool is freed */
+static void
+clist_render_thread(void *data)
+{
+    clist_render_thread_control_t *thread = (clist_render_thread_control_t *)data;
+    clist_render_thread_pool_t *pool = thread->pool;
+    clist_render_band_t *buf;
+    int code;
+
+    gx_monitor_enter(pool->lock);
+    while (!pool->exit) {
+        buf = clist_claim_render_band(pool);
+        if (buf == NULL) {
+            /* Wait for the main thread to free a buffer or start a page */
+            thread->status = RENDER_THREAD_IDLE;
+            gx_monitor_leave(pool->lock);
+            gx_semaphore_wait(thread->sema_start);
+            gx_monitor_enter(pool->lock);
+            continue;
+        }
+        thread->band = buf->band;
+        gx_monitor_leave(pool->lock);
+
+        code = clist_render_thread_band(thread, buf);
+
+        gx_monitor_enter(pool->lock);
+        buf->status = (code < 0 ? code : RENDER_THREAD_DONE);
+        buf->thread = thread - pool->threads;
+        thread->band = -1;
+        thread->bands++;
+        thread->busy_usec += buf->usec;
+        gx_semaphore_signal(pool->sema_done);
+    }
+    gx_monitor_leave(pool->lock);
 }
 
 /*
- * Copy the raster data from the completed thread to the caller's
- * device (the main thread)
+ * Swap the main thread's buffer for the one holding the band needed,
+ * waiting for the band to be rendered if need be.
  * Return 0 if OK, < 0 is the error code from the thread
- *
- * After swapping the pointers, start up the completed thread with the
- * next band remaining to do (if any)
  */
 static int
 clist_get_band_from_thread(gx_device *dev, int band_needed)
@@ -422,70 +743,66 @@ clist_get_band_from_thread(gx_device *dev, int band_needed)
     gx_device_clist *cldev = (gx_device_clist *)dev;
     gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
     gx_device_clist_reader *crdev = &cldev->reader;
-    int i, next_band, code = 0;
-    int thread_index = crdev->curr_render_thread;
-    clist_render_thread_control_t *thread = &(crdev->render_threads[thread_index]);
-    gx_device_clist_common *thread_cdev = (gx_device_clist_common *)thread->cdev;
+    clist_render_thread_pool_t *pool = ((gx_device_printer *)dev)->render_thread_pool;
     int band_height = crdev->page_info.band_params.BandHeight;
-    int band_count = cdev->nbands;
+    clist_render_band_t *buf;
+    long starttime[2];
+    int code = 0, thread = -1;
+    long usec = 0;
     byte *tmp;                  /* for swapping data areas */
 
-    /* We expect that the thread needed will be the 'current' thread */
-    if (thread->band != band_needed) {
-        int band = band_needed;
+    gx_monitor_enter(pool->lock);
+    if (clist_find_render_band(pool, band_needed) == NULL &&
+        pool->next_band != band_needed) {
+        /* The band has not been handed out: the caller has skipped some   */
+        /* bands, or it has turned round, if the band was handed out       */
+        /* before. Carry on from the band needed, in the new direction.    */
+        if ((band_needed - pool->next_band) * pool->direction < 0)
+            pool->direction = -pool->direction;
+        crdev->thread_lookahead_direction = pool->direction;
+        pool->next_band = band_needed;
+    }
+    gp_get_realtime(starttime);
+    for (;;) {
+        /* Bands behind the one needed are of no use now */
+        clist_drop_render_bands(pool, band_needed);
+        buf = clist_find_render_band(pool, band_needed);
+        if (buf != NULL && buf->status != RENDER_THREAD_BUSY)
+            break;
+        gx_monitor_leave(pool->lock);
+        gx_semaphore_wait(pool->sema_done);
+        gx_monitor_enter(pool->lock);
+    }
+    pool->wait_usec += clist_usec_since(starttime);
 
-        /* Probably we went in the wrong direction, so let the threads */
-        /* all complete, then restart them in the opposite direction   */
-        /* If the caller is 'bouncing around' we may end up back here, */
-        /* but that is a VERY rare case (we haven't seen it yet).      */
-        for (i=0; i < crdev->num_render_threads; i++) {
-            clist_render_thread_control_t *thread = &(crdev->render_threads[i]);
+    if (buf->status < 0)
+        code = buf->status;             /* FAIL */
+    else {
+        /* Swap the data areas to avoid the copy */
+        tmp = cdev->data;
+        cdev->data = buf->data;
+        buf->data = tmp;
+        thread = buf->thread;
+        usec = buf->usec;
+    }
+    /* The buffer is free for the next band to be handed out */
+    buf->status = RENDER_THREAD_IDLE;
+    buf->band = -1;
+    clist_wake_render_threads(pool, 1);
+    gx_monitor_leave(pool->lock);
+    if (code < 0)
+        return code;
+
+    if (gs_debug[':'] != 0)
+        dprintf3("%% Band %d: thread %d, %ld usec\n", band_needed, thread, usec);
 
-            if (thread->status == RENDER_THREAD_BUSY)
-                gx_semaphore_wait(thread->sema_this);
-        }
-        crdev->thread_lookahead_direction *= -1;
-        /* Loop creating the devices and semaphores for each thread, then start them */
-        for (i=0; (i < crdev->num_render_threads) && (band >= 0) && (band < band_count);
-                i++, band += crdev->thread_lookahead_direction) {
-            thread = &(crdev->render_threads[i]);
-
-            thread->band = -1;          /* a value that won't match any valid band */
-            /* Start thread 'i' to do band */
-            if ((code = clist_start_render_thread(dev, i, band)) < 0)
-                break;
-        }
-        crdev->curr_render_thread = thread_index = 0;
-        thread = &(crdev->render_threads[0]);
-    }
-    /* Wait for this thread */
-    gx_semaphore_wait(thread->sema_this);
-    gp_thread_finish(thread->thread);
-    thread->thread = NULL;
-    if (thread->status < 0)
-        return thread->status;          /* FAIL */
-
-    /* Swap the data areas to avoid the copy */
-    tmp = cdev->data;
-    cdev->data = thread_cdev->data;
-    thread_cdev->data = tmp;
-    thread->status = RENDER_THREAD_IDLE;        /* the data is no longer valid */
-    thread->band = -1;
     /* Update the bounds for this band */
     cdev->ymin =  band_needed * band_height;
     cdev->ymax =  cdev->ymin + band_height;
     if (cdev->ymax > dev->height)
         cdev->ymax = dev->height;
 
-    /* If we are not at the final band, start up this thread with the next one to do */
-    next_band = band_needed + (crdev->num_render_threads * crdev->thread_lookahead_direction);
-    if (next_band >= 0 && next_band < band_count)
-        code = clist_start_render_thread(dev, thread_index, next_band);
-    /* bump the 'curr' to the next thread */
-    crdev->curr_render_thread = crdev->curr_render_thread == crdev->num_render_threads - 1 ?
-                0 : crdev->curr_render_thread + 1;
-
-    return code;
+    return 0;
 }
 
 /* Copy a rasterized rectangle to the client, rasterizing if needed. */
@@ -646,3 +963,356 @@ clist_enable_multi_thread_render(gx_device *dev)
 
     return 1;
 }
+
+/* ---------------- Page pipeline ---------------- */
+
+/*
+ * With MaxPagesInFlight > 0, the printer device saves each page it has
+ * written (gdev_prn_save_page), which gives the writer new band files for
+ * the next page, and queues it for the pipeline's thread. That thread
+ * prints the saved pages in order with its own instance of the device, so
+ * that interpreting a page overlaps printing the previous ones. At most
+ * MaxPagesInFlight pages are queued or being printed: the writer waits
+ * for the oldest one when the queue is full.
+ *
+ * The render device is opened with the parameters of the writer, and is
+ * given them again when the page geometry or the output file changes;
+ * it is kept until the writer is closed, so that drivers that keep state
+ * from page to page (e.g. the tiff devices) see every page. While pages
+ * are in flight it owns the output file: clist_sync_page_pipeline gives
+ * the file back to the writer once they have all been printed.
+ */
+
+/* Forward reference prototypes */
+static void clist_pipeline_thread(void *data);
+
+/* Wait until at most 'count' pages are in flight. The pipeline's lock must be held. */
+static void
+clist_pipeline_wait(clist_page_pipeline_t *pipeline, int count)
+{
+    while (pipeline->count > count) {
+        gx_monitor_leave(pipeline->lock);
+        gx_semaphore_wait(pipeline->sema_done);
+        gx_monitor_enter(pipeline->lock);
+    }
+}
+
+/* Hand the output file from one instance of the device to the other */
+static void
+clist_pipeline_move_file(gx_device_printer *to, gx_device_printer *from)
+{
+    if (to->file == NULL && from->file != NULL) {
+        to->file = from->file;
+        to->file_is_new = from->file_is_new;
+        from->file = NULL;
+    }
+}
+
+/* Can the render device print the page the device has just written? */
+static bool
+clist_pipeline_matches(gx_device *dev, clist_page_pipeline_t *pipeline)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
+    gx_device_printer *rdev = pipeline->rdev;
+    gx_device_clist_common *rcdev = (gx_device_clist_common *)rdev;
+
+    return rdev->width == dev->width && rdev->height == dev->height &&
+        rdev->HWResolution[0] == dev->HWResolution[0] &&
+        rdev->HWResolution[1] == dev->HWResolution[1] &&
+        rdev->color_info.depth == dev->color_info.depth &&
+        rdev->color_info.num_components == dev->color_info.num_components &&
+        rdev->color_info.polarity == dev->color_info.polarity &&
+        rdev->color_info.max_gray == dev->color_info.max_gray &&
+        rdev->color_info.max_color == dev->color_info.max_color &&
+        rdev->buffer_space == pdev->buffer_space &&
+        rcdev->page_tile_cache_size == cdev->page_tile_cache_size &&
+        rcdev->page_info.band_params.BandWidth ==
+            cdev->page_info.band_params.BandWidth &&
+        rcdev->page_info.band_params.BandBufferSpace ==
+            cdev->page_info.band_params.BandBufferSpace &&
+        rdev->page_uses_transparency == pdev->page_uses_transparency &&
+        rdev->device_icc_profile == dev->device_icc_profile &&
+        strcmp(rdev->fname, pdev->fname) == 0;
+}
+
+/* Give the render device the parameters of the writer. No page may be in flight. */
+static int
+clist_pipeline_put_params(gx_device *dev, clist_page_pipeline_t *pipeline)
+{
+    gx_device *rdev = (gx_device *)pipeline->rdev;
+    gs_c_param_list paramlist;
+    int code;
+
+    gs_c_param_list_write(&paramlist, dev->memory);
+    if ((code = gs_getdeviceparams(dev, (gs_param_list *)&paramlist)) >= 0) {
+        gs_c_param_list_read(&paramlist);
+        rdev->PageCount = dev->PageCount;       /* copy to prevent mismatch error */
+        code = gs_putdeviceparams(rdev, (gs_param_list *)&paramlist);
+    }
+    gs_c_param_list_release(&paramlist);
+    if (code < 0)
+        return code;
+    /* The render device prints what it is given, and opens the output */
+    /* file when it first prints to it, unless it has been handed over.  */
+    pipeline->rdev->max_pages_in_flight = 0;
+    pipeline->rdev->OpenOutputFile = false;
+    /* Only doing reads of the profile from the other thread */
+    rc_assign(rdev->device_icc_profile, dev->device_icc_profile,
+              "clist_pipeline_put_params");
+    /* Changing some parameters closes the device */
+    if (!rdev->is_open && (code = gs_opendevice(rdev)) < 0)
+        return code;
+    if (pipeline->rdev->buffer_space == 0)
+        return_error(gs_error_rangecheck);      /* not banding */
+    /* The render device only reads saved pages: it has no use for */
+    /* the band files created for it to write to.                  */
+    return clist_close_output_file(rdev);
+}
+
+/* Free a pipeline whose thread is not running */
+static void
+clist_destroy_page_pipeline(clist_page_pipeline_t *pipeline)
+{
+    gs_memory_t *mem = pipeline->memory;
+    gx_device *rdev = (gx_device *)pipeline->rdev;
+
+    if (rdev != NULL) {
+        gs_closedevice(rdev);
+        rc_decrement(rdev->device_icc_profile, "clist_destroy_page_pipeline");
+        gs_free_object(pipeline->render_memory, rdev, "clist_destroy_page_pipeline");
+    }
+    if (pipeline->render_memory != NULL)
+        gs_memory_chunk_release(pipeline->render_memory);
+    gx_semaphore_free(pipeline->sema_done);
+    gx_semaphore_free(pipeline->sema_page);
+    gx_monitor_free(pipeline->lock);
+    gs_free_object(mem, pipeline->pages, "clist_destroy_page_pipeline");
+    gs_free_object(mem, pipeline, "clist_destroy_page_pipeline");
+}
+
+/* Create the page pipeline for a device, and start its thread */
+static int
+clist_create_page_pipeline(gx_device *dev)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    gs_memory_t *mem = dev->memory->thread_safe_memory;
+    clist_page_pipeline_t *pipeline;
+    gx_device *protodev, *rdev;
+    int code;
+
+    if ((protodev = clist_find_prototype(dev)) == NULL)
+        return_error(gs_error_rangecheck);
+    pipeline = (clist_page_pipeline_t *)gs_alloc_bytes(mem,
+                sizeof(clist_page_pipeline_t), "clist_create_page_pipeline");
+    if (pipeline == NULL)
+        return_error(gs_error_VMerror);
+    memset(pipeline, 0, sizeof(clist_page_pipeline_t));
+    pipeline->memory = mem;
+    pipeline->max_pages = pdev->max_pages_in_flight;
+    pipeline->pages = (gx_saved_page *)gs_alloc_byte_array(mem, pipeline->max_pages,
+                sizeof(gx_saved_page), "clist_create_page_pipeline");
+    pipeline->lock = gx_monitor_alloc(mem);
+    pipeline->sema_page = gx_semaphore_alloc(mem);
+    pipeline->sema_done = gx_semaphore_alloc(mem);
+    if (pipeline->pages == NULL || pipeline->lock == NULL ||
+        pipeline->sema_page == NULL || pipeline->sema_done == NULL) {
+        clist_destroy_page_pipeline(pipeline);
+        return_error(gs_error_VMerror);
+    }
+
+    /* The render device has a 'chunk' allocator of its own, as the */
+    /* rendering threads do, since only the pipeline's thread uses it. */
+    if ((code = gs_memory_chunk_wrap(&pipeline->render_memory, mem)) < 0 ||
+        (code = gs_copydevice(&rdev, protodev, pipeline->render_memory)) < 0) {
+        clist_destroy_page_pipeline(pipeline);
+        return code;
+    }
+    pipeline->rdev = (gx_device_printer *)rdev;
+    gx_device_fill_in_procs(rdev);
+    pipeline->rdev->buffer_memory = pipeline->rdev->bandlist_memory =
+        pipeline->render_memory;
+    if ((code = clist_pipeline_put_params(dev, pipeline)) < 0 ||
+        (code = gp_thread_start(clist_pipeline_thread, pipeline,
+                                &pipeline->thread)) < 0) {
+        clist_destroy_page_pipeline(pipeline);
+        return code;
+    }
+    pdev->page_pipeline = pipeline;
+    return 0;
+}
+
+/*
+ * Wait for the pages in flight to be printed, and give the output file back
+ * to the device. Returns the first error from printing them, if any.
+ */
+int
+clist_sync_page_pipeline(gx_device *dev)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    clist_page_pipeline_t *pipeline = pdev->page_pipeline;
+    int code;
+
+    if (pipeline == NULL)
+        return 0;
+    gx_monitor_enter(pipeline->lock);
+    clist_pipeline_wait(pipeline, 0);
+    code = pipeline->code;
+    pipeline->code = 0;
+    gx_monitor_leave(pipeline->lock);
+    clist_pipeline_move_file(pdev, pipeline->rdev);
+    return code;
+}
+
+/* Shutdown the page pipeline and free up the related memory */
+int
+clist_free_page_pipeline(gx_device *dev)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    clist_page_pipeline_t *pipeline = pdev->page_pipeline;
+    int code;
+
+    if (pipeline == NULL)
+        return 0;
+    code = clist_sync_page_pipeline(dev);
+    gx_monitor_enter(pipeline->lock);
+    pipeline->exit = true;
+    gx_semaphore_signal(pipeline->sema_page);
+    gx_monitor_leave(pipeline->lock);
+    gp_thread_finish(pipeline->thread);
+    clist_destroy_page_pipeline(pipeline);
+    pdev->page_pipeline = NULL;
+    return code;
+}
+
+/*
+ * Queue the current page to be printed by the page pipeline, starting it
+ * if need be. Returns 1 if the page can't be queued, once the pages in
+ * flight have been printed: the caller must then print it itself.
+ */
+int
+clist_pipeline_page(gx_device *dev, int num_copies)
+{
+    gx_device_printer *pdev = (gx_device_printer *)dev;
+    gx_device_clist *cldev = (gx_device_clist *)dev;
+    clist_page_pipeline_t *pipeline = pdev->page_pipeline;
+    gs_memory_status_t mem_status;
+    gx_saved_page *page;
+    int code;
+
+    /*
+     * The page must still be being written, to band files the pipeline's
+     * thread can free. The separation devices' parameters aren't copied.
+     */
+    gs_memory_status(cldev->common.bandlist_memory, &mem_status);
+    if (!CLIST_IS_WRITER(cldev) || !mem_status.is_thread_safe ||
+        strlen(dev->dname) >= sizeof(page->dname) ||
+        dev_proc(dev, ret_devn_params)(dev) != NULL) {
+        code = clist_sync_page_pipeline(dev);
+        return (code < 0 ? code : 1);
+    }
+    if (pipeline != NULL && pipeline->max_pages != pdev->max_pages_in_flight) {
+        if ((code = clist_free_page_pipeline(dev)) < 0)
+            return code;
+        pipeline = NULL;
+    }
+    if (pipeline == NULL) {
+        if ((code = clist_create_page_pipeline(dev)) < 0) {
+            emprintf1(dev->memory,
+                      "Page pipeline not started, code=%d. Printing pages in turn.\n",
+                      code);
+            pdev->max_pages_in_flight = 0;
+            return 1;
+        }
+        pipeline = pdev->page_pipeline;
+    }
+
+    /* Bring the render device up to date, once it is idle */
+    if (pdev->file != NULL || !clist_pipeline_matches(dev, pipeline)) {
+        if ((code = clist_sync_page_pipeline(dev)) < 0)
+            return code;
+        clist_pipeline_move_file(pipeline->rdev, pdev);
+        if (!clist_pipeline_matches(dev, pipeline) &&
+            (code = clist_pipeline_put_params(dev, pipeline)) < 0)
+            return code;
+    }
+
+    /* Wait for room in the queue */
+    gx_monitor_enter(pipeline->lock);
+    clist_pipeline_wait(pipeline, pipeline->max_pages - 1);
+    code = pipeline->code;
+    pipeline->code = 0;
+    page = &pipeline->pages[(pipeline->first + pipeline->count) % pipeline->max_pages];
+    gx_monitor_leave(pipeline->lock);
+    if (code < 0)
+        return code;
+
+    /* Only this thread uses the free part of the queue */
+    if ((code = gdev_prn_save_page(pdev, page, num_copies)) < 0)
+        return code;
+    gx_monitor_enter(pipeline->lock);
+    pipeline->count++;
+    if (gs_debug[':'] != 0)
+        dprintf2("%% Page %ld queued, %d pages in flight\n",
+                 (long)page->device.PageCount, pipeline->count);
+    gx_semaphore_signal(pipeline->sema_page);
+    gx_monitor_leave(pipeline->lock);
+    return 0;
+}
+
+/* Print a saved page with the render device */
+static int
+clist_pipeline_print_page(gx_device_printer *rdev, gx_saved_page *page)
+{
+    int code, closecode;
+
+    rdev->PageCount = page->device.PageCount;
+    code = gdev_prn_open_saved_page(rdev, page);
+    if (code >= 0)
+        code = gdev_prn_open_printer((gx_device *)rdev, 1);
+    if (code >= 0) {
+        code = (*rdev->printer_procs.print_page_copies)(rdev, rdev->file,
+                                                        page->num_copies);
+        fflush(rdev->file);
+        if (code >= 0 && ferror(rdev->file))
+            code = gs_note_error(gs_error_ioerror);
+        closecode = gdev_prn_close_printer((gx_device *)rdev);
+        if (code >= 0)
+            code = closecode;
+    }
+    closecode = gdev_prn_close_saved_page(rdev);
+    return (code < 0 ? code : closecode);
+}
+
+/* Print the pages as they are queued, until the pipeline is freed */
+static void
+clist_pipeline_thread(void *data)
+{
+    clist_page_pipeline_t *pipeline = (clist_page_pipeline_t *)data;
+    gx_saved_page *page;
+    int code;
+
+    gx_monitor_enter(pipeline->lock);
+    for (;;) {
+        if (pipeline->count == 0) {
+            if (pipeline->exit)
+                break;
+            gx_monitor_leave(pipeline->lock);
+            gx_semaphore_wait(pipeline->sema_page);
+            gx_monitor_enter(pipeline->lock);
+            continue;
+        }
+        page = &pipeline->pages[pipeline->first];
+        gx_monitor_leave(pipeline->lock);
+
+        code = clist_pipeline_print_page(pipeline->rdev, page);
+
+        gx_monitor_enter(pipeline->lock);
+        if (code < 0 && pipeline->code == 0)
+            pipeline->code = code;
+        pipeline->first = (pipeline->first + 1) % pipeline->max_pages;
+        pipeline->count--;
+        gx_semaphore_signal(pipeline->sema_done);
+    }
+    gx_monitor_leave(pipeline->lock);
+}
@@ -28,20 +28,90 @@
 #  define clist_render_thread_control_t_DEFINED
 typedef struct clist_render_thread_control_s clist_render_thread_control_t;
 #endif
+#ifndef clist_render_thread_pool_t_DEFINED
+#  define clist_render_thread_pool_t_DEFINED
+typedef struct clist_render_thread_pool_s clist_render_thread_pool_t;
+#endif
 
 struct clist_render_thread_control_s {
-    int status;	/* 0: not started, 1: done, 2: busy, < 0: error */ 
-		/* values allow waiting until status < 2 */
+    int status;	/* RENDER_THREAD_IDLE: waiting on sema_start, */
+		/* RENDER_THREAD_BUSY: looking for or rendering a band */
     gs_memory_t *memory;	/* thread's 'chunk' memory allocator */
-    gx_semaphore_t *sema_this;
-    gx_semaphore_t *sema_group;
+    gx_semaphore_t *sema_start;	/* signalled when there may be a band */
+				/* to render, or to make the thread exit */
+    clist_render_thread_pool_t *pool;	/* the pool this thread belongs to */
     gx_device *cdev;	/* clist device copy */
     gx_device *bdev;	/* this thread's buffer device */
-    int band;
+    int band;	/* band being rendered, -1 if none */
     gp_thread_id thread;
+    int bands;	/* bands rendered on this page */
+    long busy_usec;	/* real time spent rendering them */
 #ifdef DEBUG
     ulong cputime;
 #endif
 };
 
+/*
+ * A band buffer of the pool. The buffers are handed round between the
+ * threads and the main thread: a thread takes a free one for the next
+ * band to render, and the main thread swaps its own buffer for the one
+ * holding the band it needs. The buffers that are not free hold the
+ * bands rendered ahead of the main thread, so their number bounds how
+ * far ahead the threads can get.
+ */
+typedef struct clist_render_band_s {
+    byte *data;	/* buffer area, as for gx_device_clist_common */
+    int band;	/* band rendered or being rendered, -1 if none */
+    int status;	/* RENDER_THREAD_IDLE: free, RENDER_THREAD_BUSY: */
+		/* being rendered, RENDER_THREAD_DONE: ready, < 0: error */
+    int thread;	/* index of the thread that rendered it */
+    long usec;	/* real time taken to render it */
+} clist_render_band_t;
+
+/*
+ * The render threads are kept by the printer device from page to page
+ * (see clist_setup_render_threads). Bands are handed out in order to
+ * whichever thread is free, rather than to a fixed thread.
+ */
+struct clist_render_thread_pool_s {
+    gs_memory_t *memory;	/* allocator for the pool */
+    int num_threads;
+    clist_render_thread_control_t *threads;
+    int num_buffers;
+    clist_render_band_t *buffers;
+    byte *extra_data;	/* buffers beyond those of the threads */
+    gx_monitor_t *lock;	/* protects the fields below, the buffers, */
+			/* and the status of the threads */
+    gx_semaphore_t *sema_done;	/* signalled when a band is rendered */
+    int next_band;	/* next band to hand out, if in range */
+    int direction;	/* +1 or -1 */
+    int band_count;	/* bands on the current page, 0 between pages */
+    bool exit;	/* set to make the threads exit */
+    /* Statistics for the current page, reported with -Z: */
+    long page_start[2];
+    long wait_usec;	/* real time the main thread waited for bands */
+};
+
+/*
+ * The page pipeline prints the pages saved by the printer device in a
+ * thread of its own, with its own instance of the device, while the
+ * device writes the command list of the next page (see clist_pipeline_page).
+ */
+struct clist_page_pipeline_s {
+    gs_memory_t *memory;	/* thread safe allocator for the pipeline */
+    gs_memory_t *render_memory;	/* 'chunk' allocator of the render device */
+    gx_device_printer *rdev;	/* device instance that prints the pages */
+    gp_thread_id thread;
+    gx_monitor_t *lock;	/* protects the fields below */
+    gx_semaphore_t *sema_page;	/* signalled when a page is queued, */
+				/* or to make the thread exit */
+    gx_semaphore_t *sema_done;	/* signalled when a page is printed */
+    int max_pages;	/* size of the queue */
+    gx_saved_page *pages;	/* the queue */
+    int first;	/* index of the oldest page in the queue */
+    int count;	/* pages queued or being printed */
+    int code;	/* first error from printing them */
+    bool exit;	/* set to make the thread exit */
+};
+
 #endif /* gxclthrd_INCLUDED */
@@ -145,6 +145,17 @@ cmd_write_band(gx_device_clist_writer * cldev, int band_min, int band_max,
 	cb.band_max = band_max;
 	cb.pos = cldev->page_info.io_procs->ftell(cfile);
 	clist_copy_band_complexity(&cb.band_complexity, band_complexity);  
+	if (band_complexity != NULL) {
+	    /* The band keeps the page total; each block records its own */
+	    /* bytes, since appended pages (copypage) restart the total. */
+	    const cmd_prefix *bp;
+	    ulong bytes = 0;
+
+	    for (bp = cp; bp != 0; bp = (bp == pcl->tail ? 0 : bp->next))
+		bytes += bp->size;
+	    band_complexity->cmd_bytes += bytes;
+	    cb.band_complexity.cmd_bytes = bytes;
+	}
 	if_debug4('l', "[l]writing for bands (%d,%d) at %ld K %d \n",
 		  band_min, band_max, (long)cb.pos, cb.band_complexity.uses_color);
 	cldev->page_info.io_procs->fwrite_chars(&cb, sizeof(cb), bfile);
@@ -199,8 +210,7 @@ cmd_write_icctable(gx_device_clist_writer * cldev, unsigned char *pbuf, int data
        is stored in the bfile.  Note complexity information
        is filled in but not used. */
 
-    cb.band_complexity.nontrivial_rops = false;
-    cb.band_complexity.uses_color = false;
+    clist_copy_band_complexity(&cb.band_complexity, NULL);
     cb.band_min = band;
     cb.band_max = band;
     cb.pos = cldev->page_info.io_procs->ftell(cfile);
@@ -48,6 +48,12 @@ typedef struct gx_band_complexity_s {
     bool uses_color;
     bool nontrivial_rops;
 
+    /* per-band profile, for skipping empty bands and tuning band height */
+    ulong cmd_bytes;		/* bytes of commands written for this band */
+    bool uses_images;
+    bool uses_patterns;
+    bool blank;			/* set when reading: nothing but fillpage */
+
 #if 0
     /* halftone phase */
     int x0;
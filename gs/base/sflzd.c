@@ -0,0 +1,221 @@
+/* Copyright (C) 2001-2006 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* $Id$ */
+/* Fast LZ decoding filter for RAM-based band lists */
+#include "memory_.h"
+#include "strimpl.h"
+#include "sflzx.h"
+
+/* ------ FLZDecode ------ */
+
+private_st_FLZD_state();
+
+/* Values for phase */
+#define FLZD_TOKEN 0
+#define FLZD_LITERAL_LENGTH 1
+#define FLZD_LITERALS 2
+#define FLZD_OFFSET_LOW 3
+#define FLZD_OFFSET_HIGH 4
+#define FLZD_MATCH_LENGTH 5
+#define FLZD_MATCH 6
+
+/*
+ * Sequences whose lengths fit in the token take at most this much input
+ * and output, so while there is this much we decode them without keeping
+ * the state up to date.  The literals are copied in one 16-byte piece.
+ */
+#define FLZD_FAST_IN (1 + 16 + 2)
+#define FLZD_FAST_OUT (16 + 14 + FLZ_MIN_MATCH)
+
+/* Copy a match, which may overlap the bytes it produces. */
+static void
+flzd_copy_match(byte * to, uint offset, uint count)
+{
+    const byte *from = to - offset;
+
+    if (offset >= count)
+	memcpy(to, from, count);
+    else {
+	/* Each copy doubles the distance between from and to. */
+	while (count > 0) {
+	    uint n = min(count, to - from);
+
+	    memcpy(to, from, n);
+	    to += n;
+	    count -= n;
+	}
+    }
+}
+
+/* Initialize */
+static int
+s_FLZD_init(stream_state * st)
+{
+    stream_FLZD_state *const ss = (stream_FLZD_state *) st;
+
+    ss->phase = FLZD_TOKEN;
+    ss->token = 0;
+    ss->literals = ss->match = ss->offset = 0;
+    ss->written = 0;
+    return 0;
+}
+
+/* Process a buffer */
+static int
+s_FLZD_process(stream_state * st, stream_cursor_read * pr,
+	       stream_cursor_write * pw, bool last)
+{
+    stream_FLZD_state *const ss = (stream_FLZD_state *) st;
+    const byte *p = pr->ptr;
+    const byte *const rlimit = pr->limit;
+    byte *q = pw->ptr;
+    byte *const wlimit = pw->limit;
+    int status = 0;
+    uint b, count;
+
+    /*
+     * Every phase consumes whatever input there is, so that we never
+     * suspend with unused input: the band list only carries a few bytes
+     * over from one physical block to the next.
+     */
+    for (;;) {
+	switch (ss->phase) {
+	    case FLZD_TOKEN:
+		while (rlimit - p >= FLZD_FAST_IN && wlimit - q >= FLZD_FAST_OUT) {
+		    uint token = p[1];
+		    uint literals = token >> 4;
+		    uint match = (token & 15) + FLZ_MIN_MATCH;
+		    uint offset = p[2 + literals] + (p[3 + literals] << 8);
+		    uint written = ss->written + literals;
+
+		    /* Leave long lengths, the end and errors to the code below. */
+		    if (literals == 15 || match == 15 + FLZ_MIN_MATCH ||
+			(offset == 0 ? literals == 0 : offset > written))
+			break;
+		    memcpy(q + 1, p + 2, 16);
+		    p += 3 + literals;
+		    q += literals;
+		    if (offset != 0) {
+			flzd_copy_match(q + 1, offset, match);
+			q += match;
+			written += match;
+		    }
+		    ss->written = min(written, FLZ_MAX_OFFSET);
+		}
+		if (p >= rlimit)
+		    goto out;
+		ss->token = *++p;
+		ss->literals = ss->token >> 4;
+		ss->match = (ss->token & 15) + FLZ_MIN_MATCH;
+		if (ss->literals < 15) {
+		    ss->phase = FLZD_LITERALS;
+		    continue;
+		}
+		ss->phase = FLZD_LITERAL_LENGTH;
+		/* falls through */
+	    case FLZD_LITERAL_LENGTH:
+		do {
+		    if (p >= rlimit)
+			goto out;
+		    b = *++p;
+		    ss->literals += b;
+		} while (b == 255);
+		ss->phase = FLZD_LITERALS;
+		/* falls through */
+	    case FLZD_LITERALS:
+		if (ss->literals > 0) {
+		    count = ss->literals;
+		    if (count > rlimit - p)
+			count = rlimit - p;
+		    if (count > wlimit - q)
+			count = wlimit - q;
+		    memcpy(q + 1, p + 1, count);
+		    p += count;
+		    q += count;
+		    ss->literals -= count;
+		    if ((ss->written += count) > FLZ_MAX_OFFSET)
+			ss->written = FLZ_MAX_OFFSET;
+		    if (ss->literals > 0) {
+			status = (p < rlimit ? 1 : 0);
+			goto out;
+		    }
+		}
+		ss->phase = FLZD_OFFSET_LOW;
+		/* falls through */
+	    case FLZD_OFFSET_LOW:
+		if (p >= rlimit)
+		    goto out;
+		ss->offset = *++p;
+		ss->phase = FLZD_OFFSET_HIGH;
+		/* falls through */
+	    case FLZD_OFFSET_HIGH:
+		if (p >= rlimit)
+		    goto out;
+		ss->offset += *++p << 8;
+		if (ss->offset == 0) {
+		    /* No match; with no literals either, this is the end. */
+		    ss->phase = FLZD_TOKEN;
+		    if (ss->token >> 4 == 0) {
+			status = EOFC;
+			goto out;
+		    }
+		    continue;
+		}
+		if (ss->offset > ss->written) {
+		    status = ERRC;
+		    goto out;
+		}
+		if ((ss->token & 15) < 15) {
+		    ss->phase = FLZD_MATCH;
+		    continue;
+		}
+		ss->phase = FLZD_MATCH_LENGTH;
+		/* falls through */
+	    case FLZD_MATCH_LENGTH:
+		do {
+		    if (p >= rlimit)
+			goto out;
+		    b = *++p;
+		    ss->match += b;
+		} while (b == 255);
+		ss->phase = FLZD_MATCH;
+		/* falls through */
+	    case FLZD_MATCH:
+		count = ss->match;
+		if (count > wlimit - q)
+		    count = wlimit - q;
+		flzd_copy_match(q + 1, ss->offset, count);
+		q += count;
+		ss->match -= count;
+		if ((ss->written += count) > FLZ_MAX_OFFSET)
+		    ss->written = FLZ_MAX_OFFSET;
+		if (ss->match > 0) {
+		    status = 1;
+		    goto out;
+		}
+		ss->phase = FLZD_TOKEN;
+		continue;
+	}
+    }
+out:
+    pr->ptr = p;
+    pw->ptr = q;
+    return status;
+}
+
+/* Stream template */
+const stream_template s_FLZD_template = {
+    &st_FLZD_state, s_FLZD_init, s_FLZD_process, 1, 1, NULL,
+    NULL, s_FLZD_init
+};
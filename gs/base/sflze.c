@@ -0,0 +1,198 @@
+/* Copyright (C) 2001-2006 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* $Id$ */
+/* Fast LZ encoding filter for RAM-based band lists */
+#include "memory_.h"
+#include "strimpl.h"
+#include "sflzx.h"
+
+/* ------ FLZEncode ------ */
+
+private_st_FLZE_state();
+
+#define FLZ_READ32(p)\
+  ((bits32)(p)[0] | ((bits32)(p)[1] << 8) |\
+   ((bits32)(p)[2] << 16) | ((bits32)(p)[3] << 24))
+#define FLZ_HASH(v)\
+  ((uint)((((v) * 2654435761U) & 0xffffffff) >> (32 - FLZ_HASH_BITS)))
+/* The number of extra bytes needed to write a length nibble of n. */
+#define FLZ_LENGTH_BYTES(n) ((n) < 15 ? 0 : ((n) - 15) / 255 + 1)
+
+/* Initialize */
+static int
+s_FLZE_reinit(stream_state * st)
+{
+    stream_FLZE_state *const ss = (stream_FLZE_state *) st;
+
+    ss->end_written = false;
+    return 0;
+}
+static int
+s_FLZE_init(stream_state * st)
+{
+    stream_FLZE_state *const ss = (stream_FLZE_state *) st;
+
+    /*
+     * Stale table entries are harmless, since every candidate is checked
+     * against the data, but clearing them keeps the output repeatable.
+     */
+    memset(ss->table, 0, sizeof(ss->table));
+    ss->position = 0;
+    return s_FLZE_reinit(st);
+}
+
+/* Write the extension bytes of a length whose nibble is 15. */
+static byte *
+flz_put_length(byte * q, uint n)
+{
+    for (n -= 15; n >= 255; n -= 255)
+	*++q = 255;
+    *++q = (byte)n;
+    return q;
+}
+
+/*
+ * Write as many of count literals as fit as a sequence with no match.
+ * Return the number written.
+ */
+static uint
+flz_put_literals(const byte * p, uint count, byte ** pq, const byte * wlimit)
+{
+    byte *q = *pq;
+    uint room = wlimit - q;
+    uint n;
+
+    if (room < 4)
+	return 0;
+    n = min(count, room - 3);
+    while (n > 0 && 3 + n + FLZ_LENGTH_BYTES(n) > room)
+	--n;
+    if (n == 0)
+	return 0;
+    *++q = (byte)(min(n, 15) << 4);
+    if (n >= 15)
+	q = flz_put_length(q, n);
+    memcpy(q + 1, p, n);
+    q += n;
+    *++q = 0;
+    *++q = 0;
+    *pq = q;
+    return n;
+}
+
+/* Process a buffer */
+static int
+s_FLZE_process(stream_state * st, stream_cursor_read * pr,
+	       stream_cursor_write * pw, bool last)
+{
+    stream_FLZE_state *const ss = (stream_FLZE_state *) st;
+    /*
+     * Matches only refer back within this call's input, which is all the
+     * decoder is sure to have in its output: for the band list, that is
+     * the whole MEMFILE block.
+     */
+    const byte *const base = pr->ptr + 1;
+    const byte *const end = pr->limit + 1;
+    const byte *ip = base;
+    const byte *anchor = base;
+    byte *q = pw->ptr;
+    const byte *const wlimit = pw->limit;
+    bits32 *const table = ss->table;
+    const bits32 position = ss->position;
+    int status = 0;
+
+    if (end - base > FLZ_MIN_MATCH) {
+	const byte *const ilimit = end - FLZ_MIN_MATCH;
+
+	while (ip <= ilimit) {
+	    bits32 v = FLZ_READ32(ip);
+	    uint h = FLZ_HASH(v);
+	    bits32 pos = position + (bits32)(ip - base);
+	    bits32 dist = pos - table[h];
+	    const byte *ref;
+	    const byte *mend;
+	    uint lit, mlen;
+
+	    table[h] = pos;
+	    if (dist == 0 || dist > FLZ_MAX_OFFSET ||
+		dist > (bits32)(ip - base) || FLZ_READ32(ip - dist) != v) {
+		/* Step faster through data that doesn't compress. */
+		ip += 1 + ((ip - anchor) >> 6);
+		continue;
+	    }
+	    ref = ip - dist;
+	    while (ip > anchor && ref > base && ip[-1] == ref[-1])
+		--ip, --ref;
+	    for (mend = ip + FLZ_MIN_MATCH, ref += FLZ_MIN_MATCH;
+		 mend < end && *mend == *ref;
+		 ++mend, ++ref)
+		DO_NOTHING;
+	    lit = ip - anchor;
+	    mlen = mend - ip - FLZ_MIN_MATCH;
+	    if (wlimit - q < 3 + FLZ_LENGTH_BYTES(lit) + lit +
+		FLZ_LENGTH_BYTES(mlen)) {
+		anchor += flz_put_literals(anchor, lit, &q, wlimit);
+		status = 1;
+		goto out;
+	    }
+	    *++q = (byte)((min(lit, 15) << 4) + min(mlen, 15));
+	    if (lit >= 15)
+		q = flz_put_length(q, lit);
+	    memcpy(q + 1, anchor, lit);
+	    q += lit;
+	    *++q = (byte)dist;
+	    *++q = (byte)(dist >> 8);
+	    if (mlen >= 15)
+		q = flz_put_length(q, mlen);
+	    ip = anchor = mend;
+	    /* Remember a position inside the match too. */
+	    if (ip - 2 <= ilimit) {
+		v = FLZ_READ32(ip - 2);
+		table[FLZ_HASH(v)] = position + (bits32)(ip - 2 - base);
+	    }
+	}
+    }
+    /* Flush the trailing literals. */
+    if (anchor < end) {
+	uint lit = end - anchor;
+	uint n = flz_put_literals(anchor, lit, &q, wlimit);
+
+	anchor += n;
+	if (n < lit) {
+	    status = 1;
+	    goto out;
+	}
+    }
+    if (last && !ss->end_written) {
+	if (wlimit - q < 3) {
+	    status = 1;
+	    goto out;
+	}
+	*++q = 0;
+	*++q = 0;
+	*++q = 0;
+	ss->end_written = true;
+    }
+out:
+    ss->position = position + (bits32)(anchor - base);
+    pr->ptr = anchor - 1;
+    pw->ptr = q;
+    return status;
+}
+
+/* Stream template */
+const stream_template s_FLZE_template = {
+    &st_FLZE_state, s_FLZE_init, s_FLZE_process, 1, 4, NULL,
+    NULL, s_FLZE_reinit
+};
@@ -0,0 +1,72 @@
+/* Copyright (C) 2001-2006 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied, modified
+   or distributed except as expressly authorized under the terms of that
+   license.  Refer to licensing information at http://www.artifex.com/
+   or contact Artifex Software, Inc.,  7 Mt. Lassen Drive - Suite A-134,
+   San Rafael, CA  94903, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* $Id$ */
+/* Definitions for the fast LZ filters used by RAM-based band lists */
+/* Requires strimpl.h */
+
+#ifndef sflzx_INCLUDED
+#  define sflzx_INCLUDED
+
+/*
+ * The fast LZ format is a byte-oriented LZ77 that trades compression for
+ * speed: decoding is little more than a memcpy.  The data is a sequence of
+ *	token, [literal length bytes], literals, offset, [match length bytes]
+ * where the high 4 bits of the token are the number of literals and the
+ * low 4 bits are the match length minus FLZ_MIN_MATCH; a nibble of 15 is
+ * extended by following bytes, each added in, until one that is not 255.
+ * The offset is 2 bytes, low-order first, counting back from the end of
+ * the output.  An offset of 0 means the sequence has no match; a sequence
+ * with neither literals nor a match marks the end of the data.
+ *
+ * The decoder copies matches from its own earlier output, so the client
+ * must keep all of the output since the (re)initialization in the output
+ * buffer.  The band list decodes each MEMFILE block into a single raw
+ * buffer, which meets this; the filters are not suitable for use on
+ * general streams.
+ */
+#define FLZ_MIN_MATCH 4
+#define FLZ_MAX_OFFSET 0xffff
+#define FLZ_HASH_BITS 12
+
+/* FLZEncode */
+typedef struct stream_FLZE_state_s {
+    stream_state_common;
+    /* The following change dynamically. */
+    bool end_written;		/* true if the EOD sequence has been written */
+    bits32 position;		/* input bytes seen since initialization */
+    bits32 table[1 << FLZ_HASH_BITS];	/* last position of each hash */
+} stream_FLZE_state;
+
+#define private_st_FLZE_state()	/* in sflze.c */\
+  gs_private_st_simple(st_FLZE_state, stream_FLZE_state, "FLZEncode state")
+extern const stream_template s_FLZE_template;
+
+/* FLZDecode */
+typedef struct stream_FLZD_state_s {
+    stream_state_common;
+    /* The following change dynamically. */
+    int phase;			/* which part of a sequence comes next */
+    int token;			/* token of the current sequence */
+    uint literals;		/* # of literals left to copy */
+    uint match;			/* # of match bytes left to copy */
+    uint offset;		/* offset of the match */
+    uint written;		/* bytes written since (re)initialization, */
+				/* up to FLZ_MAX_OFFSET */
+} stream_FLZD_state;
+
+#define private_st_FLZD_state()	/* in sflzd.c */\
+  gs_private_st_simple(st_FLZD_state, stream_FLZD_state, "FLZDecode state")
+extern const stream_template s_FLZD_template;
+
+#endif /* sflzx_INCLUDED */